@@ -17,6 +17,9 @@ limitations under the License.
 #include "oneflow/api/python/of_api_registry.h"
 #include "oneflow/core/vm/vm_util.h"
 #include "oneflow/core/eager/dev_vm_dep_object_consume_mode.h"
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/eager/tensor_offloader.h"
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
 
 ONEFLOW_API_PYBIND11_MODULE("eager", m) {
   using namespace oneflow;
@@ -32,4 +35,34 @@ ONEFLOW_API_PYBIND11_MODULE("eager", m) {
     return std::make_shared<one::DevVmDepObjectConsumeModeGuard>(
         one::DevVmDepObjectConsumeMode::NONE);
   });
+
+  m.def("DtrStats", []() {
+    py::dict ret;
+    ret["enabled"] = vm::DtrTensorPool::Enabled();
+    if (!vm::DtrTensorPool::Enabled()) { return ret; }
+    const vm::DtrTensorPoolStats stats = vm::DtrTensorPool::Get()->GetStats();
+    ret["evicted_cnt"] = stats.evicted_cnt;
+    ret["evicted_bytes"] = stats.evicted_bytes;
+    ret["rematerialized_cnt"] = stats.rematerialized_cnt;
+    return ret;
+  });
+
+  m.def("OffloadStats", []() {
+    py::dict ret;
+    ret["enabled"] = vm::TensorOffloader::Enabled();
+    if (!vm::TensorOffloader::Enabled()) { return ret; }
+    const vm::TensorOffloaderStats stats = vm::TensorOffloader::Get()->GetStats();
+    ret["offload_cnt"] = stats.offload_cnt;
+    ret["offloaded_bytes"] = stats.offloaded_bytes;
+    ret["prefetch_cnt"] = stats.prefetch_cnt;
+    ret["on_demand_restore_cnt"] = stats.on_demand_restore_cnt;
+    ret["restored_bytes"] = stats.restored_bytes;
+    ret["resident_bytes"] = stats.resident_bytes;
+    return ret;
+  });
+
+  // Returns the large cpu blocks kept for reuse to the system, and the number of bytes released.
+  m.def(
+      "EmptyCpuHostCache", []() { return ep::NumaHostAllocator::Get()->EmptyCache(); },
+      py::call_guard<py::gil_scoped_release>());
 }
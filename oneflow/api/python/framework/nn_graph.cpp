@@ -22,6 +22,7 @@ limitations under the License.
 #include "oneflow/core/framework/multi_client_session_context.h"
 #include "oneflow/core/framework/tensor.h"
 #include "oneflow/core/framework/nn_graph.h"
+#include "oneflow/core/common/protobuf.h"
 #include "oneflow/core/job/runtime.h"
 #include "oneflow/core/register/blob.h"
 #include "oneflow/core/job/job.pb.h"
@@ -75,6 +76,9 @@ ONEFLOW_API_PYBIND11_MODULE("nn.graph.", m) {
            &NNGraph::RegisterAdditionalVarOpNamesAndTensorsToBeLoaded)
       .def_property_readonly("additional_var_names", &APINNGraphAdditionalVarNames)
       .def_property_readonly("additional_var_tensors", &APINNGraphAdditionalVarTensors)
+      .def_property_readonly("plan_cache_hit", &NNGraph::plan_cache_hit)
+      .def_property_readonly(
+          "plan", [](const NNGraph& nn_graph) { return PbMessage2TxtString(nn_graph.plan()); })
       .def("complie_and_init_runtime", &NNGraph::CompileAndInitRuntime);
 
   m.def("RunLazyNNGraph", &RunLazyNNGraph);
@@ -230,69 +230,7 @@ class AssignLocalTensorFunctor {
 class LocalTensorSharedNumpyDataFunctor {
  public:
   LocalTensorSharedNumpyDataFunctor() {}
-  Maybe<Tensor> operator()(PyObject* obj) const {
-    if (!PyArray_Check(obj)) {
-      return Error::TypeError() << "expected np.ndarray, but got " << Py_TYPE(obj)->tp_name;
-    }
-    auto* array = reinterpret_cast<PyArrayObject*>(obj);
-    // TODO(wyg): support non-contiguous array.
-    if (!PyArray_IS_C_CONTIGUOUS(array)) {
-      OF_LOG_ONCE(LOG(WARNING) << "OneFlow don't support non-contiguous array now, "
-                                  "and we will copy the array to a contiguous one.");
-      array = PyArray_GETCONTIGUOUS(array);
-    }
-
-    // Build TensorMeta
-    int32_t dim = PyArray_NDIM(array);
-    const npy_intp* dims_ptr = PyArray_SHAPE(array);
-    const auto shape = std::make_shared<Shape>(DimVector(dims_ptr, dims_ptr + dim));
-    DataType data_type = JUST(numpy::GetOFDataTypeFromNpArray(array));
-    Symbol<Device> device = JUST(Device::New("cpu"));
-    const npy_intp* stride_ptr = PyArray_STRIDES(array);
-    // stride
-    auto strides_vec = DimVector(stride_ptr, stride_ptr + dim);
-    auto element_size_in_bytes = PyArray_ITEMSIZE(array);
-    // NumPy strides use bytes. OneFlow strides use element counts.
-    for (auto& stride : strides_vec) {
-      if (stride % element_size_in_bytes != 0) {
-        return Error::RuntimeError() << "given numpy array strides not a multiple of the element "
-                                        "byte size. Copy the numpy array to reallocate the memory.";
-      }
-      stride /= element_size_in_bytes;
-    }
-    const auto strides = std::make_shared<Stride>(strides_vec);
-    auto tensor_meta = std::make_shared<MirroredTensorMeta>(shape, strides, data_type, device, 0);
-
-    // Build TensorBuffer
-    const auto& Free = [obj](char* dptr) {
-      CHECK_JUST(Global<ForeignLockHelper>::Get()->WithScopedAcquire([&]() -> Maybe<void> {
-        Py_DECREF(obj);
-        return Maybe<void>::Ok();
-      }));
-    };
-    Py_INCREF(obj);  // make TensorBuffer hold ndarray
-    void* data_ptr = PyArray_DATA(array);
-    auto array_size_in_bytes = PyArray_NBYTES(array);
-    auto tensor_data = std::make_shared<vm::TensorStorage>();
-    tensor_data->set_blob_dptr(
-        std::unique_ptr<char, std::function<void(char*)>>(static_cast<char*>(data_ptr), Free),
-        array_size_in_bytes);
-
-    // Build TensorStorage: decrease ndarray reference count before releasing
-    auto tensor_storage = std::make_shared<TensorStorage>(tensor_data);
-
-    // Build Tensor
-    auto tensor_impl = std::make_shared<EagerMirroredTensorImpl>(tensor_meta, tensor_storage,
-                                                                 /*requires_grad=*/false,
-                                                                 /*ls_leaf=*/true);
-
-    // Init blob
-    JUST(tensor_impl->InitEagerBlobObject(NewLocalDepObject(), /*pin_memory=*/false));
-    const auto& stream = GetDefaultStreamByDevice(device);
-    JUST(tensor_impl->eager_blob_object())->set_last_used_stream(stream);
-    std::shared_ptr<Tensor> out(new MirroredTensor(tensor_impl));
-    return out;
-  }
+  Maybe<Tensor> operator()(PyObject* obj) const { return MakeLocalTensorSharedNumpyData(obj); }
 };
 
 }  // namespace impl
@@ -37,6 +37,30 @@ ONEFLOW_API_PYBIND11_MODULE("multiprocessing", m) {
                              })
       .def_property_readonly("name", &ipc::SharedMemory::name)
       .def_property_readonly("size", &ipc::SharedMemory::size);
+  py::class_<ipc::SharedMemoryBatchRing, std::shared_ptr<ipc::SharedMemoryBatchRing>>(
+      m, "SharedMemoryBatchRing")
+      .def_static("create",
+                  [](size_t slot_num, size_t slot_size) {
+                    return ipc::SharedMemoryBatchRing::Create(slot_num, slot_size).GetPtrOrThrow();
+                  })
+      .def_static("open",
+                  [](const std::string& name) {
+                    return ipc::SharedMemoryBatchRing::Open(name).GetPtrOrThrow();
+                  })
+      .def("try_acquire_slot", &ipc::SharedMemoryBatchRing::TryAcquireSlot)
+      .def("release_slot",
+           [](ipc::SharedMemoryBatchRing* ring, int64_t slot_id) {
+             return ring->ReleaseSlot(slot_id).GetOrThrow();
+           })
+      .def("slot_buf",
+           [](ipc::SharedMemoryBatchRing* ring, int64_t slot_id) {
+             return py::memoryview::from_memory(ring->MutSlotBuf(slot_id).GetOrThrow(),
+                                                ring->slot_size());
+           })
+      .def_property_readonly("name", &ipc::SharedMemoryBatchRing::name)
+      .def_property_readonly("slot_num", &ipc::SharedMemoryBatchRing::slot_num)
+      .def_property_readonly("slot_size", &ipc::SharedMemoryBatchRing::slot_size)
+      .def_property_readonly("used_slot_num", &ipc::SharedMemoryBatchRing::used_slot_num);
   m.def("unlink_all_shared_memory",
         []() { return ipc::SharedMemoryManager::get().UnlinkAllShms(); });
 }
@@ -0,0 +1,113 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/rpc/include/base.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace {
+
+Maybe<CtrlClient*> GetCtrlClient() {
+  CtrlClient* client = Global<CtrlClient>::Get();
+  CHECK_NOTNULL_OR_RETURN(client) << "the control plane is not initialized";
+  return client;
+}
+
+}  // namespace
+
+// Direct access to the control plane key-value store, for tests and tools/ benchmarks of the
+// bootstrap paths. Every call may block on other ranks, so the GIL is released.
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  m.def(
+      "CtrlBarrier",
+      [](const std::string& barrier_name) -> Maybe<void> {
+        JUST(GetCtrlClient())->Barrier(barrier_name);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlPushKV",
+      [](const std::string& key, const std::string& val) -> Maybe<void> {
+        JUST(GetCtrlClient())->PushKV(key, val);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlPullKV",
+      [](const std::string& key) -> Maybe<std::string> {
+        std::string val;
+        JUST(GetCtrlClient())->PullKV(key, &val);
+        return val;
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlClearKV",
+      [](const std::string& key) -> Maybe<void> {
+        JUST(GetCtrlClient())->ClearKV(key);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlBatchPushKV",
+      [](const std::vector<std::pair<std::string, std::string>>& kvs) -> Maybe<void> {
+        JUST(GetCtrlClient())->BatchPushKV(kvs);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlBatchPullKV",
+      [](const std::vector<std::string>& keys) -> Maybe<std::vector<std::string>> {
+        std::vector<std::string> vals;
+        JUST(GetCtrlClient())->BatchPullKV(keys, &vals);
+        return vals;
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlPushPrefixKV",
+      [](const std::string& prefix, const std::string& key, const std::string& val) -> Maybe<void> {
+        JUST(GetCtrlClient())->PushPrefixKV(prefix, key, val);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlPullKVByPrefix",
+      [](const std::string& prefix, int32_t num) -> Maybe<std::map<std::string, std::string>> {
+        HashMap<std::string, std::string> kvs;
+        JUST(GetCtrlClient())->PullKVByPrefix(prefix, num, &kvs);
+        return std::map<std::string, std::string>(kvs.begin(), kvs.end());
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlClearKVByPrefix",
+      [](const std::string& prefix) -> Maybe<void> {
+        JUST(GetCtrlClient())->ClearKVByPrefix(prefix);
+        return Maybe<void>::Ok();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "CtrlIncreaseCount",
+      [](const std::string& key, int32_t val) -> Maybe<int32_t> {
+        return JUST(GetCtrlClient())->IncreaseCount(key, val);
+      },
+      py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace oneflow
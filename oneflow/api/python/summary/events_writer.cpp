@@ -0,0 +1,50 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/user/summary/events_writer.h"
+
+namespace oneflow {
+namespace summary {
+
+namespace py = pybind11;
+
+namespace {
+
+Maybe<EventsWriterStats> GetEventsWriterStatsMaybe() {
+  auto* events_writer = JUST(GlobalMaybe<EventsWriter>());
+  return events_writer->GetStats();
+}
+
+py::dict GetEventsWriterStats() {
+  const auto& stats = GetEventsWriterStatsMaybe().GetOrThrow();
+  py::dict ret;
+  ret["written_event_num"] = stats.written_event_num;
+  ret["written_bytes"] = stats.written_bytes;
+  ret["dropped_event_num"] = stats.dropped_event_num;
+  ret["events_per_second"] = stats.events_per_second;
+  return ret;
+}
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("summary", m) {
+  m.def("GetEventsWriterStats", &GetEventsWriterStats);
+}
+
+}  // namespace summary
+}  // namespace oneflow
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/api/python/utils/tensor_utils.h"
 
+#include <cstring>
 #include "oneflow/api/python/ofblob/ofblob.e.h"
 #include "oneflow/core/autograd/autograd_engine.h"
 #include "oneflow/core/common/container_util.h"
@@ -26,6 +27,13 @@ limitations under the License.
 #include "oneflow/core/common/decorator.h"
 #include "oneflow/core/framework/consistency_check.h"
 #include "oneflow/core/functional/impl/common.h"
+#include "oneflow/core/framework/stream.h"
+#include "oneflow/core/framework/tensor_impl.h"
+#include "oneflow/core/eager/local_dep_object.h"
+#include "oneflow/core/framework/shut_down_util.h"
+#ifdef WITH_CUDA
+#include "oneflow/core/vm/cuda_host_allocator.h"
+#endif  // WITH_CUDA
 
 namespace py = pybind11;
 
@@ -140,6 +148,140 @@ Maybe<py::tuple> TensorGetPyTupleOfSbp(const Tensor& tensor) {
 DEFINE_STATIC_SWITCH_FUNC(Maybe<void>, CopyMirroredTensorFromUntypedArray, MAKE_SWITCH_ENTRY,
                           MAKE_DATA_TYPE_CTRV_SEQ(POD_AND_HALF_DATA_TYPE_SEQ));
 
+namespace {
+
+// Builds a cpu tensor on top of host memory which is already filled, `dptr` is released together
+// with the tensor storage.
+Maybe<Tensor> MakeLocalTensorFromHostMemory(
+    const std::shared_ptr<MirroredTensorMeta>& tensor_meta,
+    std::unique_ptr<char, std::function<void(char*)>>&& dptr, size_t bytes, const bool pin_memory) {
+  auto tensor_data = std::make_shared<vm::TensorStorage>();
+  tensor_data->set_blob_dptr(std::move(dptr), bytes);
+  auto tensor_storage = std::make_shared<TensorStorage>(tensor_data);
+  auto tensor_impl = std::make_shared<EagerMirroredTensorImpl>(tensor_meta, tensor_storage,
+                                                               /*requires_grad=*/false,
+                                                               /*ls_leaf=*/true);
+  JUST(tensor_impl->InitEagerBlobObject(NewLocalDepObject(), pin_memory));
+  const auto& stream = GetDefaultStreamByDevice(tensor_meta->device());
+  JUST(tensor_impl->eager_blob_object())->set_last_used_stream(stream);
+  std::shared_ptr<Tensor> out(new MirroredTensor(tensor_impl));
+  return out;
+}
+
+}  // namespace
+
+Maybe<Tensor> MakeLocalTensorSharedNumpyData(PyObject* obj) {
+  if (!PyArray_Check(obj)) {
+    return Error::TypeError() << "expected np.ndarray, but got " << Py_TYPE(obj)->tp_name;
+  }
+  auto* array = reinterpret_cast<PyArrayObject*>(obj);
+  // TODO(wyg): support non-contiguous array.
+  if (!PyArray_IS_C_CONTIGUOUS(array)) {
+    OF_LOG_ONCE(LOG(WARNING) << "OneFlow don't support non-contiguous array now, "
+                                "and we will copy the array to a contiguous one.");
+    // PyArray_GETCONTIGUOUS returns a new reference which is owned by the tensor storage below
+    array = PyArray_GETCONTIGUOUS(array);
+  } else {
+    Py_INCREF(obj);  // make TensorBuffer hold ndarray
+  }
+  PyObject* owner = reinterpret_cast<PyObject*>(array);
+
+  // Build TensorMeta
+  int32_t dim = PyArray_NDIM(array);
+  const npy_intp* dims_ptr = PyArray_SHAPE(array);
+  const auto shape = std::make_shared<Shape>(DimVector(dims_ptr, dims_ptr + dim));
+  DataType data_type = JUST(numpy::GetOFDataTypeFromNpArray(array));
+  Symbol<Device> device = JUST(Device::New("cpu"));
+  const npy_intp* stride_ptr = PyArray_STRIDES(array);
+  // stride
+  auto strides_vec = DimVector(stride_ptr, stride_ptr + dim);
+  auto element_size_in_bytes = PyArray_ITEMSIZE(array);
+  // NumPy strides use bytes. OneFlow strides use element counts.
+  for (auto& stride : strides_vec) {
+    if (stride % element_size_in_bytes != 0) {
+      Py_DECREF(owner);
+      return Error::RuntimeError() << "given numpy array strides not a multiple of the element "
+                                      "byte size. Copy the numpy array to reallocate the memory.";
+    }
+    stride /= element_size_in_bytes;
+  }
+  const auto strides = std::make_shared<Stride>(strides_vec);
+  auto tensor_meta = std::make_shared<MirroredTensorMeta>(shape, strides, data_type, device, 0);
+
+  // Build TensorBuffer
+  const auto& Free = [owner](char* dptr) {
+    CHECK_JUST(Global<ForeignLockHelper>::Get()->WithScopedAcquire([&]() -> Maybe<void> {
+      Py_DECREF(owner);
+      return Maybe<void>::Ok();
+    }));
+  };
+  void* data_ptr = PyArray_DATA(array);
+  auto array_size_in_bytes = PyArray_NBYTES(array);
+  // the storage decreases the ndarray reference count when it is released
+  return MakeLocalTensorFromHostMemory(
+      tensor_meta,
+      std::unique_ptr<char, std::function<void(char*)>>(static_cast<char*>(data_ptr), Free),
+      array_size_in_bytes, /*pin_memory=*/false);
+}
+
+namespace {
+
+// Copies a C-contiguous numpy array into pinned memory from the cached host allocator. The copy
+// runs on the calling thread instead of in a vm instruction, so the caller may reuse the array as
+// soon as this returns and nothing waits for the vm.
+Maybe<Tensor> MakePinnedLocalTensorFromArray(PyArrayObject* array, const Shape& shape,
+                                             DataType data_type) {
+#ifdef WITH_CUDA
+  vm::Allocator* allocator = Global<vm::CudaHostAllocator>::Get();
+  const size_t bytes = PyArray_NBYTES(array);
+  char* dptr = nullptr;
+  if (bytes > 0) {
+    allocator->Allocate(&dptr, bytes);
+    std::memcpy(dptr, PyArray_DATA(array), bytes);
+  }
+  const auto& Free = [allocator, bytes](char* dptr) {
+    if (IsShuttingDown()) { return; }
+    allocator->Deallocate(dptr, bytes);
+  };
+  const auto& shape_ptr = std::make_shared<Shape>(shape);
+  auto tensor_meta = std::make_shared<MirroredTensorMeta>(
+      shape_ptr, std::make_shared<Stride>(shape), data_type, JUST(Device::New("cpu")), 0);
+  return MakeLocalTensorFromHostMemory(
+      tensor_meta, std::unique_ptr<char, std::function<void(char*)>>(dptr, Free), bytes,
+      /*pin_memory=*/true);
+#else
+  return Error::RuntimeError() << "pinned memory is only available in builds with CUDA.";
+#endif  // WITH_CUDA
+}
+
+// Whether MakeLocalTensorFromArray is done reading the array when it returns. Otherwise the array
+// is taken over by the tensor or read by a vm instruction later, and has to be a private copy.
+bool IsArrayBorrowed(Symbol<Device> device, const bool pin_memory) {
+  return device->type() == "cuda" || (device->type() == "cpu" && pin_memory);
+}
+
+// Makes a tensor on `device` from a C-contiguous numpy array. Cpu tensors take over the array
+// memory. Cuda and pinned tensors are filled from pinned staging memory, the host to device copy
+// is an asynchronous copy op and the staging buffer goes back to the cached host allocator once it
+// is done, so repeated feeding reuses the same staging memory.
+Maybe<Tensor> MakeLocalTensorFromArray(PyObject* array, const Shape& shape, DataType data_type,
+                                       Symbol<Device> device, const bool pin_memory) {
+  if (device->type() == "cpu" && !pin_memory) { return MakeLocalTensorSharedNumpyData(array); }
+  auto* np_arr = reinterpret_cast<PyArrayObject*>(array);
+  if (device->type() == "cpu") { return MakePinnedLocalTensorFromArray(np_arr, shape, data_type); }
+  if (device->type() == "cuda") {
+    const auto& staging_tensor = JUST(MakePinnedLocalTensorFromArray(np_arr, shape, data_type));
+    return functional::Copy(staging_tensor, device->type(), device->device_id(),
+                            /*pin_memory=*/false);
+  }
+  const auto& tensor = JUST(
+      functional::Empty(shape, JUST(DType::Get(data_type)), device, /*pin_memory=*/pin_memory));
+  JUST(SwitchCopyMirroredTensorFromUntypedArray(SwitchCase(data_type), tensor, array));
+  return tensor;
+}
+
+}  // namespace
+
 Maybe<Tensor> MakeLocalTensorFromData(PyObject* data, const Optional<Symbol<DType>>& dtype,
                                       const Optional<Symbol<Device>>& device,
                                       const bool requires_grad, const bool pin_memory) {
@@ -148,12 +290,21 @@ Maybe<Tensor> MakeLocalTensorFromData(PyObject* data, const Optional<Symbol<DTyp
       dtype.has_value()
           ? PyArray_DescrFromType(JUST(numpy::OFDataTypeToNumpyType(JUST(dtype)->data_type())))
           : nullptr;
+  Symbol<Device> device_;
+  if (device) {
+    device_ = JUST(device);
+  } else {
+    device_ = JUST(Device::New("cpu"));
+  }
   // PyArray_FromAny steals a reference to np_dtype object, so no need to decref it.
   // NPY_ARRAY_DEFAULT is NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_BEHAVED, so the
   // array with NPY_ARRAY_DEFAULT flag is C-style contiguous.
   // NPY_ARRAY_FORCECAST is needed otherwise there will a segfault.
-  array = PyArray_FromAny(data, np_dtype, 0, 0,
-                          NPY_ARRAY_DEFAULT | NPY_ARRAY_ENSURECOPY | NPY_ARRAY_FORCECAST, nullptr);
+  // A borrowed ndarray which is already C-contiguous with the requested dtype is used as is.
+  const int requirements = IsArrayBorrowed(device_, pin_memory)
+                               ? NPY_ARRAY_CARRAY_RO | NPY_ARRAY_FORCECAST
+                               : NPY_ARRAY_DEFAULT | NPY_ARRAY_ENSURECOPY | NPY_ARRAY_FORCECAST;
+  array = PyArray_FromAny(data, np_dtype, 0, 0, requirements, nullptr);
   if (!array) {
     return Error::RuntimeError() << "Can not convert input data to a new numpy array.";
   }
@@ -172,15 +323,8 @@ Maybe<Tensor> MakeLocalTensorFromData(PyObject* data, const Optional<Symbol<DTyp
   const Shape shape(DimVector(dims_ptr, dims_ptr + PyArray_NDIM(np_arr)));
   DataType data_type = JUST(numpy::GetOFDataTypeFromNpArray(np_arr));
 
-  Symbol<Device> device_;
-  if (device) {
-    device_ = JUST(device);
-  } else {
-    device_ = JUST(Device::New("cpu"));
-  }
-  std::shared_ptr<Tensor> tensor = JUST(
-      functional::Empty(shape, JUST(DType::Get(data_type)), device_, /*pin_memory=*/pin_memory));
-  JUST(SwitchCopyMirroredTensorFromUntypedArray(SwitchCase(data_type), tensor, array));
+  std::shared_ptr<Tensor> tensor =
+      JUST(MakeLocalTensorFromArray(array, shape, data_type, device_, pin_memory));
 
   Py_DECREF(array);
   JUST(tensor->set_requires_grad(requires_grad));
@@ -230,8 +374,7 @@ Maybe<Tensor> MakeConsistentTensorFromData(PyObject* data, const Optional<Symbol
 
   Symbol<Device> device = JUST(Device::New(placement->device_tag()));
   std::shared_ptr<Tensor> local_tensor =
-      JUST(functional::Empty(shape, JUST(DType::Get(data_type)), device, /*pin_memory=*/false));
-  JUST(SwitchCopyMirroredTensorFromUntypedArray(SwitchCase(data_type), local_tensor, array));
+      JUST(MakeLocalTensorFromArray(array, shape, data_type, device, /*pin_memory=*/false));
 
   Py_DECREF(array);
   // Cast to float if data is double sequence, rather than numpy array.
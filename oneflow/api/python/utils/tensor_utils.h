@@ -140,6 +140,10 @@ Maybe<void> RegisterTensorPostGradAccumulationHook(const std::shared_ptr<Tensor>
 
 Maybe<py::tuple> TensorGetPyTupleOfSbp(const Tensor& tensor);
 
+// Wraps the memory of a numpy array as a cpu tensor without copying. The array is kept alive
+// until the tensor storage is released.
+Maybe<Tensor> MakeLocalTensorSharedNumpyData(PyObject* obj);
+
 Maybe<Tensor> MakeLocalTensorFromData(PyObject* data, const Optional<Symbol<DType>>& dtype,
                                       const Optional<Symbol<Device>>& device,
                                       const bool requires_grad, const bool pin_memory);
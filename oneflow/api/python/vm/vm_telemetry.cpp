@@ -0,0 +1,101 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/vm/virtual_machine.h"
+#include "oneflow/core/vm/vm_telemetry.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace py = pybind11;
+
+namespace {
+
+Maybe<VmTelemetrySnapshot> GetVmTelemetrySnapshot() {
+  auto* virtual_machine = JUST(GlobalMaybe<VirtualMachine>());
+  return virtual_machine->vm().telemetry().Snapshot();
+}
+
+py::dict LatencySummaryToDict(const LatencySummary& summary) {
+  py::dict ret;
+  ret["count"] = summary.count;
+  ret["sum_ns"] = summary.sum_ns;
+  ret["p50_ns"] = summary.p50_ns;
+  ret["p99_ns"] = summary.p99_ns;
+  ret["max_ns"] = summary.max_ns;
+  return ret;
+}
+
+py::dict GetVmTelemetry() {
+  const auto& snapshot = GetVmTelemetrySnapshot().GetOrThrow();
+  py::dict streams;
+  for (const auto& stream : snapshot.streams) {
+    py::dict stream_dict;
+    stream_dict["waiting"] = stream.waiting;
+    stream_dict["ready"] = stream.ready;
+    stream_dict["running"] = stream.running;
+    stream_dict["dispatched"] = stream.dispatched;
+    streams[py::str(stream.name)] = stream_dict;
+  }
+  py::dict instr_types;
+  for (const auto& instr_type : snapshot.instr_types) {
+    py::dict instr_type_dict;
+    instr_type_dict["receive_to_dispatch"] = LatencySummaryToDict(instr_type.receive_to_dispatch);
+    instr_type_dict["dispatch_to_done"] = LatencySummaryToDict(instr_type.dispatch_to_done);
+    instr_types[py::str(instr_type.name)] = instr_type_dict;
+  }
+  py::dict threads;
+  for (const auto& thread : snapshot.threads) {
+    py::dict thread_dict;
+    thread_dict["cpu_ns"] = thread.cpu_ns;
+    thread_dict["spin_us"] = thread.spin_us;
+    thread_dict["spin_hit_cnt"] = thread.spin_hit_cnt;
+    thread_dict["spin_miss_cnt"] = thread.spin_miss_cnt;
+    thread_dict["park_cnt"] = thread.park_cnt;
+    thread_dict["spin_budget_us"] = thread.spin_budget_us;
+    threads[py::str(thread.name)] = thread_dict;
+  }
+  py::dict fusion;
+  fusion["handled_msg_cnt"] = snapshot.handled_msg_cnt;
+  fusion["fused_msg_cnt"] = snapshot.fused_msg_cnt;
+  fusion["fused_instr_cnt"] = snapshot.fused_instr_cnt;
+  fusion["ratio"] = snapshot.fusion_ratio();
+  py::dict scheduler;
+  scheduler["busy_ns"] = snapshot.scheduler_busy_ns;
+  scheduler["idle_ns"] = snapshot.scheduler_idle_ns;
+  scheduler["wakeup_cnt"] = snapshot.scheduler_wakeup_cnt;
+  py::dict ret;
+  ret["streams"] = streams;
+  ret["instruction_types"] = instr_types;
+  ret["fusion"] = fusion;
+  ret["scheduler"] = scheduler;
+  ret["threads"] = threads;
+  return ret;
+}
+
+std::string GetVmTelemetryString() { return GetVmTelemetrySnapshot().GetOrThrow().DebugString(); }
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("vm", m) {
+  m.def("GetVmTelemetry", &GetVmTelemetry);
+  m.def("GetVmTelemetryString", &GetVmTelemetryString);
+}
+
+}  // namespace vm
+}  // namespace oneflow
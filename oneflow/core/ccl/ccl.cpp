@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/ccl/ccl.h"
+#include <array>
 #include "oneflow/core/device/nccl_util.h"
 #include "oneflow/core/framework/transport_util.h"
 #include "oneflow/core/job/parallel_desc.h"
@@ -51,16 +52,317 @@ int64_t RingDecrease(int64_t n, int64_t size) { return (n - 1 + size) % size; }
 
 int64_t RingIncrease(int64_t n, int64_t size) { return (n + 1 + size) % size; }
 
+// The part reduced, or received, at `step` of a ring pass whose first step sends `first_send_part`.
+int64_t RingRecvPart(int64_t first_send_part, int64_t step, int64_t size) {
+  return ((first_send_part - step - 1) % size + size) % size;
+}
+
+// Smaller reductions are not worth handing to the thread pool.
+constexpr size_t kMinElemCntPerReduceThread = 32 * 1024;
+constexpr int64_t kMaxPipelineChunkNum = 16;
+
+template<typename T>
+void VecAddRange(size_t begin, size_t end, T* out, const T* in0, const T* in1) {
+  // `out` may alias `in0`, so no restrict; the loop is still left simple enough to vectorize.
+  for (size_t i = begin; i < end; ++i) { out[i] = in0[i] + in1[i]; }
+}
+
 template<typename T>
 void VecAdd(size_t size, T* out, const T* in0, const T* in1) {
-  size_t thread_num = Global<ThreadPool>::Get()->thread_num();
+  size_t thread_num =
+      std::min<size_t>(Global<ThreadPool>::Get()->thread_num(), size / kMinElemCntPerReduceThread);
+  if (thread_num <= 1) {
+    VecAddRange(0, size, out, in0, in1);
+    return;
+  }
   BalancedSplitter bs(size, thread_num);
   MultiThreadLoop(thread_num, [&](size_t thread_idx) {
-    size_t end = bs.At(thread_idx).end();
-    for (size_t i = bs.At(thread_idx).begin(); i < end; ++i) { out[i] = in0[i] + in1[i]; }
+    VecAddRange(bs.At(thread_idx).begin(), bs.At(thread_idx).end(), out, in0, in1);
   });
 }
 
+enum class CpuAllReduceAlgorithm {
+  kRing,
+  kHalvingDoubling,
+};
+
+// ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO is "ring", "halving_doubling" or "auto", which picks
+// halving-doubling up to ONEFLOW_CCL_CPU_HALVING_DOUBLING_MAX_BYTES. They are read on each call so
+// that benchmarks can switch between calls, and must be the same on all ranks.
+Maybe<CpuAllReduceAlgorithm> GetCpuAllReduceAlgorithm(size_t buffer_size) {
+  const std::string algo = GetStringFromEnv("ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO", "auto");
+  if (algo == "ring") { return CpuAllReduceAlgorithm::kRing; }
+  if (algo == "halving_doubling") { return CpuAllReduceAlgorithm::kHalvingDoubling; }
+  CHECK_EQ_OR_RETURN(algo, "auto") << "invalid ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO " << algo;
+  const int64_t max_bytes =
+      ParseIntegerFromEnv("ONEFLOW_CCL_CPU_HALVING_DOUBLING_MAX_BYTES", 256 * 1024);
+  return static_cast<int64_t>(buffer_size) <= max_bytes
+             ? CpuAllReduceAlgorithm::kHalvingDoubling
+             : CpuAllReduceAlgorithm::kRing;
+}
+
+// Ring parts are cut into chunks of about ONEFLOW_CCL_CPU_CHUNK_BYTES. Every rank must get the
+// same number, so it is derived from the largest part.
+int64_t GetPipelineChunkNum(size_t max_part_size) {
+  const int64_t chunk_size =
+      std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_CCL_CPU_CHUNK_BYTES", 1024 * 1024), 1);
+  const int64_t chunk_num = (max_part_size + chunk_size - 1) / chunk_size;
+  return std::max<int64_t>(std::min(chunk_num, kMaxPipelineChunkNum), 1);
+}
+
+using TransportCtxList = std::vector<std::unique_ptr<NaiveAsyncTransportCtx>>;
+
+std::unique_ptr<NaiveAsyncTransportCtx> NewTransportCtx(const TransportToken& transport_token,
+                                                        const void* send_ptr, size_t send_size,
+                                                        void* recv_ptr, size_t recv_size) {
+  return std::make_unique<NaiveAsyncTransportCtx>(
+      transport_token,
+      [send_ptr, send_size](void** buffer, std::size_t* size,
+                            std::function<void()>* Cb) -> Maybe<void> {
+        *buffer = const_cast<void*>(send_ptr);
+        *size = send_size;
+        *Cb = [] {};
+        return Maybe<void>::Ok();
+      },
+      [recv_ptr, recv_size](void** buffer, std::size_t* size,
+                            std::function<void()>* Cb) -> Maybe<void> {
+        *buffer = recv_ptr;
+        *size = recv_size;
+        *Cb = [] {};
+        return Maybe<void>::Ok();
+      });
+}
+
+Maybe<void> SendToNextRankInRing(Symbol<RankGroup> rank_group,
+                                 const TransportToken& transport_token, const void* ptr,
+                                 size_t size, TransportCtxList* ctxs) {
+  ctxs->emplace_back(NewTransportCtx(transport_token, ptr, size, nullptr, 0));
+  if (size > 0) {
+    JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, ctxs->back().get()));
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> ReceiveFromPrevRankInRing(Symbol<RankGroup> rank_group,
+                                      const TransportToken& transport_token, void* ptr,
+                                      size_t size, TransportCtxList* ctxs) {
+  ctxs->emplace_back(NewTransportCtx(transport_token, nullptr, 0, ptr, size));
+  if (size > 0) {
+    JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token,
+                                                  ctxs->back().get()));
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> WaitAllDone(TransportCtxList* ctxs) {
+  for (const auto& ctx : *ctxs) { JUST(ctx->WaitDone()); }
+  ctxs->clear();
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> SendRecv(int64_t peer_rank, const TransportToken& transport_token,
+                     const void* send_ptr, size_t send_size, void* recv_ptr, size_t recv_size) {
+  const auto& ctx = NewTransportCtx(transport_token, send_ptr, send_size, recv_ptr, recv_size);
+  if (send_size > 0) { JUST(TransportUtil::SendDataToRank(peer_rank, transport_token, ctx.get())); }
+  if (recv_size > 0) {
+    JUST(TransportUtil::ReceiveDataFromRank(peer_rank, transport_token, ctx.get()));
+  }
+  JUST(ctx->WaitDone());
+  return Maybe<void>::Ok();
+}
+
+// Ring reduce-scatter over the parts of `bs`. Step i sends part `first_send_part` - i and reduces
+// the part before it, received from the previous rank, into Dst(i). Parts are cut into chunks
+// and each reduced chunk is forwarded at once, so that receiving, reducing and sending overlap.
+template<typename T>
+Maybe<void> PipelinedRingReduceScatter(const T* in, const BalancedSplitter& bs,
+                                       int64_t parallel_num, int64_t first_send_part,
+                                       const std::function<T*(int64_t step)>& Dst,
+                                       Symbol<RankGroup> rank_group,
+                                       const TransportToken& transport_token) {
+  const int64_t step_num = parallel_num - 1;
+  const int64_t chunk_num = GetPipelineChunkNum(bs.At(0).size() * sizeof(T));
+  // Receiving for step i + 1 is under way while step i is reduced.
+  std::array<std::unique_ptr<T[]>, 2> recv_buffers{std::make_unique<T[]>(bs.At(0).size()),
+                                                   std::make_unique<T[]>(bs.At(0).size())};
+  std::vector<TransportCtxList> recv_ctxs(step_num);
+  // send_ctxs[i + 1] holds the sends issued while reducing step i.
+  std::vector<TransportCtxList> send_ctxs(step_num + 1);
+  const auto& ReceiveStep = [&](int64_t step) -> Maybe<void> {
+    BalancedSplitter chunks(bs.At(RingRecvPart(first_send_part, step, parallel_num)).size(),
+                            chunk_num);
+    T* buffer = recv_buffers.at(step % 2).get();
+    for (int64_t i = 0; i < chunk_num; ++i) {
+      JUST(ReceiveFromPrevRankInRing(rank_group, transport_token, buffer + chunks.At(i).begin(),
+                                     chunks.At(i).size() * sizeof(T), &recv_ctxs.at(step)));
+    }
+    return Maybe<void>::Ok();
+  };
+  {
+    const Range& part = bs.At(first_send_part);
+    BalancedSplitter chunks(part.size(), chunk_num);
+    for (int64_t i = 0; i < chunk_num; ++i) {
+      JUST(SendToNextRankInRing(rank_group, transport_token,
+                                in + part.begin() + chunks.At(i).begin(),
+                                chunks.At(i).size() * sizeof(T), &send_ctxs.at(0)));
+    }
+  }
+  for (int64_t step = 0; step < std::min<int64_t>(step_num, 2); ++step) { JUST(ReceiveStep(step)); }
+  for (int64_t step = 0; step < step_num; ++step) {
+    // Dst may alternate between two buffers, in which case the sends from step - 2 read this one.
+    if (step >= 2) { JUST(WaitAllDone(&send_ctxs.at(step - 1))); }
+    const Range& part = bs.At(RingRecvPart(first_send_part, step, parallel_num));
+    BalancedSplitter chunks(part.size(), chunk_num);
+    const T* received = recv_buffers.at(step % 2).get();
+    T* dst = Dst(step);
+    for (int64_t i = 0; i < chunk_num; ++i) {
+      const Range& chunk = chunks.At(i);
+      JUST(recv_ctxs.at(step).at(i)->WaitDone());
+      VecAdd(chunk.size(), dst + chunk.begin(), in + part.begin() + chunk.begin(),
+             received + chunk.begin());
+      if (step + 1 < step_num) {
+        JUST(SendToNextRankInRing(rank_group, transport_token, dst + chunk.begin(),
+                                  chunk.size() * sizeof(T), &send_ctxs.at(step + 1)));
+      }
+    }
+    recv_ctxs.at(step).clear();
+    if (step + 2 < step_num) { JUST(ReceiveStep(step + 2)); }
+  }
+  for (auto& ctxs : send_ctxs) { JUST(WaitAllDone(&ctxs)); }
+  return Maybe<void>::Ok();
+}
+
+// Ring all-gather of the parts of `bs`, counted in `elem_size` bytes, in `out` which already
+// holds `first_send_part`. Chunks are forwarded to the next rank as soon as they arrive.
+Maybe<void> PipelinedRingAllGather(char* out, size_t elem_size, const BalancedSplitter& bs,
+                                   int64_t parallel_num, int64_t first_send_part,
+                                   Symbol<RankGroup> rank_group,
+                                   const TransportToken& transport_token) {
+  const int64_t step_num = parallel_num - 1;
+  const int64_t chunk_num = GetPipelineChunkNum(bs.At(0).size() * elem_size);
+  const auto& ForEachChunk =
+      [&](int64_t part_id, const std::function<Maybe<void>(char*, size_t)>& DoEach) -> Maybe<void> {
+    const Range& part = bs.At(part_id);
+    BalancedSplitter chunks(part.size(), chunk_num);
+    for (int64_t i = 0; i < chunk_num; ++i) {
+      JUST(DoEach(out + (part.begin() + chunks.At(i).begin()) * elem_size,
+                  chunks.At(i).size() * elem_size));
+    }
+    return Maybe<void>::Ok();
+  };
+  // Every step receives into its own part, so all receives are posted up front.
+  std::vector<TransportCtxList> recv_ctxs(step_num);
+  for (int64_t step = 0; step < step_num; ++step) {
+    JUST(ForEachChunk(RingRecvPart(first_send_part, step, parallel_num),
+                      [&](char* ptr, size_t size) -> Maybe<void> {
+                        return ReceiveFromPrevRankInRing(rank_group, transport_token, ptr, size,
+                                                         &recv_ctxs.at(step));
+                      }));
+  }
+  TransportCtxList send_ctxs;
+  JUST(ForEachChunk(first_send_part, [&](char* ptr, size_t size) -> Maybe<void> {
+    return SendToNextRankInRing(rank_group, transport_token, ptr, size, &send_ctxs);
+  }));
+  for (int64_t step = 0; step < step_num; ++step) {
+    int64_t chunk_id = 0;
+    JUST(ForEachChunk(RingRecvPart(first_send_part, step, parallel_num),
+                      [&](char* ptr, size_t size) -> Maybe<void> {
+                        JUST(recv_ctxs.at(step).at(chunk_id++)->WaitDone());
+                        if (step + 1 == step_num) { return Maybe<void>::Ok(); }
+                        return SendToNextRankInRing(rank_group, transport_token, ptr, size,
+                                                    &send_ctxs);
+                      }));
+    recv_ctxs.at(step).clear();
+  }
+  JUST(WaitAllDone(&send_ctxs));
+  return Maybe<void>::Ok();
+}
+
+// Recursive halving reduce-scatter followed by recursive doubling all-gather. It takes
+// 2 * log2(n) steps against the ring's 2 * (n - 1), which is what counts for small messages.
+// With n not a power of two, the first 2 * (n - pof2) ranks pair up: even ones hand their data to
+// the odd ones and get the result back at the end.
+template<typename T>
+Maybe<void> HalvingDoublingAllReduce(const T* in, T* out, size_t elem_cnt, int64_t parallel_id,
+                                     Symbol<ParallelDesc> parallel_desc,
+                                     const TransportToken& transport_token) {
+  const int64_t parallel_num = parallel_desc->parallel_num();
+  const size_t buffer_size = elem_cnt * sizeof(T);
+  if (in != out) { std::memcpy(out, in, buffer_size); }
+  auto recv_buffer = std::make_unique<T[]>(elem_cnt);
+  int64_t pof2 = 1;
+  while (pof2 * 2 <= parallel_num) { pof2 *= 2; }
+  const int64_t rem = parallel_num - pof2;
+  const auto& Rank4ParallelId = [&](int64_t id) {
+    return parallel_desc->MachineId4ParallelId(id);
+  };
+  int64_t new_id = -1;
+  if (parallel_id < 2 * rem) {
+    if (parallel_id % 2 == 0) {
+      JUST(SendRecv(JUST(Rank4ParallelId(parallel_id + 1)), transport_token, out, buffer_size,
+                    nullptr, 0));
+    } else {
+      JUST(SendRecv(JUST(Rank4ParallelId(parallel_id - 1)), transport_token, nullptr, 0,
+                    recv_buffer.get(), buffer_size));
+      VecAdd(elem_cnt, out, out, recv_buffer.get());
+      new_id = parallel_id / 2;
+    }
+  } else {
+    new_id = parallel_id - rem;
+  }
+  if (new_id >= 0) {
+    const auto& PeerRank = [&](int64_t mask) {
+      const int64_t peer_new_id = new_id ^ mask;
+      return Rank4ParallelId(peer_new_id < rem ? peer_new_id * 2 + 1 : peer_new_id + rem);
+    };
+    struct Halving {
+      size_t begin;
+      size_t end;
+      bool keep_lower;
+    };
+    std::vector<Halving> halvings;
+    size_t begin = 0;
+    size_t end = elem_cnt;
+    for (int64_t mask = pof2 / 2; mask > 0; mask /= 2) {
+      const size_t mid = begin + (end - begin) / 2;
+      const bool keep_lower = (new_id & mask) == 0;
+      halvings.push_back(Halving{begin, end, keep_lower});
+      const size_t keep_begin = keep_lower ? begin : mid;
+      const size_t keep_end = keep_lower ? mid : end;
+      const size_t send_begin = keep_lower ? mid : begin;
+      const size_t send_end = keep_lower ? end : mid;
+      JUST(SendRecv(JUST(PeerRank(mask)), transport_token, out + send_begin,
+                    (send_end - send_begin) * sizeof(T), recv_buffer.get() + keep_begin,
+                    (keep_end - keep_begin) * sizeof(T)));
+      VecAdd(keep_end - keep_begin, out + keep_begin, out + keep_begin,
+             recv_buffer.get() + keep_begin);
+      begin = keep_begin;
+      end = keep_end;
+    }
+    for (int64_t mask = 1; mask < pof2; mask *= 2) {
+      const Halving& halving = halvings.back();
+      // The peer holds the other half of what was split at this mask.
+      const size_t peer_begin = halving.keep_lower ? end : halving.begin;
+      const size_t peer_end = halving.keep_lower ? halving.end : begin;
+      JUST(SendRecv(JUST(PeerRank(mask)), transport_token, out + begin, (end - begin) * sizeof(T),
+                    out + peer_begin, (peer_end - peer_begin) * sizeof(T)));
+      begin = halving.begin;
+      end = halving.end;
+      halvings.pop_back();
+    }
+  }
+  if (parallel_id < 2 * rem) {
+    if (parallel_id % 2 == 0) {
+      JUST(SendRecv(JUST(Rank4ParallelId(parallel_id + 1)), transport_token, nullptr, 0, out,
+                    buffer_size));
+    } else {
+      JUST(SendRecv(JUST(Rank4ParallelId(parallel_id - 1)), transport_token, out, buffer_size,
+                    nullptr, 0));
+    }
+  }
+  return Maybe<void>::Ok();
+}
+
 }  // namespace
 
 template<typename T, ReduceType reduce_type>
@@ -77,81 +379,28 @@ struct DtypeAllReduce<T, kSum> {
     }
     const T* in = reinterpret_cast<const T*>(void_in);
     T* out = reinterpret_cast<T*>(void_out);
-    BalancedSplitter bs(elem_cnt, parallel_num);
-    auto recv_buffer = std::make_unique<T[]>(bs.At(0).size());
     Optional<int64_t> parallel_id;
     JUST(GetTensorDevice4CurrentProcessCtx(parallel_desc, &parallel_id));
-    const auto& rank_group = JUST(RankGroup::New(parallel_desc));
     TransportToken transport_token =
         JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
-    for (int64_t i = 0, part_id = JUST(parallel_id); i < parallel_num - 1;
-         ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = nullptr;
-      if (i == 0) {
-        send_ptr = &in[bs.At(send_part_id).begin()];
-      } else {
-        send_ptr = &out[bs.At(send_part_id).begin()];
-      }
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = recv_buffer.get();
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(ctx.WaitDone());
-      const T* cur_in = &in[bs.At(recv_part_id).begin()];
-      T* cur_out = &out[bs.At(recv_part_id).begin()];
-      if (recv_size > 0) { VecAdd(recv_size, cur_out, cur_in, recv_ptr); }
-    }
-    for (int64_t i = 0, part_id = RingIncrease(JUST(parallel_id), parallel_num);
-         i < parallel_num - 1; ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = &out[bs.At(send_part_id).begin()];
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = &out[bs.At(recv_part_id).begin()];
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(ctx.WaitDone());
+    const auto algo = JUST(GetCpuAllReduceAlgorithm(elem_cnt * sizeof(T)));
+    if (algo == CpuAllReduceAlgorithm::kHalvingDoubling) {
+      return HalvingDoublingAllReduce(in, out, elem_cnt, JUST(parallel_id), parallel_desc,
+                                      transport_token);
     }
+    BalancedSplitter bs(elem_cnt, parallel_num);
+    const auto& rank_group = JUST(RankGroup::New(parallel_desc));
+    const int64_t first_send_part = JUST(parallel_id);
+    JUST(PipelinedRingReduceScatter<T>(
+        in, bs, parallel_num, first_send_part,
+        [&](int64_t step) {
+          return out + bs.At(RingRecvPart(first_send_part, step, parallel_num)).begin();
+        },
+        rank_group, transport_token));
+    // The last part reduced here is the one after `first_send_part`.
+    JUST(PipelinedRingAllGather(reinterpret_cast<char*>(out), sizeof(T), bs, parallel_num,
+                                RingIncrease(first_send_part, parallel_num), rank_group,
+                                transport_token));
     return Maybe<void>::Ok();
   }
 };
@@ -191,48 +440,18 @@ struct DtypeReduceScatter<T, kSum> {
     CHECK_OR_RETURN(opt_parallel_id->has_value());
     int64_t parallel_id = JUST(*opt_parallel_id);
 
-    auto recv_buffer = std::make_unique<T[]>(bs.At(0).size());
+    // Partial sums alternate between `tmp_out` and `out` so that the one being forwarded is not
+    // overwritten; the last step lands in `out`.
+    auto tmp_out = std::make_unique<T[]>(bs.At(0).size());
     const auto& rank_group = JUST(RankGroup::New(parallel_desc));
 
     TransportToken transport_token =
         JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
-    for (int64_t i = 0, part_id = RingDecrease(parallel_id, parallel_num); i < parallel_num - 1;
-         ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = nullptr;
-      if (i == 0) {
-        send_ptr = &in[bs.At(send_part_id).begin()];
-      } else {
-        send_ptr = out;
-      }
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = recv_buffer.get();
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(ctx.WaitDone());
-      const T* cur_in = &in[bs.At(recv_part_id).begin()];
-      if (recv_size > 0) { VecAdd(recv_size, out, cur_in, recv_ptr); }
-    }
+    const int64_t step_num = parallel_num - 1;
+    JUST(PipelinedRingReduceScatter<T>(
+        in, bs, parallel_num, RingDecrease(parallel_id, parallel_num),
+        [&](int64_t step) { return (step_num - 1 - step) % 2 == 0 ? out : tmp_out.get(); },
+        rank_group, transport_token));
     return Maybe<void>::Ok();
   }
 };
@@ -272,37 +491,8 @@ Maybe<void> AllGather<DeviceType::kCPU>(const void* in, void* out, size_t elem_c
   if (in != &char_out[parallel_id * chunk_size]) {
     memcpy(&char_out[parallel_id * chunk_size], in, chunk_size);
   }
-  for (int64_t i = 0, part_id = parallel_id; i < parallel_num - 1;
-       ++i, part_id = RingDecrease(part_id, parallel_num)) {
-    int64_t send_part_id = part_id;
-    const void* send_ptr = &char_out[bs.At(send_part_id).begin()];
-    size_t send_size = bs.At(send_part_id).size();
-    int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-    void* recv_ptr = &char_out[bs.At(recv_part_id).begin()];
-    size_t recv_size = bs.At(recv_part_id).size();
-    NaiveAsyncTransportCtx ctx(
-        transport_token,
-        [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-          *buffer = const_cast<void*>(send_ptr);
-          *size = send_size;
-          *Cb = [] {};
-          return Maybe<void>::Ok();
-        },
-        [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-          *buffer = recv_ptr;
-          *size = recv_size;
-          *Cb = [] {};
-          return Maybe<void>::Ok();
-        });
-    if (send_size > 0) {
-      JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-    }
-    if (recv_size > 0) {
-      JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-    }
-    JUST(ctx.WaitDone());
-  }
-  return Maybe<void>::Ok();
+  return PipelinedRingAllGather(char_out, 1, bs, parallel_num, parallel_id, rank_group,
+                                transport_token);
 }
 
 template<>
@@ -68,16 +68,11 @@ int SockListen(int listen_sockfd, int32_t* listen_port, int32_t total_machine_nu
   return bind_result;
 }
 
-std::string GenPortKey(int64_t machine_id) { return "EpollPort/" + std::to_string(machine_id); }
-void PushPort(int64_t machine_id, uint16_t port) {
-  Global<CtrlClient>::Get()->PushKV(GenPortKey(machine_id), std::to_string(port));
-}
-void ClearPort(int64_t machine_id) { Global<CtrlClient>::Get()->ClearKV(GenPortKey(machine_id)); }
-uint16_t PullPort(int64_t machine_id) {
-  uint16_t port = 0;
-  Global<CtrlClient>::Get()->PullKV(
-      GenPortKey(machine_id), [&](const std::string& v) { port = oneflow_cast<uint16_t>(v); });
-  return port;
+// NOTE: every rank constructs the same sequence of EpollCommNet, so the generation in the prefix
+// agrees across ranks and keeps the ports of consecutive instances apart.
+std::string NewPortKeyPrefix() {
+  static std::atomic<int64_t> generation(0);
+  return "EpollPort/" + std::to_string(generation++) + "/";
 }
 
 }  // namespace
@@ -88,6 +83,9 @@ EpollCommNet::~EpollCommNet() {
     pollers_[i]->Stop();
   }
   OF_ENV_BARRIER();
+  if (GlobalProcessCtx::IsThisProcessMaster()) {
+    Global<CtrlClient>::Get()->ClearKVByPrefix(port_key_prefix_);
+  }
   for (IOEventPoller* poller : pollers_) { delete poller; }
   for (auto& pair : sockfd2helper_) { delete pair.second; }
 }
@@ -152,7 +150,13 @@ void EpollCommNet::InitSockets() {
   }
   CHECK_EQ(SockListen(listen_sockfd, &this_listen_port, total_machine_num), 0);
   CHECK_NE(this_listen_port, 0);
-  PushPort(this_machine_id, this_listen_port);
+  // NOTE: all ports are exchanged under one prefix, which costs every rank two control-plane
+  // round-trips instead of one per peer.
+  port_key_prefix_ = NewPortKeyPrefix();
+  Global<CtrlClient>::Get()->PushPrefixKV(port_key_prefix_, std::to_string(this_machine_id),
+                                          std::to_string(this_listen_port));
+  HashMap<std::string, std::string> rank2port;
+  Global<CtrlClient>::Get()->PullKVByPrefix(port_key_prefix_, total_machine_num, &rank2port);
   int32_t src_machine_count = 0;
 
   // connect
@@ -161,7 +165,7 @@ void EpollCommNet::InitSockets() {
       ++src_machine_count;
       continue;
     }
-    uint16_t peer_port = PullPort(peer_id);
+    uint16_t peer_port = oneflow_cast<uint16_t>(rank2port.at(std::to_string(peer_id)));
     auto peer_machine = Global<ResourceDesc, ForSession>::Get()->machine(peer_id);
     sockaddr_in peer_sockaddr = GetSockAddr(peer_machine.addr(), peer_port);
     int sockfd = socket(AF_INET, SOCK_STREAM, 0);
@@ -190,7 +194,6 @@ void EpollCommNet::InitSockets() {
     machine_id2sockfd_[peer_rank] = sockfd;
   }
   PCHECK(close(listen_sockfd) == 0);
-  ClearPort(this_machine_id);
 
   // useful log
   FOR_RANGE(int64_t, machine_id, 0, total_machine_num) {
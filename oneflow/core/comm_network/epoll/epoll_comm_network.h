@@ -45,6 +45,7 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   std::vector<IOEventPoller*> pollers_;
   std::vector<int> machine_id2sockfd_;
   HashMap<int, SocketHelper*> sockfd2helper_;
+  std::string port_key_prefix_;
 };
 
 }  // namespace oneflow
@@ -46,6 +46,10 @@ DEFINE_ENV_INTEGER(ONEFLOW_CHECK_TIMEOUT_SLEEP_SECONDS, EnvInteger<ONEFLOW_TIMEO
 DEFINE_ENV_INTEGER(ONEFLOW_VM_BLOCKING_DEBUG_INSTRUCTIONS_DISPLAY_LIMIT, 100);
 DEFINE_ENV_INTEGER(ONEFLOW_DELETE_OUTDATED_SHM_NAMES_INTERVAL, 1000);
 
+DEFINE_ENV_BOOL(ONEFLOW_VM_ADAPTIVE_SPIN, true);
+DEFINE_ENV_INTEGER(ONEFLOW_VM_SCHEDULER_MAX_SPIN_MICROSECONDS, 1000);
+DEFINE_ENV_INTEGER(ONEFLOW_VM_WORKER_MAX_SPIN_MICROSECONDS, 50);
+
 template<typename env_var>
 int64_t ThreadLocalEnvInteger();
 
@@ -0,0 +1,96 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_PHILOX_H_
+#define ONEFLOW_CORE_COMMON_PHILOX_H_
+
+#include <array>
+#include <cstdint>
+
+namespace oneflow {
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11), the
+// generator behind curand's philox states. A 128-bit block is a pure function of the key and the
+// counter, so disjoint counter ranges can be filled by different threads and the stream does not
+// depend on how the work is split.
+class Philox4x32 final {
+ public:
+  using Block = std::array<uint32_t, 4>;
+
+  explicit Philox4x32(uint64_t seed)
+      : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+  // Block `index` of the stream keyed by the seed.
+  Block operator()(uint64_t index) const {
+    return Generate(Block{static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), 0, 0},
+                    key_[0], key_[1]);
+  }
+
+  static Block Generate(Block counter, uint32_t key0, uint32_t key1) {
+    for (int round = 0; round < kNumRounds; ++round) {
+      if (round > 0) {
+        key0 += kWeyl0;
+        key1 += kWeyl1;
+      }
+      const uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * counter[0];
+      const uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * counter[2];
+      counter = Block{static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key0,
+                      static_cast<uint32_t>(product1),
+                      static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key1,
+                      static_cast<uint32_t>(product0)};
+    }
+    return counter;
+  }
+
+ private:
+  static constexpr int kNumRounds = 10;
+  static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+  static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  std::array<uint32_t, 2> key_;
+};
+
+// Uniform numbers in [0, 1) out of a philox block: four floats from the top 24 bits of each word,
+// or two doubles from 53 bits of each pair of words.
+template<typename T>
+struct PhiloxUniform;
+
+template<>
+struct PhiloxUniform<float> {
+  static constexpr int kNumPerBlock = 4;
+  static void Convert(const Philox4x32::Block& block, float* out) {
+    for (int i = 0; i < kNumPerBlock; ++i) {
+      out[i] = static_cast<float>(block[i] >> 8) * (1.0f / 16777216.0f);
+    }
+  }
+};
+
+template<>
+struct PhiloxUniform<double> {
+  static constexpr int kNumPerBlock = 2;
+  static void Convert(const Philox4x32::Block& block, double* out) {
+    for (int i = 0; i < kNumPerBlock; ++i) {
+      const uint64_t bits =
+          (static_cast<uint64_t>(block[2 * i]) << 21) | (block[2 * i + 1] >> 11);
+      out[i] = static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+    }
+  }
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_PHILOX_H_
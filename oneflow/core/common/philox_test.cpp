@@ -0,0 +1,54 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/common/philox.h"
+
+namespace oneflow {
+
+// Known answers from the Random123 distribution (kat_vectors, philox4x32_10).
+TEST(Philox4x32, known_answers) {
+  ASSERT_TRUE(Philox4x32::Generate({0, 0, 0, 0}, 0, 0)
+              == (Philox4x32::Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+  ASSERT_TRUE(Philox4x32::Generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, 0xffffffff,
+                                   0xffffffff)
+              == (Philox4x32::Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+  ASSERT_TRUE(Philox4x32::Generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, 0xa4093822,
+                                   0x299f31d0)
+              == (Philox4x32::Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(Philox4x32, block_index_is_the_counter) {
+  const uint64_t seed = 0x0123456789abcdefULL;
+  const Philox4x32 philox(seed);
+  const uint64_t index = (1ULL << 40) + 7;
+  ASSERT_TRUE(philox(index)
+              == Philox4x32::Generate({7, 1 << 8, 0, 0}, 0x89abcdef, 0x01234567));
+}
+
+TEST(PhiloxUniform, range) {
+  float f[4];
+  PhiloxUniform<float>::Convert({0, 0xffffffff, 0x80000000, 0xff}, f);
+  ASSERT_EQ(f[0], 0.0f);
+  ASSERT_LT(f[1], 1.0f);
+  ASSERT_EQ(f[2], 0.5f);
+  ASSERT_EQ(f[3], 0.0f);
+  double d[2];
+  PhiloxUniform<double>::Convert({0xffffffff, 0xffffffff, 0x80000000, 0}, d);
+  ASSERT_LT(d[0], 1.0);
+  ASSERT_EQ(d[1], 0.5);
+}
+
+}  // namespace oneflow
@@ -102,6 +102,29 @@ void GrpcCtrlClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   rpc_client_.PullMasterKV(k, msg);
 }
 
+void GrpcCtrlClient::BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+  rpc_client_.BatchPushKV(kvs);
+}
+
+void GrpcCtrlClient::BatchPullKV(const std::vector<std::string>& keys,
+                                 std::vector<std::string>* vals) {
+  rpc_client_.BatchPullKV(keys, vals);
+}
+
+void GrpcCtrlClient::PushPrefixKV(const std::string& prefix, const std::string& k,
+                                  const std::string& v) {
+  rpc_client_.PushPrefixKV(prefix, k, v);
+}
+
+void GrpcCtrlClient::PullKVByPrefix(const std::string& prefix, int32_t num,
+                                    HashMap<std::string, std::string>* kvs) {
+  rpc_client_.PullKVByPrefix(prefix, num, kvs);
+}
+
+void GrpcCtrlClient::ClearKVByPrefix(const std::string& prefix) {
+  rpc_client_.ClearKVByPrefix(prefix);
+}
+
 void GrpcCtrlClient::Clear() { rpc_client_.Clear(); }
 
 int32_t GrpcCtrlClient::IncreaseCount(const std::string& k, int32_t v) {
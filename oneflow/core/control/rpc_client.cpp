@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <map>
 #include "oneflow/core/control/rpc_client.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/job/env_desc.h"
@@ -45,6 +46,21 @@ class ClientCall final {
   CtrlResponse<ctrl_method> response_;
 };
 
+// A barrier over the whole world either rendezvous at the master, which serializes N requests
+// on rank 0, or runs as a dissemination barrier: ceil(log2(N)) rounds in which every rank
+// signals rank + 2^round and waits for rank - 2^round, so no server handles more than a
+// logarithmic number of requests. The choice must agree on every rank.
+bool UseDisseminationBarrier(int64_t world_size) {
+  static const std::string algo = GetStringFromEnv("ONEFLOW_CTRL_BARRIER_ALGO", "auto");
+  if (algo == "master") { return false; }
+  if (algo == "dissemination") { return true; }
+  CHECK_EQ(algo, "auto") << "ONEFLOW_CTRL_BARRIER_ALGO should be one of master, dissemination "
+                            "and auto";
+  static const int64_t min_world_size =
+      ParseIntegerFromEnv("ONEFLOW_CTRL_DISSEMINATION_BARRIER_MIN_RANKS", 64);
+  return world_size >= min_world_size;
+}
+
 }  // namespace
 
 void RpcClient::Barrier(const std::string& barrier_name) {
@@ -52,6 +68,11 @@ void RpcClient::Barrier(const std::string& barrier_name) {
 }
 
 void RpcClient::Barrier(const std::string& barrier_name, int32_t barrier_num) {
+  const int64_t world_size = Global<EnvDesc>::Get()->TotalMachineNum();
+  if (barrier_num == world_size && world_size > 1 && UseDisseminationBarrier(world_size)) {
+    DisseminationBarrier(barrier_name);
+    return;
+  }
   ClientCall<CtrlMethod::kBarrier> call;
   call.mut_request()->set_name(barrier_name);
   call.mut_request()->set_num(barrier_num);
@@ -150,6 +171,66 @@ void RpcClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   PullMasterKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void RpcClient::BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+  std::map<int64_t, std::vector<size_t>> rank2indices;
+  for (size_t i = 0; i < kvs.size(); ++i) {
+    rank2indices[GetResponsibleRank(kvs.at(i).first)].emplace_back(i);
+  }
+  for (const auto& pair : rank2indices) {
+    ClientCall<CtrlMethod::kBatchPushKV> call;
+    for (size_t i : pair.second) {
+      call.mut_request()->add_keys(kvs.at(i).first);
+      call.mut_request()->add_vals(kvs.at(i).second);
+    }
+    call(GetStubAt(pair.first));
+  }
+}
+
+void RpcClient::BatchPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) {
+  std::map<int64_t, std::vector<size_t>> rank2indices;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    rank2indices[GetResponsibleRank(keys.at(i))].emplace_back(i);
+  }
+  vals->resize(keys.size());
+  for (const auto& pair : rank2indices) {
+    ClientCall<CtrlMethod::kBatchPullKV> call;
+    for (size_t i : pair.second) { call.mut_request()->add_keys(keys.at(i)); }
+    call(GetStubAt(pair.first));
+    CHECK_EQ(call.response().vals_size(), pair.second.size());
+    for (size_t j = 0; j < pair.second.size(); ++j) {
+      vals->at(pair.second.at(j)) = call.response().vals(j);
+    }
+  }
+}
+
+void RpcClient::PushPrefixKV(const std::string& prefix, const std::string& k,
+                             const std::string& v) {
+  ClientCall<CtrlMethod::kPushKV> call;
+  call.mut_request()->set_key(prefix + k);
+  call.mut_request()->set_val(v);
+  call(GetResponsibleStub(prefix));
+}
+
+void RpcClient::PullKVByPrefix(const std::string& prefix, int32_t num,
+                               HashMap<std::string, std::string>* kvs) {
+  ClientCall<CtrlMethod::kPullKVByPrefix> call;
+  call.mut_request()->set_prefix(prefix);
+  call.mut_request()->set_num(num);
+  call(GetResponsibleStub(prefix));
+  const auto& response = call.response();
+  CHECK_EQ(response.keys_size(), response.vals_size());
+  kvs->clear();
+  for (int i = 0; i < response.keys_size(); ++i) {
+    kvs->emplace(response.keys(i), response.vals(i));
+  }
+}
+
+void RpcClient::ClearKVByPrefix(const std::string& prefix) {
+  ClientCall<CtrlMethod::kClearKVByPrefix> call;
+  call.mut_request()->set_prefix(prefix);
+  call(GetResponsibleStub(prefix));
+}
+
 void RpcClient::Clear() {
   ClientCall<CtrlMethod::kClear> call;
   call(GetThisStub());
@@ -201,8 +282,40 @@ void RpcClient::LoadServer(const LoadServerRequest& request, CtrlService::Stub*
 CtrlService::Stub* RpcClient::GetThisStub() { return stubs_[GlobalProcessCtx::Rank()].get(); }
 
 CtrlService::Stub* RpcClient::GetResponsibleStub(const std::string& key) {
-  int64_t machine_id = (std::hash<std::string>{}(key)) % Global<EnvDesc>::Get()->TotalMachineNum();
-  return stubs_[machine_id].get();
+  return stubs_[GetResponsibleRank(key)].get();
+}
+
+int64_t RpcClient::GetResponsibleRank(const std::string& key) {
+  return (std::hash<std::string>{}(key)) % Global<EnvDesc>::Get()->TotalMachineNum();
+}
+
+void RpcClient::DisseminationBarrier(const std::string& barrier_name) {
+  const int64_t world_size = Global<EnvDesc>::Get()->TotalMachineNum();
+  const int64_t rank = GlobalProcessCtx::Rank();
+  int64_t generation = 0;
+  {
+    // NOTE: barrier names are reused (e.g. OF_ENV_BARRIER in a loop), the generation keeps the
+    // signals of consecutive barriers with the same name apart.
+    std::unique_lock<std::mutex> lck(barrier_generation_mtx_);
+    generation = barrier_generation_[barrier_name]++;
+  }
+  const std::string prefix =
+      "DisseminationBarrier/" + barrier_name + "/" + std::to_string(generation) + "/";
+  for (int64_t round = 0, distance = 1; distance < world_size; ++round, distance <<= 1) {
+    const std::string round_prefix = prefix + std::to_string(round) + "/";
+    ClientCall<CtrlMethod::kPushKV> signal;
+    signal.mut_request()->set_key(round_prefix + std::to_string(rank));
+    signal.mut_request()->set_val("");
+    signal(GetStubAt((rank + distance) % world_size));
+    ClientCall<CtrlMethod::kPullKV> wait;
+    wait.mut_request()->set_key(round_prefix
+                                + std::to_string((rank + world_size - distance) % world_size));
+    wait(GetThisStub());
+  }
+  // Every signal addressed to this rank has been consumed above, so the keys can be dropped.
+  ClientCall<CtrlMethod::kClearKVByPrefix> clear;
+  clear.mut_request()->set_prefix(prefix);
+  clear(GetThisStub());
 }
 
 }  // namespace oneflow
@@ -59,6 +59,14 @@ class RpcClient {
     *v = oneflow_cast<T>(v_str);
   }
 
+  void BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs);
+  void BatchPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals);
+
+  void PushPrefixKV(const std::string& prefix, const std::string& k, const std::string& v);
+  void PullKVByPrefix(const std::string& prefix, int32_t num,
+                      HashMap<std::string, std::string>* kvs);
+  void ClearKVByPrefix(const std::string& prefix);
+
   void Clear();
 
   int32_t IncreaseCount(const std::string& k, int32_t v);
@@ -79,6 +87,13 @@ class RpcClient {
   std::vector<std::unique_ptr<CtrlService::Stub>> stubs_;
   std::mutex done_names_mtx_;
   HashSet<std::string> done_names_;
+
+ private:
+  int64_t GetResponsibleRank(const std::string& key);
+  void DisseminationBarrier(const std::string& barrier_name);
+
+  std::mutex barrier_generation_mtx_;
+  HashMap<std::string, int64_t> barrier_generation_;
 };
 
 }  // namespace oneflow
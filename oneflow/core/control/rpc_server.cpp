@@ -19,6 +19,14 @@ limitations under the License.
 
 namespace oneflow {
 
+namespace {
+
+bool HasPrefix(const std::string& key, const std::string& prefix) {
+  return key.size() >= prefix.size() && key.compare(0, prefix.size(), prefix) == 0;
+}
+
+}  // namespace
+
 RpcServer::~RpcServer() {
   // NOTE(chengcheng): This enqueues a special event (with a null tag) that causes
   // the completion queue to be shut down on the polling thread.
@@ -129,26 +137,13 @@ void RpcServer::Init() {
   });
 
   Add([this](CtrlCall<CtrlMethod::kPushKV>* call) {
-    const std::string& k = call->request().key();
-    const std::string& v = call->request().val();
-    CHECK(kv_.emplace(k, v).second);
-
-    auto pending_kv_calls_it = pending_kv_calls_.find(k);
-    if (pending_kv_calls_it != pending_kv_calls_.end()) {
-      for (auto pending_call : pending_kv_calls_it->second) {
-        pending_call->mut_response()->set_val(v);
-        pending_call->SendResponse();
-      }
-      pending_kv_calls_.erase(pending_kv_calls_it);
-    }
+    InsertKV(call->request().key(), call->request().val());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kPushKV>();
   });
 
   Add([this](CtrlCall<CtrlMethod::kClearKV>* call) {
-    const std::string& k = call->request().key();
-    CHECK_EQ(kv_.erase(k), 1);
-    CHECK(pending_kv_calls_.find(k) == pending_kv_calls_.end());
+    EraseKV(call->request().key());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClearKV>();
   });
@@ -170,6 +165,11 @@ void RpcServer::Init() {
     kv_.clear();
     CHECK(pending_kv_calls_.empty()) << "size(): " << pending_kv_calls_.size()
                                      << ", begin()->key: " << pending_kv_calls_.begin()->first;
+    CHECK(pending_batch_kv_calls_.empty())
+        << "size(): " << pending_batch_kv_calls_.size()
+        << ", begin()->key: " << pending_batch_kv_calls_.begin()->first;
+    CHECK(prefix_watches_.empty()) << "size(): " << prefix_watches_.size()
+                                   << ", begin()->prefix: " << prefix_watches_.begin()->first;
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClear>();
   });
@@ -187,6 +187,128 @@ void RpcServer::Init() {
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kEraseCount>();
   });
+
+  Add([this](CtrlCall<CtrlMethod::kBatchPushKV>* call) {
+    const auto& request = call->request();
+    CHECK_EQ(request.keys_size(), request.vals_size());
+    for (int i = 0; i < request.keys_size(); ++i) { InsertKV(request.keys(i), request.vals(i)); }
+    call->SendResponse();
+    EnqueueRequest<CtrlMethod::kBatchPushKV>();
+  });
+
+  Add([this](CtrlCall<CtrlMethod::kBatchPullKV>* call) {
+    auto pending = std::make_shared<PendingBatchPullKV>();
+    pending->call = call;
+    pending->missing_key_cnt = 0;
+    HashSet<std::string> missing_keys;
+    for (const std::string& k : call->request().keys()) {
+      if (kv_.find(k) != kv_.end() || !missing_keys.emplace(k).second) { continue; }
+      pending_batch_kv_calls_[k].emplace_back(pending);
+      pending->missing_key_cnt += 1;
+    }
+    if (pending->missing_key_cnt == 0) {
+      for (const std::string& k : call->request().keys()) {
+        *call->mut_response()->add_vals() = kv_.at(k);
+      }
+      call->SendResponse();
+    }
+    EnqueueRequest<CtrlMethod::kBatchPullKV>();
+  });
+
+  Add([this](CtrlCall<CtrlMethod::kPullKVByPrefix>* call) {
+    const std::string& prefix = call->request().prefix();
+    auto watch_it = prefix_watches_.find(prefix);
+    if (watch_it == prefix_watches_.end()) {
+      int64_t key_cnt = 0;
+      for (const auto& pair : kv_) {
+        if (HasPrefix(pair.first, prefix)) { key_cnt += 1; }
+      }
+      watch_it = prefix_watches_.emplace(prefix, PrefixWatch{key_cnt, {}}).first;
+    }
+    watch_it->second.calls.emplace_back(call);
+    RespondPrefixWatchers(prefix);
+    EnqueueRequest<CtrlMethod::kPullKVByPrefix>();
+  });
+
+  Add([this](CtrlCall<CtrlMethod::kClearKVByPrefix>* call) {
+    std::vector<std::string> keys;
+    for (const auto& pair : kv_) {
+      if (HasPrefix(pair.first, call->request().prefix())) { keys.emplace_back(pair.first); }
+    }
+    for (const std::string& k : keys) { EraseKV(k); }
+    call->SendResponse();
+    EnqueueRequest<CtrlMethod::kClearKVByPrefix>();
+  });
+}
+
+void RpcServer::InsertKV(const std::string& k, const std::string& v) {
+  CHECK(kv_.emplace(k, v).second) << k;
+
+  auto pending_kv_calls_it = pending_kv_calls_.find(k);
+  if (pending_kv_calls_it != pending_kv_calls_.end()) {
+    for (auto pending_call : pending_kv_calls_it->second) {
+      pending_call->mut_response()->set_val(v);
+      pending_call->SendResponse();
+    }
+    pending_kv_calls_.erase(pending_kv_calls_it);
+  }
+
+  auto pending_batch_kv_calls_it = pending_batch_kv_calls_.find(k);
+  if (pending_batch_kv_calls_it != pending_batch_kv_calls_.end()) {
+    for (const auto& pending : pending_batch_kv_calls_it->second) {
+      pending->missing_key_cnt -= 1;
+      if (pending->missing_key_cnt > 0) { continue; }
+      for (const std::string& key : pending->call->request().keys()) {
+        *pending->call->mut_response()->add_vals() = kv_.at(key);
+      }
+      pending->call->SendResponse();
+    }
+    pending_batch_kv_calls_.erase(pending_batch_kv_calls_it);
+  }
+
+  std::vector<std::string> ready_prefixes;
+  for (auto& pair : prefix_watches_) {
+    if (!HasPrefix(k, pair.first)) { continue; }
+    pair.second.key_cnt += 1;
+    ready_prefixes.emplace_back(pair.first);
+  }
+  for (const std::string& prefix : ready_prefixes) { RespondPrefixWatchers(prefix); }
+}
+
+void RpcServer::EraseKV(const std::string& k) {
+  CHECK_EQ(kv_.erase(k), 1) << k;
+  CHECK(pending_kv_calls_.find(k) == pending_kv_calls_.end());
+  CHECK(pending_batch_kv_calls_.find(k) == pending_batch_kv_calls_.end());
+  for (auto& pair : prefix_watches_) {
+    if (HasPrefix(k, pair.first)) { pair.second.key_cnt -= 1; }
+  }
+}
+
+void RpcServer::RespondPrefixWatchers(const std::string& prefix) {
+  auto watch_it = prefix_watches_.find(prefix);
+  CHECK(watch_it != prefix_watches_.end());
+  PrefixWatch* watch = &watch_it->second;
+  // NOTE: the response is built at most once and shared by every watcher that became ready.
+  std::unique_ptr<PullKVByPrefixResponse> response;
+  for (auto call_it = watch->calls.begin(); call_it != watch->calls.end();) {
+    auto* call = *call_it;
+    if (call->request().num() > watch->key_cnt) {
+      ++call_it;
+      continue;
+    }
+    if (!response) {
+      response.reset(new PullKVByPrefixResponse());
+      for (const auto& pair : kv_) {
+        if (!HasPrefix(pair.first, prefix)) { continue; }
+        response->add_keys(pair.first.substr(prefix.size()));
+        response->add_vals(pair.second);
+      }
+    }
+    *call->mut_response() = *response;
+    call->SendResponse();
+    call_it = watch->calls.erase(call_it);
+  }
+  if (watch->calls.empty()) { prefix_watches_.erase(watch_it); }
 }
 
 }  // namespace oneflow
@@ -67,6 +67,10 @@ class RpcServer {
 
   virtual void OnLoadServer(CtrlCall<CtrlMethod::kLoadServer>* call) = 0;
 
+  void InsertKV(const std::string& k, const std::string& v);
+  void EraseKV(const std::string& k);
+  void RespondPrefixWatchers(const std::string& prefix);
+
   struct helper {
     helper(RpcServer* s) : s_(s) {}
     template<typename T, typename V>
@@ -91,6 +95,18 @@ class RpcServer {
   // PushKV, ClearKV, PullKV
   HashMap<std::string, std::string> kv_;
   HashMap<std::string, std::list<CtrlCall<CtrlMethod::kPullKV>*>> pending_kv_calls_;
+  // BatchPushKV, BatchPullKV
+  struct PendingBatchPullKV {
+    CtrlCall<CtrlMethod::kBatchPullKV>* call;
+    int64_t missing_key_cnt;
+  };
+  HashMap<std::string, std::list<std::shared_ptr<PendingBatchPullKV>>> pending_batch_kv_calls_;
+  // PullKVByPrefix, ClearKVByPrefix
+  struct PrefixWatch {
+    int64_t key_cnt;
+    std::list<CtrlCall<CtrlMethod::kPullKVByPrefix>*> calls;
+  };
+  HashMap<std::string, PrefixWatch> prefix_watches_;
   // IncreaseCount, EraseCount
   HashMap<std::string, int32_t> count_;
 };
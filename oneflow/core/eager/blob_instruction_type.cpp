@@ -27,6 +27,7 @@ limitations under the License.
 #include "oneflow/core/vm/access_blob_arg_cb_phy_instr_operand.h"
 #include "oneflow/core/register/ofblob.h"
 #include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/eager/opkernel_instruction_type.h"
 
 namespace oneflow {
 namespace vm {
@@ -47,6 +48,8 @@ void AccessBlobByCallbackInstructionType::ComputeInstrMsg(
       dynamic_cast<const vm::AccessBlobArgCbPhyInstrOperand*>(phy_instr_operand.get());
   CHECK_NOTNULL(ptr);
   DeviceCtx* device_ctx = instr_msg.phy_instr_stream()->device_ctx().get();
+  CHECK_JUST(PrepareBlobAccess(ptr->eager_blob_object().get(), ptr->modifier() != "const",
+                               device_ctx));
   auto* blob = ptr->eager_blob_object()->blob();
   OfBlob ofblob(device_ctx->stream(), blob);
   ptr->callback()(reinterpret_cast<uint64_t>(&ofblob));
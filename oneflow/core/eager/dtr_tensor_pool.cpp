@@ -0,0 +1,221 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/eager/local_call_opkernel_phy_instr_operand.h"
+#include "oneflow/user/kernels/stateful_local_opkernel.h"
+
+namespace oneflow {
+namespace vm {
+
+/* static */ bool DtrTensorPool::Enabled() {
+  static const bool enabled = ParseIntegerFromEnv("ONEFLOW_DTR_MEMORY_BUDGET_MB", 0) > 0;
+  return enabled;
+}
+
+/* static */ DtrTensorPool* DtrTensorPool::Get() {
+  // Never destructed: storages may still be freed by worker threads during shutdown.
+  static DtrTensorPool* pool =
+      new DtrTensorPool(ParseIntegerFromEnv("ONEFLOW_DTR_MEMORY_BUDGET_MB", 0) * 1024 * 1024);
+  return pool;
+}
+
+/* static */ bool DtrTensorPool::Recordable(const LocalCallOpKernelPhyInstrOperand& operand) {
+  // Rerunning the producer must reproduce exactly the evicted value and nothing else.
+  if (operand.outputs()->size() != 1) { return false; }
+  if (operand.user_opkernel()->has_state_or_cache()) { return false; }
+  if (operand.op_interp_ctx().state) { return false; }
+  if (operand.consistent_tensor_infer_result()) { return false; }
+  const auto& opkernel = operand.opkernel();
+  if (!opkernel.input_tuple_indexes4mut_ibns().empty()) { return false; }
+  if (!opkernel.output_tuple_indexes4mut2_obns().empty()) { return false; }
+  const auto& output = operand.outputs()->at(0);
+  if (output->pin_memory() || output->ByteSizeOfBlobBody() == 0) { return false; }
+  for (const auto& input : *operand.inputs()) {
+    if (input == output) { return false; }
+  }
+  return true;
+}
+
+size_t DtrTensorPool::AllocatedBytes(Allocator* allocator) {
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  return allocator2allocated_bytes_[allocator];
+}
+
+void DtrTensorPool::OnAllocate(Allocator* allocator, size_t bytes) {
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  allocator2allocated_bytes_[allocator] += bytes;
+}
+
+void DtrTensorPool::OnDeallocate(Allocator* allocator, size_t bytes) {
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  auto* allocated_bytes = &allocator2allocated_bytes_[allocator];
+  *allocated_bytes -= std::min(*allocated_bytes, bytes);
+}
+
+bool DtrTensorPool::Evictable(EagerBlobObject* eager_blob_object, const Entry& entry,
+                              Allocator* allocator, const DeviceCtx* device_ctx) const {
+  if (entry.evicted || entry.allocator != allocator || entry.device_ctx != device_ctx) {
+    return false;
+  }
+  if (pinned_.count(eager_blob_object) > 0) { return false; }
+  if (evicted_dependents_.count(eager_blob_object) > 0) { return false; }
+  // Views share the storage and would observe the eviction.
+  const auto& tensor_storage = eager_blob_object->tensor_storage();
+  if (tensor_storage.use_count() > 1 || tensor_storage->blob_dptr() == nullptr) { return false; }
+  for (const auto& input : *entry.producer->inputs()) {
+    if (input->ByteSizeOfBlobBody() > 0 && input->tensor_storage()->blob_dptr() == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DtrTensorPool::Evict(EagerBlobObject* eager_blob_object, Entry* entry) {
+  entry->evicted = true;
+  ++stats_.evicted_cnt;
+  stats_.evicted_bytes += entry->bytes;
+  for (const auto& input : *entry->producer->inputs()) {
+    evicted_dependents_[input.get()].emplace_back(eager_blob_object);
+  }
+  eager_blob_object->tensor_storage()->ReleaseBlobDptr();
+}
+
+void DtrTensorPool::EvictUntilFits(Allocator* allocator, size_t bytes,
+                                   const DeviceCtx* device_ctx) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (AllocatedBytes(allocator) + bytes > memory_budget_bytes_) {
+    EagerBlobObject* victim = nullptr;
+    Entry* victim_entry = nullptr;
+    double min_score = 0;
+    for (auto& pair : entries_) {
+      if (!Evictable(pair.first, pair.second, allocator, device_ctx)) { continue; }
+      const double staleness = static_cast<double>(clock_ - pair.second.last_access + 1);
+      const double score = pair.second.compute_cost / (pair.second.bytes * staleness);
+      if (victim == nullptr || score < min_score) {
+        victim = pair.first;
+        victim_entry = &pair.second;
+        min_score = score;
+      }
+    }
+    // The budget is soft: let the allocator decide when nothing is left to evict.
+    if (victim == nullptr) { break; }
+    Evict(victim, victim_entry);
+  }
+}
+
+void DtrTensorPool::Pin(const LocalCallOpKernelPhyInstrOperand& operand) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& input : *operand.inputs()) { ++pinned_[input.get()]; }
+  for (const auto& output : *operand.outputs()) { ++pinned_[output.get()]; }
+}
+
+void DtrTensorPool::Unpin(const LocalCallOpKernelPhyInstrOperand& operand) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto& DoUnpin = [&](EagerBlobObject* eager_blob_object) {
+    auto iter = pinned_.find(eager_blob_object);
+    CHECK(iter != pinned_.end());
+    if (--iter->second == 0) { pinned_.erase(iter); }
+  };
+  for (const auto& input : *operand.inputs()) { DoUnpin(input.get()); }
+  for (const auto& output : *operand.outputs()) { DoUnpin(output.get()); }
+}
+
+void DtrTensorPool::Touch(EagerBlobObject* eager_blob_object) {
+  auto iter = entries_.find(eager_blob_object);
+  if (iter != entries_.end()) { iter->second.last_access = clock_; }
+}
+
+std::shared_ptr<LocalCallOpKernelPhyInstrOperand> DtrTensorPool::EraseEntry(
+    EagerBlobObject* eager_blob_object) {
+  auto iter = entries_.find(eager_blob_object);
+  if (iter == entries_.end()) { return nullptr; }
+  auto producer = std::move(iter->second.producer);
+  if (iter->second.evicted) {
+    for (const auto& input : *producer->inputs()) {
+      auto dependents_iter = evicted_dependents_.find(input.get());
+      CHECK(dependents_iter != evicted_dependents_.end());
+      auto* dependents = &dependents_iter->second;
+      dependents->erase(std::find(dependents->begin(), dependents->end(), eager_blob_object));
+      if (dependents->empty()) { evicted_dependents_.erase(dependents_iter); }
+    }
+  }
+  entries_.erase(iter);
+  return producer;
+}
+
+void DtrTensorPool::RecordProducer(const std::shared_ptr<LocalCallOpKernelPhyInstrOperand>& operand,
+                                   const DeviceCtx* device_ctx, Allocator* allocator,
+                                   double compute_cost) {
+  std::vector<std::shared_ptr<LocalCallOpKernelPhyInstrOperand>> dropped_producers;
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++clock_;
+  for (const auto& input : *operand->inputs()) { Touch(input.get()); }
+  for (const auto& output : *operand->outputs()) {
+    dropped_producers.emplace_back(EraseEntry(output.get()));
+  }
+  if (!Recordable(*operand)) { return; }
+  auto* output = operand->outputs()->at(0).get();
+  Entry entry;
+  entry.producer = operand;
+  entry.device_ctx = device_ctx;
+  entry.allocator = allocator;
+  entry.bytes = output->AlignedByteSizeOfBlobBody();
+  // Avoid zero costs so that staleness and size still order cheap tensors.
+  entry.compute_cost = std::max(compute_cost, 1e-9);
+  entry.last_access = clock_;
+  entry.evicted = false;
+  CHECK(entries_.emplace(output, std::move(entry)).second);
+}
+
+std::shared_ptr<LocalCallOpKernelPhyInstrOperand> DtrTensorPool::EvictedProducer(
+    EagerBlobObject* eager_blob_object, const DeviceCtx** producer_device_ctx) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = entries_.find(eager_blob_object);
+  if (iter == entries_.end() || !iter->second.evicted) { return nullptr; }
+  *producer_device_ctx = iter->second.device_ctx;
+  ++stats_.rematerialized_cnt;
+  return iter->second.producer;
+}
+
+std::vector<EagerBlobObject*> DtrTensorPool::EvictedDependents(
+    EagerBlobObject* eager_blob_object) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = evicted_dependents_.find(eager_blob_object);
+  if (iter == evicted_dependents_.end()) { return {}; }
+  return iter->second;
+}
+
+void DtrTensorPool::Forget(EagerBlobObject* eager_blob_object) {
+  std::shared_ptr<LocalCallOpKernelPhyInstrOperand> dropped_producer;
+  std::unique_lock<std::mutex> lock(mutex_);
+  dropped_producer = EraseEntry(eager_blob_object);
+}
+
+bool DtrTensorPool::Release(EagerBlobObject* eager_blob_object) {
+  std::shared_ptr<LocalCallOpKernelPhyInstrOperand> dropped_producer;
+  std::unique_lock<std::mutex> lock(mutex_);
+  dropped_producer = EraseEntry(eager_blob_object);
+  return evicted_dependents_.count(eager_blob_object) == 0;
+}
+
+DtrTensorPoolStats DtrTensorPool::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,148 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EAGER_DTR_TENSOR_POOL_H_
+#define ONEFLOW_CORE_EAGER_DTR_TENSOR_POOL_H_
+
+#include <mutex>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+
+namespace oneflow {
+
+class DeviceCtx;
+
+namespace vm {
+
+class Allocator;
+class EagerBlobObject;
+class LocalCallOpKernelPhyInstrOperand;
+
+struct DtrTensorPoolStats {
+  int64_t evicted_cnt;
+  int64_t evicted_bytes;
+  int64_t rematerialized_cnt;
+};
+
+// Dynamic tensor rematerialization for eager mode.
+//
+// Tensors produced by deterministic single-output ops are registered together with their producer
+// operand. When an allocation would push the bytes held on an allocator over
+// ONEFLOW_DTR_MEMORY_BUDGET_MB, the pool frees the storage of the registered tensors with the
+// lowest `compute_cost / (bytes * staleness)` until the allocation fits. An evicted tensor is
+// recomputed from its producer by the next instruction that touches it.
+//
+// Invariants that keep recomputation exact:
+//   - the inputs of an evicted tensor stay resident and are never evicted themselves;
+//   - a tensor is restored before anything that any evicted tensor was computed from is mutated;
+//   - release of a tensor still read by an evicted producer is deferred until that producer goes.
+class DtrTensorPool final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(DtrTensorPool);
+  ~DtrTensorPool() = default;
+
+  static bool Enabled();
+  static DtrTensorPool* Get();
+
+  size_t memory_budget_bytes() const { return memory_budget_bytes_; }
+
+  // Called by the owning stream's worker thread before it allocates `bytes` from `allocator`.
+  void EvictUntilFits(Allocator* allocator, size_t bytes, const DeviceCtx* device_ctx);
+  void OnAllocate(Allocator* allocator, size_t bytes);
+  void OnDeallocate(Allocator* allocator, size_t bytes);
+
+  // Pinned tensors are being read or written by the running instruction and are never evicted.
+  void Pin(const LocalCallOpKernelPhyInstrOperand& operand);
+  void Unpin(const LocalCallOpKernelPhyInstrOperand& operand);
+
+  // Registers (or forgets) `operand` as the producer of its output after it has been computed.
+  void RecordProducer(const std::shared_ptr<LocalCallOpKernelPhyInstrOperand>& operand,
+                      const DeviceCtx* device_ctx, Allocator* allocator, double compute_cost);
+
+  // Returns the producer to rerun if `eager_blob_object` is currently evicted, otherwise nullptr.
+  std::shared_ptr<LocalCallOpKernelPhyInstrOperand> EvictedProducer(
+      EagerBlobObject* eager_blob_object, const DeviceCtx** producer_device_ctx);
+
+  // Returns the evicted tensors that were computed from `eager_blob_object`. They must be restored
+  // before `eager_blob_object` is overwritten.
+  std::vector<EagerBlobObject*> EvictedDependents(EagerBlobObject* eager_blob_object);
+
+  // `eager_blob_object` is about to be overwritten in place, so its producer no longer
+  // describes it.
+  void Forget(EagerBlobObject* eager_blob_object);
+
+  // Returns false if the storage of `eager_blob_object` is still needed to recompute an evicted
+  // tensor. The storage is then released together with the last such producer.
+  bool Release(EagerBlobObject* eager_blob_object);
+
+  DtrTensorPoolStats GetStats() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<LocalCallOpKernelPhyInstrOperand> producer;
+    const DeviceCtx* device_ctx;
+    Allocator* allocator;
+    size_t bytes;
+    double compute_cost;
+    int64_t last_access;
+    bool evicted;
+  };
+
+  explicit DtrTensorPool(size_t memory_budget_bytes)
+      : memory_budget_bytes_(memory_budget_bytes), clock_(0), stats_() {}
+
+  static bool Recordable(const LocalCallOpKernelPhyInstrOperand& operand);
+
+  bool Evictable(EagerBlobObject* eager_blob_object, const Entry& entry, Allocator* allocator,
+                 const DeviceCtx* device_ctx) const;
+  void Evict(EagerBlobObject* eager_blob_object, Entry* entry);
+  // Returns the producer of the erased entry so that callers can drop it outside of `mutex_`.
+  std::shared_ptr<LocalCallOpKernelPhyInstrOperand> EraseEntry(
+      EagerBlobObject* eager_blob_object);
+  void Touch(EagerBlobObject* eager_blob_object);
+  size_t AllocatedBytes(Allocator* allocator);
+
+  const size_t memory_budget_bytes_;
+  mutable std::mutex mutex_;
+  int64_t clock_;
+  DtrTensorPoolStats stats_;
+  // Storages are freed on arbitrary threads, possibly while `mutex_` is held by an eviction.
+  std::mutex allocated_bytes_mutex_;
+  HashMap<Allocator*, size_t> allocator2allocated_bytes_;
+  HashMap<EagerBlobObject*, Entry> entries_;
+  // input tensor -> evicted tensors whose producers read it
+  HashMap<EagerBlobObject*, std::vector<EagerBlobObject*>> evicted_dependents_;
+  HashMap<EagerBlobObject*, int32_t> pinned_;
+};
+
+// Pins the tensors of `operand` for the lifetime of the guard, including early returns on error.
+class DtrPinGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(DtrPinGuard);
+  DtrPinGuard(DtrTensorPool* pool, const LocalCallOpKernelPhyInstrOperand& operand)
+      : pool_(pool), operand_(operand) {
+    pool_->Pin(operand_);
+  }
+  ~DtrPinGuard() { pool_->Unpin(operand_); }
+
+ private:
+  DtrTensorPool* pool_;
+  const LocalCallOpKernelPhyInstrOperand& operand_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EAGER_DTR_TENSOR_POOL_H_
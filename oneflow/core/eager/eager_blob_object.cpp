@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/eager/tensor_offloader.h"
 #include "oneflow/core/vm/allocator.h"
 #include "oneflow/core/framework/to_string.h"
 #include "oneflow/core/framework/shut_down_util.h"
@@ -46,6 +48,9 @@ EagerBlobObject::EagerBlobObject(const std::shared_ptr<MemoryCase>& mem_case,
 Blob* EagerBlobObject::blob() {
   if (!blob_) {
     blob_.reset(new Blob(*mem_case_, &blob_desc_, mut_header_ptr(), mut_dptr<char>()));
+  } else {
+    // The body may have been evicted and rematerialized at another address.
+    blob_->reset_dptr(mut_dptr<char>());
   }
   return blob_.get();
 }
@@ -83,13 +88,30 @@ Maybe<void> EagerBlobObject::TryAllocateBlobBodyMemory(DeviceCtx* device_ctx) {
     return Maybe<void>::Ok();
   }
   {
+    // Pinned host memory is not budgeted by the dtr pool or the offloader.
+    DtrTensorPool* dtr_pool =
+        (DtrTensorPool::Enabled() && !pin_memory) ? DtrTensorPool::Get() : nullptr;
+    TensorOffloader* offloader =
+        (TensorOffloader::Enabled() && !pin_memory) ? TensorOffloader::Get() : nullptr;
     // reset tensor_storage_;
-    const auto& Free = [allocator, required_body_bytes](char* dptr) {
+    const auto& Free = [allocator, required_body_bytes, dtr_pool, offloader](char* dptr) {
       if (IsShuttingDown()) { return; }
       allocator->Deallocate(dptr, required_body_bytes);
+      if (dtr_pool != nullptr) { dtr_pool->OnDeallocate(allocator, required_body_bytes); }
+      if (offloader != nullptr) { offloader->OnDeallocate(allocator, required_body_bytes); }
     };
     char* dptr = nullptr;
+    if (dtr_pool != nullptr) {
+      dtr_pool->EvictUntilFits(allocator, required_body_bytes, device_ctx);
+    }
+    if (offloader != nullptr) {
+      offloader->OffloadUntilFits(allocator, required_body_bytes, device_ctx);
+    }
     allocator->Allocate(&dptr, required_body_bytes);
+    if (dtr_pool != nullptr) { dtr_pool->OnAllocate(allocator, required_body_bytes); }
+    if (offloader != nullptr) {
+      offloader->OnAllocate(tensor_storage_.get(), allocator, device_ctx, required_body_bytes);
+    }
     tensor_storage_->set_blob_dptr(std::unique_ptr<char, std::function<void(char*)>>(dptr, Free),
                                    required_body_bytes);
 
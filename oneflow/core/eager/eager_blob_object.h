@@ -69,6 +69,9 @@ class TensorStorage {
     blob_dptr_.reset();
   }
 
+  // Frees the blob body only, e.g. when DtrTensorPool evicts it. It is reallocated on next use.
+  void ReleaseBlobDptr() { blob_dptr_.reset(); }
+
   void RegisterStorageDeleteHook(const std::function<void()>& hook) {
     storage_delete_hooks_.emplace_back(hook);
   }
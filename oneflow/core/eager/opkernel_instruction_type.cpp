@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <chrono>
 #include "oneflow/core/common/device_type.pb.h"
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/protobuf.h"
@@ -26,6 +27,8 @@ limitations under the License.
 #include "oneflow/core/vm/cuda_stream_type.h"
 #include "oneflow/core/eager/opkernel_instruction_type.h"
 #include "oneflow/core/eager/local_call_opkernel_phy_instr_operand.h"
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/eager/tensor_offloader.h"
 #include "oneflow/core/vm/instruction.h"
 #include "oneflow/core/vm/instruction_type.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
@@ -43,10 +46,107 @@ namespace vm {
 
 struct LocalCallOpKernelUtil final {
   static inline Maybe<void> Compute(const vm::InstructionMsg& instr_msg) {
-    OF_PROFILER_RANGE_PUSH("ResetPrior");
     auto* operand = LocalCallOpKernelUtil::GetLocalCallOpKernelPhyInstrOperand(instr_msg);
-    operand->mut_opkernel()->composed_attrs_for_scheduler_thread()->ResetPrior(operand->attrs());
     DeviceCtx* device_ctx = instr_msg.phy_instr_stream()->device_ctx().get();
+    if (unlikely(DtrTensorPool::Enabled())) {
+      return ComputeWithDtr(
+          std::dynamic_pointer_cast<LocalCallOpKernelPhyInstrOperand>(
+              instr_msg.phy_instr_operand()),
+          device_ctx);
+    }
+    if (unlikely(TensorOffloader::Enabled())) { return ComputeWithOffload(operand, device_ctx); }
+    return Compute(operand, device_ctx);
+  }
+
+  static void Prefetch(const vm::InstructionMsg& instr_msg) {
+    auto* operand = LocalCallOpKernelUtil::GetLocalCallOpKernelPhyInstrOperand(instr_msg);
+    auto* offloader = TensorOffloader::Get();
+    for (const auto& input : *operand->inputs()) {
+      CHECK_JUST(offloader->Prefetch(input->tensor_storage().get()));
+    }
+  }
+
+  static inline LocalCallOpKernelPhyInstrOperand* GetLocalCallOpKernelPhyInstrOperand(
+      const vm::InstructionMsg& instr_msg) {
+    auto* operand = CHECK_NOTNULL(instr_msg.phy_instr_operand().get());
+    return CHECK_NOTNULL(dynamic_cast<LocalCallOpKernelPhyInstrOperand*>(operand));
+  }
+
+  static Maybe<void> DtrRematerialize(EagerBlobObject* eager_blob_object, DeviceCtx* device_ctx) {
+    const DeviceCtx* producer_device_ctx = nullptr;
+    const auto& producer =
+        DtrTensorPool::Get()->EvictedProducer(eager_blob_object, &producer_device_ctx);
+    if (likely(!producer)) { return Maybe<void>::Ok(); }
+    // Kernels are bound to the worker thread of their stream.
+    CHECK_OR_RETURN(producer_device_ctx == device_ctx)
+        << Error::RuntimeError()
+        << "a tensor evicted under ONEFLOW_DTR_MEMORY_BUDGET_MB is accessed from a stream other "
+           "than the one that produced it and cannot be rematerialized there";
+    return ComputeWithDtr(producer, device_ctx);
+  }
+
+  // Evicted tensors computed from `eager_blob_object` must be restored before it is overwritten.
+  static Maybe<void> DtrRestoreEvictedDependents(EagerBlobObject* eager_blob_object,
+                                                 DeviceCtx* device_ctx) {
+    for (auto* dependent : DtrTensorPool::Get()->EvictedDependents(eager_blob_object)) {
+      JUST(DtrRematerialize(dependent, device_ctx));
+    }
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  static Maybe<void> ComputeWithDtr(
+      const std::shared_ptr<LocalCallOpKernelPhyInstrOperand>& operand, DeviceCtx* device_ctx) {
+    CHECK_NOTNULL_OR_RETURN(operand.get());
+    auto* dtr_pool = DtrTensorPool::Get();
+    double compute_cost = 0;
+    {
+      DtrPinGuard pin_guard(dtr_pool, *operand);
+      for (const auto& input : *operand->inputs()) {
+        JUST(DtrRematerialize(input.get(), device_ctx));
+      }
+      for (int64_t index : operand->opkernel().input_tuple_indexes4mut_ibns()) {
+        auto* mut_input = operand->inputs()->at(index).get();
+        JUST(DtrRestoreEvictedDependents(mut_input, device_ctx));
+        dtr_pool->Forget(mut_input);
+      }
+      for (const auto& output : *operand->outputs()) {
+        JUST(DtrRestoreEvictedDependents(output.get(), device_ctx));
+      }
+      const auto start = std::chrono::steady_clock::now();
+      JUST(Compute(operand.get(), device_ctx));
+      // Host side time, which only covers kernel launches on asynchronous devices.
+      compute_cost =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    dtr_pool->RecordProducer(operand, device_ctx, device_ctx->mut_allocator(), compute_cost);
+    return Maybe<void>::Ok();
+  }
+
+  static Maybe<void> ComputeWithOffload(LocalCallOpKernelPhyInstrOperand* operand,
+                                        DeviceCtx* device_ctx) {
+    auto* offloader = TensorOffloader::Get();
+    std::vector<TensorStorage*> tensor_storages;
+    for (const auto& input : *operand->inputs()) {
+      tensor_storages.push_back(input->tensor_storage().get());
+    }
+    for (const auto& output : *operand->outputs()) {
+      tensor_storages.push_back(output->tensor_storage().get());
+    }
+    // Pin everything first so that restoring one storage never offloads another one.
+    for (auto* tensor_storage : tensor_storages) { offloader->Pin(tensor_storage); }
+    for (auto* tensor_storage : tensor_storages) {
+      JUST(offloader->Restore(tensor_storage, device_ctx));
+    }
+    JUST(Compute(operand, device_ctx));
+    for (auto* tensor_storage : tensor_storages) { offloader->Unpin(tensor_storage); }
+    return Maybe<void>::Ok();
+  }
+
+  static inline Maybe<void> Compute(LocalCallOpKernelPhyInstrOperand* operand,
+                                    DeviceCtx* device_ctx) {
+    OF_PROFILER_RANGE_PUSH("ResetPrior");
+    operand->mut_opkernel()->composed_attrs_for_scheduler_thread()->ResetPrior(operand->attrs());
     OF_PROFILER_RANGE_POP();
     OF_PROFILER_RANGE_PUSH("AllocateOutputBlobsMemory");
     JUST(AllocateOutputBlobsMemory(operand, device_ctx));
@@ -70,13 +170,6 @@ struct LocalCallOpKernelUtil final {
     return Maybe<void>::Ok();
   }
 
-  static inline LocalCallOpKernelPhyInstrOperand* GetLocalCallOpKernelPhyInstrOperand(
-      const vm::InstructionMsg& instr_msg) {
-    auto* operand = CHECK_NOTNULL(instr_msg.phy_instr_operand().get());
-    return CHECK_NOTNULL(dynamic_cast<LocalCallOpKernelPhyInstrOperand*>(operand));
-  }
-
- private:
   static inline void InferTempStorageBlobDesc(LocalCallOpKernelPhyInstrOperand* operand) {
     const auto& InferTmpSizeFn = operand->opkernel().GetInferTmpSizeFn(operand->user_opkernel());
     auto* temp_eager_blob_object = operand->mut_opkernel()->mut_temp_blob_object();
@@ -171,6 +264,20 @@ struct LocalCallOpKernelUtil final {
   }
 };
 
+Maybe<void> PrepareBlobAccess(EagerBlobObject* eager_blob_object, bool is_mut,
+                              DeviceCtx* device_ctx) {
+  if (unlikely(TensorOffloader::Enabled())) {
+    return TensorOffloader::Get()->Restore(eager_blob_object->tensor_storage().get(), device_ctx);
+  }
+  if (likely(!DtrTensorPool::Enabled())) { return Maybe<void>::Ok(); }
+  JUST(LocalCallOpKernelUtil::DtrRematerialize(eager_blob_object, device_ctx));
+  if (is_mut) {
+    JUST(LocalCallOpKernelUtil::DtrRestoreEvictedDependents(eager_blob_object, device_ctx));
+    DtrTensorPool::Get()->Forget(eager_blob_object);
+  }
+  return Maybe<void>::Ok();
+}
+
 void LocalCallOpKernelInstructionType::Compute(vm::Instruction* instruction) const {
   CHECK_JUST(LocalCallOpKernelUtil::Compute(instruction->instr_msg()));
 }
@@ -179,6 +286,11 @@ void LocalCallOpKernelInstructionType::ComputeInFuseMode(vm::InstructionMsg* ins
   CHECK_JUST(LocalCallOpKernelUtil::Compute(*instr_msg));
 }
 
+void LocalCallOpKernelInstructionType::Prefetch(const vm::InstructionMsg& instr_msg) const {
+  if (likely(!TensorOffloader::Enabled())) { return; }
+  LocalCallOpKernelUtil::Prefetch(instr_msg);
+}
+
 std::string LocalCallOpKernelInstructionType::DebugOpTypeName(
     const vm::InstructionMsg& instr_msg) const {
   auto* operand = CHECK_NOTNULL(instr_msg.phy_instr_operand().get());
@@ -22,12 +22,24 @@ limitations under the License.
 #include "oneflow/core/memory/memory_case.pb.h"
 
 namespace oneflow {
+
+class DeviceCtx;
+
 namespace vm {
 
+class EagerBlobObject;
+
+// Brings back the body of `eager_blob_object` if DtrTensorPool evicted it or TensorOffloader
+// offloaded it. Instructions other than LocalCallOpKernel call this before touching eager blob
+// bodies.
+Maybe<void> PrepareBlobAccess(EagerBlobObject* eager_blob_object, bool is_mut,
+                              DeviceCtx* device_ctx);
+
 class LocalCallOpKernelInstructionType : public vm::InstructionType {
  public:
   void Compute(vm::Instruction* instruction) const override;
   void ComputeInFuseMode(vm::InstructionMsg* instr_msg) const override;
+  void Prefetch(const vm::InstructionMsg& instr_msg) const override;
 
   InstructionFuseType fuse_type() const override { return kEnableInstructionFuseAtAnyPosition; }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #include "oneflow/core/vm/instruction.h"
 #include "oneflow/core/eager/release_tensor_arg_phy_instr_operand.h"
 #include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/common/cpp_attribute.h"
 #include "oneflow/core/vm/cuda_stream_type.h"
 #include "oneflow/core/vm/async_cuda_stream_type.h"
 #include "oneflow/core/vm/cuda_copy_h2d_stream_type.h"
@@ -43,6 +45,11 @@ class ReleaseTensorInstructionType : public vm::InstructionType {
     const auto* ptr =
         dynamic_cast<const vm::ReleaseTensorArgPhyInstrOperand*>(phy_instr_operand.get());
     CHECK_NOTNULL(ptr);
+    if (unlikely(DtrTensorPool::Enabled())
+        && !DtrTensorPool::Get()->Release(ptr->eager_blob_object().get())) {
+      // Still read by the producer of an evicted tensor, which frees it when it goes.
+      return;
+    }
     CHECK_JUST(ptr->eager_blob_object()->DeallocateBlobDataPtr());
   }
   void Compute(vm::Instruction* instruction) const override { Release(instruction->instr_msg()); }
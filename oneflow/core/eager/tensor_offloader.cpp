@@ -0,0 +1,313 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/eager/tensor_offloader.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include "oneflow/core/eager/dtr_tensor_pool.h"
+#include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/device/device_context.h"
+#include "oneflow/core/ep/include/device.h"
+#include "oneflow/core/ep/include/event.h"
+#include "oneflow/core/ep/include/primitive/memcpy.h"
+#include "oneflow/core/framework/shut_down_util.h"
+#include "oneflow/core/vm/allocator.h"
+#ifdef WITH_CUDA
+#include "oneflow/core/vm/cuda_host_allocator.h"
+#endif  // WITH_CUDA
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+void MemcpyOnStream(DeviceCtx* device_ctx, ep::primitive::MemcpyKind kind, void* dst,
+                    const void* src, size_t size) {
+  std::unique_ptr<ep::primitive::Memcpy> primitive =
+      ep::primitive::NewPrimitive<ep::primitive::MemcpyFactory>(device_ctx->device_type(), kind);
+  CHECK(primitive);
+  primitive->Launch(device_ctx->stream(), dst, src, size);
+}
+
+}  // namespace
+
+/* static */ bool TensorOffloader::Enabled() {
+  static const bool enabled =
+      ParseIntegerFromEnv("ONEFLOW_EAGER_OFFLOAD_BUDGET_MB", 0) > 0 && !DtrTensorPool::Enabled();
+  return enabled;
+}
+
+/* static */ TensorOffloader* TensorOffloader::Get() {
+  // Never destructed: storages may still be freed by worker threads during shutdown.
+  static TensorOffloader* offloader = new TensorOffloader(
+      ParseIntegerFromEnv("ONEFLOW_EAGER_OFFLOAD_BUDGET_MB", 0) * 1024 * 1024);
+  return offloader;
+}
+
+size_t TensorOffloader::AllocatedBytes(Allocator* allocator) {
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  return allocator2allocated_bytes_[allocator];
+}
+
+void TensorOffloader::OnDeallocate(Allocator* allocator, size_t bytes) {
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  auto* allocated_bytes = &allocator2allocated_bytes_[allocator];
+  *allocated_bytes -= std::min(*allocated_bytes, bytes);
+}
+
+void TensorOffloader::OnAllocate(TensorStorage* tensor_storage, Allocator* allocator,
+                                 DeviceCtx* device_ctx, size_t bytes) {
+  {
+    std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+    allocator2allocated_bytes_[allocator] += bytes;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  FreeCompletedHostCopies();
+  auto iter = entries_.find(tensor_storage);
+  if (iter == entries_.end()) {
+    iter = entries_.emplace(tensor_storage, Entry()).first;
+    tensor_storage->RegisterStorageDeleteHook([this, tensor_storage]() { Forget(tensor_storage); });
+  }
+  Entry* entry = &iter->second;
+  // Reallocated without being restored, e.g. because it is about to be overwritten.
+  if (entry->offloaded) { FreeHostCopyAfterStream(*entry, &entry->host_copy); }
+  entry->allocator = allocator;
+  entry->device_ctx = device_ctx;
+  entry->bytes = bytes;
+  entry->last_access = ++clock_;
+  entry->offloaded = false;
+}
+
+void TensorOffloader::Forget(TensorStorage* tensor_storage) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = entries_.find(tensor_storage);
+  if (iter == entries_.end()) { return; }
+  if (iter->second.offloaded) { FreeHostCopyAfterStream(iter->second, &iter->second.host_copy); }
+  entries_.erase(iter);
+}
+
+void TensorOffloader::Pin(TensorStorage* tensor_storage) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++pinned_[tensor_storage];
+}
+
+void TensorOffloader::Unpin(TensorStorage* tensor_storage) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = pinned_.find(tensor_storage);
+  CHECK(iter != pinned_.end());
+  if (--iter->second == 0) { pinned_.erase(iter); }
+}
+
+bool TensorOffloader::Offloadable(TensorStorage* tensor_storage, const Entry& entry,
+                                  Allocator* allocator, const DeviceCtx* device_ctx) const {
+  if (entry.offloaded || entry.allocator != allocator || entry.device_ctx != device_ctx) {
+    return false;
+  }
+  if (pinned_.count(tensor_storage) > 0) { return false; }
+  return tensor_storage->blob_dptr() != nullptr;
+}
+
+Maybe<void> TensorOffloader::AllocateHostCopy(const Entry& entry, HostCopy* host_copy) const {
+  host_copy->size = entry.bytes;
+  if (entry.device_ctx->device_type() != DeviceType::kCPU) {
+#ifdef WITH_CUDA
+    auto* pinned_allocator = Global<CudaHostAllocator>::Get();
+    CHECK_NOTNULL_OR_RETURN(pinned_allocator) << "no pinned host memory to offload to";
+    pinned_allocator->Allocate(&host_copy->ptr, host_copy->size);
+#else
+    // Builds without cuda have no pinned host allocator.
+    host_copy->ptr = static_cast<char*>(
+        aligned_alloc(kHostAlignSize, RoundUp(host_copy->size, kHostAlignSize)));
+    CHECK_NOTNULL_OR_RETURN(host_copy->ptr)
+        << "failed to allocate " << host_copy->size << " offload bytes";
+#endif  // WITH_CUDA
+    host_copy->is_mmap = false;
+    return Maybe<void>::Ok();
+  }
+  std::string path =
+      GetStringFromEnv("ONEFLOW_EAGER_OFFLOAD_DIR", "/tmp") + "/oneflow_offload_XXXXXX";
+  int fd = mkstemp(&path[0]);
+  CHECK_GE_OR_RETURN(fd, 0) << "failed to create offload file " << path;
+  // The mapping keeps the file alive.
+  PCHECK(unlink(path.c_str()) == 0);
+  const int truncate_ret = ftruncate(fd, host_copy->size);
+  void* ptr = (truncate_ret == 0)
+                  ? mmap(nullptr, host_copy->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                  : MAP_FAILED;
+  PCHECK(close(fd) == 0);
+  CHECK_OR_RETURN(ptr != MAP_FAILED) << "failed to map " << host_copy->size << " offload bytes";
+  host_copy->ptr = static_cast<char*>(ptr);
+  host_copy->is_mmap = true;
+  return Maybe<void>::Ok();
+}
+
+void TensorOffloader::FreeHostCopy(HostCopy* host_copy) const {
+  if (host_copy->is_mmap) {
+    PCHECK(munmap(host_copy->ptr, host_copy->size) == 0);
+  } else {
+#ifdef WITH_CUDA
+    Global<CudaHostAllocator>::Get()->Deallocate(host_copy->ptr, host_copy->size);
+#else
+    free(host_copy->ptr);  // NOLINT
+#endif  // WITH_CUDA
+  }
+  host_copy->ptr = nullptr;
+}
+
+void TensorOffloader::FreeHostCopyAfterStream(const Entry& entry, HostCopy* host_copy) {
+  // Copies from and to mmap'd files are synchronous.
+  if (host_copy->is_mmap) { return FreeHostCopy(host_copy); }
+  // The pinned buffer goes back to the caching allocator, which may hand it out right away, so it
+  // must outlive the asynchronous copy.
+  ep::Stream* stream = entry.device_ctx->stream();
+  ep::Event* event = stream->device()->CreateEvent();
+  stream->RecordEvent(event);
+  pending_host_copy_frees_.emplace_back(PendingHostCopyFree{stream->device(), event, *host_copy});
+  host_copy->ptr = nullptr;
+}
+
+void TensorOffloader::FreeCompletedHostCopies() {
+  auto iter = std::remove_if(
+      pending_host_copy_frees_.begin(), pending_host_copy_frees_.end(),
+      [this](PendingHostCopyFree& pending) {
+        if (!CHECK_JUST(pending.event->QueryDone())) { return false; }
+        FreeHostCopy(&pending.host_copy);
+        pending.device->DestroyEvent(pending.event);
+        return true;
+      });
+  pending_host_copy_frees_.erase(iter, pending_host_copy_frees_.end());
+}
+
+Maybe<void> TensorOffloader::Offload(TensorStorage* tensor_storage, Entry* entry) {
+  JUST(AllocateHostCopy(*entry, &entry->host_copy));
+  if (entry->host_copy.is_mmap) {
+    std::memcpy(entry->host_copy.ptr, tensor_storage->blob_dptr(), entry->bytes);
+    // Start writeback so that the pages can be reclaimed under memory pressure.
+    msync(entry->host_copy.ptr, entry->bytes, MS_ASYNC);
+  } else {
+    // Stream ordered: the device memory freed below is only reused by later work on this stream.
+    MemcpyOnStream(entry->device_ctx, ep::primitive::MemcpyKind::kDtoH, entry->host_copy.ptr,
+                   tensor_storage->blob_dptr(), entry->bytes);
+  }
+  entry->offloaded = true;
+  tensor_storage->ReleaseBlobDptr();
+  ++stats_.offload_cnt;
+  stats_.offloaded_bytes += entry->bytes;
+  return Maybe<void>::Ok();
+}
+
+void TensorOffloader::OffloadUntilFits(Allocator* allocator, size_t bytes,
+                                       const DeviceCtx* device_ctx) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  OffloadUntilFitsLocked(allocator, bytes, device_ctx);
+}
+
+void TensorOffloader::OffloadUntilFitsLocked(Allocator* allocator, size_t bytes,
+                                             const DeviceCtx* device_ctx) {
+  FreeCompletedHostCopies();
+  while (AllocatedBytes(allocator) + bytes > memory_budget_bytes_) {
+    TensorStorage* victim = nullptr;
+    Entry* victim_entry = nullptr;
+    for (auto& pair : entries_) {
+      if (!Offloadable(pair.first, pair.second, allocator, device_ctx)) { continue; }
+      if (victim == nullptr || pair.second.last_access < victim_entry->last_access) {
+        victim = pair.first;
+        victim_entry = &pair.second;
+      }
+    }
+    // The budget is soft: let the allocator decide when nothing is left to offload.
+    if (victim == nullptr) { break; }
+    const auto& maybe_ok = Offload(victim, victim_entry);
+    if (!maybe_ok.IsOk()) {
+      LOG(WARNING) << maybe_ok.GetSerializedError();
+      break;
+    }
+  }
+}
+
+Maybe<void> TensorOffloader::CopyBack(TensorStorage* tensor_storage, Entry* entry) {
+  Allocator* allocator = entry->allocator;
+  const size_t bytes = entry->bytes;
+  OffloadUntilFitsLocked(allocator, bytes, entry->device_ctx);
+  char* dptr = nullptr;
+  allocator->Allocate(&dptr, bytes);
+  CHECK_NOTNULL_OR_RETURN(dptr) << "failed to allocate " << bytes << " bytes to restore into";
+  {
+    std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+    allocator2allocated_bytes_[allocator] += bytes;
+  }
+  const auto& Free = [allocator, bytes, this](char* dptr) {
+    if (IsShuttingDown()) { return; }
+    allocator->Deallocate(dptr, bytes);
+    OnDeallocate(allocator, bytes);
+  };
+  if (entry->host_copy.is_mmap) {
+    std::memcpy(dptr, entry->host_copy.ptr, bytes);
+  } else {
+    MemcpyOnStream(entry->device_ctx, ep::primitive::MemcpyKind::kHtoD, dptr, entry->host_copy.ptr,
+                   bytes);
+  }
+  FreeHostCopyAfterStream(*entry, &entry->host_copy);
+  tensor_storage->set_blob_dptr(std::unique_ptr<char, std::function<void(char*)>>(dptr, Free),
+                                bytes);
+  entry->offloaded = false;
+  entry->last_access = ++clock_;
+  stats_.restored_bytes += bytes;
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> TensorOffloader::Restore(TensorStorage* tensor_storage, DeviceCtx* device_ctx) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = entries_.find(tensor_storage);
+  if (iter == entries_.end()) { return Maybe<void>::Ok(); }
+  Entry* entry = &iter->second;
+  if (!entry->offloaded) {
+    entry->last_access = ++clock_;
+    return Maybe<void>::Ok();
+  }
+  JUST(CopyBack(tensor_storage, entry));
+  ++stats_.on_demand_restore_cnt;
+  if (entry->device_ctx != device_ctx && entry->device_ctx->device_type() != DeviceType::kCPU) {
+    JUST(entry->device_ctx->stream()->Sync());
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> TensorOffloader::Prefetch(TensorStorage* tensor_storage) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = entries_.find(tensor_storage);
+  if (iter == entries_.end() || !iter->second.offloaded) { return Maybe<void>::Ok(); }
+  // Copying back from mmap'd files is synchronous and would stall the scheduler thread.
+  if (iter->second.host_copy.is_mmap) { return Maybe<void>::Ok(); }
+  iter->second.device_ctx->stream()->device()->SetAsActiveDevice();
+  JUST(CopyBack(tensor_storage, &iter->second));
+  ++stats_.prefetch_cnt;
+  return Maybe<void>::Ok();
+}
+
+TensorOffloaderStats TensorOffloader::GetStats() const {
+  TensorOffloaderStats stats{};
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stats = stats_;
+  }
+  std::unique_lock<std::mutex> lock(allocated_bytes_mutex_);
+  stats.resident_bytes = 0;
+  for (const auto& pair : allocator2allocated_bytes_) { stats.resident_bytes += pair.second; }
+  return stats;
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,143 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EAGER_TENSOR_OFFLOADER_H_
+#define ONEFLOW_CORE_EAGER_TENSOR_OFFLOADER_H_
+
+#include <mutex>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+
+namespace oneflow {
+
+class DeviceCtx;
+
+namespace ep {
+class Device;
+class Event;
+}  // namespace ep
+
+namespace vm {
+
+class Allocator;
+class TensorStorage;
+
+struct TensorOffloaderStats {
+  int64_t offload_cnt;
+  int64_t offloaded_bytes;
+  // Restores issued ahead of the consuming instruction, while it was only dispatched.
+  int64_t prefetch_cnt;
+  // Restores done by the consuming instruction itself, which stalls it.
+  int64_t on_demand_restore_cnt;
+  int64_t restored_bytes;
+  // Bytes currently allocated for tensor storages, summed over all allocators.
+  int64_t resident_bytes;
+};
+
+// Host memory tier for eager tensor storages.
+//
+// When an allocation would push the bytes held on an allocator over
+// ONEFLOW_EAGER_OFFLOAD_BUDGET_MB, the least recently used storages are copied out and their
+// device memory is freed. Device memory goes to the pinned host pool; cpu memory goes to unlinked
+// files mmap'd under ONEFLOW_EAGER_OFFLOAD_DIR (default /tmp) so that the kernel can page it out.
+// Storages are copied back by the instruction that touches them, or earlier by Prefetch when the
+// VM dispatches that instruction to its worker thread.
+//
+// Unlike DtrTensorPool nothing needs to be recomputable, so optimizer states and parameters are
+// candidates too. It is disabled while DtrTensorPool is enabled.
+class TensorOffloader final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TensorOffloader);
+  ~TensorOffloader() = default;
+
+  static bool Enabled();
+  static TensorOffloader* Get();
+
+  // Called by the stream's worker thread around each blob body allocation of `tensor_storage`.
+  void OffloadUntilFits(Allocator* allocator, size_t bytes, const DeviceCtx* device_ctx);
+  void OnAllocate(TensorStorage* tensor_storage, Allocator* allocator, DeviceCtx* device_ctx,
+                  size_t bytes);
+  void OnDeallocate(Allocator* allocator, size_t bytes);
+
+  // Pinned storages are used by the running instruction and are never offloaded.
+  void Pin(TensorStorage* tensor_storage);
+  void Unpin(TensorStorage* tensor_storage);
+
+  // Copies `tensor_storage` back if it is offloaded. The copy is issued on the stream that
+  // offloaded it and is visible to `device_ctx` on return.
+  Maybe<void> Restore(TensorStorage* tensor_storage, DeviceCtx* device_ctx);
+
+  // Issues the copy back of an offloaded non-cpu storage without waiting for it.
+  Maybe<void> Prefetch(TensorStorage* tensor_storage);
+
+  TensorOffloaderStats GetStats() const;
+
+ private:
+  struct HostCopy {
+    char* ptr;
+    size_t size;
+    bool is_mmap;
+  };
+
+  // A pinned host copy which an asynchronous copy may still read from or write to.
+  struct PendingHostCopyFree {
+    ep::Device* device;
+    ep::Event* event;
+    HostCopy host_copy;
+  };
+
+  struct Entry {
+    Allocator* allocator;
+    DeviceCtx* device_ctx;
+    size_t bytes;
+    int64_t last_access;
+    bool offloaded;
+    HostCopy host_copy;
+  };
+
+  explicit TensorOffloader(size_t memory_budget_bytes)
+      : memory_budget_bytes_(memory_budget_bytes), clock_(0), stats_() {}
+
+  void Forget(TensorStorage* tensor_storage);
+  size_t AllocatedBytes(Allocator* allocator);
+
+  // All of the following are called with `mutex_` held.
+  bool Offloadable(TensorStorage* tensor_storage, const Entry& entry, Allocator* allocator,
+                   const DeviceCtx* device_ctx) const;
+  void OffloadUntilFitsLocked(Allocator* allocator, size_t bytes, const DeviceCtx* device_ctx);
+  Maybe<void> Offload(TensorStorage* tensor_storage, Entry* entry);
+  Maybe<void> CopyBack(TensorStorage* tensor_storage, Entry* entry);
+  Maybe<void> AllocateHostCopy(const Entry& entry, HostCopy* host_copy) const;
+  void FreeHostCopy(HostCopy* host_copy) const;
+  // Frees `host_copy` once the work issued so far on the stream of `entry` is done.
+  void FreeHostCopyAfterStream(const Entry& entry, HostCopy* host_copy);
+  void FreeCompletedHostCopies();
+
+  const size_t memory_budget_bytes_;
+  mutable std::mutex mutex_;
+  int64_t clock_;
+  HashMap<TensorStorage*, Entry> entries_;
+  HashMap<TensorStorage*, int32_t> pinned_;
+  TensorOffloaderStats stats_;
+  std::vector<PendingHostCopyFree> pending_host_copy_frees_;
+  // Device memory is freed on arbitrary threads, possibly while `mutex_` is held by an offload.
+  mutable std::mutex allocated_bytes_mutex_;
+  HashMap<Allocator*, size_t> allocator2allocated_bytes_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EAGER_TENSOR_OFFLOADER_H_
@@ -17,14 +17,27 @@ limitations under the License.
 #include "oneflow/core/embedding/persistent_table_key_value_store.h"
 #include "oneflow/core/ep/include/device_manager_registry.h"
 #include "oneflow/core/embedding/cached_key_value_store.h"
+#include "oneflow/core/device/cuda_util.h"
 
 namespace oneflow {
 
 namespace embedding {
 
+constexpr size_t kDefaultMaxQueryLength = 65536;
+
+namespace {
+
 #ifdef WITH_CUDA
 
-constexpr size_t kDefaultMaxQueryLength = 65536;
+std::unique_ptr<CudaCurrentDeviceGuard> NewDeviceGuardIfNeeded(DeviceType device_type,
+                                                              int64_t local_rank_id) {
+  if (device_type != DeviceType::kCUDA) { return nullptr; }
+  return std::make_unique<CudaCurrentDeviceGuard>(local_rank_id);
+}
+
+#endif  // WITH_CUDA
+
+}  // namespace
 
 KeyValueStore* EmbeddingManager::GetKeyValueStore(const std::string& embedding_name,
                                                   int64_t rank_id) {
@@ -39,7 +52,10 @@ KeyValueStore* EmbeddingManager::GetKeyValueStore(const std::string& embedding_n
 void EmbeddingManager::CreateKeyValueStore(const KeyValueStoreOptions& key_value_store_options,
                                            int64_t local_rank_id, int64_t rank_id,
                                            int64_t world_size) {
-  CudaCurrentDeviceGuard guard(local_rank_id);
+  const DeviceType device_type = key_value_store_options.GetDeviceType();
+#ifdef WITH_CUDA
+  auto guard = NewDeviceGuardIfNeeded(device_type, local_rank_id);
+#endif  // WITH_CUDA
   const std::string& name = key_value_store_options.Name();
   const uint32_t line_size = key_value_store_options.LineSize();
   std::pair<std::string, int64_t> map_key = std::make_pair(name, rank_id);
@@ -57,36 +73,49 @@ void EmbeddingManager::CreateKeyValueStore(const KeyValueStoreOptions& key_value
       key_value_store_options.PersistentTablePhysicalBlockSize();
   options.table_options.target_chunk_size_mb = 4 * 1024;
   options.table_options.capacity_hint = key_value_store_options.PersistentTableCapacityHint();
-  store = NewPersistentTableKeyValueStore(options);
-  const std::vector<CacheOptions>& cache_options = key_value_store_options.GetCachesOptions();
-  for (int i = cache_options.size() - 1; i >= 0; --i) {
-    std::unique_ptr<Cache> cache = NewCache(cache_options.at(i));
-    store = NewCachedKeyValueStore(std::move(store), std::move(cache));
+  if (device_type == DeviceType::kCPU) {
+    store = NewHostPersistentTableKeyValueStore(options);
+  } else {
+#ifdef WITH_CUDA
+    store = NewPersistentTableKeyValueStore(options);
+    const std::vector<CacheOptions>& cache_options = key_value_store_options.GetCachesOptions();
+    for (int i = cache_options.size() - 1; i >= 0; --i) {
+      std::unique_ptr<Cache> cache = NewCache(cache_options.at(i));
+      store = NewCachedKeyValueStore(std::move(store), std::move(cache));
+    }
+#else
+    UNIMPLEMENTED() << "The cuda kv_store of embedding " << name << " requires WITH_CUDA";
+#endif  // WITH_CUDA
   }
   store->ReserveQueryLength(kDefaultMaxQueryLength);
   CHECK(key_value_store_map_.emplace(map_key, std::move(store)).second)
       << "Can't create an embedding with same name of an existing embedding, the name: " << name;
+  device_type_map_.emplace(map_key, device_type);
 }
 
 void EmbeddingManager::SaveSnapshot(const std::string& embedding_name, int64_t local_rank_id,
                                     int64_t rank_id, const std::string& snapshot_name) {
-  CudaCurrentDeviceGuard guard(local_rank_id);
   std::pair<std::string, int64_t> map_key = std::make_pair(embedding_name, rank_id);
   std::unique_lock<std::mutex> lock(mutex_);
-
   auto it = key_value_store_map_.find(map_key);
   CHECK(it != key_value_store_map_.end())
       << "Can not find embedding: " << embedding_name << "-" << rank_id;
+#ifdef WITH_CUDA
+  auto guard = NewDeviceGuardIfNeeded(device_type_map_.at(map_key), local_rank_id);
+#endif  // WITH_CUDA
   it->second->SaveSnapshot(snapshot_name);
 }
 
 void EmbeddingManager::LoadSnapshot(const std::string& embedding_name, int64_t local_rank_id,
                                     int64_t rank_id, const std::string& snapshot_name) {
-  CudaCurrentDeviceGuard guard(local_rank_id);
   std::pair<std::string, int64_t> map_key = std::make_pair(embedding_name, rank_id);
+  std::unique_lock<std::mutex> lock(mutex_);
   auto it = key_value_store_map_.find(map_key);
   CHECK(it != key_value_store_map_.end())
       << "Can not find embedding: " << embedding_name << "-" << rank_id;
+#ifdef WITH_CUDA
+  auto guard = NewDeviceGuardIfNeeded(device_type_map_.at(map_key), local_rank_id);
+#endif  // WITH_CUDA
   if (it->second->SnapshotExists(snapshot_name)) {
     it->second->LoadSnapshot(snapshot_name);
   } else {
@@ -95,8 +124,6 @@ void EmbeddingManager::LoadSnapshot(const std::string& embedding_name, int64_t l
   }
 }
 
-#endif  // WITH_CUDA
-
 }  // namespace embedding
 
 }  // namespace oneflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_EMBEDDING_KEY_VALUE_STORE_OPTIONS_H_
 #include "nlohmann/json.hpp"
 #include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/common/device_type.h"
 #include "oneflow/core/embedding/cache.h"
 
 namespace oneflow {
@@ -97,6 +98,23 @@ class KeyValueStoreOptions final {
     CHECK(json_object.contains("kv_store"));
     auto kv_store = json_object["kv_store"];
 
+#ifdef WITH_CUDA
+    device_type_ = DeviceType::kCUDA;
+#else
+    device_type_ = DeviceType::kCPU;
+#endif  // WITH_CUDA
+    if (kv_store.contains("device_type")) {
+      CHECK(kv_store["device_type"].is_string());
+      const std::string device_type = kv_store["device_type"].get<std::string>();
+      if (device_type == "cuda") {
+        device_type_ = DeviceType::kCUDA;
+      } else if (device_type == "cpu") {
+        device_type_ = DeviceType::kCPU;
+      } else {
+        UNIMPLEMENTED() << "Unsupported kv_store device_type: " << device_type;
+      }
+    }
+
     auto caches = kv_store["caches"];
     if (caches != nlohmann::detail::value_t::null && caches.size() > 0) {
       CHECK(caches.is_array());
@@ -107,6 +125,8 @@ class KeyValueStoreOptions final {
         ParseCacheOptions(caches.at(i), &cache_options_.at(i));
       }
     }
+    CHECK(device_type_ != DeviceType::kCPU || cache_options_.empty())
+        << "Caches are not supported by cpu kv_store";
 
     CHECK(kv_store.contains("persistent_table"));
     auto persistent_table = kv_store["persistent_table"];
@@ -146,6 +166,7 @@ class KeyValueStoreOptions final {
   int64_t ValueTypeSize() const { return value_type_size_; }
   const std::string& Name() const { return name_; }
   int64_t LineSize() const { return line_size_; }
+  DeviceType GetDeviceType() const { return device_type_; }
   const std::vector<CacheOptions>& GetCachesOptions() const { return cache_options_; }
   const std::vector<std::string>& PersistentTablePaths() const { return persistent_table_paths_; }
   int64_t PersistentTablePhysicalBlockSize() const { return persistent_table_physical_block_size_; }
@@ -162,6 +183,7 @@ class KeyValueStoreOptions final {
   int64_t value_type_size_;
   std::string name_;
   int64_t line_size_;
+  DeviceType device_type_;
   std::vector<std::string> persistent_table_paths_;
   int64_t persistent_table_physical_block_size_;
   int64_t persistent_table_capacity_hint_;
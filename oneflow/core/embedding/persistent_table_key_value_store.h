@@ -23,12 +23,16 @@ namespace oneflow {
 
 namespace embedding {
 
-#ifdef WITH_CUDA
-
 struct PersistentTableKeyValueStoreOptions {
   PersistentTableOptions table_options{};
 };
 
+// Store whose Get/Put take host pointers and run on CPU streams, without any device staging.
+std::unique_ptr<KeyValueStore> NewHostPersistentTableKeyValueStore(
+    const PersistentTableKeyValueStoreOptions& options);
+
+#ifdef WITH_CUDA
+
 std::unique_ptr<KeyValueStore> NewPersistentTableKeyValueStore(
     const PersistentTableKeyValueStoreOptions& options);
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/ep/cpu/cpu_device.h"
 #include "oneflow/core/ep/cpu/cpu_event.h"
 #include "oneflow/core/ep/cpu/cpu_stream.h"
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
 #include "oneflow/core/ep/include/device_manager_registry.h"
 
 namespace oneflow {
@@ -44,7 +45,9 @@ Maybe<void> CpuDevice::Alloc(const AllocationOptions& options, void** ptr, size_
     CHECK_OR_RETURN(device);
     return device->AllocPinned(options, ptr, size);
   } else {
-    *ptr = aligned_alloc(kMaxAlignmentRequirement, size);
+    const int32_t numa_node =
+        options.HasNumaNodeAffinity() ? static_cast<int32_t>(options.GetNumaNodeAffinity()) : -1;
+    *ptr = NumaHostAllocator::Get()->Allocate(size, kMaxAlignmentRequirement, numa_node);
     if (*ptr == nullptr) {
       return Error::RuntimeError() << "allocate failed";
     } else {
@@ -61,7 +64,7 @@ void CpuDevice::Free(const AllocationOptions& options, void* ptr) {
     CHECK(device);
     return device->FreePinned(options, ptr);
   } else {
-    free(ptr);  // NOLINT
+    NumaHostAllocator::Get()->Deallocate(ptr);
   }
 }
 
@@ -0,0 +1,351 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EP_CPU_CPU_SOFTMAX_H_
+#define ONEFLOW_CORE_EP_CPU_CPU_SOFTMAX_H_
+
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace oneflow {
+
+namespace ep {
+
+namespace cpu_softmax {
+
+// Row softmax over tiles of columns, the cpu counterpart of oneflow/core/cuda/softmax.cuh.
+//
+// The forward pass reads every tile once to get its max and its sum of exp, and merges them into
+// the row max and sum online. For softmax it keeps exp(x - tile_max) in the output, so the second
+// pass only rescales the tile by exp(tile_max - row_max) / row_sum.
+//
+// A LOAD provides `const T* load(T* buf, int64_t row, int64_t col, int64_t n) const`, returning n
+// inputs starting at (row, col), either in place or computed into buf. A STORE provides
+// `T* ptr(int64_t row, int64_t col) const`, where the result is written, and
+// `void store(int64_t row, int64_t col, int64_t n) const`, called once the n results at
+// ptr(row, col) are final.
+
+enum class Algorithm {
+  kSoftmax,
+  kLogSoftmax,
+};
+
+// Columns per tile, a tile of inputs and outputs stays in L1 between the passes over it.
+constexpr int64_t kTileSize = 2048;
+// Independent accumulators of the tile reductions, which lets the compiler keep them in vector
+// registers without reassociating floating point math.
+constexpr int64_t kNumLanes = 16;
+// Rows at least this wide are split into tiles across threads when there are fewer rows than
+// threads.
+constexpr int64_t kMinColsPerThread = 8 * kTileSize;
+
+// exp on [-88.38, 88], Cephes polynomial with results below FLT_MIN flushed to zero. It has no
+// branches and no libm call, so loops over it are vectorized by the compiler.
+inline float ExpPolynomial(float x) {
+  const float t = x * 1.44269504088896341f + 0.5f;
+  int32_t n = static_cast<int32_t>(t);
+  n -= static_cast<float>(n) > t ? 1 : 0;
+  const float fn = static_cast<float>(n);
+  x = x - fn * 0.693359375f + fn * 2.12194440e-4f;
+  float p = 1.9875691500e-4f;
+  p = p * x + 1.3981999507e-3f;
+  p = p * x + 8.3334519073e-3f;
+  p = p * x + 4.1665795894e-2f;
+  p = p * x + 1.6666665459e-1f;
+  p = p * x + 5.0000001201e-1f;
+  p = p * x * x + x + 1.0f;
+  const int32_t bits = (n + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+// y = exp(x - shift), y may alias x.
+template<typename T>
+inline void TileExp(const T* x, T shift, T* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = std::exp(x[i] - shift); }
+}
+
+template<>
+inline void TileExp<float>(const float* x, float shift, float* y, int64_t n) {
+  constexpr float kMax = 88.0f;
+  constexpr float kMin = -88.3762626647949f;
+  // Clamping in its own loop keeps the selects out of the polynomial, where gcc would otherwise
+  // specialize the arithmetic per branch and give up on vectorizing.
+  for (int64_t i = 0; i < n; ++i) {
+    float v = x[i] - shift;
+    v = v > kMax ? kMax : v;
+    y[i] = v < kMin ? kMin : v;
+  }
+  for (int64_t i = 0; i < n; ++i) { y[i] = ExpPolynomial(y[i]); }
+}
+
+template<typename T>
+inline T TileMax(const T* x, int64_t n) {
+  T lanes[kNumLanes];
+  std::fill(lanes, lanes + kNumLanes, -std::numeric_limits<T>::infinity());
+  int64_t i = 0;
+  for (; i + kNumLanes <= n; i += kNumLanes) {
+    for (int64_t k = 0; k < kNumLanes; ++k) {
+      lanes[k] = x[i + k] > lanes[k] ? x[i + k] : lanes[k];
+    }
+  }
+  for (; i < n; ++i) { lanes[0] = x[i] > lanes[0] ? x[i] : lanes[0]; }
+  T max = lanes[0];
+  for (int64_t k = 1; k < kNumLanes; ++k) { max = lanes[k] > max ? lanes[k] : max; }
+  return max;
+}
+
+template<typename T>
+inline T TileSum(const T* x, int64_t n) {
+  T lanes[kNumLanes] = {0};
+  int64_t i = 0;
+  for (; i + kNumLanes <= n; i += kNumLanes) {
+    for (int64_t k = 0; k < kNumLanes; ++k) { lanes[k] += x[i + k]; }
+  }
+  for (; i < n; ++i) { lanes[0] += x[i]; }
+  T sum = 0;
+  for (int64_t k = 0; k < kNumLanes; ++k) { sum += lanes[k]; }
+  return sum;
+}
+
+template<typename T>
+inline T TileDot(const T* x, const T* y, int64_t n) {
+  T lanes[kNumLanes] = {0};
+  int64_t i = 0;
+  for (; i + kNumLanes <= n; i += kNumLanes) {
+    for (int64_t k = 0; k < kNumLanes; ++k) { lanes[k] += x[i + k] * y[i + k]; }
+  }
+  for (; i < n; ++i) { lanes[0] += x[i] * y[i]; }
+  T sum = 0;
+  for (int64_t k = 0; k < kNumLanes; ++k) { sum += lanes[k]; }
+  return sum;
+}
+
+template<typename T>
+struct MaxSum {
+  T max = -std::numeric_limits<T>::infinity();
+  T sum = 0;
+
+  void Merge(T other_max, T other_sum) {
+    // A tile of -inf contributes nothing, and would turn the rescaling below into nan.
+    if (other_max == -std::numeric_limits<T>::infinity()) { return; }
+    if (other_max > max) {
+      sum = sum * std::exp(max - other_max) + other_sum;
+      max = other_max;
+    } else {
+      sum += other_sum * std::exp(other_max - max);
+    }
+  }
+};
+
+template<typename T>
+struct DirectLoad {
+  DirectLoad(const T* src, int64_t row_size) : src(src), row_size(row_size) {}
+  const T* load(T* buf, int64_t row, int64_t col, int64_t n) const {
+    return src + row * row_size + col;
+  }
+  const T* src;
+  int64_t row_size;
+};
+
+template<typename T>
+struct DirectStore {
+  DirectStore(T* dst, int64_t row_size) : dst(dst), row_size(row_size) {}
+  T* ptr(int64_t row, int64_t col) const { return dst + row * row_size + col; }
+  void store(int64_t row, int64_t col, int64_t n) const {}
+  T* dst;
+  int64_t row_size;
+};
+
+// First pass over a tile, returns its max and sum of exp(x - max). For softmax exp(x - max) is
+// kept in the output, log softmax only needs exp_buf as scratch.
+template<Algorithm algorithm, typename T, typename LOAD, typename STORE>
+inline void ReduceTile(const LOAD& load, const STORE& store, int64_t row, int64_t col, int64_t n,
+                       T* buf, T* exp_buf, T* tile_max, T* tile_sum) {
+  const T* x = load.load(buf, row, col, n);
+  const T max = TileMax(x, n);
+  // Shifting a tile of -inf by 0 keeps its exp at 0 instead of nan.
+  const T shift = max == -std::numeric_limits<T>::infinity() ? T(0) : max;
+  T* exp = algorithm == Algorithm::kSoftmax ? store.ptr(row, col) : exp_buf;
+  TileExp(x, shift, exp, n);
+  *tile_max = max;
+  *tile_sum = TileSum(exp, n);
+}
+
+template<Algorithm algorithm, typename T, typename LOAD, typename STORE>
+inline void FinishTile(const LOAD& load, const STORE& store, int64_t row, int64_t col, int64_t n,
+                       T* buf, T tile_max, const MaxSum<T>& row_max_sum) {
+  T* y = store.ptr(row, col);
+  if (algorithm == Algorithm::kSoftmax) {
+    if (tile_max != -std::numeric_limits<T>::infinity()) {
+      const T scale = std::exp(tile_max - row_max_sum.max) / row_max_sum.sum;
+      for (int64_t i = 0; i < n; ++i) { y[i] *= scale; }
+    }
+  } else if (algorithm == Algorithm::kLogSoftmax) {
+    const T* x = load.load(buf, row, col, n);
+    const T shift = row_max_sum.max + std::log(row_max_sum.sum);
+    for (int64_t i = 0; i < n; ++i) { y[i] = x[i] - shift; }
+  } else {
+    UNIMPLEMENTED();
+  }
+  store.store(row, col, n);
+}
+
+template<Algorithm algorithm, typename T, typename LOAD, typename STORE>
+void SoftmaxRows(const LOAD& load, const STORE& store, int64_t row_begin, int64_t row_end,
+                 int64_t cols) {
+  const int64_t num_tiles = (cols + kTileSize - 1) / kTileSize;
+  const int64_t buf_size = std::min(cols, kTileSize);
+  std::vector<T> buf(buf_size);
+  std::vector<T> exp_buf(algorithm == Algorithm::kLogSoftmax ? buf_size : 0);
+  std::vector<T> tile_max(num_tiles);
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    MaxSum<T> row_max_sum;
+    for (int64_t tile = 0; tile < num_tiles; ++tile) {
+      const int64_t col = tile * kTileSize;
+      const int64_t n = std::min(kTileSize, cols - col);
+      T tile_sum;
+      ReduceTile<algorithm>(load, store, row, col, n, buf.data(), exp_buf.data(),
+                            &tile_max[tile], &tile_sum);
+      row_max_sum.Merge(tile_max[tile], tile_sum);
+    }
+    for (int64_t tile = 0; tile < num_tiles; ++tile) {
+      const int64_t col = tile * kTileSize;
+      FinishTile<algorithm>(load, store, row, col, std::min(kTileSize, cols - col), buf.data(),
+                            tile_max[tile], row_max_sum);
+    }
+  }
+}
+
+// Wide rows and too few of them to keep every thread busy: tiles are reduced in parallel, merged
+// per row, then finished in parallel.
+template<Algorithm algorithm, typename T, typename LOAD, typename STORE>
+void SoftmaxTiles(CpuStream* stream, const LOAD& load, const STORE& store, int64_t rows,
+                  int64_t cols) {
+  const int64_t num_tiles = (cols + kTileSize - 1) / kTileSize;
+  std::vector<T> tile_max(rows * num_tiles);
+  std::vector<T> tile_sum(rows * num_tiles);
+  stream->ParallelFor(
+      0, rows * num_tiles,
+      [&](int64_t begin, int64_t end) {
+        std::vector<T> buf(kTileSize);
+        std::vector<T> exp_buf(algorithm == Algorithm::kLogSoftmax ? kTileSize : 0);
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t row = i / num_tiles;
+          const int64_t col = (i % num_tiles) * kTileSize;
+          ReduceTile<algorithm>(load, store, row, col, std::min(kTileSize, cols - col),
+                                buf.data(), exp_buf.data(), &tile_max[i], &tile_sum[i]);
+        }
+      },
+      1);
+  std::vector<MaxSum<T>> row_max_sum(rows);
+  for (int64_t i = 0; i < rows * num_tiles; ++i) {
+    row_max_sum[i / num_tiles].Merge(tile_max[i], tile_sum[i]);
+  }
+  stream->ParallelFor(
+      0, rows * num_tiles,
+      [&](int64_t begin, int64_t end) {
+        std::vector<T> buf(kTileSize);
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t row = i / num_tiles;
+          const int64_t col = (i % num_tiles) * kTileSize;
+          FinishTile<algorithm>(load, store, row, col, std::min(kTileSize, cols - col),
+                                buf.data(), tile_max[i], row_max_sum[row]);
+        }
+      },
+      1);
+}
+
+template<Algorithm algorithm, typename T, typename LOAD, typename STORE>
+void DispatchSoftmax(CpuStream* stream, const LOAD& load, const STORE& store, int64_t rows,
+                     int64_t cols) {
+  if (rows == 0 || cols == 0) { return; }
+  const int64_t num_threads = stream->device()->GetNumThreads();
+  if (rows < num_threads && cols >= kMinColsPerThread) {
+    SoftmaxTiles<algorithm, T>(stream, load, store, rows, cols);
+  } else {
+    const int64_t grain = std::max<int64_t>(32768 / cols, 1);
+    stream->ParallelFor(
+        0, rows,
+        [&](int64_t begin, int64_t end) {
+          SoftmaxRows<algorithm, T>(load, store, begin, end, cols);
+        },
+        grain);
+  }
+}
+
+template<Algorithm algorithm, typename T, typename LOAD_Y, typename LOAD_DY, typename STORE>
+void SoftmaxGradRows(const LOAD_Y& load_y, const LOAD_DY& load_dy, const STORE& store,
+                     int64_t row_begin, int64_t row_end, int64_t cols) {
+  const int64_t buf_size = std::min(cols, kTileSize);
+  std::vector<T> y_buf(buf_size);
+  std::vector<T> dy_buf(buf_size);
+  std::vector<T> exp_buf(algorithm == Algorithm::kLogSoftmax ? buf_size : 0);
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    T sum = 0;
+    for (int64_t col = 0; col < cols; col += kTileSize) {
+      const int64_t n = std::min(kTileSize, cols - col);
+      const T* dy = load_dy.load(dy_buf.data(), row, col, n);
+      if (algorithm == Algorithm::kSoftmax) {
+        sum += TileDot(load_y.load(y_buf.data(), row, col, n), dy, n);
+      } else if (algorithm == Algorithm::kLogSoftmax) {
+        sum += TileSum(dy, n);
+      } else {
+        UNIMPLEMENTED();
+      }
+    }
+    for (int64_t col = 0; col < cols; col += kTileSize) {
+      const int64_t n = std::min(kTileSize, cols - col);
+      const T* y = load_y.load(y_buf.data(), row, col, n);
+      const T* dy = load_dy.load(dy_buf.data(), row, col, n);
+      T* dx = store.ptr(row, col);
+      if (algorithm == Algorithm::kSoftmax) {
+        for (int64_t i = 0; i < n; ++i) { dx[i] = (dy[i] - sum) * y[i]; }
+      } else if (algorithm == Algorithm::kLogSoftmax) {
+        TileExp(y, T(0), exp_buf.data(), n);
+        for (int64_t i = 0; i < n; ++i) { dx[i] = dy[i] - exp_buf[i] * sum; }
+      } else {
+        UNIMPLEMENTED();
+      }
+      store.store(row, col, n);
+    }
+  }
+}
+
+template<Algorithm algorithm, typename T, typename LOAD_Y, typename LOAD_DY, typename STORE>
+void DispatchSoftmaxGrad(CpuStream* stream, const LOAD_Y& load_y, const LOAD_DY& load_dy,
+                         const STORE& store, int64_t rows, int64_t cols) {
+  if (rows == 0 || cols == 0) { return; }
+  const int64_t grain = std::max<int64_t>(32768 / cols, 1);
+  stream->ParallelFor(
+      0, rows,
+      [&](int64_t begin, int64_t end) {
+        SoftmaxGradRows<algorithm, T>(load_y, load_dy, store, begin, end, cols);
+      },
+      grain);
+}
+
+}  // namespace cpu_softmax
+
+}  // namespace ep
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EP_CPU_CPU_SOFTMAX_H_
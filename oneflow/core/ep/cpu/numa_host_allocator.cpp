@@ -0,0 +1,269 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif  // MAP_HUGE_SHIFT
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif  // MADV_POPULATE_WRITE
+
+namespace oneflow {
+
+namespace ep {
+
+namespace {
+
+constexpr size_t kTransparentHugePageSize = 2 * 1024 * 1024;
+// From linux/mempolicy.h, which is not always installed.
+constexpr int kMpolPreferred = 1;
+
+size_t GetNumNumaNodes() {
+  // e.g. "0-1" or "0".
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string nodes;
+  if (!(online >> nodes)) { return 1; }
+  const size_t dash = nodes.rfind('-');
+  const std::string last = dash == std::string::npos ? nodes : nodes.substr(dash + 1);
+  return std::max<size_t>(std::strtoul(last.c_str(), nullptr, 10) + 1, 1);
+}
+
+size_t GetHugeTlbPageSize() {
+  const std::string page_size = GetStringFromEnv("ONEFLOW_CPU_HUGETLB_PAGE_SIZE", "");
+  if (page_size.empty()) { return 0; }
+  if (page_size == "2M") { return 2 * 1024 * 1024; }
+  if (page_size == "1G") { return 1024 * 1024 * 1024; }
+  LOG(WARNING) << "ignoring ONEFLOW_CPU_HUGETLB_PAGE_SIZE=" << page_size
+               << ", expected 2M or 1G";
+  return 0;
+}
+
+}  // namespace
+
+NumaHostAllocator::NumaHostAllocator()
+    : num_numa_nodes_(GetNumNumaNodes()),
+      large_block_bytes_(ParseIntegerFromEnv("ONEFLOW_CPU_LARGE_BLOCK_BYTES", 2 * 1024 * 1024)),
+      hugetlb_page_size_(GetHugeTlbPageSize()),
+      prefault_large_blocks_(ParseBooleanFromEnv("ONEFLOW_CPU_PREFAULT_LARGE_BLOCKS", true)),
+      large_block_cache_bytes_(
+          ParseIntegerFromEnv("ONEFLOW_CPU_LARGE_BLOCK_CACHE_BYTES", 1024 * 1024 * 1024)),
+      node2cached_blocks_(num_numa_nodes_),
+      cached_bytes_(0),
+      node2stats_(num_numa_nodes_, NumaHostAllocatorStats{}) {}
+
+/* static */ NumaHostAllocator* NumaHostAllocator::Get() {
+  // Never destructed: host memory may be freed by static destructors of other modules.
+  static NumaHostAllocator* allocator = new NumaHostAllocator();
+  return allocator;
+}
+
+/* static */ int32_t NumaHostAllocator::CurrentNumaNode() {
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) { return 0; }
+  return static_cast<int32_t>(node);
+}
+
+void* NumaHostAllocator::Allocate(size_t size, size_t alignment, int32_t numa_node) {
+  if (size < large_block_bytes_) { return aligned_alloc(alignment, size); }
+  if (numa_node < 0) { numa_node = CurrentNumaNode(); }
+  return AllocateLargeBlock(
+      size, std::min<int32_t>(numa_node, static_cast<int32_t>(num_numa_nodes_) - 1));
+}
+
+void NumaHostAllocator::Deallocate(void* ptr) {
+  if (ptr == nullptr) { return; }
+  // Large blocks all start on a huge page boundary, which spares most small blocks the lookup.
+  if (reinterpret_cast<uintptr_t>(ptr) % kTransparentHugePageSize != 0) {
+    free(ptr);  // NOLINT
+    return;
+  }
+  LargeBlock block{};
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = ptr2large_block_.find(ptr);
+    if (iter == ptr2large_block_.end()) {
+      lock.unlock();
+      free(ptr);  // NOLINT
+      return;
+    }
+    block = iter->second;
+    ptr2large_block_.erase(iter);
+    auto* stats = &node2stats_.at(block.numa_node);
+    stats->large_block_cnt -= 1;
+    stats->large_block_bytes -= block.mapped_size;
+    if (block.hugetlb) { stats->hugetlb_bytes -= block.mapped_size; }
+    if (CacheBlock(ptr, block)) { return; }
+  }
+  PCHECK(munmap(ptr, block.mapped_size) == 0);
+}
+
+std::vector<NumaHostAllocatorStats> NumaHostAllocator::GetStats() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return node2stats_;
+}
+
+size_t NumaHostAllocator::EmptyCache() {
+  std::vector<std::pair<void*, size_t>> blocks;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& size2cached_blocks : node2cached_blocks_) {
+      for (auto& pair : size2cached_blocks) {
+        for (const auto& cached : pair.second) {
+          blocks.emplace_back(cached.first, cached.second.mapped_size);
+        }
+      }
+      size2cached_blocks.clear();
+    }
+    for (auto& stats : node2stats_) {
+      stats.cached_block_cnt = 0;
+      stats.cached_block_bytes = 0;
+    }
+    cached_bytes_ = 0;
+  }
+  size_t released_bytes = 0;
+  for (const auto& block : blocks) {
+    PCHECK(munmap(block.first, block.second) == 0);
+    released_bytes += block.second;
+  }
+  return released_bytes;
+}
+
+void* NumaHostAllocator::AllocateLargeBlock(size_t size, int32_t numa_node) {
+  void* cached = TakeCachedBlock(size, numa_node);
+  if (cached != nullptr) { return cached; }
+  size_t mapped_size = 0;
+  bool hugetlb = false;
+  void* ptr = nullptr;
+  if (hugetlb_page_size_ > 0) {
+    ptr = MapHugeTlb(size, &mapped_size);
+    hugetlb = (ptr != nullptr);
+  }
+  if (ptr == nullptr) { ptr = MapTransparentHugePages(size, &mapped_size); }
+  if (ptr == nullptr && EmptyCache() > 0) {
+    // Cached blocks of other sizes may be what is holding the memory.
+    ptr = MapTransparentHugePages(size, &mapped_size);
+  }
+  if (ptr == nullptr) { return nullptr; }
+  // Must precede the first touch, which is where pages get placed.
+  BindToNumaNode(ptr, mapped_size, numa_node);
+  if (prefault_large_blocks_) { Prefault(static_cast<char*>(ptr), mapped_size); }
+  std::unique_lock<std::mutex> lock(mutex_);
+  ptr2large_block_[ptr] = LargeBlock{mapped_size, numa_node, hugetlb};
+  auto* stats = &node2stats_.at(numa_node);
+  stats->large_block_cnt += 1;
+  stats->large_block_bytes += mapped_size;
+  if (hugetlb) { stats->hugetlb_bytes += mapped_size; }
+  return ptr;
+}
+
+void* NumaHostAllocator::TakeCachedBlock(size_t size, int32_t numa_node) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (cached_bytes_ == 0) { return nullptr; }
+  auto* size2cached_blocks = &node2cached_blocks_.at(numa_node);
+  for (const size_t page_size : {hugetlb_page_size_, kTransparentHugePageSize}) {
+    if (page_size == 0) { continue; }
+    auto iter = size2cached_blocks->find(RoundUp(size, page_size));
+    if (iter == size2cached_blocks->end() || iter->second.empty()) { continue; }
+    void* ptr = iter->second.back().first;
+    const LargeBlock block = iter->second.back().second;
+    iter->second.pop_back();
+    cached_bytes_ -= block.mapped_size;
+    ptr2large_block_[ptr] = block;
+    auto* stats = &node2stats_.at(numa_node);
+    stats->cached_block_cnt -= 1;
+    stats->cached_block_bytes -= block.mapped_size;
+    stats->large_block_cnt += 1;
+    stats->large_block_bytes += block.mapped_size;
+    if (block.hugetlb) { stats->hugetlb_bytes += block.mapped_size; }
+    return ptr;
+  }
+  return nullptr;
+}
+
+bool NumaHostAllocator::CacheBlock(void* ptr, const LargeBlock& block) {
+  if (cached_bytes_ + block.mapped_size > large_block_cache_bytes_) { return false; }
+  node2cached_blocks_.at(block.numa_node)[block.mapped_size].emplace_back(ptr, block);
+  cached_bytes_ += block.mapped_size;
+  auto* stats = &node2stats_.at(block.numa_node);
+  stats->cached_block_cnt += 1;
+  stats->cached_block_bytes += block.mapped_size;
+  return true;
+}
+
+void* NumaHostAllocator::MapHugeTlb(size_t size, size_t* mapped_size) const {
+  const int page_shift = (hugetlb_page_size_ == 1024 * 1024 * 1024) ? 30 : 21;
+  *mapped_size = RoundUp(size, hugetlb_page_size_);
+  void* ptr = mmap(nullptr, *mapped_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT), -1,
+                   0);
+  // The hugetlb pool is sized by the administrator and may be exhausted.
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+void* NumaHostAllocator::MapTransparentHugePages(size_t size, size_t* mapped_size) const {
+  *mapped_size = RoundUp(size, kTransparentHugePageSize);
+  // Over-map so that the block can start on a huge page boundary, then trim both ends.
+  const size_t padded_size = *mapped_size + kTransparentHugePageSize;
+  void* padded = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1, 0);
+  if (padded == MAP_FAILED) { return nullptr; }
+  char* begin = static_cast<char*>(padded);
+  char* ptr = reinterpret_cast<char*>(
+      RoundUp(reinterpret_cast<uintptr_t>(begin), kTransparentHugePageSize));
+  const size_t head = ptr - begin;
+  const size_t tail = padded_size - head - *mapped_size;
+  if (head > 0) { PCHECK(munmap(begin, head) == 0); }
+  if (tail > 0) { PCHECK(munmap(ptr + *mapped_size, tail) == 0); }
+  // Only a hint: THP may be disabled system wide.
+  madvise(ptr, *mapped_size, MADV_HUGEPAGE);
+  return ptr;
+}
+
+void NumaHostAllocator::BindToNumaNode(void* ptr, size_t size, int32_t numa_node) const {
+  if (num_numa_nodes_ <= 1) { return; }
+  constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> node_mask(num_numa_nodes_ / kBitsPerMask + 1, 0);
+  node_mask.at(numa_node / kBitsPerMask) |= 1UL << (numa_node % kBitsPerMask);
+  // Preferred rather than bound, so that a full node spills over instead of failing.
+  if (syscall(SYS_mbind, ptr, size, kMpolPreferred, node_mask.data(),
+              node_mask.size() * kBitsPerMask, 0)
+      != 0) {
+    PLOG(WARNING) << "mbind to numa node " << numa_node << " failed";
+  }
+}
+
+void NumaHostAllocator::Prefault(char* ptr, size_t size) const {
+  // On the calling thread: blocks are also allocated from inside thread pool work items, e.g. by
+  // TensorBuffer::Resize in the image decoders, so the allocator must never wait on the pool.
+  // Linux 5.14+ faults the whole range in with one call.
+  if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) { return; }
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    *static_cast<volatile char*>(ptr + offset) = 0;
+  }
+}
+
+}  // namespace ep
+
+}  // namespace oneflow
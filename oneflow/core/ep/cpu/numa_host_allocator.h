@@ -0,0 +1,105 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EP_CPU_NUMA_HOST_ALLOCATOR_H_
+#define ONEFLOW_CORE_EP_CPU_NUMA_HOST_ALLOCATOR_H_
+
+#include <mutex>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace ep {
+
+struct NumaHostAllocatorStats {
+  // Large blocks handed out and not yet deallocated.
+  size_t large_block_cnt;
+  size_t large_block_bytes;
+  // Part of large_block_bytes backed by explicit huge pages.
+  size_t hugetlb_bytes;
+  // Deallocated large blocks kept mapped for reuse.
+  size_t cached_block_cnt;
+  size_t cached_block_bytes;
+};
+
+// Host memory allocator behind CpuDevice, the eager cpu allocator and unpinned host buffers.
+//
+// Blocks smaller than ONEFLOW_CPU_LARGE_BLOCK_BYTES (default 2MB) come from aligned_alloc. Larger
+// ones are mmap'd on their own and bound to a NUMA node, which is the node the calling thread runs
+// on unless one is given, so blocks allocated by a stream's worker thread follow its affinity.
+// Large blocks are backed by explicit huge pages when ONEFLOW_CPU_HUGETLB_PAGE_SIZE is "2M" or
+// "1G" and the hugetlb pool has room, and advised for transparent huge pages otherwise. Unless
+// ONEFLOW_CPU_PREFAULT_LARGE_BLOCKS is false new mappings are also faulted in by the allocating
+// thread, instead of page by page by whichever kernel touches them first.
+//
+// Deallocated large blocks are cached per node and mapped size, up to
+// ONEFLOW_CPU_LARGE_BLOCK_CACHE_BYTES (default 1GB) in total, so that tensors reallocated every
+// iteration pay for mmap, mbind and the page faults only once. The cache is emptied by
+// EmptyCache, and before a new mapping that fails is retried.
+class NumaHostAllocator final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(NumaHostAllocator);
+  ~NumaHostAllocator() = default;
+
+  static NumaHostAllocator* Get();
+
+  // `numa_node` < 0 means the node of the calling thread. Returns nullptr on failure.
+  void* Allocate(size_t size, size_t alignment, int32_t numa_node);
+  void Deallocate(void* ptr);
+
+  size_t NumNumaNodes() const { return num_numa_nodes_; }
+  static int32_t CurrentNumaNode();
+  // Indexed by NUMA node.
+  std::vector<NumaHostAllocatorStats> GetStats() const;
+  // Unmaps every cached block. Returns the number of bytes released.
+  size_t EmptyCache();
+
+ private:
+  struct LargeBlock {
+    size_t mapped_size;
+    int32_t numa_node;
+    bool hugetlb;
+  };
+
+  NumaHostAllocator();
+
+  void* AllocateLargeBlock(size_t size, int32_t numa_node);
+  void* TakeCachedBlock(size_t size, int32_t numa_node);
+  // Returns false if the cache is full.
+  bool CacheBlock(void* ptr, const LargeBlock& block);
+  void* MapHugeTlb(size_t size, size_t* mapped_size) const;
+  void* MapTransparentHugePages(size_t size, size_t* mapped_size) const;
+  void BindToNumaNode(void* ptr, size_t size, int32_t numa_node) const;
+  void Prefault(char* ptr, size_t size) const;
+
+  const size_t num_numa_nodes_;
+  const size_t large_block_bytes_;
+  const size_t hugetlb_page_size_;
+  const bool prefault_large_blocks_;
+  const size_t large_block_cache_bytes_;
+  mutable std::mutex mutex_;
+  // Handed out blocks only.
+  HashMap<void*, LargeBlock> ptr2large_block_;
+  // Indexed by NUMA node, then keyed by mapped size.
+  std::vector<HashMap<size_t, std::vector<std::pair<void*, LargeBlock>>>> node2cached_blocks_;
+  size_t cached_bytes_;
+  std::vector<NumaHostAllocatorStats> node2stats_;
+};
+
+}  // namespace ep
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EP_CPU_NUMA_HOST_ALLOCATOR_H_
@@ -0,0 +1,98 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstring>
+#include "gtest/gtest.h"
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
+
+namespace oneflow {
+
+namespace ep {
+
+namespace test {
+
+TEST(NumaHostAllocator, small_and_large_blocks) {
+  NumaHostAllocator* allocator = NumaHostAllocator::Get();
+  const int32_t numa_node = NumaHostAllocator::CurrentNumaNode();
+  ASSERT_GE(numa_node, 0);
+  ASSERT_LT(numa_node, static_cast<int32_t>(allocator->NumNumaNodes()));
+  const NumaHostAllocatorStats before = allocator->GetStats().at(numa_node);
+
+  char* small = static_cast<char*>(allocator->Allocate(4096, kHostAlignSize, numa_node));
+  ASSERT_TRUE(small != nullptr);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(small) % kHostAlignSize, 0);
+  std::memset(small, 1, 4096);
+
+  const size_t large_size = 64 * 1024 * 1024 + 3;
+  char* large = static_cast<char*>(allocator->Allocate(large_size, kHostAlignSize, numa_node));
+  ASSERT_TRUE(large != nullptr);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(large) % (2 * 1024 * 1024), 0);
+  // Anonymous mappings start zeroed and prefaulting must not change that.
+  ASSERT_EQ(large[0], 0);
+  ASSERT_EQ(large[large_size - 1], 0);
+  std::memset(large, 2, large_size);
+
+  const NumaHostAllocatorStats during = allocator->GetStats().at(numa_node);
+  ASSERT_EQ(during.large_block_cnt, before.large_block_cnt + 1);
+  ASSERT_GE(during.large_block_bytes, before.large_block_bytes + large_size);
+
+  allocator->Deallocate(small);
+  allocator->Deallocate(large);
+  const NumaHostAllocatorStats after = allocator->GetStats().at(numa_node);
+  ASSERT_EQ(after.large_block_cnt, before.large_block_cnt);
+  ASSERT_EQ(after.large_block_bytes, before.large_block_bytes);
+}
+
+TEST(NumaHostAllocator, reuse_cached_large_blocks) {
+  NumaHostAllocator* allocator = NumaHostAllocator::Get();
+  const int32_t numa_node = NumaHostAllocator::CurrentNumaNode();
+  const size_t large_size = 8 * 1024 * 1024;
+  char* large = static_cast<char*>(allocator->Allocate(large_size, kHostAlignSize, numa_node));
+  ASSERT_TRUE(large != nullptr);
+  std::memset(large, 3, large_size);
+  allocator->Deallocate(large);
+  const NumaHostAllocatorStats cached = allocator->GetStats().at(numa_node);
+  ASSERT_GE(cached.cached_block_cnt, 1);
+  ASSERT_GE(cached.cached_block_bytes, large_size);
+
+  // The block comes back as it was left, without being mapped again.
+  char* reused = static_cast<char*>(allocator->Allocate(large_size, kHostAlignSize, numa_node));
+  ASSERT_EQ(reused, large);
+  ASSERT_EQ(reused[large_size - 1], 3);
+  const NumaHostAllocatorStats during = allocator->GetStats().at(numa_node);
+  ASSERT_EQ(during.cached_block_cnt, cached.cached_block_cnt - 1);
+  ASSERT_EQ(during.cached_block_bytes, cached.cached_block_bytes - large_size);
+  allocator->Deallocate(reused);
+}
+
+TEST(NumaHostAllocator, empty_cache) {
+  NumaHostAllocator* allocator = NumaHostAllocator::Get();
+  const int32_t numa_node = NumaHostAllocator::CurrentNumaNode();
+  const size_t large_size = 8 * 1024 * 1024;
+  void* large = allocator->Allocate(large_size, kHostAlignSize, numa_node);
+  ASSERT_TRUE(large != nullptr);
+  allocator->Deallocate(large);
+  ASSERT_GE(allocator->EmptyCache(), large_size);
+  const NumaHostAllocatorStats after = allocator->GetStats().at(numa_node);
+  ASSERT_EQ(after.cached_block_cnt, 0);
+  ASSERT_EQ(after.cached_block_bytes, 0);
+  ASSERT_EQ(allocator->EmptyCache(), 0);
+}
+
+}  // namespace test
+
+}  // namespace ep
+
+}  // namespace oneflow
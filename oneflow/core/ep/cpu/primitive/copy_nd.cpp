@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/ep/include/primitive/copy_nd.h"
 #include "oneflow/core/ep/common/primitive/copy_nd.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
@@ -23,29 +24,66 @@ namespace primitive {
 
 namespace {
 
+constexpr int64_t kParallelGrain = 32768;
+
+// The last dim of the simplified copy is contiguous on both sides, so the copy is done row by row
+// with one index computation per row instead of one per element.
 template<size_t num_dims, size_t movement_size, typename IndexType>
-void CopyNdKernel(CopyNdKernelParams<num_dims, IndexType> params) {
+void CopyNdKernel(const CopyNdKernelParams<num_dims, IndexType>& params, int64_t row_size,
+                  int64_t row_begin, int64_t row_end, int64_t col_begin, int64_t col_end) {
   using T = typename std::aligned_storage<movement_size, movement_size>::type;
   const T* src = reinterpret_cast<const T*>(params.src);
   T* dst = reinterpret_cast<T*>(params.dst);
-  for (IndexType i = 0; i < params.count; ++i) {
-    IndexType copy_index[num_dims];
-    IndexType src_index[num_dims];
-    IndexType dst_index[num_dims];
-    params.copy_index_helper.OffsetToNdIndex(i, copy_index);
+  IndexType copy_index[num_dims];
+  IndexType src_index[num_dims];
+  IndexType dst_index[num_dims];
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    params.copy_index_helper.OffsetToNdIndex(static_cast<IndexType>(row * row_size + col_begin),
+                                             copy_index);
     for (size_t j = 0; j < num_dims; ++j) {
       src_index[j] = params.src_pos[j] + copy_index[j];
       dst_index[j] = params.dst_pos[j] + copy_index[j];
     }
     const IndexType src_offset = params.src_index_helper.NdIndexToOffset(src_index);
     const IndexType dst_offset = params.dst_index_helper.NdIndexToOffset(dst_index);
-    dst[dst_offset] = src[src_offset];
+    std::memcpy(dst + dst_offset, src + src_offset, (col_end - col_begin) * sizeof(T));
   }
 }
 
 template<size_t num_dims, size_t movement_size, typename IndexType>
 void LaunchKernel(Stream* stream, CopyNdKernelParams<num_dims, IndexType> params) {
-  CopyNdKernel<num_dims, movement_size, IndexType>(params);
+  if (params.count == 0) { return; }
+  CpuStream* cpu_stream = stream->As<CpuStream>();
+  // The index of the last element holds extent - 1 in every dim.
+  IndexType last_index[num_dims];
+  params.copy_index_helper.OffsetToNdIndex(params.count - 1, last_index);
+  const int64_t row_size = static_cast<int64_t>(last_index[num_dims - 1]) + 1;
+  const int64_t num_rows = params.count / row_size;
+  if (row_size < kParallelGrain) {
+    cpu_stream->ParallelFor(
+        0, num_rows,
+        [&](int64_t begin, int64_t end) {
+          CopyNdKernel<num_dims, movement_size, IndexType>(params, row_size, begin, end, 0,
+                                                           row_size);
+        },
+        kParallelGrain / row_size);
+  } else {
+    // Long rows are cut into chunks, so that a few large rows still spread over the threads.
+    const int64_t num_chunks_per_row = (row_size + kParallelGrain - 1) / kParallelGrain;
+    const int64_t chunk_size = (row_size + num_chunks_per_row - 1) / num_chunks_per_row;
+    cpu_stream->ParallelFor(
+        0, num_rows * num_chunks_per_row,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const int64_t row = i / num_chunks_per_row;
+            const int64_t col_begin = i % num_chunks_per_row * chunk_size;
+            CopyNdKernel<num_dims, movement_size, IndexType>(
+                params, row_size, row, row + 1, col_begin,
+                std::min(col_begin + chunk_size, row_size));
+          }
+        },
+        1);
+  }
 }
 
 class CopyNdImpl : public CopyNd {
@@ -18,6 +18,10 @@ limitations under the License.
 #include "oneflow/core/ep/cpu/cpu_stream.h"
 #include "oneflow/core/ep/cpu/cpu_device.h"
 #include "oneflow/core/ep/common/onednn.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif  // __SSE2__
 
 namespace oneflow {
 
@@ -30,12 +34,77 @@ namespace internal {
 
 namespace {
 
+constexpr int64_t kTileSize = 16;
+constexpr int64_t kParallelGrain = 32768;
+
+template<size_t movement_size>
+using Movement = typename std::aligned_storage<movement_size, movement_size>::type;
+
+// dst[r * dst_stride + c] = src[c * src_stride + r] for a full kTileSize x kTileSize tile.
+template<size_t movement_size>
+struct TileTranspose {
+  using T = Movement<movement_size>;
+  static void Apply(const T* src, int64_t src_stride, T* dst, int64_t dst_stride) {
+    for (int64_t r = 0; r < kTileSize; ++r) {
+      for (int64_t c = 0; c < kTileSize; ++c) { dst[r * dst_stride + c] = src[c * src_stride + r]; }
+    }
+  }
+};
+
+#ifdef __SSE2__
+// 4x4 register transposes of 4-byte elements.
+template<>
+struct TileTranspose<4> {
+  using T = Movement<4>;
+  static void Apply(const T* src, int64_t src_stride, T* dst, int64_t dst_stride) {
+    const float* src_ptr = reinterpret_cast<const float*>(src);
+    float* dst_ptr = reinterpret_cast<float*>(dst);
+    for (int64_t c = 0; c < kTileSize; c += 4) {
+      for (int64_t r = 0; r < kTileSize; r += 4) {
+        const float* from = src_ptr + c * src_stride + r;
+        __m128 row0 = _mm_loadu_ps(from);
+        __m128 row1 = _mm_loadu_ps(from + src_stride);
+        __m128 row2 = _mm_loadu_ps(from + 2 * src_stride);
+        __m128 row3 = _mm_loadu_ps(from + 3 * src_stride);
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        float* to = dst_ptr + r * dst_stride + c;
+        _mm_storeu_ps(to, row0);
+        _mm_storeu_ps(to + dst_stride, row1);
+        _mm_storeu_ps(to + 2 * dst_stride, row2);
+        _mm_storeu_ps(to + 3 * dst_stride, row3);
+      }
+    }
+  }
+};
+
+// 2x2 register transposes of 8-byte elements.
+template<>
+struct TileTranspose<8> {
+  using T = Movement<8>;
+  static void Apply(const T* src, int64_t src_stride, T* dst, int64_t dst_stride) {
+    const double* src_ptr = reinterpret_cast<const double*>(src);
+    double* dst_ptr = reinterpret_cast<double*>(dst);
+    for (int64_t c = 0; c < kTileSize; c += 2) {
+      for (int64_t r = 0; r < kTileSize; r += 2) {
+        const double* from = src_ptr + c * src_stride + r;
+        const __m128d row0 = _mm_loadu_pd(from);
+        const __m128d row1 = _mm_loadu_pd(from + src_stride);
+        double* to = dst_ptr + r * dst_stride + c;
+        _mm_storeu_pd(to, _mm_unpacklo_pd(row0, row1));
+        _mm_storeu_pd(to + dst_stride, _mm_unpackhi_pd(row0, row1));
+      }
+    }
+  }
+};
+#endif  // __SSE2__
+
 template<size_t num_dims, size_t movement_size, typename IndexType>
-void PermuteKernel(PermuteKernelParams<num_dims, IndexType> params) {
-  using T = typename std::aligned_storage<movement_size, movement_size>::type;
+void PermuteKernel(PermuteKernelParams<num_dims, IndexType> params, IndexType begin,
+                   IndexType end) {
+  using T = Movement<movement_size>;
   const T* src = reinterpret_cast<const T*>(params.src);
   T* dst = reinterpret_cast<T*>(params.dst);
-  for (IndexType i = 0; i < params.count; ++i) {
+  for (IndexType i = begin; i < end; ++i) {
     IndexType src_index[num_dims];
     IndexType dst_index[num_dims];
     params.dst_index_helper.OffsetToNdIndex(i, dst_index);
@@ -47,13 +116,142 @@ void PermuteKernel(PermuteKernelParams<num_dims, IndexType> params) {
   }
 }
 
+// The last dim is kept, so every dst row is a contiguous run of src.
+template<size_t num_dims, size_t movement_size, typename IndexType>
+void PermuteRows(CpuStream* cpu_stream, PermuteKernelParams<num_dims, IndexType> params,
+                 int64_t row_size) {
+  using T = Movement<movement_size>;
+  const T* src = reinterpret_cast<const T*>(params.src);
+  T* dst = reinterpret_cast<T*>(params.dst);
+  const int64_t num_rows = params.count / row_size;
+  cpu_stream->ParallelFor(
+      0, num_rows,
+      [&](int64_t begin, int64_t end) {
+        IndexType src_index[num_dims];
+        IndexType dst_index[num_dims];
+        for (int64_t row = begin; row < end; ++row) {
+          params.dst_index_helper.OffsetToNdIndex(static_cast<IndexType>(row * row_size),
+                                                  dst_index);
+          for (size_t dim = 0; dim < num_dims; ++dim) {
+            src_index[params.permutation[dim]] = dst_index[dim];
+          }
+          const IndexType src_offset = params.src_index_helper.NdIndexToOffset(src_index);
+          std::memcpy(dst + row * row_size, src + src_offset, row_size * sizeof(T));
+        }
+      },
+      std::max<int64_t>(kParallelGrain / row_size, 1));
+}
+
+// The last dim moves. Let `rows` be the dst dim that is the src last dim and `cols` the dst last
+// dim, so src is contiguous along rows and dst along cols. Every (rows, cols) plane is cut into
+// kTileSize x kTileSize tiles, which are small enough to keep both sides in cache, and the tiles
+// of all planes are spread over the threads.
+template<size_t num_dims, size_t movement_size>
+void PermuteTiles(CpuStream* cpu_stream, const int64_t* src_dims, const void* src_ptr,
+                  const int* permutation, void* dst_ptr) {
+  using T = Movement<movement_size>;
+  const T* src = reinterpret_cast<const T*>(src_ptr);
+  T* dst = reinterpret_cast<T*>(dst_ptr);
+  int64_t src_strides[num_dims];
+  int64_t dst_dims[num_dims];
+  int64_t dst_strides[num_dims];
+  src_strides[num_dims - 1] = 1;
+  dst_strides[num_dims - 1] = 1;
+  for (size_t i = 0; i < num_dims; ++i) { dst_dims[i] = src_dims[permutation[i]]; }
+  for (int64_t i = static_cast<int64_t>(num_dims) - 2; i >= 0; --i) {
+    src_strides[i] = src_strides[i + 1] * src_dims[i + 1];
+    dst_strides[i] = dst_strides[i + 1] * dst_dims[i + 1];
+  }
+  size_t rows_dim = 0;
+  while (permutation[rows_dim] != static_cast<int>(num_dims) - 1) { ++rows_dim; }
+  const int64_t rows = dst_dims[rows_dim];
+  const int64_t cols = dst_dims[num_dims - 1];
+  const int64_t src_col_stride = src_strides[permutation[num_dims - 1]];
+  const int64_t dst_row_stride = dst_strides[rows_dim];
+  // The remaining dst dims index the planes.
+  int64_t plane_dims[num_dims];
+  int64_t plane_src_strides[num_dims];
+  int64_t plane_dst_strides[num_dims];
+  size_t num_plane_dims = 0;
+  int64_t num_planes = 1;
+  for (size_t i = 0; i + 1 < num_dims; ++i) {
+    if (i == rows_dim) { continue; }
+    plane_dims[num_plane_dims] = dst_dims[i];
+    plane_src_strides[num_plane_dims] = src_strides[permutation[i]];
+    plane_dst_strides[num_plane_dims] = dst_strides[i];
+    num_plane_dims += 1;
+    num_planes *= dst_dims[i];
+  }
+  const int64_t num_row_tiles = (rows + kTileSize - 1) / kTileSize;
+  const int64_t num_col_tiles = (cols + kTileSize - 1) / kTileSize;
+  const int64_t num_tiles_per_plane = num_row_tiles * num_col_tiles;
+  cpu_stream->ParallelFor(
+      0, num_planes * num_tiles_per_plane,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t tile = begin; tile < end; ++tile) {
+          int64_t plane = tile / num_tiles_per_plane;
+          const int64_t tile_in_plane = tile - plane * num_tiles_per_plane;
+          const int64_t row_begin = tile_in_plane / num_col_tiles * kTileSize;
+          const int64_t col_begin = tile_in_plane % num_col_tiles * kTileSize;
+          int64_t src_offset = row_begin + col_begin * src_col_stride;
+          int64_t dst_offset = row_begin * dst_row_stride + col_begin;
+          for (int64_t i = static_cast<int64_t>(num_plane_dims) - 1; i >= 0; --i) {
+            const int64_t index = plane % plane_dims[i];
+            plane /= plane_dims[i];
+            src_offset += index * plane_src_strides[i];
+            dst_offset += index * plane_dst_strides[i];
+          }
+          const int64_t tile_rows = std::min(kTileSize, rows - row_begin);
+          const int64_t tile_cols = std::min(kTileSize, cols - col_begin);
+          if (tile_rows == kTileSize && tile_cols == kTileSize) {
+            TileTranspose<movement_size>::Apply(src + src_offset, src_col_stride, dst + dst_offset,
+                                                dst_row_stride);
+          } else {
+            for (int64_t r = 0; r < tile_rows; ++r) {
+              for (int64_t c = 0; c < tile_cols; ++c) {
+                dst[dst_offset + r * dst_row_stride + c] = src[src_offset + c * src_col_stride + r];
+              }
+            }
+          }
+        }
+      },
+      std::max<int64_t>(kParallelGrain / (kTileSize * kTileSize), 1));
+}
+
 template<size_t num_dims, size_t movement_size, typename IndexType>
 void LaunchKernel(Stream* stream, const int64_t* src_dims, const void* src, const int* permutation,
                   void* dst, size_t count) {
+  // Empty tensors would divide by a zero row size below.
+  if (count == 0) { return; }
   PermuteKernelParams<num_dims, IndexType> params =
       MakePermuteParams<num_dims, IndexType>(src_dims, src, permutation, dst, count);
-  PermuteKernel<num_dims, movement_size, IndexType>(params);
+  using T = Movement<movement_size>;
+  CpuStream* cpu_stream = stream->As<CpuStream>();
+  // Blocked paths for the 2-D, 3-D and 4-D permutations that remain after simplification, the
+  // per-element index arithmetic for everything else.
+  if (num_dims == 1) {
+    // A plain copy, split into chunks.
+    const T* src_ptr = reinterpret_cast<const T*>(src);
+    T* dst_ptr = reinterpret_cast<T*>(dst);
+    cpu_stream->ParallelFor(0, params.count, [&](int64_t begin, int64_t end) {
+      std::memcpy(dst_ptr + begin, src_ptr + begin, (end - begin) * sizeof(T));
+    });
+    return;
+  }
+  if (num_dims <= 4) {
+    if (permutation[num_dims - 1] == static_cast<int>(num_dims) - 1) {
+      PermuteRows<num_dims, movement_size, IndexType>(cpu_stream, params, src_dims[num_dims - 1]);
+    } else {
+      PermuteTiles<num_dims, movement_size>(cpu_stream, src_dims, src, permutation, dst);
+    }
+    return;
+  }
+  cpu_stream->ParallelFor(0, params.count, [&](int64_t begin, int64_t end) {
+    PermuteKernel<num_dims, movement_size, IndexType>(params, static_cast<IndexType>(begin),
+                                                      static_cast<IndexType>(end));
+  });
 }
+
 class PermuteImpl : public Permute {
  public:
   OF_DISALLOW_COPY_AND_MOVE(PermuteImpl);
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/ep/cpu/primitive/type_seq.h"
 #include "oneflow/core/ep/cpu/cpu_stream.h"
 #include "oneflow/core/ep/cpu/cpu_device.h"
+#include "oneflow/core/ep/cpu/cpu_softmax.h"
 #include "oneflow/core/ep/common/primitive/util.h"
 #include "oneflow/core/ep/common/onednn.h"
 
@@ -28,42 +29,7 @@ namespace primitive {
 
 namespace {
 
-enum class Algorithm {
-  kSoftmax,
-  kLogSoftmax,
-};
-
-template<Algorithm algorithm, typename T>
-void SoftmaxCpu(size_t rows, size_t cols, const T* x, T* y) {
-  for (size_t i = 0; i < rows; ++i) {
-    size_t row_offset = i * cols;
-    const T* row_x = x + row_offset;
-    T* row_y = y + row_offset;
-    const T row_max = *std::max_element(row_x, row_x + cols);
-    T row_sum = 0;
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        T exp_x = std::exp(row_x[j] - row_max);
-        row_sum += exp_x;
-        row_y[j] = exp_x;
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_y[j] = row_x[j] - row_max;
-        row_sum += std::exp(row_y[j]);
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_y[j] /= row_sum;
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_y[j] -= std::log(row_sum);
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
-  }
-}
+using cpu_softmax::Algorithm;
 
 template<typename SoftmaxBase, Algorithm algorithm, typename T>
 class SoftmaxImpl : public SoftmaxBase {
@@ -73,7 +39,9 @@ class SoftmaxImpl : public SoftmaxBase {
   ~SoftmaxImpl() override = default;
 
   void Launch(Stream* stream, size_t rows, size_t cols, const void* x, void* y) override {
-    SoftmaxCpu<algorithm, T>(rows, cols, reinterpret_cast<const T*>(x), reinterpret_cast<T*>(y));
+    cpu_softmax::DispatchSoftmax<algorithm, T>(
+        stream->As<CpuStream>(), cpu_softmax::DirectLoad<T>(reinterpret_cast<const T*>(x), cols),
+        cpu_softmax::DirectStore<T>(reinterpret_cast<T*>(y), cols), rows, cols);
   }
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/ep/include/primitive/softmax_backward.h"
 #include "oneflow/core/ep/include/primitive/log_softmax_backward.h"
 #include "oneflow/core/ep/cpu/primitive/type_seq.h"
+#include "oneflow/core/ep/cpu/cpu_softmax.h"
 
 namespace oneflow {
 
@@ -24,39 +25,7 @@ namespace primitive {
 
 namespace {
 
-enum class Algorithm {
-  kSoftmax,
-  kLogSoftmax,
-};
-
-template<Algorithm algorithm, typename T>
-void SoftmaxBackwardCpu(size_t rows, size_t cols, const T* y, const T* dy, T* dx) {
-  for (size_t i = 0; i < rows; ++i) {
-    size_t row_offset = i * cols;
-    const T* row_y = y + row_offset;
-    const T* row_dy = dy + row_offset;
-    T* row_dx = dx + row_offset;
-    T row_sum = 0;
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_sum += row_y[j] * row_dy[j];
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_sum += row_dy[j];
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_dx[j] = (row_dy[j] - row_sum) * row_y[j];
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_dx[j] = row_dy[j] - std::exp(row_y[j]) * row_sum;
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
-  }
-}
+using cpu_softmax::Algorithm;
 
 template<typename SoftmaxBackwardBase, Algorithm algorithm, typename T>
 class SoftmaxBackwardImpl : public SoftmaxBackwardBase {
@@ -67,8 +36,10 @@ class SoftmaxBackwardImpl : public SoftmaxBackwardBase {
 
   void Launch(Stream* stream, size_t rows, size_t cols, const void* y, const void* dy,
               void* dx) override {
-    SoftmaxBackwardCpu<algorithm, T>(rows, cols, reinterpret_cast<const T*>(y),
-                                     reinterpret_cast<const T*>(dy), reinterpret_cast<T*>(dx));
+    cpu_softmax::DispatchSoftmaxGrad<algorithm, T>(
+        stream->As<CpuStream>(), cpu_softmax::DirectLoad<T>(reinterpret_cast<const T*>(y), cols),
+        cpu_softmax::DirectLoad<T>(reinterpret_cast<const T*>(dy), cols),
+        cpu_softmax::DirectStore<T>(reinterpret_cast<T*>(dx), cols), rows, cols);
   }
 };
 
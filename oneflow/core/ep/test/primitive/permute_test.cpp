@@ -162,6 +162,27 @@ TEST_F(PrimitiveTest, TestPermute) {
       &device_manager_registry_, available_device_types_, dims4, permutation_list4);
 }
 
+TEST_F(PrimitiveTest, TestPermuteMultipleTiles) {
+  const int permutation_2d[2] = {1, 0};
+  const int permutation_3d0[3] = {0, 2, 1};
+  const int permutation_3d1[3] = {2, 1, 0};
+  const int32_t dims_2d0[2] = {37, 70};
+  const int32_t dims_2d1[2] = {64, 48};
+  const int32_t dims_3d0[3] = {3, 40, 33};
+  const int32_t dims_3d1[3] = {17, 5, 32};
+
+  TestPermute2D<float, DataType::kFloat, 2>(&device_manager_registry_, available_device_types_,
+                                            dims_2d0, permutation_2d);
+  TestPermute2D<double, DataType::kDouble, 2>(&device_manager_registry_, available_device_types_,
+                                              dims_2d1, permutation_2d);
+  TestPermute2D<Eigen::half, DataType::kFloat16, 2>(
+      &device_manager_registry_, available_device_types_, dims_2d0, permutation_2d);
+  TestPermute3D<float, DataType::kFloat, 3>(&device_manager_registry_, available_device_types_,
+                                            dims_3d0, permutation_3d0);
+  TestPermute3D<int64_t, DataType::kInt64, 3>(&device_manager_registry_, available_device_types_,
+                                              dims_3d1, permutation_3d1);
+}
+
 }  // namespace test
 
 }  // namespace primitive
@@ -120,6 +120,19 @@ TEST_F(PrimitiveTest, TestSoftmax) {
   }
 }
 
+TEST_F(PrimitiveTest, TestSoftmaxWideRows) {
+  // Fewer rows than threads with wide rows, which the cpu softmax splits into tiles across
+  // threads.
+  std::vector<int> num_rows = {1, 3};
+  std::vector<int> num_cols = {2049, 50000};
+  for (int i = 0; i < num_rows.size(); ++i) {
+    for (int j = 0; j < num_cols.size(); ++j) {
+      TestSoftmax(&device_manager_registry_, available_device_types_, num_rows.at(i),
+                  num_cols.at(j));
+    }
+  }
+}
+
 }  // namespace test
 
 }  // namespace primitive
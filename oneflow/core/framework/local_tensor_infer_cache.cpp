@@ -0,0 +1,125 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
+#include "oneflow/core/framework/tensor_tuple.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/framework/tensor_impl.h"
+#include "oneflow/core/common/stride.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace one {
+
+namespace {
+
+// Ops fed with ever-changing shapes would otherwise grow the cache without bound.
+constexpr size_t kMaxLocalTensorInferCacheSize = 128;
+
+MirroredTensorMeta DetachedTensorMeta(const MirroredTensorMeta& tensor_meta) {
+  MirroredTensorMeta detached(std::make_shared<const Shape>(tensor_meta.shape()),
+                              std::make_shared<const Stride>(tensor_meta.stride()),
+                              tensor_meta.dtype(), tensor_meta.device(),
+                              tensor_meta.storage_offset());
+  detached.set_is_dynamic(tensor_meta.is_dynamic());
+  return detached;
+}
+
+}  // namespace
+
+bool LocalTensorMetaInferArgs::operator==(const LocalTensorMetaInferArgs& other) const {
+  return this->hash_value_ == other.hash_value_ && this->attrs_ == other.attrs_
+         && this->default_device_ == other.default_device_
+         && this->input_tensor_metas_ == other.input_tensor_metas_;
+}
+
+void LocalTensorMetaInferArgs::InitHashValue() {
+  hash_value_ = std::hash<AttrMap>()(attrs_);
+  HashCombine(&hash_value_, std::hash<Symbol<Device>>()(default_device_));
+  for (const auto& tensor_meta : input_tensor_metas_) {
+    HashCombine(&hash_value_, tensor_meta.CalcHashValue());
+  }
+}
+
+LocalTensorMetaInferArgs LocalTensorMetaInferArgs::Detached() const {
+  LocalTensorMetaInferArgs detached;
+  detached.attrs_ = attrs_;
+  detached.default_device_ = default_device_;
+  detached.input_tensor_metas_.reserve(input_tensor_metas_.size());
+  for (const auto& tensor_meta : input_tensor_metas_) {
+    detached.input_tensor_metas_.emplace_back(DetachedTensorMeta(tensor_meta));
+  }
+  detached.hash_value_ = hash_value_;
+  return detached;
+}
+
+/* static */ Maybe<LocalTensorMetaInferArgs> LocalTensorMetaInferArgs::New(
+    const AttrMap& attrs, Symbol<Device> default_device, const TensorTuple& input_tensors) {
+  std::shared_ptr<LocalTensorMetaInferArgs> infer_args(new LocalTensorMetaInferArgs());
+  infer_args->attrs_ = attrs;
+  infer_args->default_device_ = default_device;
+  infer_args->input_tensor_metas_.reserve(input_tensors.size());
+  for (const auto& tensor : input_tensors) {
+    auto* tensor_impl = JUST(tensor->mut_eager_mirrored_tensor_impl());
+    infer_args->input_tensor_metas_.emplace_back(*tensor_impl->tensor_meta());
+  }
+  infer_args->InitHashValue();
+  return infer_args;
+}
+
+std::shared_ptr<const LocalTensorInferResult> LocalTensorInferCache::Find(
+    const LocalTensorMetaInferArgs& infer_args) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto& iter = cache_.find(infer_args);
+  if (iter == cache_.end()) { return nullptr; }
+  return iter->second;
+}
+
+Maybe<const LocalTensorInferResult> LocalTensorInferCache::Insert(
+    const LocalTensorMetaInferArgs& infer_args, const TensorTuple& outputs,
+    Symbol<Stream> stream) {
+  auto result = std::make_shared<LocalTensorInferResult>();
+  result->set_stream(stream);
+  auto* output_tensor_metas = result->mut_output_tensor_metas();
+  output_tensor_metas->reserve(outputs.size());
+  for (const auto& tensor : outputs) {
+    auto* tensor_impl = JUST(tensor->mut_eager_mirrored_tensor_impl());
+    output_tensor_metas->emplace_back(DetachedTensorMeta(*tensor_impl->tensor_meta()));
+  }
+  LocalTensorMetaInferArgs detached_infer_args = infer_args.Detached();
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (cache_.size() >= kMaxLocalTensorInferCacheSize) { cache_.clear(); }
+  cache_.emplace(std::move(detached_infer_args), result);
+  return std::shared_ptr<const LocalTensorInferResult>(result);
+}
+
+/* static */ void LocalTensorInferCache::AssignTensorMeta(const MirroredTensorMeta& src,
+                                                         MirroredTensorMeta* dst) {
+  // Kernels with dynamic outputs reshape their tensors in place, so never share cached shapes.
+  dst->set_shape(std::make_shared<const Shape>(src.shape()));
+  dst->set_stride(std::make_shared<const Stride>(src.stride()));
+  dst->set_dtype(src.dtype());
+  dst->set_is_dynamic(src.is_dynamic());
+  *dst->mut_device() = src.device();
+  dst->set_storage_offset(src.storage_offset());
+}
+
+/* static */ bool LocalTensorInferCache::Enabled() {
+  static const bool enabled = ParseBooleanFromEnv("ONEFLOW_EAGER_ENABLE_LOCAL_INFER_CACHE", true);
+  return enabled;
+}
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,133 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
+#define ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
+
+#include <mutex>
+#include "oneflow/core/common/symbol.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/stream.h"
+#include "oneflow/core/framework/tensor_meta.h"
+
+namespace oneflow {
+namespace one {
+
+class TensorTuple;
+
+// Everything the physical inference of a local user op depends on. Inputs are compared by shape,
+// stride, dtype, device and storage offset, so a cached result is invalidated as soon as any of
+// them changes.
+class LocalTensorMetaInferArgs final {
+ public:
+  LocalTensorMetaInferArgs(const LocalTensorMetaInferArgs&) = default;
+  LocalTensorMetaInferArgs(LocalTensorMetaInferArgs&&) = default;
+  ~LocalTensorMetaInferArgs() = default;
+
+  const AttrMap& attrs() const { return attrs_; }
+  Symbol<Device> default_device() const { return default_device_; }
+  const std::vector<MirroredTensorMeta>& input_tensor_metas() const { return input_tensor_metas_; }
+
+  size_t hash_value() const { return hash_value_; }
+
+  bool operator==(const LocalTensorMetaInferArgs& other) const;
+
+  // Input metas share their shapes and strides with the input tensors, which may be reshaped in
+  // place by dynamic shape kernels. Cache keys hold their own copies.
+  LocalTensorMetaInferArgs Detached() const;
+
+  static Maybe<LocalTensorMetaInferArgs> New(const AttrMap& attrs, Symbol<Device> default_device,
+                                             const TensorTuple& input_tensors);
+
+ private:
+  LocalTensorMetaInferArgs() = default;
+  void InitHashValue();
+
+  AttrMap attrs_;
+  Symbol<Device> default_device_;
+  std::vector<MirroredTensorMeta> input_tensor_metas_;
+  size_t hash_value_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+namespace std {
+
+template<>
+struct hash<oneflow::one::LocalTensorMetaInferArgs> final {
+  size_t operator()(const oneflow::one::LocalTensorMetaInferArgs& val) const {
+    return val.hash_value();
+  }
+};
+
+}  // namespace std
+
+namespace oneflow {
+namespace one {
+
+class LocalTensorInferResult final {
+ public:
+  LocalTensorInferResult() = default;
+  LocalTensorInferResult(const LocalTensorInferResult&) = delete;
+  LocalTensorInferResult(LocalTensorInferResult&&) = delete;
+  ~LocalTensorInferResult() = default;
+
+  const std::vector<MirroredTensorMeta>& output_tensor_metas() const {
+    return output_tensor_metas_;
+  }
+  std::vector<MirroredTensorMeta>* mut_output_tensor_metas() { return &output_tensor_metas_; }
+
+  const Symbol<Stream>& stream() const { return stream_; }
+  void set_stream(const Symbol<Stream>& stream) { stream_ = stream; }
+
+ private:
+  std::vector<MirroredTensorMeta> output_tensor_metas_;
+  Symbol<Stream> stream_;
+};
+
+// Caches device, stream, shape, stride and dtype inference of eager local user ops so that
+// repeated training steps with unchanged input metas skip straight to instruction building.
+// Instructions are still built, scheduled and dependence-analyzed by the VM every step, only the
+// per-op inference is memoized. Safe to use from several threads, as one op expr may be called
+// from any of them. Disabled by setting ONEFLOW_EAGER_ENABLE_LOCAL_INFER_CACHE=0.
+class LocalTensorInferCache final {
+ public:
+  LocalTensorInferCache() = default;
+
+  // Returns nullptr on miss.
+  std::shared_ptr<const LocalTensorInferResult> Find(
+      const LocalTensorMetaInferArgs& infer_args) const;
+
+  // Records the metas and stream inferred for `outputs`.
+  Maybe<const LocalTensorInferResult> Insert(const LocalTensorMetaInferArgs& infer_args,
+                                             const TensorTuple& outputs, Symbol<Stream> stream);
+
+  // Copies a cached output meta onto a newly created output tensor.
+  static void AssignTensorMeta(const MirroredTensorMeta& src, MirroredTensorMeta* dst);
+
+  static bool Enabled();
+
+ private:
+  mutable std::mutex mutex_;
+  HashMap<LocalTensorMetaInferArgs, std::shared_ptr<const LocalTensorInferResult>> cache_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
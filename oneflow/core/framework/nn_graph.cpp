@@ -28,6 +28,7 @@ limitations under the License.
 #include "oneflow/core/functional/functional.h"
 #include "oneflow/core/graph/op_graph.h"
 #include "oneflow/core/job/compiler.h"
+#include "oneflow/core/job/compiled_plan_cache.h"
 #include "oneflow/core/job/job_build_and_infer_ctx_mgr.h"
 #include "oneflow/core/job/job_desc.h"
 #include "oneflow/core/job/job_instance.h"
@@ -275,9 +276,40 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
   auto scope = std::make_unique<GlobalJobDescScope>(job_.job_conf(), job_id_);
   if (GlobalProcessCtx::IsThisProcessMaster()) {
     double start = GetCurTime();
-    // TODO(chengcheng): new memory reused by chunk
-    Compiler().Compile(&job_, &plan_, /* need_job_complete */ true);
-    PlanUtil::GenMemBlockAndChunkWithVariableOpNames4Plan(&plan_, variable_op_names_);
+    CompiledPlanCache plan_cache(job_, job_id_, variable_op_names_);
+    if (plan_cache.enabled()) {
+      plan_cache_hit_ = JUST(plan_cache.TryLoad(&job_, &plan_));
+      VLOG(1) << "Graph name: " << name_ << " plan cache " << (plan_cache_hit_ ? "hit" : "miss")
+              << " (key " << plan_cache.key() << "), lookup time: "
+              << (GetCurTime() - start) / 1000000000.0 << " seconds.";
+    }
+    if (!plan_cache_hit_) {
+      // TODO(chengcheng): new memory reused by chunk
+      double phase_start = GetCurTime();
+      Compiler().Compile(&job_, &plan_, /* need_job_complete */ true);
+      VLOG(1) << "Graph name: " << name_
+              << " compile job to plan time: " << (GetCurTime() - phase_start) / 1000000000.0
+              << " seconds.";
+      phase_start = GetCurTime();
+      PlanUtil::GenMemBlockAndChunkWithVariableOpNames4Plan(&plan_, variable_op_names_);
+      VLOG(1) << "Graph name: " << name_ << " gen mem block and chunk time: "
+              << (GetCurTime() - phase_start) / 1000000000.0 << " seconds.";
+      phase_start = GetCurTime();
+      PlanUtil::GenRegisterHint(&plan_);
+      // TODO(chengcheng): test collective boxing for multi-job.
+      PlanUtil::GenCollectiveBoxingPlan(&job_, &plan_);
+      // PlanUtil::SetForceInplaceMemBlock(&plan_); NOTE(chengcheng): only for ssp.
+      PlanUtil::DumpCtrlRegstInfoToPlan(&plan_);
+      VLOG(1) << "Graph name: " << name_
+              << " plan post-process time: " << (GetCurTime() - phase_start) / 1000000000.0
+              << " seconds.";
+      if (plan_cache.enabled()) {
+        phase_start = GetCurTime();
+        JUST(plan_cache.Store(job_, plan_));
+        VLOG(1) << "Graph name: " << name_ << " plan cache store time: "
+                << (GetCurTime() - phase_start) / 1000000000.0 << " seconds.";
+      }
+    }
 
     VLOG(1) << "Graph name: " << name_ << " compile time: " << (GetCurTime() - start) / 1000000000.0
             << " seconds.";
@@ -285,11 +317,6 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
       TeePersistentLogStream::Create("job_" + name_ + "_plan")->Write(plan_);
       PlanUtil::ToDotFile(plan_, "job_" + name_ + "_plan.dot");
     }
-    PlanUtil::GenRegisterHint(&plan_);
-    // TODO(chengcheng): test collective boxing for multi-job.
-    PlanUtil::GenCollectiveBoxingPlan(&job_, &plan_);
-    // PlanUtil::SetForceInplaceMemBlock(&plan_); NOTE(chengcheng): only for ssp.
-    PlanUtil::DumpCtrlRegstInfoToPlan(&plan_);
     PlanUtil::PlanMemoryLog(&plan_, name_);
   }
   if (GlobalProcessCtx::WorldSize() > 1) {
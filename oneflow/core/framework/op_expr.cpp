@@ -23,6 +23,7 @@ limitations under the License.
 #include "oneflow/core/framework/op_interpreter/dispatch_frame.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
 #include "oneflow/core/framework/consistent_tensor_infer_cache.h"
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
 #include "oneflow/core/operator/op_conf.pb.h"
 #include "oneflow/user/kernels/stateful_local_opkernel.h"
 
@@ -463,6 +464,7 @@ Maybe<void> UserOpExpr::Init(const std::shared_ptr<const UserOpExpr>& self) {
     device_and_stream_infer_fn_ = registry->device_and_stream_infer_fn;
   }
   consistent_tensor_infer_cache_.reset(new ConsistentTensorInferCache(self));
+  local_tensor_infer_cache_.reset(new LocalTensorInferCache());
   return Maybe<void>::Ok();
 }
 
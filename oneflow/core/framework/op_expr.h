@@ -127,6 +127,7 @@ class BuiltinOpExprImpl : public BuiltinOpExpr {
 
 class StatefulLocalOpKernel;
 class ConsistentTensorInferCache;
+class LocalTensorInferCache;
 
 class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
  public:
@@ -162,6 +163,9 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
   ConsistentTensorInferCache* mut_consistent_tensor_infer_cache() const {
     return consistent_tensor_infer_cache_.get();
   }
+  LocalTensorInferCache* mut_local_tensor_infer_cache() const {
+    return local_tensor_infer_cache_.get();
+  }
 
  private:
   UserOpExpr(const std::string& op_name, UserOpConf&& proto, const AttrMap& base_attrs,
@@ -174,6 +178,7 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
   user_op::DeviceAndStreamInferFn device_and_stream_infer_fn_;
   mutable HashMap<Symbol<Stream>, std::shared_ptr<StatefulLocalOpKernel>> stream2kernel_;
   std::shared_ptr<ConsistentTensorInferCache> consistent_tensor_infer_cache_;
+  std::shared_ptr<LocalTensorInferCache> local_tensor_infer_cache_;
 };
 
 class ConsistentToConsistentOpExpr : public OpExpr {
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/framework/op_interpreter.h"
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
 #include "oneflow/core/framework/instructions_builder.h"
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
 #include "oneflow/core/framework/scope_util.h"
 #include "oneflow/core/framework/session_util.h"
 #include "oneflow/core/framework/symbol_storage_util.h"
@@ -103,6 +104,7 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
   std::shared_ptr<EagerBlobObjectList> output_eager_blob_objects =
       std::make_shared<EagerBlobObjectList>(outputs->size());
   auto* output_tensor_metas = ThreadLocalDefaultOutputMutTensorMetas(outputs->size());
+  bool is_inplace = false;
   for (int i = 0; i < outputs->size(); i++) {
     if (!outputs->at(i)) {
       const auto& tensor_impl = std::make_shared<EagerMirroredTensorImpl>();
@@ -112,35 +114,53 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
       bool has_eager_blob_object = JUST(outputs->at(i)->has_eager_blob_object());
       CHECK_OR_RETURN(has_eager_blob_object);
       output_eager_blob_objects->at(i) = JUST(outputs->at(i)->eager_blob_object());
+      is_inplace = true;
     }
   }
   Symbol<Stream> stream;
-  bool need_check_mem_case = true;
+  const bool need_check_mem_case = !user_op_expr.has_device_and_stream_infer_fn();
+
+  // Inplaced outputs are checked against freshly inferred metas, so they always take the slow path.
+  auto* infer_cache = user_op_expr.mut_local_tensor_infer_cache();
+  std::shared_ptr<const LocalTensorMetaInferArgs> infer_args;
+  std::shared_ptr<const LocalTensorInferResult> infer_result;
+  if (!is_inplace && LocalTensorInferCache::Enabled()) {
+    infer_args = JUST(LocalTensorMetaInferArgs::New(attrs, default_device, inputs));
+    infer_result = infer_cache->Find(*infer_args);
+  }
 
-  // Infer devices
-  if (!user_op_expr.has_device_and_stream_infer_fn()) {
-    stream = GetDefaultStreamByDevice(default_device);
+  if (infer_result) {
+    stream = infer_result->stream();
     for (int i = 0; i < outputs->size(); i++) {
       auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
-      *JUST(tensor_impl->mut_device()) = default_device;
+      LocalTensorInferCache::AssignTensorMeta(infer_result->output_tensor_metas().at(i),
+                                              tensor_impl->mut_tensor_meta());
     }
   } else {
-    need_check_mem_case = false;
-    stream = JUST(user_op_expr.InferDeviceAndStream(attrs, inputs, outputs));
-  }
+    // Infer devices
+    if (!user_op_expr.has_device_and_stream_infer_fn()) {
+      stream = GetDefaultStreamByDevice(default_device);
+      for (int i = 0; i < outputs->size(); i++) {
+        auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
+        *JUST(tensor_impl->mut_device()) = default_device;
+      }
+    } else {
+      stream = JUST(user_op_expr.InferDeviceAndStream(attrs, inputs, outputs));
+    }
 
-  // Infer shapes and dtypes
-  const auto& device_tag = stream->device()->type();
-  JUST(user_op_expr.InferPhysicalTensorDesc(
-      attrs, device_tag,
-      [&](int32_t i) -> const TensorMeta* {
-        return CHECK_JUST(TensorImpl4Tensor(inputs[i]))->mut_tensor_meta();
-      },
-      [&](int32_t i) -> TensorMeta* {
-        // using thread_local TensorMeta pointer if inplace.
-        // using tensor_impl TensorMeta pointer if not inplace.
-        return output_tensor_metas->at(i);
-      }));
+    // Infer shapes and dtypes
+    const auto& device_tag = stream->device()->type();
+    JUST(user_op_expr.InferPhysicalTensorDesc(
+        attrs, device_tag,
+        [&](int32_t i) -> const TensorMeta* {
+          return CHECK_JUST(TensorImpl4Tensor(inputs[i]))->mut_tensor_meta();
+        },
+        [&](int32_t i) -> TensorMeta* {
+          // using thread_local TensorMeta pointer if inplace.
+          // using tensor_impl TensorMeta pointer if not inplace.
+          return output_tensor_metas->at(i);
+        }));
+  }
 
   const bool pin_memory = ctx.pin_memory.value_or(false);
   for (int i = 0; i < output_eager_blob_objects->size(); i++) {
@@ -149,7 +169,7 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
       // NOTE: if op support stride(non-contiguous input), then output tensor's stride
       // should be inferred in InferLogicalTensorDesc.
       // otherwise, it will be set here(according to shape).
-      if (!JUST(user_op_expr.SupportNonContiguous())) {
+      if (!infer_result && !JUST(user_op_expr.SupportNonContiguous())) {
         std::shared_ptr<Stride> stride(new Stride(*tensor_impl->shape()));
         tensor_impl->mut_tensor_meta()->set_stride(stride);
       }
@@ -167,6 +187,8 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
     }
   }
 
+  if (infer_args && !infer_result) { JUST(infer_cache->Insert(*infer_args, *outputs, stream)); }
+
   const auto& kernel = JUST(user_op_expr.MutKernel4Stream(stream));
   kernel->set_need_check_mem_case(need_check_mem_case);
 
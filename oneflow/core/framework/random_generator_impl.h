@@ -102,6 +102,14 @@ class CPUGeneratorImpl : public DeviceGeneratorImpl {
 
   std::mt19937& engine() { return engine_; }
 
+  // Reserves `num_blocks` consecutive blocks of the philox stream keyed by the current seed and
+  // returns the index of the first one.
+  uint64_t IncrementPhiloxOffset(uint64_t num_blocks) {
+    const uint64_t offset = philox_offset_;
+    philox_offset_ += num_blocks;
+    return offset;
+  }
+
   Maybe<Symbol<Device>> device() const override { return Device::New("cpu", device_index()); }
 
   Maybe<Tensor> GetState() const override;
@@ -109,6 +117,9 @@ class CPUGeneratorImpl : public DeviceGeneratorImpl {
 
  public:
   std::mt19937 engine_;
+
+ private:
+  uint64_t philox_offset_ = 0;
 };
 
 #ifdef WITH_CUDA
@@ -419,6 +419,28 @@ class ArgWhereFunctor {
   std::shared_ptr<OpExpr> op_;
 };
 
+class UniqueWithCountsFunctor {
+ public:
+  UniqueWithCountsFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("unique_with_counts")
+                         .Input("x")
+                         .Output("y")
+                         .Output("idx")
+                         .Output("count")
+                         .Output("num_unique")
+                         .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& x,
+                                const Symbol<DType>& out_idx) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<DataType>("out_idx", out_idx->data_type()));
+    return OpInterpUtil::Dispatch<TensorTuple>(*op_, {x}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
 class BroadcastLikeFunctor {
  public:
   BroadcastLikeFunctor() {
@@ -3072,6 +3094,7 @@ ONEFLOW_FUNCTION_LIBRARY(m) {
   m.add_functor<impl::WhereScalarYFunctor>("WhereScalarY");
   m.add_functor<impl::WhereScalarXYFunctor>("WhereScalarXY");
   m.add_functor<impl::ArgWhereFunctor>("ArgWhere");
+  m.add_functor<impl::UniqueWithCountsFunctor>("UniqueWithCounts");
   m.add_functor<impl::BroadcastLikeFunctor>("BroadcastLike");
   m.add_functor<impl::ConcatFunctor>("Concat");
   m.add_functor<impl::StackFunctor>("Stack");
@@ -29,11 +29,15 @@ limitations under the License.
 #include "oneflow/core/graph/boxing/hierarchical_sub_task_graph_builder_impl.h"
 #include "oneflow/core/graph/task_stream_index_manager.h"
 #include "oneflow/core/ep/include/primitive/memcpy.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
 namespace {
 
+// Levels smaller than this are not worth dispatching to the thread pool
+constexpr size_t kParallelTopoMinLevelSize = 16;
+
 bool IsMemcpyPrimitiveSupported(DeviceType device_type, ep::primitive::MemcpyKind kind) {
   auto primitive = ep::primitive::NewPrimitive<ep::primitive::MemcpyFactory>(device_type, kind);
   return primitive.operator bool();
@@ -540,6 +544,32 @@ void TaskGraph::ConnectCtrlEdges(const std::vector<CompTaskNode*>& src_task_node
   }
 }
 
+void TaskGraph::ParallelTopoForEachNode(const std::function<void(TaskNode*)>& Handler) const {
+  HashMap<TaskNode*, int64_t> node2remaining_in_cnt;
+  std::vector<TaskNode*> cur_level;
+  ForEachNode([&](TaskNode* node) {
+    int64_t in_cnt = 0;
+    node->ForEachNodeOnInEdge([&](TaskNode*) { ++in_cnt; });
+    node2remaining_in_cnt.emplace(node, in_cnt);
+    if (in_cnt == 0) { cur_level.emplace_back(node); }
+  });
+  std::vector<TaskNode*> next_level;
+  while (!cur_level.empty()) {
+    if (cur_level.size() < kParallelTopoMinLevelSize) {
+      for (TaskNode* node : cur_level) { Handler(node); }
+    } else {
+      MultiThreadLoop(cur_level.size(), [&](size_t i) { Handler(cur_level.at(i)); });
+    }
+    next_level.clear();
+    for (TaskNode* node : cur_level) {
+      node->ForEachNodeOnOutEdge([&](TaskNode* out_node) {
+        if (--node2remaining_in_cnt.at(out_node) == 0) { next_level.emplace_back(out_node); }
+      });
+    }
+    cur_level.swap(next_level);
+  }
+}
+
 void TaskGraph::RemoveEmptyRegsts() {
   ForEachNode([&](TaskNode* node) { node->EraseUninitializedShapeProducedBlob(); });
   ForEachNode([&](TaskNode* node) { node->EraseZeroSizeConsumedRegst(); });
@@ -48,6 +48,10 @@ class TaskGraph final : public Graph<TaskNode, TaskEdge> {
   const char* TypeName() const override { return "TaskGraph"; }
   void RemoveEmptyRegsts();
   void MergeChainAndAddOrderingCtrlEdgeInSameChain();
+  // Visits the nodes level by level in topological order, the nodes of a level are handled
+  // concurrently. Handler must only modify the visited node and its produced regsts, and must not
+  // create graph nodes or edges, whose ids come from unsynchronized counters.
+  void ParallelTopoForEachNode(const std::function<void(TaskNode*)>& Handler) const;
 
   void EnableInplaceMemSharing(const std::function<bool(const std::string&, const std::string&)>&
                                    IsOpNameDataOrCtrlReachable);
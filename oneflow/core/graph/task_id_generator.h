@@ -29,6 +29,11 @@ class TaskIdGenerator final {
   ~TaskIdGenerator() = default;
 
   TaskId Generate(const StreamId& stream_id);
+  // The counters are saved and restored along with plans restored rather than built
+  void ForEachTaskIndexCounter(
+      const std::function<void(const StreamId&, task_index_t)>& Handler) const;
+  // Makes sure no task index below `task_index_count` is generated on `stream_id` again
+  void ReserveTaskIndexCount(const StreamId& stream_id, task_index_t task_index_count);
 
  private:
   HashMap<StreamId, task_index_t> stream_id2task_index_counter_;
@@ -39,6 +44,17 @@ inline TaskId TaskIdGenerator::Generate(const StreamId& stream_id) {
   return TaskId{stream_id, task_index};
 }
 
+inline void TaskIdGenerator::ForEachTaskIndexCounter(
+    const std::function<void(const StreamId&, task_index_t)>& Handler) const {
+  for (const auto& pair : stream_id2task_index_counter_) { Handler(pair.first, pair.second); }
+}
+
+inline void TaskIdGenerator::ReserveTaskIndexCount(const StreamId& stream_id,
+                                                   task_index_t task_index_count) {
+  task_index_t& counter = stream_id2task_index_counter_[stream_id];
+  counter = std::max<task_index_t>(counter, task_index_count);
+}
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_GRAPH_TASK_ID_GENERATOR_H_
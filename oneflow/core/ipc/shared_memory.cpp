@@ -204,5 +204,86 @@ Maybe<void> SharedMemory::Unlink() {
 #endif
 }
 
+namespace {
+
+// Layout of a batch ring block: [slot_num, slot_size, slot states..., padding, slots...]
+constexpr size_t kBatchRingSlotAlignment = 4096;
+enum BatchRingSlotState : int32_t { kSlotFree = 0, kSlotInUse = 1 };
+
+size_t BatchRingHeaderSize(size_t slot_num) {
+  return RoundUp(2 * sizeof(uint64_t) + slot_num * sizeof(std::atomic<int32_t>),
+                 kBatchRingSlotAlignment);
+}
+
+}  // namespace
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "slot states are shared across processes and must be lock free");
+
+SharedMemoryBatchRing::SharedMemoryBatchRing(const std::shared_ptr<SharedMemory>& shm)
+    : shm_(shm) {
+  const uint64_t* header = reinterpret_cast<const uint64_t*>(shm_->buf());
+  slot_num_ = header[0];
+  slot_size_ = header[1];
+  slot_states_ = reinterpret_cast<std::atomic<int32_t>*>(shm_->mut_buf() + 2 * sizeof(uint64_t));
+  slots_buf_ = shm_->mut_buf() + BatchRingHeaderSize(slot_num_);
+}
+
+Maybe<SharedMemoryBatchRing> SharedMemoryBatchRing::Create(size_t slot_num, size_t slot_size) {
+  CHECK_GT_OR_RETURN(slot_num, 0);
+  CHECK_GT_OR_RETURN(slot_size, 0);
+  slot_size = RoundUp(slot_size, kBatchRingSlotAlignment);
+  const auto& shm =
+      JUST(SharedMemory::Open(BatchRingHeaderSize(slot_num) + slot_num * slot_size, true));
+  // the block is zero-filled on creation, so all the slots start as kSlotFree
+  uint64_t* header = reinterpret_cast<uint64_t*>(shm->mut_buf());
+  header[0] = slot_num;
+  header[1] = slot_size;
+  return std::shared_ptr<SharedMemoryBatchRing>(new SharedMemoryBatchRing(shm));
+}
+
+Maybe<SharedMemoryBatchRing> SharedMemoryBatchRing::Open(const std::string& name) {
+  const auto& shm = JUST(SharedMemory::Open(name, false));
+  CHECK_GE_OR_RETURN(shm->size(), 2 * sizeof(uint64_t));
+  const uint64_t* header = reinterpret_cast<const uint64_t*>(shm->buf());
+  CHECK_EQ_OR_RETURN(shm->size(), BatchRingHeaderSize(header[0]) + header[0] * header[1])
+      << "shared memory " << name << " is not a batch ring";
+  return std::shared_ptr<SharedMemoryBatchRing>(new SharedMemoryBatchRing(shm));
+}
+
+int64_t SharedMemoryBatchRing::TryAcquireSlot(size_t size) {
+  if (size > slot_size_) { return -1; }
+  for (size_t i = 0; i < slot_num_; ++i) {
+    int32_t expected = kSlotFree;
+    if (slot_states_[i].compare_exchange_strong(expected, kSlotInUse,
+                                                std::memory_order_acquire)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Maybe<void> SharedMemoryBatchRing::ReleaseSlot(int64_t slot_id) {
+  CHECK_GE_OR_RETURN(slot_id, 0);
+  CHECK_LT_OR_RETURN(slot_id, slot_num_);
+  const int32_t prev_state = slot_states_[slot_id].exchange(kSlotFree, std::memory_order_release);
+  CHECK_EQ_OR_RETURN(prev_state, kSlotInUse) << "slot " << slot_id << " released twice";
+  return Maybe<void>::Ok();
+}
+
+Maybe<char*> SharedMemoryBatchRing::MutSlotBuf(int64_t slot_id) {
+  CHECK_GE_OR_RETURN(slot_id, 0);
+  CHECK_LT_OR_RETURN(slot_id, slot_num_);
+  return slots_buf_ + slot_id * slot_size_;
+}
+
+size_t SharedMemoryBatchRing::used_slot_num() const {
+  size_t used_slot_num = 0;
+  for (size_t i = 0; i < slot_num_; ++i) {
+    if (slot_states_[i].load(std::memory_order_relaxed) == kSlotInUse) { ++used_slot_num; }
+  }
+  return used_slot_num;
+}
+
 }  // namespace ipc
 }  // namespace oneflow
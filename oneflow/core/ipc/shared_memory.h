@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/maybe.h"
 #include "oneflow/core/common/global.h"
+#include <atomic>
 
 namespace oneflow {
 namespace ipc {
@@ -68,6 +69,40 @@ class SharedMemory final {
   size_t size_;
 };
 
+// A fixed number of equally sized slots living in one shared memory block. The slot states are
+// kept in the block itself, so a producer process (e.g. a DataLoader worker) can acquire a slot,
+// fill it and hand the slot id to a consumer process, which releases the slot after use. Slots
+// are reused across batches, avoiding the creation, zero-filling and page faults of a fresh shared
+// memory block per tensor.
+class SharedMemoryBatchRing final {
+ public:
+  SharedMemoryBatchRing(const SharedMemoryBatchRing&) = delete;
+  SharedMemoryBatchRing(SharedMemoryBatchRing&&) = delete;
+  ~SharedMemoryBatchRing() = default;
+
+  static Maybe<SharedMemoryBatchRing> Create(size_t slot_num, size_t slot_size);
+  static Maybe<SharedMemoryBatchRing> Open(const std::string& name);
+
+  // Returns -1 if the request does not fit in a slot or all the slots are in use.
+  int64_t TryAcquireSlot(size_t size);
+  Maybe<void> ReleaseSlot(int64_t slot_id);
+  Maybe<char*> MutSlotBuf(int64_t slot_id);
+
+  const std::string& name() const { return shm_->name(); }
+  size_t slot_num() const { return slot_num_; }
+  size_t slot_size() const { return slot_size_; }
+  size_t used_slot_num() const;
+
+ private:
+  explicit SharedMemoryBatchRing(const std::shared_ptr<SharedMemory>& shm);
+
+  std::shared_ptr<SharedMemory> shm_;
+  size_t slot_num_;
+  size_t slot_size_;
+  std::atomic<int32_t>* slot_states_;
+  char* slots_buf_;
+};
+
 }  // namespace ipc
 }  // namespace oneflow
 
@@ -0,0 +1,116 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/compiled_plan_cache.h"
+#include "oneflow/core/job/compiled_plan_cache.pb.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/version.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace oneflow {
+
+namespace {
+
+uint64_t Fnv1aHash(const std::string& str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string ComputeKey(const Job& job, int64_t job_id,
+                       const std::vector<std::string>& variable_op_names) {
+  // NOTE: text format is used since it prints map fields in a deterministic order
+  std::string key_str = PbMessage2TxtString(job);
+  key_str += "\njob_id: " + std::to_string(job_id);
+  std::vector<std::string> sorted_variable_op_names(variable_op_names);
+  std::sort(sorted_variable_op_names.begin(), sorted_variable_op_names.end());
+  for (const auto& name : sorted_variable_op_names) { key_str += "\nvariable: " + name; }
+  key_str += "\n" + PbMessage2TxtString(Global<ResourceDesc, ForSession>::Get()->resource());
+  key_str += "\nworld_size: " + std::to_string(GlobalProcessCtx::WorldSize());
+  key_str += "\nversion: " + std::string(GetOneFlowGitVersion());
+  IdCounterState id_counter_state;
+  Global<IDMgr>::Get()->SaveIdCounterState(&id_counter_state);
+  key_str += "\n" + PbMessage2TxtString(id_counter_state);
+
+  std::ostringstream ss;
+  ss << std::hex << std::setfill('0') << std::setw(16) << std::hash<std::string>()(key_str)
+     << std::setw(16) << Fnv1aHash(key_str);
+  return ss.str();
+}
+
+}  // namespace
+
+CompiledPlanCache::CompiledPlanCache(const Job& job, int64_t job_id,
+                                     const std::vector<std::string>& variable_op_names)
+    : cache_dir_(GetStringFromEnv("ONEFLOW_PLAN_CACHE_DIR", "")) {
+  if (enabled()) { key_ = ComputeKey(job, job_id, variable_op_names); }
+}
+
+std::string CompiledPlanCache::EntryPath() const {
+  return JoinPath(cache_dir_, "plan_" + key_ + ".pb");
+}
+
+Maybe<bool> CompiledPlanCache::TryLoad(Job* job, Plan* plan) const {
+  CHECK_OR_RETURN(enabled());
+  CompiledPlanCacheEntry entry;
+  if (!TryParseProtoFromPbFile(EntryPath(), &entry)) { return false; }
+  if (entry.key() != key_) {
+    LOG(WARNING) << "Ignore the corrupted plan cache entry " << EntryPath();
+    return false;
+  }
+  Global<IDMgr>::Get()->RestoreIdCounterState(entry.id_counter_state());
+  job->Swap(entry.mutable_job());
+  plan->Swap(entry.mutable_plan());
+  return true;
+}
+
+Maybe<void> CompiledPlanCache::Store(const Job& job, const Plan& plan) const {
+  CHECK_OR_RETURN(enabled());
+  CompiledPlanCacheEntry entry;
+  entry.set_key(key_);
+  *entry.mutable_job() = job;
+  *entry.mutable_plan() = plan;
+  Global<IDMgr>::Get()->SaveIdCounterState(entry.mutable_id_counter_state());
+  LocalFS()->RecursivelyCreateDirIfNotExist(cache_dir_);
+  // write to a temporary file first, so concurrent readers never see a partial entry
+  const std::string entry_path = EntryPath();
+  const std::string tmp_path = entry_path + ".tmp." + std::to_string(GlobalProcessCtx::Rank());
+  {
+    std::ofstream out_stream(tmp_path, std::ofstream::out | std::ofstream::binary);
+    if (!out_stream.is_open() || !entry.SerializeToOstream(&out_stream)) {
+      LOG(WARNING) << "Failed to write the plan cache entry " << tmp_path;
+      return Maybe<void>::Ok();
+    }
+  }
+  if (std::rename(tmp_path.c_str(), entry_path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to write the plan cache entry " << entry_path;
+    std::remove(tmp_path.c_str());
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace oneflow
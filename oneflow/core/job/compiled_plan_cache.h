@@ -0,0 +1,55 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_COMPILED_PLAN_CACHE_H_
+#define ONEFLOW_CORE_JOB_COMPILED_PLAN_CACHE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/job/job.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// On-disk cache of the plans compiled by nn.Graph, enabled by setting ONEFLOW_PLAN_CACHE_DIR.
+// An entry is keyed by the uncompiled job, the job id, the variable names, the resource config,
+// the world size, the OneFlow version and the id and task index counters at the time of
+// compilation, so a hit yields exactly the job and plan the compiler would have produced, and its
+// ids never collide with those of the graphs compiled before it.
+class CompiledPlanCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CompiledPlanCache);
+  CompiledPlanCache(const Job& job, int64_t job_id,
+                    const std::vector<std::string>& variable_op_names);
+  ~CompiledPlanCache() = default;
+
+  bool enabled() const { return !cache_dir_.empty(); }
+  const std::string& key() const { return key_; }
+
+  // On hit, overwrites `job` with the completed job, `plan` with the compiled plan and advances
+  // the id and task index counters of IDMgr as if the job had been compiled.
+  Maybe<bool> TryLoad(Job* job, Plan* plan) const;
+  Maybe<void> Store(const Job& job, const Plan& plan) const;
+
+ private:
+  std::string EntryPath() const;
+
+  std::string cache_dir_;
+  std::string key_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_COMPILED_PLAN_CACHE_H_
@@ -20,8 +20,7 @@ limitations under the License.
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/graph/op_graph.h"
 #include "oneflow/core/job_rewriter/job_completer.h"
-#include "oneflow/core/thread/thread_pool.h"
-#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -46,8 +45,16 @@ void CreateOpAttributeRef(Plan* plan, int64_t job_id, TaskProto* task_proto) {
 }
 
 void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
+  double phase_start = GetCurTime();
+  const auto& LogPhaseTime = [&phase_start](const std::string& phase_name) {
+    const double now = GetCurTime();
+    VLOG(1) << "Compile phase " << phase_name << " time: " << (now - phase_start) / 1000000000.0
+            << " seconds.";
+    phase_start = now;
+  };
   // Step1: ensure job is completed.
   if (need_job_complete) { CHECK_JUST(JobCompleter().Complete(job)); }
+  LogPhaseTime("job completion");
 
   // Step2: new Global<OpGraph> and set log configs.
   Global<OpGraph>::New(*job);
@@ -66,41 +73,41 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
   task_gph->ForEachNode(std::bind(&TaskNode::ProduceAllRegstsAndBindEdges, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::ConsumeAllRegsts, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::PinConsumedRegst, _1));
+  // NOTE: Build stays serial, it creates exec nodes and edges and their ids must not depend on the
+  // thread schedule
   task_gph->TopoForEachNode(&TaskNode::Build);
   task_gph->RemoveEmptyRegsts();
   task_gph->MergeChainAndAddOrderingCtrlEdgeInSameChain();
   auto IsReachable = Global<OpGraph>::Get()->MakePredicatorIsOpNameDataOrCtrlReachable();
   if (job_desc.enable_inplace()) { task_gph->EnableInplaceMemSharing(IsReachable); }
-  task_gph->TopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
-  task_gph->ForEachEdge([&](TaskEdge* task_edge) { task_edge->CheckRegstLbiValid(); });
+  task_gph->ParallelTopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
+  std::vector<TaskEdge*> task_edges;
+  task_gph->ForEachEdge([&](TaskEdge* task_edge) { task_edges.emplace_back(task_edge); });
+  MultiThreadLoop(task_edges.size(),
+                  [&](size_t i) { task_edges.at(i)->CheckRegstLbiValid(); });
+  LogPhaseTime("op graph and task graph building");
 
   // Step4: put infomation from task_gph into plan.
-  const int64_t node_num = task_gph->node_num();
-  const int64_t cpu_num = std::thread::hardware_concurrency();
-  const int64_t thread_pool_size = std::min(node_num, cpu_num);
-  BlockingCounter counter(node_num);
-  std::mutex mtx;
-  ThreadPool thread_pool(thread_pool_size);
+  // NOTE: task protos are serialized concurrently but appended in the node order of task_gph, so
+  // the plan does not depend on the thread schedule.
+  std::vector<TaskNode*> task_nodes;
   task_gph->ForEachNode([&](TaskNode* task_node) {
-    thread_pool.AddWork([task_node, plan, &job_desc, &counter, &mtx]() {
-      if (!task_node->IsMeaningLess()) {
-        TaskProto task_proto;
-        task_node->ToProto(&task_proto);
-        {
-          std::unique_lock<std::mutex> guard(mtx);
-          if (task_node->GetTaskType() == kNormalForward || task_node->GetTaskType() == kRepeat
-              || task_node->GetTaskType() == kAcc) {
-            CreateOpAttributeRef(plan, job_desc.job_id(), &task_proto);
-          }
-          plan->mutable_task()->Add(std::move(task_proto));
-        }  // guard(mtx)
-      }
-      counter.Decrease();
-    } /* thread_pool.AddWork */);
-  } /* task_gph->ForEachNode */);
-  counter.WaitForeverUntilCntEqualZero();
+    if (!task_node->IsMeaningLess()) { task_nodes.emplace_back(task_node); }
+  });
+  std::vector<TaskProto> task_protos(task_nodes.size());
+  MultiThreadLoop(task_nodes.size(),
+                  [&](size_t i) { task_nodes.at(i)->ToProto(&task_protos.at(i)); });
+  plan->mutable_task()->Reserve(task_protos.size());
+  for (size_t i = 0; i < task_nodes.size(); ++i) {
+    const TaskType task_type = task_nodes.at(i)->GetTaskType();
+    if (task_type == kNormalForward || task_type == kRepeat || task_type == kAcc) {
+      CreateOpAttributeRef(plan, job_desc.job_id(), &task_protos.at(i));
+    }
+    plan->mutable_task()->Add(std::move(task_protos.at(i)));
+  }
   // NOTE(levi): release task_gph here to decrise memory peak.
   task_gph.reset();
+  LogPhaseTime("plan generation");
 
   // Step5: post-process for plan and delete Global<OpGraph>.
   auto* job_id2job_conf = plan->mutable_job_confs()->mutable_job_id2job_conf();
@@ -109,6 +116,7 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
   IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(plan, IsReachable);
   PlanUtil::SetUniqueMemBlockId4UnreusedMemRegst(plan);
   Global<OpGraph>::Delete();
+  LogPhaseTime("memory planning");
 }
 
 }  // namespace oneflow
@@ -23,4 +23,32 @@ IDMgr::IDMgr() {
   chunk_id_count_ = 0;
 }
 
+void IDMgr::SaveIdCounterState(IdCounterState* state) const {
+  state->set_regst_desc_id_count(regst_desc_id_count_);
+  state->set_mem_block_id_count(mem_block_id_count_);
+  state->set_chunk_id_count(chunk_id_count_);
+  // sorted, so that equal states are serialized equally
+  std::map<int64_t, int64_t> stream_id2task_index_count;
+  task_id_gen_.ForEachTaskIndexCounter(
+      [&](const StreamId& stream_id, TaskIdGenerator::task_index_t task_index_count) {
+        stream_id2task_index_count[EncodeStreamIdToInt64(stream_id)] = task_index_count;
+      });
+  state->clear_task_index_counter();
+  for (const auto& pair : stream_id2task_index_count) {
+    TaskIndexCounter* counter = state->add_task_index_counter();
+    counter->set_stream_id(pair.first);
+    counter->set_task_index_count(pair.second);
+  }
+}
+
+void IDMgr::RestoreIdCounterState(const IdCounterState& state) {
+  regst_desc_id_count_ = std::max(regst_desc_id_count_, state.regst_desc_id_count());
+  mem_block_id_count_ = std::max(mem_block_id_count_, state.mem_block_id_count());
+  chunk_id_count_ = std::max(chunk_id_count_, state.chunk_id_count());
+  for (const TaskIndexCounter& counter : state.task_index_counter()) {
+    task_id_gen_.ReserveTaskIndexCount(DecodeStreamIdFromInt64(counter.stream_id()),
+                                       counter.task_index_count());
+  }
+}
+
 }  // namespace oneflow
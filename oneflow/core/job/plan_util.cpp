@@ -24,6 +24,7 @@ limitations under the License.
 #include "oneflow/core/register/runtime_register_desc.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/ep/include/device_manager_registry.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -833,7 +834,8 @@ void PlanUtil::GenRegisterHint(Plan* plan) {
       }
     }
   }
-  for (TaskProto& task : *(plan->mutable_task())) {
+  MultiThreadLoop(plan->task_size(), [&](size_t i) {
+    TaskProto& task = *plan->mutable_task(i);
     bool all_register_num_eq_one = true;
     for (const auto& pair : task.produced_regst_desc()) {
       if (pair.second.register_num() != 1) {
@@ -851,7 +853,7 @@ void PlanUtil::GenRegisterHint(Plan* plan) {
       }
     }
     task.set_all_register_num_eq_one_hint(all_register_num_eq_one);
-  }
+  });
 }
 
 void PlanUtil::PlanMemoryLog(Plan* plan, const std::string& plan_name) {
@@ -910,7 +912,8 @@ const oneflow::OpAttribute& PlanUtil::GetOpAttribute(const Plan* plan, int64_t j
 void PlanUtil::PopulateOpAttribute(
     Plan* plan,
     const PbMap<int64_t, ::oneflow::OpAttributeRefTable>& job_id2op_attribute_ref_table) {
-  for (auto& task : *plan->mutable_task()) {
+  MultiThreadLoop(plan->task_size(), [&](size_t i) {
+    TaskProto& task = *plan->mutable_task(i);
     if (task.exec_sequence().exec_node_size() == 1
         && task.exec_sequence().exec_node(0).kernel_conf().has_op_attribute_ref()) {
       auto* kernel_conf = task.mutable_exec_sequence()->mutable_exec_node(0)->mutable_kernel_conf();
@@ -928,7 +931,7 @@ void PlanUtil::PopulateOpAttribute(
             << "op_attribute absent, exec_node: " << exec_node.DebugString();
       }
     }
-  }
+  });
 }
 
 /*static*/ StreamId PlanUtil::GetStreamId(const TaskProto& task) {
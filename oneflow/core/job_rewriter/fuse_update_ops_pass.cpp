@@ -41,6 +41,116 @@ bool IsUserOpWithTypeName(const OperatorConf& op_conf, const std::string& op_typ
   return op_conf.has_user_conf() && op_conf.user_conf().op_type_name() == op_type_name;
 };
 
+const std::vector<std::string>& MultiTensorStateArgNames(const std::string& op_type_name) {
+  static const HashMap<std::string, std::vector<std::string>> op_type_name2state_arg_names{
+      {"sgd_update", {}}, {"momentum_update", {"momentum"}}, {"adam_update", {"m", "v"}}};
+  return op_type_name2state_arg_names.at(op_type_name);
+}
+
+const std::vector<std::string>& MultiTensorAttrNames(const std::string& op_type_name) {
+  static const HashMap<std::string, std::vector<std::string>> op_type_name2attr_names{
+      {"sgd_update", {"learning_rate_val", "scale", "l1", "l2", "weight_decay"}},
+      {"momentum_update", {"learning_rate_val", "scale", "l1", "l2", "beta", "weight_decay"}},
+      {"adam_update",
+       {"learning_rate_val", "bias_correction1_val", "bias_correction2_val", "scale", "l1", "l2",
+        "beta1", "beta2", "epsilon", "weight_decay", "do_bias_correction"}}};
+  return op_type_name2attr_names.at(op_type_name);
+}
+
+const std::vector<std::string>& MultiTensorScalarArgNames() {
+  static const std::vector<std::string> scalar_arg_names{
+      "learning_rate", "scale_by_tensor", "skip_if", "bias_correction1", "bias_correction2"};
+  return scalar_arg_names;
+}
+
+// Update ops of CPU parameters that can share one multi_tensor_*_update op: the key holds
+// everything except the per parameter model/model_diff/state inputs, so ops with equal keys
+// differ only in the tensors they update.
+Maybe<std::string> MultiTensorGroupKey(const OpGraph& op_graph, const OpNode* op_node,
+                                       const OperatorConf& op_conf,
+                                       const HashSet<std::string>& ctrl_in_op_names) {
+  const std::string& op_type_name = op_conf.user_conf().op_type_name();
+  if (op_type_name != "sgd_update" && op_type_name != "momentum_update"
+      && op_type_name != "adam_update") {
+    return std::string();
+  }
+  const ParallelDesc& parallel_desc = op_node->parallel_desc();
+  if (parallel_desc.device_type() != DeviceType::kCPU) { return std::string(); }
+  if (ctrl_in_op_names.find(op_conf.name()) != ctrl_in_op_names.end()) { return std::string(); }
+  const user_op::UserOpConfWrapper user_op_conf(op_conf);
+  if (op_type_name == "adam_update"
+      && (user_op_conf.has_input("max_v", 0) || user_op_conf.attr<bool>("amsgrad"))) {
+    return std::string();
+  }
+  if (parallel_desc.parallel_num() > 1) {
+    for (const auto& nd_sbp : op_node->NdSbp4BnInOp(GenRepeatedBn("model", 0)).sbp_parallel()) {
+      if (!nd_sbp.has_broadcast_parallel()) { return std::string(); }
+    }
+  }
+  const auto DataType4Arg = [&](const std::string& arg_name) {
+    return op_graph.GetLogicalBlobDesc(GenLogicalBlobId(user_op_conf.input(arg_name, 0)))
+        .data_type();
+  };
+  // The cpu multi tensor kernels are registered for model_diff of the model data type only.
+  const DataType model_data_type = DataType4Arg("model");
+  if (model_data_type != DataType::kFloat && model_data_type != DataType::kDouble) {
+    return std::string();
+  }
+  if (DataType4Arg("model_diff") != model_data_type) { return std::string(); }
+  UserOpConf key_conf;
+  key_conf.set_op_type_name(op_type_name);
+  for (const auto& arg_name : MultiTensorScalarArgNames()) {
+    if (user_op_conf.has_input(arg_name, 0)) {
+      (*key_conf.mutable_input())[arg_name].add_s(user_op_conf.input(arg_name, 0));
+    }
+  }
+  for (const auto& attr_name : MultiTensorAttrNames(op_type_name)) {
+    const auto& attr = op_conf.user_conf().attr();
+    const auto it = attr.find(attr_name);
+    CHECK_OR_RETURN(it != attr.end()) << op_conf.name() << " has no attr " << attr_name;
+    (*key_conf.mutable_attr())[attr_name] = it->second;
+  }
+  return PbMessage2TxtString(parallel_desc.parallel_conf()) + PbMessage2TxtString(key_conf)
+         + DataType_Name(model_data_type) + std::to_string(op_conf.scope_symbol_id());
+}
+
+// Builds one multi_tensor_*_update op out of update ops sharing a MultiTensorGroupKey.
+OperatorConf MakeMultiTensorUpdateOpConf(const std::vector<OperatorConf>& op_confs) {
+  const OperatorConf& first_op_conf = op_confs.front();
+  const std::string& op_type_name = first_op_conf.user_conf().op_type_name();
+  user_op::UserOpConfWrapperBuilder builder("System-MultiTensorModelUpdate-" + NewUniqueId());
+  builder.OpTypeName("multi_tensor_" + op_type_name);
+  HashSet<std::string> ctrl_in_op_names;
+  for (const OperatorConf& op_conf : op_confs) {
+    const user_op::UserOpConfWrapper user_op_conf(op_conf);
+    builder.Input("model", user_op_conf.input("model", 0))
+        .Input("model_diff", user_op_conf.input("model_diff", 0));
+    for (const auto& arg_name : MultiTensorStateArgNames(op_type_name)) {
+      builder.Input(arg_name, user_op_conf.input(arg_name, 0));
+    }
+    ctrl_in_op_names.insert(op_conf.ctrl_in_op_name().cbegin(), op_conf.ctrl_in_op_name().cend());
+  }
+  const user_op::UserOpConfWrapper first_user_op_conf(first_op_conf);
+  for (const auto& arg_name : MultiTensorScalarArgNames()) {
+    if (first_user_op_conf.has_input(arg_name, 0)) {
+      builder.Input(arg_name, first_user_op_conf.input(arg_name, 0));
+    }
+  }
+  OperatorConf multi_tensor_op_conf = first_op_conf;
+  const OperatorConf built_op_conf = builder.Build().op_conf();
+  multi_tensor_op_conf.set_name(built_op_conf.name());
+  *multi_tensor_op_conf.mutable_user_conf() = built_op_conf.user_conf();
+  for (const auto& attr_name : MultiTensorAttrNames(op_type_name)) {
+    (*multi_tensor_op_conf.mutable_user_conf()->mutable_attr())[attr_name] =
+        first_op_conf.user_conf().attr().at(attr_name);
+  }
+  multi_tensor_op_conf.clear_ctrl_in_op_name();
+  for (const auto& ctrl_in_op_name : ctrl_in_op_names) {
+    multi_tensor_op_conf.add_ctrl_in_op_name(ctrl_in_op_name);
+  }
+  return multi_tensor_op_conf;
+}
+
 class FuseUpdateOpsPass final : public JobPass {
  public:
   FuseUpdateOpsPass() = default;
@@ -62,6 +172,36 @@ class FuseUpdateOpsPass final : public JobPass {
 Maybe<void> FuseUpdateOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
   const auto IsSafeToDelete = MakePredicatorIsSafeToDelete(op_graph);
   std::vector<std::string> del_op_names;
+  const bool enable_multi_tensor =
+      job_builder->job().job_conf().enable_multi_tensor_model_update();
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  // Groups are kept in first seen order so that the rewritten job is deterministic.
+  std::vector<std::string> group_keys;
+  HashMap<std::string, std::vector<OperatorConf>> group_key2op_confs;
+  HashMap<std::string, ParallelConf> group_key2parallel_conf;
+  HashSet<std::string> fused_op_names;
+  // Returns false if op_conf can not be grouped and has to be kept as a standalone update op.
+  const auto TryAddToMultiTensorGroup = [&](const OpNode* op_node, const OperatorConf& op_conf,
+                                            bool fused) -> bool {
+    if (!enable_multi_tensor) { return false; }
+    const std::string key =
+        CHECK_JUST(MultiTensorGroupKey(op_graph, op_node, op_conf, ctrl_in_op_names));
+    if (key.empty()) { return false; }
+    if (fused) { fused_op_names.insert(op_conf.name()); }
+    auto it = group_key2op_confs.find(key);
+    if (it == group_key2op_confs.end()) {
+      group_keys.emplace_back(key);
+      group_key2parallel_conf.emplace(key, op_node->parallel_desc().parallel_conf());
+      it = group_key2op_confs.emplace(key, std::vector<OperatorConf>()).first;
+    }
+    it->second.emplace_back(op_conf);
+    return true;
+  };
   op_graph.ForEachNode([&](const OpNode* op_node) {
     if (!op_node->op().op_conf().has_user_conf()) { return; }
     const user_op::UserOpConfWrapper user_op_conf(op_node->op().op_conf());
@@ -147,7 +287,10 @@ Maybe<void> FuseUpdateOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_bu
       } while (false);
     }();
 
-    if (!fused) { return; }
+    if (!fused) {
+      TryAddToMultiTensorGroup(op_node, user_op_conf.op_conf(), /*fused=*/false);
+      return;
+    }
 
     const TrainConf& train_conf = job_builder->job().job_conf().train_conf();
 
@@ -231,8 +374,20 @@ Maybe<void> FuseUpdateOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_bu
     fused_op_builder.ScopeSymbolId(user_op_conf.op_conf().scope_symbol_id());
     OperatorConf new_op_conf = user_op_conf.op_conf();
     *new_op_conf.mutable_user_conf() = fused_op_builder.Build().op_conf().user_conf();
+    if (TryAddToMultiTensorGroup(op_node, new_op_conf, /*fused=*/true)) { return; }
     job_builder->MutOpsOnlyOnce({new_op_conf});
   });
+  for (const auto& key : group_keys) {
+    const std::vector<OperatorConf>& op_confs = group_key2op_confs.at(key);
+    // A single parameter gains nothing from the multi tensor op.
+    if (op_confs.size() == 1) {
+      const OperatorConf& op_conf = op_confs.front();
+      if (fused_op_names.count(op_conf.name()) > 0) { job_builder->MutOpsOnlyOnce({op_conf}); }
+      continue;
+    }
+    for (const OperatorConf& op_conf : op_confs) { del_op_names.emplace_back(op_conf.name()); }
+    job_builder->AddOps(group_key2parallel_conf.at(key), {MakeMultiTensorUpdateOpConf(op_confs)});
+  }
   job_builder->DelOps(del_op_names);
   return Maybe<void>::Ok();
 }
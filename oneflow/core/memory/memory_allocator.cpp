@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/record/record.pb.h"
 #include "oneflow/core/ep/include/device_manager_registry.h"
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
 
 namespace oneflow {
 
@@ -67,13 +68,13 @@ void MemoryAllocatorImpl::Deallocate(void* ptr, const MemoryCase& mem_case) {
 }
 
 void* MemoryAllocatorImpl::AllocateUnPinnedHostMem(size_t size) {
-  void* ptr = aligned_alloc(kHostAlignSize, size);
+  void* ptr = ep::NumaHostAllocator::Get()->Allocate(size, kHostAlignSize, /*numa_node=*/-1);
   CHECK_NOTNULL(ptr);
   return ptr;
 }
 
 void MemoryAllocatorImpl::DeallocateUnPinnedHostMem(void* ptr) {
-  free(ptr);  // NOLINT
+  ep::NumaHostAllocator::Get()->Deallocate(ptr);
 }
 
 MemoryAllocator::~MemoryAllocator() {
@@ -17,51 +17,306 @@ limitations under the License.
 #include "oneflow/core/common/preprocessor.h"
 #include "oneflow/core/ndarray/ndarray_reduce_impl.h"
 #include "oneflow/core/ndarray/binary_func.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
-#define SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(struct_name)                                        \
+namespace {
+
+// float16 is accumulated in float, so long reductions keep their precision.
+template<typename T>
+struct ReduceAccType {
+  using type = T;
+};
+
+template<>
+struct ReduceAccType<float16> {
+  using type = float;
+};
+
+constexpr int64_t kReduceLanes = 8;
+constexpr int64_t kReduceColBlock = 1024;
+constexpr int64_t kReduceGrain = 32768;
+constexpr int64_t kReduceMinTasks = 64;
+constexpr int64_t kReduceMaxParts = 64;
+constexpr int kMaxReduceAxes = 8;
+
+// After TrySimplifyDims the axes alternate between kept and reduced. The last axis, and the
+// reduced axis in front of it when the last one is kept, stay contiguous as reduce_size rows
+// of inner_size elements. The leading axes are split into the kept ones, which enumerate the
+// output lines, and the reduced ones, which enumerate the slices every line reduces over, so
+// any shape is one outer/reduce/inner walk.
+struct ReduceAxes {
+  int num_axes = 0;
+  int64_t dims[kMaxReduceAxes];
+  int64_t strides[kMaxReduceAxes];
+  int64_t elem_cnt = 1;
+
+  void Append(int64_t dim, int64_t stride) {
+    CHECK_LT(num_axes, kMaxReduceAxes);
+    dims[num_axes] = dim;
+    strides[num_axes] = stride;
+    num_axes += 1;
+    elem_cnt *= dim;
+  }
+
+  int64_t Offset(int64_t index) const {
+    int64_t offset = 0;
+    for (int i = num_axes - 1; i >= 0; --i) {
+      const int64_t quotient = index / dims[i];
+      offset += (index - quotient * dims[i]) * strides[i];
+      index = quotient;
+    }
+    return offset;
+  }
+};
+
+struct ReduceLayout {
+  ReduceAxes line_axes;
+  ReduceAxes slice_axes;
+  int64_t reduce_size;
+  int64_t inner_size;
+};
+
+ReduceLayout GetReduceLayout(const XpuShape& y_shape, const XpuShape& x_shape) {
+  const int num_axes = x_shape.NumAxes();
+  CHECK_EQ(y_shape.NumAxes(), num_axes);
+  ReduceLayout layout;
+  int num_leading_axes = num_axes - 1;
+  if (y_shape.At(num_axes - 1) == 1) {
+    layout.reduce_size = x_shape.At(num_axes - 1);
+    layout.inner_size = 1;
+  } else if (num_axes == 1) {
+    layout.reduce_size = 1;
+    layout.inner_size = x_shape.At(0);
+  } else {
+    layout.reduce_size = x_shape.At(num_axes - 2);
+    layout.inner_size = x_shape.At(num_axes - 1);
+    num_leading_axes = num_axes - 2;
+  }
+  int64_t strides[kMaxReduceAxes];
+  int64_t stride = layout.reduce_size * layout.inner_size;
+  for (int i = num_leading_axes - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= x_shape.At(i);
+  }
+  for (int i = 0; i < num_leading_axes; ++i) {
+    if (y_shape.At(i) == x_shape.At(i)) {
+      layout.line_axes.Append(x_shape.At(i), strides[i]);
+    } else {
+      CHECK_EQ(y_shape.At(i), 1);
+      layout.slice_axes.Append(x_shape.At(i), strides[i]);
+    }
+  }
+  return layout;
+}
+
+template<typename T, template<typename> class binary_func>
+class CpuReducer final {
+ public:
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  using AccT = typename ReduceAccType<T>::type;
+
+  CpuReducer(const ReduceLayout& layout, const T* x)
+      : line_axes_(layout.line_axes),
+        slice_axes_(layout.slice_axes),
+        reduce_size_(layout.reduce_size),
+        inner_size_(layout.inner_size),
+        x_(x) {}
+
+  static AccT Unit() { return static_cast<AccT>(UnitOfBinaryFunc<T, binary_func>::Val()); }
+  static AccT Combine(AccT a, AccT b) { return binary_func<AccT>::Invoke(a, b); }
+
+  // Reduces rows [row_begin, row_end) of one output line when inner_size is 1, the rows of all
+  // its slices being numbered one after another. Contiguous rows are reduced into kReduceLanes
+  // partial results, so the loop vectorizes and does not wait on a single accumulator.
+  AccT ReduceLine(int64_t line, int64_t row_begin, int64_t row_end) const {
+    const int64_t reduce_size = reduce_size_;
+    const T* line_x = x_ + line_axes_.Offset(line);
+    AccT acc[kReduceLanes];
+    for (int64_t l = 0; l < kReduceLanes; ++l) { acc[l] = Unit(); }
+    AccT tail = Unit();
+    for (int64_t row = row_begin; row < row_end;) {
+      const int64_t slice = row / reduce_size;
+      const int64_t slice_row = row - slice * reduce_size;
+      const int64_t n = std::min(row_end - row, reduce_size - slice_row);
+      const T* in = line_x + slice_axes_.Offset(slice) + slice_row;
+      int64_t i = 0;
+      for (; i + kReduceLanes <= n; i += kReduceLanes) {
+        for (int64_t l = 0; l < kReduceLanes; ++l) {
+          acc[l] = Combine(acc[l], static_cast<AccT>(in[i + l]));
+        }
+      }
+      for (; i < n; ++i) { tail = Combine(tail, static_cast<AccT>(in[i])); }
+      row += n;
+    }
+    for (int64_t l = 0; l < kReduceLanes; ++l) { tail = Combine(tail, acc[l]); }
+    return tail;
+  }
+
+  // Reduces rows [row_begin, row_end) of columns [col_begin, col_begin + num_cols) of one output
+  // line. Every row is a contiguous run of kept columns, so the columns are the vector lanes.
+  void ReduceColumns(int64_t line, int64_t col_begin, int64_t num_cols, int64_t row_begin,
+                     int64_t row_end, AccT* acc) const {
+    const int64_t reduce_size = reduce_size_;
+    const int64_t inner_size = inner_size_;
+    const T* line_x = x_ + line_axes_.Offset(line) + col_begin;
+    for (int64_t j = 0; j < num_cols; ++j) { acc[j] = Unit(); }
+    for (int64_t row = row_begin; row < row_end;) {
+      const int64_t slice = row / reduce_size;
+      const int64_t slice_row = row - slice * reduce_size;
+      const int64_t n = std::min(row_end - row, reduce_size - slice_row);
+      const T* in = line_x + slice_axes_.Offset(slice) + slice_row * inner_size;
+      for (int64_t i = 0; i < n; ++i) {
+        const T* in_row = in + i * inner_size;
+        for (int64_t j = 0; j < num_cols; ++j) {
+          acc[j] = Combine(acc[j], static_cast<AccT>(in_row[j]));
+        }
+      }
+      row += n;
+    }
+  }
+
+  int64_t num_rows() const { return slice_axes_.elem_cnt * reduce_size_; }
+
+ private:
+  ReduceAxes line_axes_;
+  ReduceAxes slice_axes_;
+  int64_t reduce_size_;
+  int64_t inner_size_;
+  const T* x_;
+};
+
+// Tasks are output lines, or blocks of kReduceColBlock columns of them. When there are too few
+// of them to feed the threads, the reduced rows are also split into parts whose partial results
+// go to tmp_storage and are combined in order afterwards. The split only depends on the shape,
+// so results do not change with the number of threads.
+template<typename T, template<typename> class binary_func>
+void CpuReduce(ep::Stream* stream,
+               const XpuVarNdarray<typename BinaryFuncTrait<binary_func, T>::return_type>& y,
+               const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) {
+  using Reducer = CpuReducer<T, binary_func>;
+  using RetT = typename Reducer::RetT;
+  using AccT = typename Reducer::AccT;
+  const ReduceLayout layout = GetReduceLayout(y.shape(), x.shape());
+  const Reducer reducer(layout, x.ptr());
+  const int64_t num_lines = layout.line_axes.elem_cnt;
+  const int64_t inner_size = layout.inner_size;
+  const int64_t num_rows = reducer.num_rows();
+  const int64_t num_outputs = num_lines * inner_size;
+  CHECK_EQ(num_outputs, y.shape().ElemNum());
+  const int64_t num_col_blocks = (inner_size + kReduceColBlock - 1) / kReduceColBlock;
+  const int64_t num_tasks = num_lines * num_col_blocks;
+  const int64_t task_elem_cnt = num_rows * std::min(inner_size, kReduceColBlock);
+  const int64_t tmp_storage_bytes = tmp_storage.shape().ElemNum() * sizeof(T);
+  int64_t num_parts = 1;
+  if (num_outputs > 0 && num_tasks < kReduceMinTasks) {
+    num_parts = std::min(std::min(task_elem_cnt / kReduceGrain, kReduceMaxParts), num_rows);
+    // The partials of all parts have to fit in tmp_storage.
+    num_parts = std::min<int64_t>(num_parts, tmp_storage_bytes / (num_outputs * sizeof(AccT)));
+    num_parts = std::max<int64_t>(num_parts, 1);
+  }
+  const int64_t rows_per_part = (num_rows + num_parts - 1) / num_parts;
+  AccT* partials = nullptr;
+  if (num_parts > 1) {
+    CHECK_LE(num_parts * num_outputs * sizeof(AccT), tmp_storage_bytes);
+    partials = reinterpret_cast<AccT*>(tmp_storage.ptr());
+  }
+  RetT* y_ptr = y.ptr();
+  auto* cpu_stream = stream->As<ep::CpuStream>();
+  cpu_stream->ParallelFor(
+      0, num_tasks * num_parts,
+      [&](int64_t begin, int64_t end) {
+        AccT acc[kReduceColBlock];
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t part = i / num_tasks;
+          const int64_t task = i - part * num_tasks;
+          const int64_t line = task / num_col_blocks;
+          const int64_t col_begin = (task - line * num_col_blocks) * kReduceColBlock;
+          const int64_t num_cols = std::min(kReduceColBlock, inner_size - col_begin);
+          const int64_t row_begin = std::min(part * rows_per_part, num_rows);
+          const int64_t row_end = std::min(row_begin + rows_per_part, num_rows);
+          if (inner_size == 1) {
+            acc[0] = reducer.ReduceLine(line, row_begin, row_end);
+          } else {
+            reducer.ReduceColumns(line, col_begin, num_cols, row_begin, row_end, acc);
+          }
+          const int64_t out_offset = line * inner_size + col_begin;
+          if (num_parts == 1) {
+            for (int64_t j = 0; j < num_cols; ++j) {
+              y_ptr[out_offset + j] = static_cast<RetT>(acc[j]);
+            }
+          } else {
+            AccT* part_out = partials + part * num_outputs + out_offset;
+            for (int64_t j = 0; j < num_cols; ++j) { part_out[j] = acc[j]; }
+          }
+        }
+      },
+      std::max<int64_t>(kReduceGrain / std::max<int64_t>(task_elem_cnt, 1), 1));
+  if (num_parts == 1) { return; }
+  cpu_stream->ParallelFor(0, num_outputs, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      AccT reduced = partials[i];
+      for (int64_t part = 1; part < num_parts; ++part) {
+        reduced = Reducer::Combine(reduced, partials[part * num_outputs + i]);
+      }
+      y_ptr[i] = static_cast<RetT>(reduced);
+    }
+  });
+}
+
+bool MatchScalarReduce(const XpuShape& y, const XpuShape& x) { return y.ElemNum() == 1; }
+
+bool MatchMatrixRowReduce(const XpuShape& y, const XpuShape& x) {
+  return x.NumAxes() == 2 && y.NumAxes() == 2 && x.At(0) == y.At(0) && y.At(1) == 1;
+}
+
+bool MatchMatrixColReduce(const XpuShape& y, const XpuShape& x) {
+  return x.NumAxes() == 2 && y.NumAxes() == 2 && y.At(0) == 1 && x.At(1) == y.At(1);
+}
+
+bool MatchXYZCubeXZReduce(const XpuShape& y, const XpuShape& x) {
+  return x.NumAxes() == 3 && y.NumAxes() == 3 && y.At(0) == 1 && x.At(1) == y.At(1)
+         && y.At(2) == 1;
+}
+
+}  // namespace
+
+#define SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(struct_name, match_func)                            \
   template<typename T, template<typename> class binary_func>                                   \
   struct struct_name<DeviceType::kCPU, T, binary_func> final {                                 \
     using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;                        \
     static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {       \
-      return false;                                                                            \
+      return match_func(y.shape(), x.shape());                                                 \
     }                                                                                          \
     static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,                       \
                        const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) { \
-      UNIMPLEMENTED();                                                                         \
+      CHECK(Matched(y, x));                                                                    \
+      CpuReduce<T, binary_func>(stream, y, x, tmp_storage);                                    \
     }                                                                                          \
   }
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayScalarReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixRowReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixColReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce);
+SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayScalarReduce, MatchScalarReduce);
+SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixRowReduce, MatchMatrixRowReduce);
+SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixColReduce, MatchMatrixColReduce);
+SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce, MatchXYZCubeXZReduce);
 #undef SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL
 
+template<typename T, template<typename> class binary_func>
+void NdarrayDefaultReduce<DeviceType::kCPU, T, binary_func>::Reduce(
+    ep::Stream* ctx, const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x,
+    const XpuVarNdarray<T>& tmp_storage) {
+  CpuReduce<T, binary_func>(ctx, y, x, tmp_storage);
+}
+
 #define INSTANTIATE_NDARRAY_REDUCE_IMPL(dtype, binary_func)                                       \
   template struct NdarrayScalarReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;    \
   template struct NdarrayMatrixRowReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
   template struct NdarrayMatrixColReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
-  template struct NdarrayXYZCubeXZReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
+  template struct NdarrayXYZCubeXZReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
+  template struct NdarrayDefaultReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
 OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_IMPL,
                                  ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ
                                      UNSIGNED_INT_DATA_TYPE_SEQ BOOL_DATA_TYPE_SEQ,
                                  REDUCE_BINARY_FUNC_SEQ);
 
-template<typename T, int NDIMS, template<typename> class binary_func>
-struct NdarrayReduceCoreWrapper<DeviceType::kCPU, T, NDIMS, binary_func> final {
-  static void ReduceAxis(ep::Stream* stream, const XpuReducedNdarray<T, NDIMS>& dst_reduced,
-                         const XpuReducedNdarray<T, NDIMS>& x, int axis) {
-    NdarrayReduceCore<T, NDIMS, binary_func>::ReduceAxis(dst_reduced, x, axis);
-  }
-};
-
-#define INSTANTIATE_NDARRAY_REDUCE_CORE_WRAPPER(dtype_pair, NDIMS, binary_func)                   \
-  template struct NdarrayReduceCoreWrapper<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype_pair), NDIMS, \
-                                           binary_func>;
-OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_CORE_WRAPPER,
-                                 ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ
-                                     UNSIGNED_INT_DATA_TYPE_SEQ BOOL_DATA_TYPE_SEQ,
-                                 DIM_SEQ, REDUCE_BINARY_FUNC_SEQ);
-
 }  // namespace oneflow
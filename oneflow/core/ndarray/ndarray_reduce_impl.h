@@ -138,6 +138,15 @@ struct NdarrayDefaultReduce final {
   }
 };
 
+// The cpu reduce engine handles arbitrary simplified shapes in one pass, see
+// ndarray_reduce_impl.cpp.
+template<typename T, template<typename> class binary_func>
+struct NdarrayDefaultReduce<DeviceType::kCPU, T, binary_func> final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  static void Reduce(ep::Stream* ctx, const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x,
+                     const XpuVarNdarray<T>& tmp_storage);
+};
+
 template<typename T, int NDIMS, template<typename> class binary_func>
 struct NdarrayReduceCore final {
   template<typename X>
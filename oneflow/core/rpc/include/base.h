@@ -24,18 +24,22 @@ limitations under the License.
 
 namespace oneflow {
 
-#define CTRL_METHOD_SEQ               \
-  OF_PP_MAKE_TUPLE_SEQ(LoadServer)    \
-  OF_PP_MAKE_TUPLE_SEQ(Barrier)       \
-  OF_PP_MAKE_TUPLE_SEQ(TryLock)       \
-  OF_PP_MAKE_TUPLE_SEQ(NotifyDone)    \
-  OF_PP_MAKE_TUPLE_SEQ(WaitUntilDone) \
-  OF_PP_MAKE_TUPLE_SEQ(PushKV)        \
-  OF_PP_MAKE_TUPLE_SEQ(ClearKV)       \
-  OF_PP_MAKE_TUPLE_SEQ(PullKV)        \
-  OF_PP_MAKE_TUPLE_SEQ(Clear)         \
-  OF_PP_MAKE_TUPLE_SEQ(IncreaseCount) \
-  OF_PP_MAKE_TUPLE_SEQ(EraseCount)
+#define CTRL_METHOD_SEQ                 \
+  OF_PP_MAKE_TUPLE_SEQ(LoadServer)      \
+  OF_PP_MAKE_TUPLE_SEQ(Barrier)         \
+  OF_PP_MAKE_TUPLE_SEQ(TryLock)         \
+  OF_PP_MAKE_TUPLE_SEQ(NotifyDone)      \
+  OF_PP_MAKE_TUPLE_SEQ(WaitUntilDone)   \
+  OF_PP_MAKE_TUPLE_SEQ(PushKV)          \
+  OF_PP_MAKE_TUPLE_SEQ(ClearKV)         \
+  OF_PP_MAKE_TUPLE_SEQ(PullKV)          \
+  OF_PP_MAKE_TUPLE_SEQ(Clear)           \
+  OF_PP_MAKE_TUPLE_SEQ(IncreaseCount)   \
+  OF_PP_MAKE_TUPLE_SEQ(EraseCount)      \
+  OF_PP_MAKE_TUPLE_SEQ(BatchPushKV)     \
+  OF_PP_MAKE_TUPLE_SEQ(BatchPullKV)     \
+  OF_PP_MAKE_TUPLE_SEQ(PullKVByPrefix)  \
+  OF_PP_MAKE_TUPLE_SEQ(ClearKVByPrefix)
 
 #define CatRequest(method) method##Request,
 #define CatReqponse(method) method##Response,
@@ -100,6 +104,21 @@ class CtrlClient {
     *v = oneflow_cast<T>(v_str);
   }
 
+  // Batched variants of PushKV/PullKV. Keys are grouped by the server responsible for them so
+  // that each server is contacted at most once per call.
+  virtual void BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) = 0;
+  virtual void BatchPullKV(const std::vector<std::string>& keys,
+                           std::vector<std::string>* vals) = 0;
+
+  // Prefix KV: all keys under `prefix` live on the server responsible for `prefix`, so one call
+  // watches the whole set. PullKVByPrefix blocks until at least `num` keys exist under `prefix`
+  // and returns them with `prefix` stripped.
+  virtual void PushPrefixKV(const std::string& prefix, const std::string& k,
+                            const std::string& v) = 0;
+  virtual void PullKVByPrefix(const std::string& prefix, int32_t num,
+                              HashMap<std::string, std::string>* kvs) = 0;
+  virtual void ClearKVByPrefix(const std::string& prefix) = 0;
+
   virtual void Clear() = 0;
   virtual int32_t IncreaseCount(const std::string& k, int32_t v) = 0;
   int32_t IncreaseCount(const std::string& k) { return IncreaseCount(k, 1); }
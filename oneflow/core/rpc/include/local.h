@@ -50,6 +50,13 @@ class LocalCtrlClient : public CtrlClient {
   void PullKV(const std::string& k, std::string* v) override;
   void PullKV(const std::string& k, PbMessage* msg) override;
   void PullMasterKV(const std::string& k, PbMessage* msg) override;
+  void BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) override;
+  void BatchPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) override;
+  void PushPrefixKV(const std::string& prefix, const std::string& k,
+                    const std::string& v) override;
+  void PullKVByPrefix(const std::string& prefix, int32_t num,
+                      HashMap<std::string, std::string>* kvs) override;
+  void ClearKVByPrefix(const std::string& prefix) override;
   void Clear() override;
   int32_t IncreaseCount(const std::string& k, int32_t v) override;
   void EraseCount(const std::string& k) override;
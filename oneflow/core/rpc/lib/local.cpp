@@ -132,6 +132,57 @@ void LocalCtrlClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   PullKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void LocalCtrlClient::BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+  std::unique_lock<std::mutex> lck(kv_mtx_);
+  for (const auto& pair : kvs) { kv_[pair.first] = pair.second; }
+  kv_cv_.notify_all();
+}
+
+void LocalCtrlClient::BatchPullKV(const std::vector<std::string>& keys,
+                                  std::vector<std::string>* vals) {
+  std::unique_lock<std::mutex> lck(kv_mtx_);
+  size_t ready_cnt = 0;
+  kv_cv_.wait(lck, [&]() {
+    while (ready_cnt < keys.size() && kv_.find(keys.at(ready_cnt)) != kv_.end()) { ++ready_cnt; }
+    if (ready_cnt < keys.size()) { VLOG(3) << "waiting for key: " << keys.at(ready_cnt); }
+    return ready_cnt == keys.size();
+  });
+  vals->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) { vals->at(i) = kv_.at(keys.at(i)); }
+}
+
+void LocalCtrlClient::PushPrefixKV(const std::string& prefix, const std::string& k,
+                                   const std::string& v) {
+  PushKV(prefix + k, v);
+}
+
+void LocalCtrlClient::PullKVByPrefix(const std::string& prefix, int32_t num,
+                                     HashMap<std::string, std::string>* kvs) {
+  std::unique_lock<std::mutex> lck(kv_mtx_);
+  while (true) {
+    kvs->clear();
+    for (const auto& pair : kv_) {
+      if (pair.first.compare(0, prefix.size(), prefix) == 0) {
+        kvs->emplace(pair.first.substr(prefix.size()), pair.second);
+      }
+    }
+    if (kvs->size() >= static_cast<size_t>(num)) { break; }
+    VLOG(3) << "waiting for " << num << " keys with prefix: " << prefix;
+    kv_cv_.wait(lck);
+  }
+}
+
+void LocalCtrlClient::ClearKVByPrefix(const std::string& prefix) {
+  std::unique_lock<std::mutex> lck(kv_mtx_);
+  for (auto it = kv_.begin(); it != kv_.end();) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) {
+      it = kv_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void LocalCtrlClient::Clear() {
   {
     std::unique_lock<std::mutex> lck(done_names_mtx_);
@@ -211,6 +262,23 @@ class DryRunCtrlClient : public CtrlClient {
   void PullMasterKV(const std::string& k, PbMessage* msg) override {
     local_ctrl_client_->PullMasterKV(k, msg);
   }
+  void BatchPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) override {
+    local_ctrl_client_->BatchPushKV(kvs);
+  }
+  void BatchPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) override {
+    local_ctrl_client_->BatchPullKV(keys, vals);
+  }
+  void PushPrefixKV(const std::string& prefix, const std::string& k,
+                    const std::string& v) override {
+    local_ctrl_client_->PushPrefixKV(prefix, k, v);
+  }
+  void PullKVByPrefix(const std::string& prefix, int32_t num,
+                      HashMap<std::string, std::string>* kvs) override {
+    local_ctrl_client_->PullKVByPrefix(prefix, num, kvs);
+  }
+  void ClearKVByPrefix(const std::string& prefix) override {
+    local_ctrl_client_->ClearKVByPrefix(prefix);
+  }
   void Clear() override { local_ctrl_client_->Clear(); }
   int32_t IncreaseCount(const std::string& k, int32_t v) override {
     return local_ctrl_client_->IncreaseCount(k, v);
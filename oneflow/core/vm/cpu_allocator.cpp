@@ -13,18 +13,22 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
-#include <cstdlib>
 #include "oneflow/core/vm/cpu_allocator.h"
 #include "oneflow/core/common/util.h"
+#include "oneflow/core/ep/cpu/numa_host_allocator.h"
 
 namespace oneflow {
 namespace vm {
 
 void CpuAllocator::Allocate(char** mem_ptr, std::size_t size) {
-  *mem_ptr = reinterpret_cast<char*>(aligned_alloc(kHostAlignSize, size));
+  // Called by the cpu stream's worker thread, so large blocks land on its NUMA node.
+  *mem_ptr = reinterpret_cast<char*>(
+      ep::NumaHostAllocator::Get()->Allocate(size, kHostAlignSize, /*numa_node=*/-1));
 }
 
-void CpuAllocator::Deallocate(char* mem_ptr, std::size_t size) { std::free(mem_ptr); }
+void CpuAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  ep::NumaHostAllocator::Get()->Deallocate(mem_ptr);
+}
 
 COMMAND(Global<CpuAllocator>::SetAllocated(new CpuAllocator()));
 
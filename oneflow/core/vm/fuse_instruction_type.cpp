@@ -45,6 +45,14 @@ class FuseInstructionType : public vm::InstructionType {
     last_instr_msg->instr_type_id().instruction_type().InitInstructionStatusIf(instruction);
   }
 
+  void Prefetch(const InstructionMsg& instr_msg) const override {
+    auto* ptr = dynamic_cast<vm::FusePhyInstrOperand*>(instr_msg.phy_instr_operand().get());
+    auto* instr_msg_list = CHECK_NOTNULL(ptr)->mut_instr_msg_list();
+    INTRUSIVE_UNSAFE_FOR_EACH_PTR(sub_instr_msg, instr_msg_list) {
+      sub_instr_msg->instr_type_id().instruction_type().Prefetch(*sub_instr_msg);
+    }
+  }
+
   void Compute(vm::Instruction* instruction) const override {
     const auto& phy_instr_operand = instruction->instr_msg().phy_instr_operand();
     auto* ptr = dynamic_cast<vm::FusePhyInstrOperand*>(phy_instr_operand.get());
@@ -45,9 +45,13 @@ class InstructionMsg final : public intrusive::Base {
   }
   const std::shared_ptr<PhyInstrOperand>& phy_instr_operand() const { return phy_instr_operand_; }
   Stream* phy_instr_stream() const { return phy_instr_stream_; }
+  int64_t receive_time_ns() const { return receive_time_ns_; }
+  int64_t dispatch_time_ns() const { return dispatch_time_ns_; }
   // Setters
   std::string* mut_instr_type_name() { return &instr_type_name_; }
   InstrTypeId* mut_instr_type_id() { return &instr_type_id_; }
+  void set_receive_time_ns(int64_t val) { receive_time_ns_ = val; }
+  void set_dispatch_time_ns(int64_t val) { dispatch_time_ns_ = val; }
 
   // methods
   void __Init__();
@@ -74,6 +78,8 @@ class InstructionMsg final : public intrusive::Base {
         phy_instr_parallel_desc_(),
         phy_instr_operand_(),
         phy_instr_stream_(),
+        receive_time_ns_(0),
+        dispatch_time_ns_(0),
         instr_msg_hook_() {}
   intrusive::Ref intrusive_ref_;
   // fields
@@ -83,6 +89,9 @@ class InstructionMsg final : public intrusive::Base {
   std::shared_ptr<const ParallelDesc> phy_instr_parallel_desc_;
   std::shared_ptr<PhyInstrOperand> phy_instr_operand_;
   Stream* phy_instr_stream_;
+  // timestamps for vm telemetry, zero if not recorded.
+  int64_t receive_time_ns_;
+  int64_t dispatch_time_ns_;
 
  public:
   // list hooks
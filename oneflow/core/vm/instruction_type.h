@@ -42,6 +42,9 @@ class InstructionType {
   virtual void Compute(Instruction* instruction) const = 0;
 
   virtual void ComputeInFuseMode(InstructionMsg* instr_msg) const { LOG(FATAL) << "UNIMPLEMENTED"; }
+  // Called on the scheduler thread when an instruction is handed to its worker thread, ahead of
+  // Compute.
+  virtual void Prefetch(const InstructionMsg& instr_msg) const {}
   void InitInstructionStatusIf(Instruction* instruction) const {
     InitInstructionStatus(instruction);
   }
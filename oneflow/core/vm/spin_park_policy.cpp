@@ -0,0 +1,174 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/spin_park_policy.h"
+#include <ctime>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+#include "oneflow/core/common/env_var/env_var.h"
+#include "oneflow/core/common/str_util.h"
+
+namespace oneflow {
+namespace vm {
+
+constexpr int SpinParkPolicy::kBucketNum;
+constexpr double SpinParkPolicy::kSpinHitRatio;
+constexpr double SpinParkPolicy::kMinSpinHitRatio;
+constexpr int SpinParkPolicy::kDecayPeriod;
+
+int64_t ThisThreadCpuTimeNs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) { return 0; }
+  return static_cast<int64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+#else
+  return 0;
+#endif  // CLOCK_THREAD_CPUTIME_ID
+}
+
+Maybe<std::vector<int>> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::vector<std::string> ranges;
+  Split(cpu_list, ",", [&](std::string&& range) {
+    if (!range.empty()) { ranges.emplace_back(std::move(range)); }
+  });
+  for (const auto& range : ranges) {
+    const size_t dash = range.find('-');
+    int first = 0;
+    int last = 0;
+    try {
+      first = std::stoi(range.substr(0, dash));
+      last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    } catch (const std::exception&) {
+      return Error::InvalidValueError("invalid cpu list: " + cpu_list);
+    }
+    CHECK_OR_RETURN(first >= 0 && first <= last) << "invalid cpu range " << range << " in "
+                                                 << cpu_list;
+    for (int cpu = first; cpu <= last; ++cpu) { cpus.emplace_back(cpu); }
+  }
+  return cpus;
+}
+
+Maybe<void> PinThisThreadToCpus(const std::vector<int>& cpus) {
+  if (cpus.empty()) { return Maybe<void>::Ok(); }
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    CHECK_LT_OR_RETURN(cpu, CPU_SETSIZE);
+    CPU_SET(cpu, &cpu_set);
+  }
+  const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+  CHECK_EQ_OR_RETURN(ret, 0) << "pthread_setaffinity_np failed with error code " << ret;
+#else
+  LOG(WARNING) << "pinning vm threads is only supported on linux";
+#endif  // __linux__
+  return Maybe<void>::Ok();
+}
+
+namespace {
+
+int IdleBucketIndex(int64_t idle_us) {
+  int index = 0;
+  uint64_t value = idle_us > 0 ? static_cast<uint64_t>(idle_us) : 0;
+  while (value > 0 && index < SpinParkPolicy::kBucketNum - 1) {
+    value >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+// Bucket i holds idle gaps in [2^(i-1), 2^i) microseconds.
+int64_t IdleBucketUpperBoundUs(int index) { return static_cast<int64_t>(1) << index; }
+
+}  // namespace
+
+SpinParkPolicy::SpinParkPolicy(int64_t max_spin_us, ThreadTelemetry* thread_telemetry)
+    : SpinParkPolicy(max_spin_us, EnvBool<ONEFLOW_VM_ADAPTIVE_SPIN>(), thread_telemetry) {}
+
+SpinParkPolicy::SpinParkPolicy(int64_t max_spin_us, bool adaptive,
+                               ThreadTelemetry* thread_telemetry)
+    : max_spin_us_(std::max<int64_t>(max_spin_us, 0)),
+      adaptive_(adaptive),
+      thread_telemetry_(thread_telemetry),
+      spin_us_(max_spin_us_),
+      idle_begin_us_(SpinParkNowUs()),
+      last_cpu_time_ns_(ThisThreadCpuTimeNs()),
+      observed_cnt_(0),
+      buckets_() {
+  // Spin optimistically until the first gaps are learned.
+  if (thread_telemetry_ != nullptr) { thread_telemetry_->spin_budget_us.Add(spin_us_); }
+}
+
+void SpinParkPolicy::OnSpinFinished(int64_t spin_us, bool hit) {
+  if (thread_telemetry_ != nullptr) {
+    thread_telemetry_->spin_us.Add(spin_us);
+    if (hit) {
+      thread_telemetry_->spin_hit_cnt.Add(1);
+    } else {
+      thread_telemetry_->spin_miss_cnt.Add(1);
+    }
+  }
+  if (hit) { ObserveIdle(spin_us); }
+}
+
+void SpinParkPolicy::OnPark() {
+  if (thread_telemetry_ == nullptr) { return; }
+  thread_telemetry_->park_cnt.Add(1);
+  const int64_t cpu_time_ns = ThisThreadCpuTimeNs();
+  thread_telemetry_->cpu_ns.Add(cpu_time_ns - last_cpu_time_ns_);
+  last_cpu_time_ns_ = cpu_time_ns;
+}
+
+void SpinParkPolicy::OnWakeUp(bool has_work) {
+  if (has_work) { ObserveIdle(SpinParkNowUs() - idle_begin_us_); }
+}
+
+void SpinParkPolicy::ObserveIdle(int64_t idle_us) {
+  if (!adaptive_) { return; }
+  buckets_[IdleBucketIndex(idle_us)] += 1;
+  if (++observed_cnt_ % kDecayPeriod == 0) {
+    // Forget old gaps so that the policy follows changes of the workload.
+    for (auto& bucket : buckets_) { bucket /= 2; }
+  }
+  UpdateSpinUs();
+}
+
+void SpinParkPolicy::UpdateSpinUs() {
+  double total = 0;
+  for (double bucket : buckets_) { total += bucket; }
+  double acc = 0;
+  int64_t spin_us = 0;
+  for (int i = 0; i < kBucketNum; ++i) {
+    acc += buckets_[i];
+    const int64_t upper_bound_us = IdleBucketUpperBoundUs(i);
+    if (upper_bound_us > max_spin_us_) {
+      // Spinning up to max_spin_us_ still catches most gaps.
+      if (acc - buckets_[i] >= kMinSpinHitRatio * total) { spin_us = max_spin_us_; }
+      break;
+    }
+    if (acc >= kSpinHitRatio * total) {
+      spin_us = upper_bound_us;
+      break;
+    }
+  }
+  if (thread_telemetry_ != nullptr) { thread_telemetry_->spin_budget_us.Add(spin_us - spin_us_); }
+  spin_us_ = spin_us;
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,121 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_SPIN_PARK_POLICY_H_
+#define ONEFLOW_CORE_VM_SPIN_PARK_POLICY_H_
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/vm/vm_telemetry.h"
+
+namespace oneflow {
+namespace vm {
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline int64_t SpinParkNowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// CPU time consumed by the calling thread, in nanoseconds.
+int64_t ThisThreadCpuTimeNs();
+
+// Parses cpu lists like "0-3,8". An empty string yields an empty list.
+Maybe<std::vector<int>> ParseCpuList(const std::string& cpu_list);
+// Binds the calling thread to `cpus`. Does nothing if `cpus` is empty.
+Maybe<void> PinThisThreadToCpus(const std::vector<int>& cpus);
+
+// Decides how long a vm thread busy-waits for new work before parking on its notifier.
+//
+// Spinning saves the wake-up latency of a condition variable (several to tens of microseconds)
+// but burns a core. The policy keeps a decaying log2 histogram of the idle gaps a thread observed
+// between running out of work and getting new work, and spins just long enough to catch
+// kSpinHitRatio of them. If most gaps are longer than `max_spin_us`, the thread parks at once
+// and gives the core back. Gaps observed after parking are learned as well, so a thread that
+// stopped spinning starts again once work arrives back-to-back.
+//
+// With ONEFLOW_VM_ADAPTIVE_SPIN=0 the thread always spins `max_spin_us`.
+class SpinParkPolicy final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SpinParkPolicy);
+  SpinParkPolicy(int64_t max_spin_us, ThreadTelemetry* thread_telemetry);
+  SpinParkPolicy(int64_t max_spin_us, bool adaptive, ThreadTelemetry* thread_telemetry);
+  ~SpinParkPolicy() = default;
+
+  static constexpr int kBucketNum = 24;
+  static constexpr double kSpinHitRatio = 0.9;
+  static constexpr double kMinSpinHitRatio = 0.5;
+  static constexpr int kDecayPeriod = 64;
+
+  int64_t spin_us() const { return spin_us_; }
+
+  // Called when the thread runs out of work. Busy-waits until `HasWork` returns true or the spin
+  // budget runs out. Returns true if new work arrived, in which case the thread should not park.
+  template<typename HasWorkT>
+  bool SpinUntil(const HasWorkT& HasWork) {
+    idle_begin_us_ = SpinParkNowUs();
+    if (spin_us_ <= 0) { return HasWork(); }
+    int64_t now_us = idle_begin_us_;
+    const int64_t deadline_us = idle_begin_us_ + spin_us_;
+    bool has_work = false;
+    while (true) {
+      if (HasWork()) {
+        has_work = true;
+        break;
+      }
+      CpuRelax();
+      now_us = SpinParkNowUs();
+      if (now_us >= deadline_us) { break; }
+    }
+    OnSpinFinished(now_us - idle_begin_us_, has_work);
+    return has_work;
+  }
+  // Called right before parking.
+  void OnPark();
+  // Called right after the thread is woken up. `has_work` tells a real notification from a stale
+  // one.
+  void OnWakeUp(bool has_work);
+  // Learns an idle gap of `idle_us` microseconds.
+  void ObserveIdle(int64_t idle_us);
+
+ private:
+  void OnSpinFinished(int64_t spin_us, bool hit);
+  void UpdateSpinUs();
+
+  const int64_t max_spin_us_;
+  const bool adaptive_;
+  ThreadTelemetry* thread_telemetry_;
+  int64_t spin_us_;
+  int64_t idle_begin_us_;
+  int64_t last_cpu_time_ns_;
+  int64_t observed_cnt_;
+  std::array<double, kBucketNum> buckets_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_SPIN_PARK_POLICY_H_
@@ -0,0 +1,74 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/vm/spin_park_policy.h"
+
+namespace oneflow {
+namespace vm {
+
+TEST(SpinParkPolicy, learn_short_gaps) {
+  SpinParkPolicy policy(1000, /*adaptive=*/true, nullptr);
+  ASSERT_EQ(policy.spin_us(), 1000);
+  for (int i = 0; i < 100; ++i) { policy.ObserveIdle(5); }
+  // 5us falls in [4, 8).
+  ASSERT_EQ(policy.spin_us(), 8);
+}
+
+TEST(SpinParkPolicy, park_on_long_gaps) {
+  SpinParkPolicy policy(1000, /*adaptive=*/true, nullptr);
+  for (int i = 0; i < 100; ++i) { policy.ObserveIdle(5); }
+  for (int i = 0; i < 200; ++i) { policy.ObserveIdle(100 * 1000); }
+  ASSERT_EQ(policy.spin_us(), 0);
+  // Spinning again once instructions arrive back-to-back.
+  for (int i = 0; i < 200; ++i) { policy.ObserveIdle(20); }
+  ASSERT_GT(policy.spin_us(), 0);
+}
+
+TEST(SpinParkPolicy, mixed_gaps) {
+  SpinParkPolicy policy(1000, /*adaptive=*/true, nullptr);
+  for (int i = 0; i < 100; ++i) { policy.ObserveIdle(i % 3 == 0 ? 100 * 1000 : 5); }
+  // Two thirds of the gaps are caught by spinning the longest allowed duration.
+  ASSERT_EQ(policy.spin_us(), 1000);
+}
+
+TEST(SpinParkPolicy, fixed) {
+  SpinParkPolicy policy(1000, /*adaptive=*/false, nullptr);
+  for (int i = 0; i < 100; ++i) { policy.ObserveIdle(100 * 1000); }
+  ASSERT_EQ(policy.spin_us(), 1000);
+}
+
+TEST(SpinParkPolicy, spin_until) {
+  ThreadTelemetry telemetry("test");
+  SpinParkPolicy policy(10, /*adaptive=*/false, &telemetry);
+  ASSERT_TRUE(policy.SpinUntil([]() { return true; }));
+  ASSERT_FALSE(policy.SpinUntil([]() { return false; }));
+  ASSERT_EQ(telemetry.spin_hit_cnt.Get(), 1);
+  ASSERT_EQ(telemetry.spin_miss_cnt.Get(), 1);
+  ASSERT_GE(telemetry.spin_us.Get(), 10);
+  policy.OnPark();
+  ASSERT_EQ(telemetry.park_cnt.Get(), 1);
+}
+
+TEST(SpinParkPolicy, parse_cpu_list) {
+  ASSERT_TRUE(CHECK_JUST(ParseCpuList(""))->empty());
+  const auto& cpus = CHECK_JUST(ParseCpuList("0-2,5"));
+  ASSERT_EQ(*cpus, (std::vector<int>{0, 1, 2, 5}));
+  ASSERT_FALSE(ParseCpuList("a").IsOk());
+  ASSERT_FALSE(ParseCpuList("3-1").IsOk());
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/vm/stream_desc.h"
 #include "oneflow/core/vm/instruction.h"
 #include "oneflow/core/device/device_context.h"
+#include "oneflow/core/vm/vm_telemetry.h"
 
 namespace oneflow {
 namespace vm {
@@ -45,6 +46,7 @@ class Stream final : public intrusive::Base {
     return running_instruction_list_;
   }
   const StreamId& stream_id() const { return stream_id_.key(); }
+  const StreamTelemetry& telemetry() const { return telemetry_; }
 
   // Setters
   void set_max_device_num_per_machine(int64_t val) { max_device_num_per_machine_ = val; }
@@ -56,6 +58,7 @@ class Stream final : public intrusive::Base {
   DispatchedInstructionList* mut_zombie_instruction_list() { return &zombie_instruction_list_; }
   DispatchedInstructionList* mut_running_instruction_list() { return &running_instruction_list_; }
   StreamId* mut_stream_id() { return stream_id_.mut_key(); }
+  StreamTelemetry* mut_telemetry() { return &telemetry_; }
 
   // methods
   void __Init__();
@@ -84,6 +87,7 @@ class Stream final : public intrusive::Base {
         free_instruction_list_(),
         zombie_instruction_list_(),
         running_instruction_list_(),
+        telemetry_(),
         stream_id_(),
         active_stream_hook_(),
         thread_ctx_stream_hook_() {}
@@ -96,6 +100,7 @@ class Stream final : public intrusive::Base {
   DispatchedInstructionList free_instruction_list_;
   DispatchedInstructionList zombie_instruction_list_;
   DispatchedInstructionList running_instruction_list_;
+  StreamTelemetry telemetry_;
 
  public:
   // skiplist hooks
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/vm/instruction_type.h"
 #include "oneflow/core/vm/barrier_phy_instr_operand.h"
 #include "oneflow/core/vm/vm_util.h"
+#include "oneflow/core/vm/spin_park_policy.h"
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/cpp_attribute.h"
 #include "oneflow/core/control/global_process_ctx.h"
@@ -35,13 +36,6 @@ namespace oneflow {
 
 namespace {
 
-template<typename T>
-int MicrosecondsFrom(const T& start) {
-  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()
-                                                               - start)
-      .count();
-}
-
 Maybe<void> ForEachThreadCtx(vm::VirtualMachineEngine* vm,
                              const std::function<Maybe<void>(vm::ThreadCtx*)>& DoEach) {
   INTRUSIVE_UNSAFE_FOR_EACH_PTR(thread_ctx, vm->mut_thread_ctx_list()) {
@@ -52,10 +46,16 @@ Maybe<void> ForEachThreadCtx(vm::VirtualMachineEngine* vm,
   return Maybe<void>::Ok();
 }
 
+Maybe<void> PinThisThreadToCpusFromEnv(const std::string& env_var) {
+  const auto& cpus = JUST(vm::ParseCpuList(GetStringFromEnv(env_var, "")));
+  return vm::PinThisThreadToCpus(*cpus);
+}
+
 void GetSchedulerThreadInitializer(std::function<void()>* Initializer) {
   *Initializer = [&]() {
     CHECK_JUST(InitThisThreadUniqueConsistentId(kThreadConsistentIdScheduler, "scheduler"));
     OF_PROFILER_NAME_THIS_HOST_THREAD("_VM::Scheduler");
+    CHECK_JUST(PinThisThreadToCpusFromEnv("ONEFLOW_VM_SCHEDULER_CPUS"));
   };
 }
 
@@ -102,10 +102,21 @@ void GetWorkerThreadInitializer(intrusive::shared_ptr<vm::VirtualMachineEngine>
   };
 }
 
-void WorkerLoop(vm::ThreadCtx* thread_ctx, const std::function<void(vm::ThreadCtx*)>& Initializer) {
+void WorkerLoop(vm::ThreadCtx* thread_ctx, vm::ThreadTelemetry* thread_telemetry,
+                const std::function<void(vm::ThreadCtx*)>& Initializer) {
   Initializer(thread_ctx);
+  CHECK_JUST(PinThisThreadToCpusFromEnv("ONEFLOW_VM_WORKER_CPUS"));
+  vm::SpinParkPolicy spin_park_policy(EnvInteger<ONEFLOW_VM_WORKER_MAX_SPIN_MICROSECONDS>(),
+                                      thread_telemetry);
+  const auto& HasWork = [thread_ctx]() {
+    return thread_ctx->mut_pending_instruction_list()->thread_unsafe_size() > 0;
+  };
   while (thread_ctx->mut_notifier()->WaitAndClearNotifiedCnt() == kNotifierStatusSuccess) {
-    while (thread_ctx->TryReceiveAndRun()) {}
+    spin_park_policy.OnWakeUp(HasWork());
+    do {
+      while (thread_ctx->TryReceiveAndRun()) {}
+    } while (spin_park_policy.SpinUntil(HasWork));
+    spin_park_policy.OnPark();
   }
 }
 
@@ -122,8 +133,13 @@ VirtualMachine::VirtualMachine(const Resource& resource, int64_t this_machine_id
   OF_PROFILER_NAME_THIS_HOST_THREAD("_Main");
   std::function<void(vm::ThreadCtx*)> WorkerInitializer;
   GetWorkerThreadInitializer(vm_, &WorkerInitializer);
+  HashMap<std::string, int64_t> stream_tag2worker_cnt;
   CHECK_JUST(ForEachThreadCtx(vm_.Mutable(), [&](vm::ThreadCtx* thread_ctx) -> Maybe<void> {
-    auto thread = std::make_unique<std::thread>(&WorkerLoop, thread_ctx, WorkerInitializer);
+    const std::string stream_tag = thread_ctx->stream_rt_desc().stream_type().stream_tag();
+    auto* thread_telemetry = mut_vm()->mut_telemetry()->RegisterThread(
+        "worker:" + stream_tag + ":" + std::to_string(stream_tag2worker_cnt[stream_tag]++));
+    auto thread = std::make_unique<std::thread>(&WorkerLoop, thread_ctx, thread_telemetry,
+                                                WorkerInitializer);
     worker_threads_.push_back(std::move(thread));
     return Maybe<void>::Ok();
   }));
@@ -292,36 +308,44 @@ void VirtualMachine::ScheduleLoop(const std::function<void()>& Initializer) {
   Initializer();
   MultiThreadScheduleCtx schedule_ctx(&callback_notifier_);
   auto* vm = mut_vm();
+  auto* telemetry = vm->mut_telemetry();
+  const int64_t dump_interval_ns = vm::VmTelemetryDumpIntervalSeconds() * 1000 * 1000 * 1000;
+  int64_t last_dump_ns = vm::VmTelemetryNowNs();
+  int64_t park_ns = last_dump_ns;
+  vm::SpinParkPolicy spin_park_policy(EnvInteger<ONEFLOW_VM_SCHEDULER_MAX_SPIN_MICROSECONDS>(),
+                                      telemetry->RegisterThread("scheduler"));
+  // Use SchedulerThreadUnsafeEmpty to avoid acquiring mutex lock.
+  // It's safe to use SchedulerThreadUnsafeEmpty here. pending_notifier_.notified_cnt_ will be
+  // greater than zero when inconsistency between
+  // vm->pending_msg_list.list_head_.list_head_.container_ and
+  // vm->pending_msg_list.list_head_.list_head_.size_ occured. hence the pending instructions
+  // will get handled in the next iteration.
+  //  VirtualMachine::Receive may be less effiencient if the thread safe version
+  //  `vm->SchedulerEmpty()` used here, because VirtualMachine::ScheduleLoop is more likely to get
+  //  the mutex lock.
+  const auto& HasWork = [vm]() { return !vm->SchedulerThreadUnsafeEmpty(); };
   while (pending_notifier_.WaitAndClearNotifiedCnt() == kNotifierStatusSuccess) {
     OF_PROFILER_RANGE_GUARD("VirtualMachine::ScheduleLoop");
-    auto start = std::chrono::steady_clock::now();
-    static constexpr int kWorkingMicroseconds = 1000;
-    // Every time this thread wakes up, vm is scheduled for about `kWorkingMicroseconds`.
-    // The cost of os thread switching is about 5-10 microseconds. Doing more scheduling in
-    // a single waiting up can reach higher performance.
+    const int64_t wakeup_ns = vm::VmTelemetryNowNs();
+    telemetry->OnSchedulerIdle(wakeup_ns - park_ns);
+    spin_park_policy.OnWakeUp(HasWork());
+    int64_t busy_ns = 0;
+    // Instead of parking as soon as the vm is empty, spin for a while to catch the next
+    // instructions. The cost of os thread switching is about 5-10 microseconds, the spin duration
+    // is learned from the idle gaps between instructions, see SpinParkPolicy.
     do {
-      static constexpr int kNumSchedulingPerTimoutTest = 10000;
-      // Every time kWorkingMicroseconds timeout tested, vm is scheduled for about
-      // kNumSchedulingPerTimoutTest.
-      // The cost of `MicrosecondsFrom(start)` is about 400ns, while the empty scheduling costs
-      // about 10ns.
-      int i = 0;
-      do {
-        // Use SchedulerThreadUnsafeEmpty to avoid acquiring mutex lock.
-        // It's safe to use SchedulerThreadUnsafeEmpty here. pending_notifier_.notified_cnt_ will be
-        // greater than zero when inconsistency between
-        // vm->pending_msg_list.list_head_.list_head_.container_ and
-        // vm->pending_msg_list.list_head_.list_head_.size_ occured. hence the pending
-        // instructions
-        // will get handled in the next iteration.
-        //  VirtualMachine::Receive may be less effiencient if the thread safe version
-        //  `vm->SchedulerEmpty()`
-        // used
-        //  here, because VirtualMachine::ScheduleLoop is more likely to get the mutex lock.
-        do { vm->Schedule(schedule_ctx); } while (!vm->SchedulerThreadUnsafeEmpty());
-        vm->FlushGarbageInstructions(schedule_ctx);
-      } while (++i < kNumSchedulingPerTimoutTest);
-    } while (MicrosecondsFrom(start) < kWorkingMicroseconds);
+      const int64_t busy_start_ns = vm::VmTelemetryNowNs();
+      do { vm->Schedule(schedule_ctx); } while (HasWork());
+      vm->FlushGarbageInstructions(schedule_ctx);
+      busy_ns += vm::VmTelemetryNowNs() - busy_start_ns;
+    } while (spin_park_policy.SpinUntil(HasWork));
+    spin_park_policy.OnPark();
+    park_ns = vm::VmTelemetryNowNs();
+    telemetry->OnSchedulerBusy(busy_ns);
+    if (unlikely(dump_interval_ns > 0 && park_ns - last_dump_ns >= dump_interval_ns)) {
+      LOG(INFO) << telemetry->Snapshot().DebugString();
+      last_dump_ns = park_ns;
+    }
   }
   ScheduleUntilVMEmpty(vm, schedule_ctx);
   CHECK_JUST(ForEachThreadCtx(vm_.Mutable(), [&](vm::ThreadCtx* thread_ctx) -> Maybe<void> {
@@ -51,7 +51,7 @@ void VirtualMachineEngine::ReleaseInstruction(Instruction* instruction) {
     out_instruction->mut_in_edges()->Erase(out_edge);
     if (Dispatchable(out_instruction)) {
       OF_PROFILER_RANGE_GUARD("E:" + out_instruction->instr_msg().DebugName());
-      mut_ready_instruction_list()->PushBack(out_instruction);
+      PushBackReadyInstruction(out_instruction);
     }
   }
 }
@@ -61,7 +61,9 @@ void VirtualMachineEngine::HandleLocalPending() {
   OF_PROFILER_RANGE_GUARD("HandleLocalPending");
   InstructionMsgList pending_instr_msgs;
   constexpr static int kPendingHandleWindow = 10;
+  const size_t local_pending_msg_cnt = local_pending_msg_list().size();
   GetRewritedPendingInstructionsByWindowSize(kPendingHandleWindow, &pending_instr_msgs);
+  telemetry_.OnMsgsHandled(local_pending_msg_cnt - local_pending_msg_list().size());
   InstructionList new_instruction_list;
   INTRUSIVE_FOR_EACH_PTR(instr_msg, &pending_instr_msgs) {
     MakeInstructions(instr_msg, /*out*/ &new_instruction_list);
@@ -69,7 +71,7 @@ void VirtualMachineEngine::HandleLocalPending() {
   INTRUSIVE_FOR_EACH_PTR(instruction, &new_instruction_list) {
     ConsumeMirroredObjects(instruction);
     if (likely(Dispatchable(instruction))) {
-      mut_ready_instruction_list()->PushBack(instruction);
+      PushBackReadyInstruction(instruction);
       new_instruction_list.Erase(instruction);
     }
   }
@@ -106,10 +108,14 @@ void VirtualMachineEngine::MakeAndAppendFusedInstruction(
     return;
   }
   auto* begin = fused_instr_msg_list.Begin();
+  const int64_t receive_time_ns = begin->receive_time_ns();
+  telemetry_.OnMsgsFused(fused_instr_msg_list.size());
   auto phy_instr_operand = std::make_shared<FusePhyInstrOperand>(std::move(fused_instr_msg_list));
   const auto* stream_tag = begin->phy_instr_stream()->stream_type().stream_tag();
   auto instr_msg = intrusive::make_shared<InstructionMsg>(
       this, std::string(stream_tag) + ".Fuse", begin->phy_instr_parallel_desc(), phy_instr_operand);
+  // The fused instruction is considered received as early as its first instruction.
+  instr_msg->set_receive_time_ns(receive_time_ns);
   pending_instr_msgs->EmplaceBack(std::move(instr_msg));
 }
 
@@ -179,10 +185,17 @@ intrusive::shared_ptr<Instruction> VirtualMachineEngine::LivelyInstructionListEr
 // Collect ready instructions onto ready_instruction_list_
 void VirtualMachineEngine::ReleaseFinishedInstructions(const ScheduleCtx& schedule_ctx) {
   OF_PROFILER_RANGE_PUSH("ReleaseFinishedInstructions");
+  const int64_t now_ns = telemetry_.enabled() ? VmTelemetryNowNs() : 0;
   INTRUSIVE_FOR_EACH_PTR(stream, mut_active_stream_list()) {
     while (true) {
       auto* instruction_ptr = stream->mut_running_instruction_list()->Begin();
       if (instruction_ptr == nullptr || !instruction_ptr->Done()) { break; }
+      stream->mut_telemetry()->running.Add(-1);
+      if (telemetry_.enabled()) {
+        const auto& done_instr_msg = instruction_ptr->instr_msg();
+        MutInstrTypeTelemetry(done_instr_msg)
+            ->dispatch_to_done.Record(now_ns - done_instr_msg.dispatch_time_ns());
+      }
       ReleaseInstruction(instruction_ptr);
       stream->mut_running_instruction_list()->Erase(instruction_ptr);
       // By referencing `instruction_ptr->mut_instr_msg()`, we can avoid instr_msg being destructed
@@ -217,6 +230,7 @@ void VirtualMachineEngine::MakeInstructions(InstructionMsg* instr_msg,
   Stream* stream = CHECK_NOTNULL(instr_msg->phy_instr_stream());
   const auto& pd = instr_msg->phy_instr_parallel_desc();
   intrusive::shared_ptr<Instruction> instr = stream->NewInstruction(instr_msg, pd);
+  stream->mut_telemetry()->waiting.Add(1);
   LivelyInstructionListPushBack(instr.Mutable());
   if (unlikely(is_barrier_instruction)) {
     mut_barrier_instruction_list()->PushBack(instr.Mutable());
@@ -319,21 +333,47 @@ void VirtualMachineEngine::DispatchAndPrescheduleInstructions(const ScheduleCtx&
       auto* out_instruction = edge->mut_dst_instruction();
       if (Dispatchable(out_instruction)) {
         OF_PROFILER_RANGE_GUARD("P:" + out_instruction->instr_msg().DebugName());
-        mut_ready_instruction_list()->PushBack(out_instruction);
+        PushBackReadyInstruction(out_instruction);
       }
     }
   }
 }
 
+void VirtualMachineEngine::PushBackReadyInstruction(Instruction* instruction) {
+  auto* stream_telemetry = instruction->mut_stream()->mut_telemetry();
+  stream_telemetry->waiting.Add(-1);
+  stream_telemetry->ready.Add(1);
+  mut_ready_instruction_list()->PushBack(instruction);
+}
+
+InstrTypeTelemetry* VirtualMachineEngine::MutInstrTypeTelemetry(const InstructionMsg& instr_msg) {
+  return telemetry_.MutInstrTypeTelemetry(&instr_msg.instr_type_id().instruction_type(),
+                                          instr_msg.instr_type_name());
+}
+
 void VirtualMachineEngine::DispatchInstruction(Instruction* instruction,
                                                const ScheduleCtx& schedule_ctx) {
   auto* stream = instruction->mut_stream();
+  auto* stream_telemetry = stream->mut_telemetry();
+  stream_telemetry->ready.Add(-1);
+  stream_telemetry->running.Add(1);
+  stream_telemetry->dispatched.Add(1);
+  if (telemetry_.enabled()) {
+    auto* instr_msg = instruction->mut_instr_msg();
+    const int64_t now_ns = VmTelemetryNowNs();
+    instr_msg->set_dispatch_time_ns(now_ns);
+    if (likely(instr_msg->receive_time_ns() > 0)) {
+      MutInstrTypeTelemetry(*instr_msg)
+          ->receive_to_dispatch.Record(now_ns - instr_msg->receive_time_ns());
+    }
+  }
   stream->mut_running_instruction_list()->PushBack(instruction);
   if (stream->active_stream_hook().empty()) { mut_active_stream_list()->PushBack(stream); }
   const auto& stream_type = stream->stream_type();
   if (OnSchedulerThread(stream_type)) {
     stream_type.Run(instruction);
   } else {
+    instruction->instr_msg().instr_type_id().instruction_type().Prefetch(instruction->instr_msg());
     stream->mut_thread_ctx()->mut_pending_instruction_list()->PushBack(instruction);
     schedule_ctx.OnWorkerLoadPending(stream->mut_thread_ctx());
   }
@@ -359,6 +399,9 @@ void VirtualMachineEngine::__Init__(const VmDesc& vm_desc) {
             thread_ctx.Mutable(), stream_id, vm_resource_desc().max_device_num_per_machine());
         stream_rt_desc->add_stream(stream);
         thread_ctx->mut_stream_list()->PushBack(stream.Mutable());
+        mut_telemetry()->RegisterStream(
+            std::string(stream->stream_type().stream_tag()) + ":" + std::to_string(j),
+            &stream->telemetry());
       }
     }
   }
@@ -394,7 +437,9 @@ int64_t InstructionMaxRunningSeconds() { return 60 * 5; }
 // Returns true if old pending_instruction_list is empty
 Maybe<bool> VirtualMachineEngine::Receive(InstructionMsgList* compute_instr_msg_list) {
   OF_PROFILER_RANGE_GUARD("vm:Receive");
+  const int64_t now_ns = telemetry_.enabled() ? VmTelemetryNowNs() : 0;
   INTRUSIVE_UNSAFE_FOR_EACH_PTR(compute_instr_msg, compute_instr_msg_list) {
+    compute_instr_msg->set_receive_time_ns(now_ns);
     OF_PROFILER_RANGE_PUSH(compute_instr_msg->DebugName());
     OF_PROFILER_RANGE_POP();
   }
@@ -485,7 +530,20 @@ void VirtualMachineEngine::TryRunBarrierInstruction(const ScheduleCtx& schedule_
   CHECK(instruction_type.IsFrontSequential());
   const StreamType& stream_type = instr_type_id.stream_type();
   CHECK(OnSchedulerThread(stream_type));
+  auto* stream_telemetry = sequnential_instruction->mut_stream()->mut_telemetry();
+  stream_telemetry->waiting.Add(-1);
+  stream_telemetry->dispatched.Add(1);
+  const int64_t dispatch_time_ns = telemetry_.enabled() ? VmTelemetryNowNs() : 0;
   stream_type.Run(sequnential_instruction);
+  if (telemetry_.enabled()) {
+    const auto& instr_msg = sequnential_instruction->instr_msg();
+    auto* instr_type_telemetry = MutInstrTypeTelemetry(instr_msg);
+    if (likely(instr_msg.receive_time_ns() > 0)) {
+      instr_type_telemetry->receive_to_dispatch.Record(dispatch_time_ns
+                                                       - instr_msg.receive_time_ns());
+    }
+    instr_type_telemetry->dispatch_to_done.Record(VmTelemetryNowNs() - dispatch_time_ns);
+  }
   mut_barrier_instruction_list()->Erase(sequnential_instruction);
   intrusive::shared_ptr<InstructionMsg> instr_msg(sequnential_instruction->mut_instr_msg());
   LivelyInstructionListErase(sequnential_instruction, schedule_ctx);
@@ -30,6 +30,7 @@ limitations under the License.
 #include "oneflow/core/intrusive/mutexed_list.h"
 #include "oneflow/core/intrusive/object_pool.h"
 #include "oneflow/core/vm/probe.h"
+#include "oneflow/core/vm/vm_telemetry.h"
 
 namespace oneflow {
 
@@ -87,6 +88,7 @@ class VirtualMachineEngine final : public intrusive::Base {
   const StreamType2StreamRtDesc& stream_type2stream_rt_desc() const {
     return stream_type2stream_rt_desc_;
   }
+  const VmTelemetry& telemetry() const { return telemetry_; }
   // Setters
   VmResourceDesc* mut_vm_resource_desc() {
     if (!vm_resource_desc_) { vm_resource_desc_ = intrusive::make_shared<VmResourceDesc>(); }
@@ -101,6 +103,7 @@ class VirtualMachineEngine final : public intrusive::Base {
   InstructionMsgList* mut_local_pending_msg_list() { return &local_pending_msg_list_; }
   InstructionMsgMutexedList* mut_garbage_msg_list() { return &garbage_msg_list_; }
   StreamType2StreamRtDesc* mut_stream_type2stream_rt_desc() { return &stream_type2stream_rt_desc_; }
+  VmTelemetry* mut_telemetry() { return &telemetry_; }
 
   // methods
   void __Init__(const VmDesc& vm_desc);
@@ -132,6 +135,8 @@ class VirtualMachineEngine final : public intrusive::Base {
       intrusive::List<INTRUSIVE_FIELD(Instruction, dispatched_instruction_hook_)>;
 
   ReadyInstructionList* mut_ready_instruction_list() { return &ready_instruction_list_; }
+  void PushBackReadyInstruction(Instruction* instruction);
+  InstrTypeTelemetry* MutInstrTypeTelemetry(const InstructionMsg& instr_msg);
 
   void ReleaseFinishedInstructions(const ScheduleCtx& schedule_ctx);
   void HandleLocalPending();
@@ -228,6 +233,7 @@ class VirtualMachineEngine final : public intrusive::Base {
   std::map<std::string, RtInstrTypeId> instr_type_name2rt_instr_type_id_;
   DependenceAccess::object_pool_type access_pool_;
   InstructionEdge::object_pool_type instruction_edge_pool_;
+  VmTelemetry telemetry_;
 };
 
 }  // namespace vm
@@ -0,0 +1,202 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/vm_telemetry.h"
+#include <chrono>
+#include <sstream>
+
+namespace oneflow {
+namespace vm {
+
+bool VmTelemetryEnabled() {
+  static const bool enabled = ParseBooleanFromEnv("ONEFLOW_VM_ENABLE_TELEMETRY", true);
+  return enabled;
+}
+
+int64_t VmTelemetryNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t VmTelemetryDumpIntervalSeconds() {
+  static const int64_t interval =
+      std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_VM_TELEMETRY_DUMP_INTERVAL_SECONDS", 0), 0);
+  return interval;
+}
+
+namespace {
+
+int BucketIndex(int64_t latency_ns) {
+  int index = 0;
+  uint64_t value = latency_ns > 0 ? static_cast<uint64_t>(latency_ns) : 0;
+  while (value > 0 && index < LatencyHistogram::kBucketNum - 1) {
+    value >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+int64_t BucketUpperBoundNs(int index) { return static_cast<int64_t>(1) << index; }
+
+std::string FormatNs(int64_t ns) {
+  std::stringstream ss;
+  if (ns >= 1000000) {
+    ss << ns / 1000000.0 << "ms";
+  } else if (ns >= 1000) {
+    ss << ns / 1000.0 << "us";
+  } else {
+    ss << ns << "ns";
+  }
+  return ss.str();
+}
+
+std::string FormatLatency(const LatencySummary& summary) {
+  std::stringstream ss;
+  ss << "count=" << summary.count;
+  if (summary.count > 0) {
+    ss << " mean=" << FormatNs(summary.sum_ns / summary.count)
+       << " p50=" << FormatNs(summary.p50_ns) << " p99=" << FormatNs(summary.p99_ns)
+       << " max=" << FormatNs(summary.max_ns);
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() = default;
+
+void LatencyHistogram::Record(int64_t latency_ns) {
+  if (unlikely(latency_ns < 0)) { latency_ns = 0; }
+  buckets_[BucketIndex(latency_ns)].Add(1);
+  sum_ns_.Add(latency_ns);
+  if (latency_ns > max_ns_.Get()) { max_ns_.Add(latency_ns - max_ns_.Get()); }
+}
+
+LatencySummary LatencyHistogram::Summary() const {
+  std::array<int64_t, kBucketNum> buckets{};
+  int64_t count = 0;
+  for (int i = 0; i < kBucketNum; ++i) {
+    buckets[i] = buckets_[i].Get();
+    count += buckets[i];
+  }
+  LatencySummary summary{};
+  summary.count = count;
+  summary.sum_ns = sum_ns_.Get();
+  summary.max_ns = max_ns_.Get();
+  const auto Percentile = [&](double p) -> int64_t {
+    if (count == 0) { return 0; }
+    const int64_t rank = std::max<int64_t>(static_cast<int64_t>(p * count + 0.5), 1);
+    int64_t acc = 0;
+    for (int i = 0; i < kBucketNum; ++i) {
+      acc += buckets[i];
+      if (acc >= rank) { return std::min(BucketUpperBoundNs(i), summary.max_ns); }
+    }
+    return summary.max_ns;
+  };
+  summary.p50_ns = Percentile(0.5);
+  summary.p99_ns = Percentile(0.99);
+  return summary;
+}
+
+VmTelemetry::VmTelemetry() : enabled_(VmTelemetryEnabled()) {}
+
+void VmTelemetry::RegisterStream(const std::string& name,
+                                 const StreamTelemetry* stream_telemetry) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  streams_.emplace_back(name, stream_telemetry);
+}
+
+ThreadTelemetry* VmTelemetry::RegisterThread(const std::string& name) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  thread_telemetries_.emplace_back(std::make_unique<ThreadTelemetry>(name));
+  return thread_telemetries_.back().get();
+}
+
+InstrTypeTelemetry* VmTelemetry::MutInstrTypeTelemetry(const InstructionType* instruction_type,
+                                                       const std::string& instr_type_name) {
+  // instr_type2telemetry_ is only touched by the scheduler thread.
+  const auto& iter = instr_type2telemetry_.find(instruction_type);
+  if (likely(iter != instr_type2telemetry_.end())) { return iter->second; }
+  std::unique_lock<std::mutex> lock(mutex_);
+  instr_type_telemetries_.emplace_back(std::make_unique<InstrTypeTelemetry>(instr_type_name));
+  auto* telemetry = instr_type_telemetries_.back().get();
+  instr_type2telemetry_.emplace(instruction_type, telemetry);
+  return telemetry;
+}
+
+VmTelemetrySnapshot VmTelemetry::Snapshot() const {
+  VmTelemetrySnapshot snapshot;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& pair : streams_) {
+      const StreamTelemetry* stream = pair.second;
+      snapshot.streams.emplace_back(VmTelemetrySnapshot::Stream{
+          pair.first, stream->waiting.Get(), stream->ready.Get(), stream->running.Get(),
+          stream->dispatched.Get()});
+    }
+    for (const auto& telemetry : instr_type_telemetries_) {
+      snapshot.instr_types.emplace_back(VmTelemetrySnapshot::InstrType{
+          telemetry->name, telemetry->receive_to_dispatch.Summary(),
+          telemetry->dispatch_to_done.Summary()});
+    }
+    for (const auto& thread : thread_telemetries_) {
+      snapshot.threads.emplace_back(VmTelemetrySnapshot::Thread{
+          thread->name, thread->cpu_ns.Get(), thread->spin_us.Get(), thread->spin_hit_cnt.Get(),
+          thread->spin_miss_cnt.Get(), thread->park_cnt.Get(), thread->spin_budget_us.Get()});
+    }
+  }
+  snapshot.handled_msg_cnt = handled_msg_cnt_.Get();
+  snapshot.fused_msg_cnt = fused_msg_cnt_.Get();
+  snapshot.fused_instr_cnt = fused_instr_cnt_.Get();
+  snapshot.scheduler_busy_ns = scheduler_busy_ns_.Get();
+  snapshot.scheduler_idle_ns = scheduler_idle_ns_.Get();
+  snapshot.scheduler_wakeup_cnt = scheduler_wakeup_cnt_.Get();
+  return snapshot;
+}
+
+std::string VmTelemetrySnapshot::DebugString() const {
+  std::stringstream ss;
+  const int64_t total_ns = scheduler_busy_ns + scheduler_idle_ns;
+  ss << "vm telemetry:\n";
+  const double utilization =
+      total_ns > 0 ? static_cast<double>(scheduler_busy_ns) / total_ns : 0;
+  ss << "  scheduler: busy=" << FormatNs(scheduler_busy_ns)
+     << " idle=" << FormatNs(scheduler_idle_ns) << " wakeups=" << scheduler_wakeup_cnt
+     << " utilization=" << utilization << "\n";
+  ss << "  fusion: handled_msgs=" << handled_msg_cnt << " fused_msgs=" << fused_msg_cnt
+     << " fused_instructions=" << fused_instr_cnt << " ratio=" << fusion_ratio() << "\n";
+  for (const auto& stream : streams) {
+    if (stream.dispatched == 0 && stream.waiting == 0) { continue; }
+    ss << "  stream " << stream.name << ": waiting=" << stream.waiting
+       << " ready=" << stream.ready << " running=" << stream.running
+       << " dispatched=" << stream.dispatched << "\n";
+  }
+  for (const auto& thread : threads) {
+    ss << "  thread " << thread.name << ": cpu=" << FormatNs(thread.cpu_ns)
+       << " spin=" << FormatNs(thread.spin_us * 1000) << " spin_hits=" << thread.spin_hit_cnt
+       << " spin_misses=" << thread.spin_miss_cnt << " parks=" << thread.park_cnt
+       << " spin_budget=" << thread.spin_budget_us << "us\n";
+  }
+  for (const auto& instr_type : instr_types) {
+    ss << "  instruction " << instr_type.name << ":\n";
+    ss << "    receive_to_dispatch: " << FormatLatency(instr_type.receive_to_dispatch) << "\n";
+    ss << "    dispatch_to_done: " << FormatLatency(instr_type.dispatch_to_done) << "\n";
+  }
+  return ss.str();
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,203 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_VM_TELEMETRY_H_
+#define ONEFLOW_CORE_VM_VM_TELEMETRY_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace vm {
+
+class InstructionType;
+
+// Instruction counters of the vm are always maintained. ONEFLOW_VM_ENABLE_TELEMETRY=0 turns off
+// the clock reads behind the latency histograms. All counters are written by the scheduler thread
+// only and read by any thread, so a relaxed load/store pair is enough and no read-modify-write
+// instruction is paid on the hot path.
+bool VmTelemetryEnabled();
+int64_t VmTelemetryNowNs();
+// Returns 0 if the periodic dump is disabled.
+int64_t VmTelemetryDumpIntervalSeconds();
+
+class TelemetryCounter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TelemetryCounter);
+  TelemetryCounter() : value_(0) {}
+  ~TelemetryCounter() = default;
+
+  int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+  // Single writer only.
+  void Add(int64_t delta) {
+    value_.store(value_.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+struct LatencySummary {
+  int64_t count;
+  int64_t sum_ns;
+  int64_t p50_ns;
+  int64_t p99_ns;
+  int64_t max_ns;
+};
+
+// Histogram with power-of-two buckets: bucket i counts latencies in [2^(i-1), 2^i) nanoseconds.
+// Percentiles are reported as the upper bound of the bucket they fall in.
+class LatencyHistogram final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(LatencyHistogram);
+  LatencyHistogram();
+  ~LatencyHistogram() = default;
+
+  static constexpr int kBucketNum = 40;
+
+  // Single writer only.
+  void Record(int64_t latency_ns);
+  LatencySummary Summary() const;
+
+ private:
+  std::array<TelemetryCounter, kBucketNum> buckets_;
+  TelemetryCounter sum_ns_;
+  TelemetryCounter max_ns_;
+};
+
+// Instruction counts of a vm::Stream, grouped by the state of instructions.
+//   waiting: received but still blocked by instructions it depends on.
+//   ready: on the ready list of the scheduler, not dispatched yet.
+//   running: dispatched to the stream, not released yet.
+//   dispatched: total number of instructions dispatched to the stream.
+struct StreamTelemetry {
+  TelemetryCounter waiting;
+  TelemetryCounter ready;
+  TelemetryCounter running;
+  TelemetryCounter dispatched;
+};
+
+// Spin/park statistics of a vm thread, written by the thread itself.
+struct ThreadTelemetry {
+  explicit ThreadTelemetry(const std::string& n) : name(n) {}
+  std::string name;
+  TelemetryCounter cpu_ns;
+  TelemetryCounter spin_us;
+  TelemetryCounter spin_hit_cnt;
+  TelemetryCounter spin_miss_cnt;
+  TelemetryCounter park_cnt;
+  TelemetryCounter spin_budget_us;
+};
+
+struct InstrTypeTelemetry {
+  explicit InstrTypeTelemetry(const std::string& n) : name(n) {}
+  std::string name;
+  LatencyHistogram receive_to_dispatch;
+  LatencyHistogram dispatch_to_done;
+};
+
+struct VmTelemetrySnapshot {
+  struct Stream {
+    std::string name;
+    int64_t waiting;
+    int64_t ready;
+    int64_t running;
+    int64_t dispatched;
+  };
+  struct InstrType {
+    std::string name;
+    LatencySummary receive_to_dispatch;
+    LatencySummary dispatch_to_done;
+  };
+  struct Thread {
+    std::string name;
+    int64_t cpu_ns;
+    int64_t spin_us;
+    int64_t spin_hit_cnt;
+    int64_t spin_miss_cnt;
+    int64_t park_cnt;
+    int64_t spin_budget_us;
+  };
+  std::vector<Stream> streams;
+  std::vector<InstrType> instr_types;
+  std::vector<Thread> threads;
+  int64_t handled_msg_cnt;
+  int64_t fused_msg_cnt;
+  int64_t fused_instr_cnt;
+  int64_t scheduler_busy_ns;
+  int64_t scheduler_idle_ns;
+  int64_t scheduler_wakeup_cnt;
+
+  // Ratio of instruction messages folded into fused instructions.
+  double fusion_ratio() const {
+    return handled_msg_cnt > 0 ? static_cast<double>(fused_msg_cnt) / handled_msg_cnt : 0;
+  }
+  std::string DebugString() const;
+};
+
+class VmTelemetry final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(VmTelemetry);
+  VmTelemetry();
+  ~VmTelemetry() = default;
+
+  bool enabled() const { return enabled_; }
+
+  // Streams are registered once while initializing the vm.
+  void RegisterStream(const std::string& name, const StreamTelemetry* stream_telemetry);
+  // The returned telemetry lives as long as this VmTelemetry.
+  ThreadTelemetry* RegisterThread(const std::string& name);
+  // Called on the scheduler thread only. The mutex is taken only when `instruction_type` is seen
+  // for the first time.
+  InstrTypeTelemetry* MutInstrTypeTelemetry(const InstructionType* instruction_type,
+                                            const std::string& instr_type_name);
+
+  void OnMsgsHandled(int64_t msg_cnt) { handled_msg_cnt_.Add(msg_cnt); }
+  void OnMsgsFused(int64_t msg_cnt) {
+    fused_msg_cnt_.Add(msg_cnt);
+    fused_instr_cnt_.Add(1);
+  }
+  void OnSchedulerBusy(int64_t ns) { scheduler_busy_ns_.Add(ns); }
+  void OnSchedulerIdle(int64_t ns) {
+    scheduler_idle_ns_.Add(ns);
+    scheduler_wakeup_cnt_.Add(1);
+  }
+
+  VmTelemetrySnapshot Snapshot() const;
+
+ private:
+  const bool enabled_;
+  mutable std::mutex mutex_;
+  std::vector<std::pair<std::string, const StreamTelemetry*>> streams_;
+  HashMap<const InstructionType*, InstrTypeTelemetry*> instr_type2telemetry_;
+  std::vector<std::unique_ptr<InstrTypeTelemetry>> instr_type_telemetries_;
+  std::vector<std::unique_ptr<ThreadTelemetry>> thread_telemetries_;
+  TelemetryCounter handled_msg_cnt_;
+  TelemetryCounter fused_msg_cnt_;
+  TelemetryCounter fused_instr_cnt_;
+  TelemetryCounter scheduler_busy_ns_;
+  TelemetryCounter scheduler_idle_ns_;
+  TelemetryCounter scheduler_wakeup_cnt_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_VM_TELEMETRY_H_
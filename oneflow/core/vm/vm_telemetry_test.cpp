@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/vm/vm_telemetry.h"
+
+namespace oneflow {
+namespace vm {
+
+TEST(LatencyHistogram, summary) {
+  LatencyHistogram histogram;
+  LatencySummary empty = histogram.Summary();
+  ASSERT_EQ(empty.count, 0);
+  ASSERT_EQ(empty.p50_ns, 0);
+  for (int i = 0; i < 99; ++i) { histogram.Record(1000); }
+  histogram.Record(1000000);
+  LatencySummary summary = histogram.Summary();
+  ASSERT_EQ(summary.count, 100);
+  ASSERT_EQ(summary.sum_ns, 99 * 1000 + 1000000);
+  ASSERT_EQ(summary.max_ns, 1000000);
+  // 1000ns falls in [512, 1024).
+  ASSERT_EQ(summary.p50_ns, 1024);
+  ASSERT_EQ(summary.p99_ns, 1024);
+  histogram.Record(-1);
+  ASSERT_EQ(histogram.Summary().count, 101);
+}
+
+TEST(VmTelemetry, snapshot) {
+  VmTelemetry telemetry;
+  StreamTelemetry stream_telemetry;
+  telemetry.RegisterStream("cpu:0", &stream_telemetry);
+  stream_telemetry.waiting.Add(2);
+  stream_telemetry.waiting.Add(-1);
+  stream_telemetry.ready.Add(1);
+  const InstructionType* instruction_type = nullptr;
+  auto* instr_type_telemetry = telemetry.MutInstrTypeTelemetry(instruction_type, "cpu.Foo");
+  ASSERT_EQ(instr_type_telemetry, telemetry.MutInstrTypeTelemetry(instruction_type, "cpu.Foo"));
+  instr_type_telemetry->dispatch_to_done.Record(10);
+  telemetry.OnMsgsHandled(4);
+  telemetry.OnMsgsFused(3);
+  telemetry.OnSchedulerBusy(30);
+  telemetry.OnSchedulerIdle(70);
+  const auto& snapshot = telemetry.Snapshot();
+  ASSERT_EQ(snapshot.streams.size(), 1U);
+  ASSERT_EQ(snapshot.streams.at(0).name, "cpu:0");
+  ASSERT_EQ(snapshot.streams.at(0).waiting, 1);
+  ASSERT_EQ(snapshot.streams.at(0).ready, 1);
+  ASSERT_EQ(snapshot.instr_types.size(), 1U);
+  ASSERT_EQ(snapshot.instr_types.at(0).dispatch_to_done.count, 1);
+  ASSERT_EQ(snapshot.instr_types.at(0).receive_to_dispatch.count, 0);
+  ASSERT_EQ(snapshot.fused_instr_cnt, 1);
+  ASSERT_DOUBLE_EQ(snapshot.fusion_ratio(), 0.75);
+  ASSERT_EQ(snapshot.scheduler_busy_ns, 30);
+  ASSERT_EQ(snapshot.scheduler_idle_ns, 70);
+  ASSERT_EQ(snapshot.scheduler_wakeup_cnt, 1);
+  ASSERT_FALSE(snapshot.DebugString().empty());
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -25,6 +25,9 @@ namespace oneflow {
 std::unique_ptr<mlir::Pass> createSerializeToCubinPass();
 void InitializeLLVMNVPTXBackend();
 void registerGpuSerializeToCubinPass();
+// Identifies the GPU the CUDA lowering builds CUBINs for, so that cached JIT artifacts are not
+// loaded on a device of another architecture.
+std::string GetCudaLoweringCacheTag();
 
 }  // namespace oneflow
 
@@ -44,6 +44,9 @@ namespace mlir {
 namespace oneflow {
 
 LogicalResult LowerModuleToLLVM(mlir::MLIRContext* context, ModuleOp module);
+// Identifies the CPU lowering configuration, so that cached JIT artifacts are not reused across
+// pipelines.
+std::string GetCpuLoweringCacheTag();
 #ifdef WITH_MLIR_CUDA_CODEGEN
 LogicalResult LowerModuleToCUDALLVM(mlir::MLIRContext* context, ModuleOp module);
 #endif  // WITH_MLIR_CUDA_CODEGEN
@@ -73,14 +73,19 @@ static void maybeSetOption(Pass::Option<std::string>& option, const char* value)
   if (!option.hasValue()) option = value;
 }
 
-SerializeToCubinPass::SerializeToCubinPass() {
+// Compute capability of device 0, which the CUBINs are built for, e.g. "80".
+static std::string GetCudaArch() {
   cudaDeviceProp prop{};
   cudaError_t err = cudaGetDeviceProperties(&prop, 0);
   if (err != cudaSuccess) {
     printf("%s\n", cudaGetErrorString(err));
     exit(1);
   }
-  std::string arch = std::to_string(prop.major) + std::to_string(prop.minor);
+  return std::to_string(prop.major) + std::to_string(prop.minor);
+}
+
+SerializeToCubinPass::SerializeToCubinPass() {
+  std::string arch = GetCudaArch();
   maybeSetOption(this->triple, "nvptx64-nvidia-cuda");
   maybeSetOption(this->chip, ("sm_" + arch).c_str());
   std::string ptx_arch = arch;
@@ -160,6 +165,8 @@ std::unique_ptr<Pass> createSerializeToCubinPass() {
   return std::make_unique<SerializeToCubinPass>();
 }
 
+std::string GetCudaLoweringCacheTag() { return "cuda-sm_" + GetCudaArch(); }
+
 }  // namespace oneflow
 
 }  // namespace mlir
@@ -56,10 +56,16 @@ limitations under the License.
 #include "mlir/Transforms/Passes.h"
 #include "mlir/Dialect/Bufferization/Transforms/Passes.h"
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
+#include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
+#include "mlir/Conversion/AsyncToLLVM/AsyncToLLVM.h"
+#include "mlir/Conversion/VectorToLLVM/ConvertVectorToLLVMPass.h"
+#include "mlir/Conversion/VectorToSCF/VectorToSCF.h"
+#include "mlir/Dialect/Affine/Passes.h"
+#include "mlir/Dialect/Arithmetic/Transforms/Passes.h"
+#include "mlir/Dialect/Async/Passes.h"
 #include "oneflow/core/framework/variable_tensor_mgr.h"
 
 #ifdef WITH_MLIR_CUDA_CODEGEN
-#include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
 #include "mlir/Conversion/GPUCommon/GPUCommonPass.h"
 #include "mlir/Conversion/GPUToNVVM/GPUToNVVMPass.h"
 #include "mlir/Dialect/GPU/Passes.h"
@@ -67,6 +73,7 @@ limitations under the License.
 #endif  // WITH_MLIR_CUDA_CODEGEN
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/ErrorHandling.h"
 
 #include <iostream>
 #include <string>
@@ -744,11 +751,96 @@ void AddLowerToLinalgMemRefPasses(PassManager& pm) {
       mlir::bufferization::createFinalizingBufferizePass());  // finalizing-bufferize
 }
 
+namespace {
+
+bool CpuLoweringOptimize() {
+  static const bool optimize = ::oneflow::ParseBooleanFromEnv("ONEFLOW_MLIR_CPU_OPTIMIZE", true);
+  return optimize;
+}
+
+bool CpuLoweringParallel() {
+  static const bool parallel = ::oneflow::ParseBooleanFromEnv("ONEFLOW_MLIR_CPU_PARALLEL", true);
+  return parallel;
+}
+
+// Tile sizes of the outermost loops, e.g. "32,256". The tiles are distributed over threads and
+// the innermost loop of each tile is vectorized.
+const llvm::SmallVector<int64_t, 4>& CpuLoweringTileSizes() {
+  static const llvm::SmallVector<int64_t, 4> tile_sizes = []() {
+    llvm::SmallVector<int64_t, 4> sizes;
+    llvm::SmallVector<llvm::StringRef, 4> fields;
+    const std::string env = ::oneflow::GetStringFromEnv("ONEFLOW_MLIR_CPU_TILE_SIZES", "32,256");
+    llvm::StringRef(env).split(fields, ',', -1, false);
+    for (llvm::StringRef field : fields) {
+      int64_t size = 0;
+      if (field.trim().getAsInteger(10, size) || size < 0) {
+        llvm::report_fatal_error(llvm::Twine("invalid ONEFLOW_MLIR_CPU_TILE_SIZES: ") + env);
+      }
+      sizes.push_back(size);
+    }
+    return sizes;
+  }();
+  return tile_sizes;
+}
+
+int64_t CpuLoweringVectorSize() {
+  static const int64_t vector_size =
+      ::oneflow::ParseIntegerFromEnv("ONEFLOW_MLIR_CPU_VECTOR_SIZE", 8);
+  return vector_size;
+}
+
+int32_t CpuLoweringMinTaskSize() {
+  static const int32_t min_task_size =
+      ::oneflow::ParseIntegerFromEnv("ONEFLOW_MLIR_CPU_MIN_TASK_SIZE", 4096);
+  return min_task_size;
+}
+
+// Tiled parallel loops over vectorized tile bodies, replacing the scalar single-threaded loops of
+// convert-linalg-to-loops. Parallel loops run on the MLIR async runtime.
+void AddOptimizedCpuLoopPasses(PassManager& pm) {
+  pm.addNestedPass<func::FuncOp>(createLinalgTilingPass(
+      CpuLoweringTileSizes(),
+      CpuLoweringParallel() ? linalg::LinalgTilingLoopType::ParallelLoops
+                            : linalg::LinalgTilingLoopType::Loops));  // linalg-tile
+  pm.addNestedPass<func::FuncOp>(
+      createConvertLinalgToAffineLoopsPass());  // convert-linalg-to-affine-loops
+  pm.addNestedPass<func::FuncOp>(
+      createSuperVectorizePass({CpuLoweringVectorSize()}));  // affine-super-vectorize
+  pm.addPass(createLowerAffinePass());                        // lower-affine
+  pm.addPass(createCanonicalizerPass());                      // canonicalize
+  if (CpuLoweringParallel()) {
+    pm.addPass(createAsyncParallelForPass(/*asyncDispatch=*/true, /*numWorkerThreads=*/0,
+                                          CpuLoweringMinTaskSize()));  // async-parallel-for
+    pm.addPass(createAsyncToAsyncRuntimePass());                      // async-to-async-runtime
+    pm.addPass(createAsyncRuntimeRefCountingPass());          // async-runtime-ref-counting
+    pm.addPass(createAsyncRuntimeRefCountingOptPass());       // async-runtime-ref-counting-opt
+    pm.addPass(arith::createArithmeticExpandOpsPass());       // arith-expand
+    pm.addPass(createConvertAsyncToLLVMPass());               // convert-async-to-llvm
+  }
+  pm.addNestedPass<func::FuncOp>(createConvertVectorToSCFPass());  // convert-vector-to-scf
+  pm.addPass(createConvertVectorToLLVMPass());                     // convert-vector-to-llvm
+}
+
+}  // namespace
+
+std::string GetCpuLoweringCacheTag() {
+  if (!CpuLoweringOptimize()) { return "cpu-loops"; }
+  std::string tag = "cpu-opt";
+  for (int64_t size : CpuLoweringTileSizes()) { tag += "-t" + std::to_string(size); }
+  tag += "-v" + std::to_string(CpuLoweringVectorSize());
+  if (CpuLoweringParallel()) { tag += "-p" + std::to_string(CpuLoweringMinTaskSize()); }
+  return tag;
+}
+
 LogicalResult LowerModuleToLLVM(mlir::MLIRContext* context, ModuleOp module) {
   mlir::PassManager pm(context);
   AddLowerToLinalgMemRefPasses(pm);
-  pm.addNestedPass<func::FuncOp>(createConvertLinalgToLoopsPass());  // convert-linalg-to-loops
-  pm.addNestedPass<func::FuncOp>(createConvertSCFToCFPass());        // convert-scf-to-cf
+  if (CpuLoweringOptimize()) {
+    AddOptimizedCpuLoopPasses(pm);
+  } else {
+    pm.addNestedPass<func::FuncOp>(createConvertLinalgToLoopsPass());  // convert-linalg-to-loops
+  }
+  pm.addNestedPass<func::FuncOp>(createConvertSCFToCFPass());  // convert-scf-to-cf
   pm.addPass(createConvertLinalgToLLVMPass());                       // convert-linalg-to-llvm
   pm.addPass(createMemRefToLLVMPass());                              // convert-memref-to-llvm
   pm.addPass(createConvertFuncToLLVMPass());                         // convert-func-to-llvm
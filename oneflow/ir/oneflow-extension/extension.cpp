@@ -18,8 +18,21 @@ limitations under the License.
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/ExecutionEngine/MemRefUtils.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
+#include "mlir/Target/LLVMIR/Export.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/VCSRevision.h"
+#include <unistd.h>
+#include <future>
 #include "OneFlow/OneFlowDialect.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/switch_func.h"
@@ -28,6 +41,9 @@ limitations under the License.
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/ir/include/OneFlow/Passes.h"
 #include "oneflow/ir/include/OneFlow/Extension.h"
+#ifdef WITH_MLIR_CUDA_CODEGEN
+#include "oneflow/ir/include/OneFlow/Conversion/PTXToCubin.h"
+#endif  // WITH_MLIR_CUDA_CODEGEN
 
 namespace oneflow {
 
@@ -132,39 +148,159 @@ llvm::SmallVector<OpaqueMemRefDescriptor> GetMLIRCInterfaceArgs(
   return args;
 }
 
-void WithMlirContext(
-    user_op::KernelComputeContext* ctx, const llvm::SmallVector<llvm::StringRef, 4>& ext_libs,
-    const std::function<mlir::OwningOpRef<mlir::ModuleOp>(mlir::MLIRContext* mlir_ctx)>& parse,
+std::string GetJitCacheKey(mlir::ModuleOp module, const std::string& lowering_tag) {
+  std::string canonical;
+  llvm::raw_string_ostream os(canonical);
+  module.print(os);
+  os << "\n" << lowering_tag << "\n" << llvm::sys::getHostCPUName();
+  // Bitcode is only guaranteed to be read back by the LLVM that wrote it, and MLIR lowers to it
+  // from the same monorepo.
+  os << "\n" << LLVM_VERSION_STRING;
+#ifdef LLVM_REVISION
+  os << " " << LLVM_REVISION;
+#endif  // LLVM_REVISION
+  llvm::MD5 hasher;
+  hasher.update(os.str());
+  llvm::MD5::MD5Result result;
+  hasher.final(result);
+  return result.digest().str().str();
+}
+
+void WriteBitcodeToCache(const llvm::Module& module, const std::string& path) {
+  // NOTE: write to a private file and rename it, so that concurrent processes never observe a
+  // partially written entry.
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  std::error_code ec;
+  {
+    llvm::raw_fd_ostream os(tmp_path, ec);
+    if (ec) {
+      LOG(WARNING) << "fail to write mlir jit cache " << tmp_path << ": " << ec.message();
+      return;
+    }
+    llvm::WriteBitcodeToFile(module, os);
+  }
+  ec = llvm::sys::fs::rename(tmp_path, path);
+  if (ec) { LOG(WARNING) << "fail to write mlir jit cache " << path << ": " << ec.message(); }
+}
+
+// Compiled engines are shared by every kernel whose module and lowering hash to the same key.
+// With ONEFLOW_MLIR_JIT_CACHE_DIR set, the optimized LLVM module is also kept on disk as
+// <key>.bc, so that later processes skip the MLIR pipeline and the LLVM optimizations.
+class MlirJitEngineCache final {
+ public:
+  using EngineFuture = std::shared_future<std::shared_ptr<mlir::ExecutionEngine>>;
+
+  static MlirJitEngineCache* Get() {
+    static MlirJitEngineCache cache;
+    return &cache;
+  }
+
+  std::shared_ptr<mlir::ExecutionEngine> GetOrCompile(
+      const std::string& key,
+      const std::function<std::shared_ptr<mlir::ExecutionEngine>()>& compile) {
+    std::promise<std::shared_ptr<mlir::ExecutionEngine>> promise;
+    EngineFuture engine;
+    bool should_compile = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = key2engine_.find(key);
+      if (it == key2engine_.end()) {
+        it = key2engine_.emplace(key, promise.get_future().share()).first;
+        should_compile = true;
+      }
+      engine = it->second;
+    }
+    // NOTE: compiling takes up to seconds, so it runs outside the lock and only kernels asking
+    // for the same key wait for it.
+    if (should_compile) { promise.set_value(compile()); }
+    return engine.get();
+  }
+
+ private:
+  MlirJitEngineCache() = default;
+
+  std::mutex mutex_;
+  HashMap<std::string, EngineFuture> key2engine_;
+};
+
+std::shared_ptr<mlir::ExecutionEngine> CompileMlirJit(
+    const std::string& op_name, const std::string& mlir_assembly, const std::string& lowering_tag,
     const std::function<void(mlir::MLIRContext* mlir_ctx, mlir::ModuleOp module)>& lower) {
+  llvm::SmallVector<llvm::StringRef, 4> ext_libs(
+      {SharedLibPaths()->begin(), SharedLibPaths()->end()});
   mlir::DialectRegistry registry;
   registry
       .insert<mlir::oneflow::OneFlowDialect, mlir::func::FuncDialect, mlir::memref::MemRefDialect,
               mlir::tosa::TosaDialect, mlir::linalg::LinalgDialect>();
   mlir::registerLLVMDialectTranslation(registry);
   mlir::MLIRContext mlir_ctx(registry);
-  mlir::OwningOpRef<mlir::ModuleOp> module = parse(&mlir_ctx);
-  CHECK(!!module) << "fail to parse MLIR, op: " << ctx->op_name();
-  if (ParseBooleanFromEnv("ONEFLOW_MLIR_STDOUT", false)) { module->print(llvm::outs()); }
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmPrinter();
-  lower(&mlir_ctx, *module);
-  if (ParseBooleanFromEnv("ONEFLOW_MLIR_STDOUT", false)) { module->print(llvm::outs()); }
-  if (ParseBooleanFromEnv("ONEFLOW_MLIR_DUMP_IR", false)) {
-    std::string mlir;
-    llvm::raw_string_ostream os_mlir(mlir);
-    module->print(os_mlir);
-    TeePersistentLogStream::Create(JoinPath("jit", ctx->op_name() + ".mlir"))->Write(mlir);
-  }
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::parseSourceString<mlir::ModuleOp>(mlir_assembly, &mlir_ctx);
+  CHECK(!!module) << "fail to parse MLIR, op: " << op_name;
+  const std::string key = GetJitCacheKey(*module, lowering_tag);
+  return MlirJitEngineCache::Get()->GetOrCompile(key, [&]() {
+    const std::string cache_dir = GetStringFromEnv("ONEFLOW_MLIR_JIT_CACHE_DIR", "");
+    std::string bitcode_path;
+    std::unique_ptr<llvm::MemoryBuffer> cached_bitcode;
+    if (!cache_dir.empty()) {
+      llvm::sys::fs::create_directories(cache_dir);
+      bitcode_path = JoinPath(cache_dir, key + ".bc");
+      auto buffer_or_error = llvm::MemoryBuffer::getFile(bitcode_path);
+      if (buffer_or_error) { cached_bitcode = std::move(buffer_or_error.get()); }
+    }
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    if (cached_bitcode) {
+      VLOG(2) << "mlir jit cache hit, op: " << op_name << ", key: " << key;
+    } else {
+      if (ParseBooleanFromEnv("ONEFLOW_MLIR_STDOUT", false)) { module->print(llvm::outs()); }
+      lower(&mlir_ctx, *module);
+      if (ParseBooleanFromEnv("ONEFLOW_MLIR_STDOUT", false)) { module->print(llvm::outs()); }
+      if (ParseBooleanFromEnv("ONEFLOW_MLIR_DUMP_IR", false)) {
+        std::string mlir;
+        llvm::raw_string_ostream os_mlir(mlir);
+        module->print(os_mlir);
+        TeePersistentLogStream::Create(JoinPath("jit", op_name + ".mlir"))->Write(mlir);
+      }
+    }
+
+    auto tm_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+    CHECK(!!tm_builder) << llvm::toString(tm_builder.takeError());
+    auto tm = tm_builder->createTargetMachine();
+    CHECK(!!tm) << llvm::toString(tm.takeError());
+    auto optimize = mlir::makeOptimizingTransformer(/*optLevel=*/3, /*sizeLevel=*/0, tm->get());
+    auto build_llvm_module = [&](mlir::ModuleOp lowered,
+                                 llvm::LLVMContext& llvm_ctx) -> std::unique_ptr<llvm::Module> {
+      if (cached_bitcode) {
+        auto module_or_error = llvm::parseBitcodeFile(cached_bitcode->getMemBufferRef(), llvm_ctx);
+        CHECK(!!module_or_error) << "fail to load mlir jit cache " << bitcode_path << ", "
+                                 << llvm::toString(module_or_error.takeError());
+        return std::move(module_or_error.get());
+      }
+      std::unique_ptr<llvm::Module> llvm_module = mlir::translateModuleToLLVMIR(lowered, llvm_ctx);
+      CHECK(llvm_module) << "fail to translate MLIR to LLVM IR, op: " << op_name;
+      llvm_module->setDataLayout((*tm)->createDataLayout());
+      llvm_module->setTargetTriple((*tm)->getTargetTriple().str());
+      llvm::Error error = optimize(llvm_module.get());
+      CHECK(!error) << "fail to optimize LLVM IR, error: " << llvm::toString(std::move(error));
+      if (!bitcode_path.empty()) { WriteBitcodeToCache(*llvm_module, bitcode_path); }
+      return llvm_module;
+    };
 
-  mlir::ExecutionEngineOptions jitOptions;
-  jitOptions.transformer = {};
-  jitOptions.jitCodeGenOptLevel = llvm::None;
-  jitOptions.sharedLibPaths = ext_libs;
+    mlir::ExecutionEngineOptions jitOptions;
+    jitOptions.llvmModuleBuilder = build_llvm_module;
+    jitOptions.transformer = {};
+    jitOptions.jitCodeGenOptLevel = llvm::CodeGenOpt::Aggressive;
+    jitOptions.sharedLibPaths = ext_libs;
+
+    auto jit_or_error = mlir::ExecutionEngine::create(*module, jitOptions);
+    CHECK(!!jit_or_error) << "failed to create JIT exe engine, "
+                          << llvm::toString(jit_or_error.takeError());
+    return std::shared_ptr<mlir::ExecutionEngine>(std::move(jit_or_error.get()));
+  });
+}
 
-  auto jit_or_error = mlir::ExecutionEngine::create(*module, jitOptions);
-  CHECK(!!jit_or_error) << "failed to create JIT exe engine, "
-                        << llvm::toString(jit_or_error.takeError());
-  auto jit = std::move(jit_or_error.get());
+void InvokeMlirJit(user_op::KernelComputeContext* ctx, mlir::ExecutionEngine* jit) {
   llvm::SmallVector<OpaqueMemRefDescriptor> args /* args must outlive JIT invocation */ =
       GetMLIRCInterfaceArgs(ctx);
   llvm::SmallVector<void*> packed_args{};
@@ -173,26 +309,41 @@ void WithMlirContext(
   CHECK(!error) << "fail to invoke jit engine, error: " << llvm::toString(std::move(error));
 }
 
+// Kernels compile their module once, when their state is created, so Compute only reads it.
+class MlirJitKernelState final : public user_op::OpKernelState {
+ public:
+  explicit MlirJitKernelState(std::shared_ptr<mlir::ExecutionEngine> jit) : jit_(std::move(jit)) {}
+  ~MlirJitKernelState() override = default;
+
+  mlir::ExecutionEngine* jit() const { return jit_.get(); }
+
+ private:
+  std::shared_ptr<mlir::ExecutionEngine> jit_;
+};
+
 template<typename T>
 class MlirJitCpuKernel final : public user_op::OpKernel {
  public:
   MlirJitCpuKernel() = default;
   ~MlirJitCpuKernel() = default;
 
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<MlirJitKernelState>(
+        CompileMlirJit(ctx->op_name(), ctx->Attr<std::string>("mlir_assembly"),
+                       mlir::oneflow::GetCpuLoweringCacheTag(),
+                       [](mlir::MLIRContext* mlir_ctx, mlir::ModuleOp module) {
+                         CHECK(mlir::succeeded(mlir::oneflow::LowerModuleToLLVM(mlir_ctx, module)))
+                             << "fail to lower OneFlow to LLVM";
+                       }));
+  }
+
  private:
-  void Compute(user_op::KernelComputeContext* ctx) const override {
-    llvm::SmallVector<llvm::StringRef, 4> ext_libs(
-        {SharedLibPaths()->begin(), SharedLibPaths()->end()});
-    WithMlirContext(
-        ctx, ext_libs,
-        [&ctx](mlir::MLIRContext* mlir_ctx) {
-          return mlir::parseSourceString<mlir::ModuleOp>(ctx->Attr<std::string>("mlir_assembly"),
-                                                         mlir_ctx);
-        },
-        [](mlir::MLIRContext* mlir_ctx, mlir::ModuleOp module) {
-          CHECK(mlir::succeeded(mlir::oneflow::LowerModuleToLLVM(mlir_ctx, module)))
-              << "fail to lower OneFlow to LLVM";
-        });
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state,
+               const user_op::OpKernelCache*) const override {
+    auto* jit_state = dynamic_cast<MlirJitKernelState*>(state);
+    CHECK_NOTNULL(jit_state);
+    InvokeMlirJit(ctx, jit_state->jit());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -222,20 +373,23 @@ class MlirJitGpuKernel final : public user_op::OpKernel {
   MlirJitGpuKernel() = default;
   ~MlirJitGpuKernel() = default;
 
- private:
-  void Compute(user_op::KernelComputeContext* ctx) const override {
-    llvm::SmallVector<llvm::StringRef, 4> ext_libs(
-        {SharedLibPaths()->begin(), SharedLibPaths()->end()});
-    WithMlirContext(
-        ctx, ext_libs,
-        [&ctx](mlir::MLIRContext* mlir_ctx) {
-          return mlir::parseSourceString<mlir::ModuleOp>(ctx->Attr<std::string>("mlir_assembly"),
-                                                         mlir_ctx);
-        },
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<MlirJitKernelState>(CompileMlirJit(
+        ctx->op_name(), ctx->Attr<std::string>("mlir_assembly"),
+        mlir::oneflow::GetCudaLoweringCacheTag(),
         [](mlir::MLIRContext* mlir_ctx, mlir::ModuleOp module) {
           CHECK(mlir::succeeded(mlir::oneflow::LowerModuleToCUDALLVM(mlir_ctx, module)))
               << "fail to lower OneFlow to CUDA LLVM";
-        });
+        }));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state,
+               const user_op::OpKernelCache*) const override {
+    auto* jit_state = dynamic_cast<MlirJitKernelState*>(state);
+    CHECK_NOTNULL(jit_state);
+    InvokeMlirJit(ctx, jit_state->jit());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
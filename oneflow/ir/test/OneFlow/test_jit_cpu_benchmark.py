@@ -0,0 +1,94 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# RUN: python3 %s | FileCheck %s
+# The chain is fused into a jit op and lowered by the CPU pipeline.
+# CHECK: oneflow.mlir_jit
+# CHECK: llvm.func
+
+import os
+import time
+import unittest
+import numpy as np
+
+os.environ["ONEFLOW_MLIR_ENABLE_ROUND_TRIP"] = "1"
+os.environ["ONEFLOW_MLIR_ENABLE_CODEGEN_FUSERS"] = "1"
+os.environ["ONEFLOW_MLIR_STDOUT"] = "1"
+
+import oneflow as flow
+import oneflow.unittest
+
+# Compares the JIT-fused cast + scale chain (lowered by the CPU JIT pipeline) with the
+# eager CPU primitives running the same ops one by one. Set
+# ONEFLOW_MLIR_JIT_BENCHMARK_SIZES to e.g. "1024,4096" for larger square inputs.
+SIZES = [
+    int(s)
+    for s in os.getenv("ONEFLOW_MLIR_JIT_BENCHMARK_SIZES", "96,512").split(",")
+    if s
+]
+ITERS = int(os.getenv("ONEFLOW_MLIR_JIT_BENCHMARK_ITERS", "20"))
+
+
+class CastScaleModule(flow.nn.Module):
+    def forward(self, x, scale):
+        return x.to(dtype=flow.float32) * scale
+
+
+class CastScaleGraph(flow.nn.Graph):
+    def __init__(self, module):
+        super().__init__()
+        self.fw = module
+
+    def build(self, x, scale):
+        return self.fw(x, scale)
+
+
+def time_it(fn, iters):
+    fn().numpy()
+    start = time.perf_counter()
+    for _ in range(iters):
+        y = fn()
+    y.numpy()
+    return (time.perf_counter() - start) / iters
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestJitCpuBenchmark(oneflow.unittest.TestCase):
+    def test_cast_scale(test_case):
+        for size in SIZES:
+            x = flow.tensor(
+                np.random.randint(-100, 100, size=(size, size)), dtype=flow.int64
+            )
+            scale = flow.tensor([7.7], dtype=flow.float32)
+            module = CastScaleModule()
+            graph = CastScaleGraph(module)
+            test_case.assertTrue(
+                np.allclose(module(x, scale).numpy(), graph(x, scale).numpy())
+            )
+            eager_seconds = time_it(lambda: module(x, scale), ITERS)
+            jit_seconds = time_it(lambda: graph(x, scale), ITERS)
+            print(
+                "cast+scale {}x{}: eager {:.3f} ms, jit {:.3f} ms, speedup {:.2f}x".format(
+                    size,
+                    size,
+                    eager_seconds * 1e3,
+                    jit_seconds * 1e3,
+                    eager_seconds / jit_seconds,
+                )
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
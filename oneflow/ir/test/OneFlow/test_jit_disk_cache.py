@@ -0,0 +1,89 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# RUN: python3 %s | FileCheck %s
+# The cold process lowers the fused kernel to LLVM, the warm one loads its bitcode.
+# CHECK: cold process
+# CHECK: oneflow.mlir_jit
+# CHECK: llvm.func
+# CHECK: warm process
+# CHECK-NOT: llvm.func
+# CHECK: disk cache checked
+
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy as np
+
+# Runs the JIT-fused cast + scale chain and saves its output to the path given on the
+# command line.
+_RUN_SCRIPT = """
+import sys
+import numpy as np
+import oneflow as flow
+
+
+class CastScaleGraph(flow.nn.Graph):
+    def build(self, x, scale):
+        return x.to(dtype=flow.float32) * scale
+
+
+x = flow.tensor(np.arange(-48, 48).reshape(8, 12), dtype=flow.int64)
+scale = flow.tensor([7.7], dtype=flow.float32)
+np.save(sys.argv[1], CastScaleGraph()(x, scale).numpy())
+"""
+
+
+def _run_in_subprocess(cache_dir, tmp_dir, run_name):
+    script_path = os.path.join(tmp_dir, "run_graph.py")
+    with open(script_path, "w") as f:
+        f.write(_RUN_SCRIPT)
+    output_path = os.path.join(tmp_dir, run_name + ".npy")
+    env = dict(os.environ)
+    env["ONEFLOW_MLIR_ENABLE_ROUND_TRIP"] = "1"
+    env["ONEFLOW_MLIR_ENABLE_CODEGEN_FUSERS"] = "1"
+    env["ONEFLOW_MLIR_STDOUT"] = "1"
+    env["ONEFLOW_MLIR_JIT_CACHE_DIR"] = cache_dir
+    print(run_name + " process", flush=True)
+    subprocess.check_call([sys.executable, script_path, output_path], env=env)
+    return np.load(output_path)
+
+
+class TestJitDiskCache(unittest.TestCase):
+    def test_jit_disk_cache(test_case):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            cache_dir = os.path.join(tmp_dir, "jit_cache")
+            cold_output = _run_in_subprocess(cache_dir, tmp_dir, "cold")
+            entries = os.listdir(cache_dir)
+            test_case.assertEqual(len(entries), 1)
+            test_case.assertTrue(entries[0].endswith(".bc"))
+            entry_path = os.path.join(cache_dir, entries[0])
+            entry_mtime = os.path.getmtime(entry_path)
+
+            warm_output = _run_in_subprocess(cache_dir, tmp_dir, "warm")
+            # a hit neither lowers again nor rewrites the entry
+            test_case.assertEqual(os.listdir(cache_dir), entries)
+            test_case.assertEqual(os.path.getmtime(entry_path), entry_mtime)
+            test_case.assertTrue(np.array_equal(warm_output, cold_output))
+            expected = np.arange(-48, 48).reshape(8, 12) * np.float32(7.7)
+            test_case.assertTrue(np.allclose(cold_output, expected))
+        print("disk cache checked", flush=True)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -14,7 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
-#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
@@ -25,45 +25,59 @@ class CpuArgSortKernel final : public user_op::OpKernel {
   ~CpuArgSortKernel() = default;
 
  private:
+  using Traits = cpu_radix_sort::KeyTraits<T>;
+  using Key = typename Traits::Key;
+
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
-
-    const int32_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
-    const int32_t instance_num = in->shape().elem_cnt() / instance_size;
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t elem_cnt = in->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int64_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
+    const int64_t instance_num = elem_cnt / instance_size;
     const std::string& direction = ctx->Attr<std::string>("direction");
     const bool is_ascending = direction == "ASCENDING";
     const bool is_descending = direction == "DESCENDING";
-    FOR_RANGE(int32_t, i, 0, instance_num) {
-      const T* in_ptr_i = in->dptr<T>() + i * instance_size;
-      int32_t* out_ptr_i = out->mut_dptr<int32_t>() + i * instance_size;
-      std::iota(out_ptr_i, out_ptr_i + instance_size, 0);
-      auto comp = [&](const int32_t lhs, const int32_t rhs) {
-        const T l = in_ptr_i[lhs];
-        const T r = in_ptr_i[rhs];
-        if (l == r) {
-          return lhs < rhs;
-        } else {
-          if (is_ascending) {
-            return l < r;
-          } else if (is_descending) {
-            return l > r;
-          } else {
-            UNIMPLEMENTED();
-          }
-        }
-      };
-      std::sort(out_ptr_i, out_ptr_i + instance_size, comp);
-    }
+    CHECK(is_ascending || is_descending);
+    // The radix sort is stable, so equal elements keep the order of their indices in both
+    // directions.
+    const Key flip = is_ascending ? Key(0) : static_cast<Key>(~Key(0));
+    int32_t* indices_tmp = tmp_buffer->mut_dptr<int32_t>();
+    Key* keys = reinterpret_cast<Key*>(tmp_buffer->mut_dptr<char>()
+                                       + GetCudaAlignedSize(elem_cnt * sizeof(int32_t)));
+    Key* keys_tmp = keys + elem_cnt;
+    auto* stream = ctx->stream()->As<ep::CpuStream>();
+    cpu_radix_sort::ForEachInstance(
+        stream, instance_num, instance_size, [&](int64_t i, bool parallel) {
+          const int64_t offset = i * instance_size;
+          const T* in_ptr_i = in->dptr<T>() + offset;
+          int32_t* out_ptr_i = out->mut_dptr<int32_t>() + offset;
+          Key* keys_i = keys + offset;
+          cpu_radix_sort::ForRange(stream, parallel, instance_size,
+                                   [&](int64_t begin, int64_t end) {
+                                     for (int64_t j = begin; j < end; ++j) {
+                                       keys_i[j] = Traits::OrderKey(in_ptr_i[j]) ^ flip;
+                                       out_ptr_i[j] = static_cast<int32_t>(j);
+                                     }
+                                   });
+          cpu_radix_sort::SortInstance(stream, parallel, keys_i, keys_tmp + offset, out_ptr_i,
+                                       indices_tmp + offset, instance_size);
+        });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CPU_ARG_SORT_KERNEL(dtype)                           \
-  REGISTER_USER_KERNEL("arg_sort")                                    \
-      .SetCreateFn<CpuArgSortKernel<dtype>>()                         \
-      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU) \
-                       && (user_op::HobDataType("in", 0) == GetDataType<dtype>::value));
+#define REGISTER_CPU_ARG_SORT_KERNEL(dtype)                                                 \
+  REGISTER_USER_KERNEL("arg_sort")                                                          \
+      .SetCreateFn<CpuArgSortKernel<dtype>>()                                               \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                       \
+                       && (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))     \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) -> size_t {                         \
+        using Key = cpu_radix_sort::KeyTraits<dtype>::Key;                                  \
+        const int64_t elem_cnt = ctx->InputShape("in", 0).elem_cnt();                       \
+        return GetCudaAlignedSize(elem_cnt * sizeof(int32_t)) + 2 * elem_cnt * sizeof(Key); \
+      });
 
 REGISTER_CPU_ARG_SORT_KERNEL(float)
 REGISTER_CPU_ARG_SORT_KERNEL(double)
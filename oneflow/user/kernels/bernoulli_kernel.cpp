@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/user/kernels/op_kernel_wrapper.h"
 #include "oneflow/user/kernels/random_seed_util.h"
 #include "oneflow/user/kernels/random_mask_generator.h"
+#include "oneflow/user/kernels/random_philox_util.h"
 
 namespace oneflow {
 
@@ -51,12 +52,15 @@ class BernoulliKerenl final : public user_op::OpKernel {
     CHECK_NOTNULL(generator);
     const auto& cpu_generator = CHECK_JUST(generator->Get<one::CPUGeneratorImpl>());
 
-    for (int32_t i = 0; i < out_blob->shape().elem_cnt(); ++i) {
-      double prob = static_cast<double>(*(in_dptr + i));
-      CHECK(prob >= 0.0 && prob <= 1.0);
-      std::bernoulli_distribution dis(prob);
-      *(out_dptr + i) = dis(cpu_generator->engine()) ? GetOneVal<K>() : GetZeroVal<K>();
-    }
+    PhiloxUniformForEach<double>(
+        ctx->stream(), cpu_generator.get(), out_blob->shape().elem_cnt(),
+        [&](int64_t first, int64_t count, const double* uniform) {
+          for (int64_t i = 0; i < count; ++i) {
+            const double prob = static_cast<double>(in_dptr[first + i]);
+            CHECK(prob >= 0.0 && prob <= 1.0);
+            out_dptr[first + i] = uniform[i] < prob ? GetOneVal<K>() : GetZeroVal<K>();
+          }
+        });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -0,0 +1,269 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+#define ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#include "oneflow/core/ep/cpu/cpu_device.h"
+
+namespace oneflow {
+
+namespace cpu_radix_sort {
+
+constexpr int kRadixBits = 8;
+constexpr int kRadixSize = 1 << kRadixBits;
+// Shorter sequences are insertion sorted.
+constexpr int64_t kMinRadixSortSize = 64;
+// A single sequence is sorted by several threads once each of them gets this many elements.
+constexpr int64_t kMinSizePerThread = 1 << 15;
+constexpr int64_t kParallelGrain = 32768;
+
+// Maps T to an unsigned key whose unsigned order is the order of T. Encode is a bijection, while
+// OrderKey also maps values that compare equal (-0.0 and +0.0) to the same key, for sorts whose
+// ties are broken by index.
+template<typename T, typename Enable = void>
+struct KeyTraits;
+
+template<typename T>
+struct KeyTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                            && std::is_signed<T>::value>::type> {
+  using Key = typename std::make_unsigned<T>::type;
+  static constexpr Key kSignBit = Key(1) << (sizeof(Key) * 8 - 1);
+  static Key Encode(T x) { return static_cast<Key>(x) ^ kSignBit; }
+  static Key OrderKey(T x) { return Encode(x); }
+  static T Decode(Key key) { return static_cast<T>(key ^ kSignBit); }
+};
+
+template<typename T>
+struct KeyTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                            && !std::is_signed<T>::value>::type> {
+  using Key = typename std::conditional<std::is_same<T, bool>::value, uint8_t, T>::type;
+  static Key Encode(T x) { return static_cast<Key>(x); }
+  static Key OrderKey(T x) { return Encode(x); }
+  static T Decode(Key key) { return static_cast<T>(key); }
+};
+
+template<typename T>
+struct KeyTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  using Key = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+  static_assert(sizeof(Key) == sizeof(T), "");
+  static constexpr Key kSignBit = Key(1) << (sizeof(Key) * 8 - 1);
+  static Key Encode(T x) {
+    Key bits;
+    std::memcpy(&bits, &x, sizeof(T));
+    return (bits & kSignBit) ? ~bits : (bits | kSignBit);
+  }
+  static Key OrderKey(T x) { return Encode(x == T(0) ? T(0) : x); }
+  static T Decode(Key key) {
+    const Key bits = (key & kSignBit) ? (key ^ kSignBit) : ~key;
+    T x;
+    std::memcpy(&x, &bits, sizeof(T));
+    return x;
+  }
+};
+
+template<typename Key>
+int Digit(Key key, int pass) {
+  return static_cast<int>((key >> (pass * kRadixBits)) & (kRadixSize - 1));
+}
+
+// Stable insertion sort of keys[0, n), moving values along when they are given.
+template<typename Key, typename Value>
+void InsertionSort(Key* keys, Value* values, int64_t n) {
+  for (int64_t i = 1; i < n; ++i) {
+    const Key key = keys[i];
+    int64_t j = i;
+    if (values != nullptr) {
+      const Value value = values[i];
+      for (; j > 0 && keys[j - 1] > key; --j) {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+      }
+      values[j] = value;
+    } else {
+      for (; j > 0 && keys[j - 1] > key; --j) { keys[j] = keys[j - 1]; }
+    }
+    keys[j] = key;
+  }
+}
+
+template<typename Key, typename Value>
+void Scatter(const Key* src_keys, const Value* src_values, Key* dst_keys, Value* dst_values,
+             int64_t begin, int64_t end, int pass, int64_t* offsets) {
+  if (src_values != nullptr) {
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t pos = offsets[Digit(src_keys[i], pass)]++;
+      dst_keys[pos] = src_keys[i];
+      dst_values[pos] = src_values[i];
+    }
+  } else {
+    for (int64_t i = begin; i < end; ++i) {
+      dst_keys[offsets[Digit(src_keys[i], pass)]++] = src_keys[i];
+    }
+  }
+}
+
+// Stable LSD radix sort of keys[0, n) in ascending order with 8-bit digits. `values` may be null;
+// otherwise it is permuted along with the keys. The scratch buffers have n elements, the result is
+// left in keys and values. Passes whose digit is the same for every key are skipped.
+template<typename Key, typename Value>
+void RadixSort(Key* keys, Key* keys_tmp, Value* values, Value* values_tmp, int64_t n) {
+  static_assert(std::is_unsigned<Key>::value, "");
+  if (n < kMinRadixSortSize) {
+    InsertionSort(keys, values, n);
+    return;
+  }
+  constexpr int kNumPasses = sizeof(Key);
+  int64_t histograms[kNumPasses][kRadixSize] = {};
+  for (int64_t i = 0; i < n; ++i) {
+    for (int pass = 0; pass < kNumPasses; ++pass) { histograms[pass][Digit(keys[i], pass)] += 1; }
+  }
+  Key* src_keys = keys;
+  Key* dst_keys = keys_tmp;
+  Value* src_values = values;
+  Value* dst_values = values_tmp;
+  for (int pass = 0; pass < kNumPasses; ++pass) {
+    const int64_t* histogram = histograms[pass];
+    if (histogram[Digit(src_keys[0], pass)] == n) { continue; }
+    int64_t offsets[kRadixSize];
+    int64_t offset = 0;
+    for (int digit = 0; digit < kRadixSize; ++digit) {
+      offsets[digit] = offset;
+      offset += histogram[digit];
+    }
+    Scatter(src_keys, src_values, dst_keys, dst_values, 0, n, pass, offsets);
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+  if (src_keys != keys) {
+    std::memcpy(keys, src_keys, n * sizeof(Key));
+    if (values != nullptr) { std::memcpy(values, src_values, n * sizeof(Value)); }
+  }
+}
+
+// RadixSort with every pass split over `num_parts` contiguous parts: the parts count their digits
+// in parallel, the counts give each (digit, part) its own output range, and the parts scatter in
+// parallel. The order is the same as the serial sort.
+template<typename Key, typename Value>
+void ParallelRadixSort(ep::CpuStream* stream, Key* keys, Key* keys_tmp, Value* values,
+                       Value* values_tmp, int64_t n, int64_t num_parts) {
+  static_assert(std::is_unsigned<Key>::value, "");
+  constexpr int kNumPasses = sizeof(Key);
+  std::vector<int64_t> histograms(num_parts * kRadixSize);
+  auto PartBegin = [&](int64_t part) { return n * part / num_parts; };
+  Key* src_keys = keys;
+  Key* dst_keys = keys_tmp;
+  Value* src_values = values;
+  Value* dst_values = values_tmp;
+  for (int pass = 0; pass < kNumPasses; ++pass) {
+    stream->ParallelFor(
+        0, num_parts,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t part = begin; part < end; ++part) {
+            int64_t* histogram = histograms.data() + part * kRadixSize;
+            std::fill(histogram, histogram + kRadixSize, 0);
+            for (int64_t i = PartBegin(part); i < PartBegin(part + 1); ++i) {
+              histogram[Digit(src_keys[i], pass)] += 1;
+            }
+          }
+        },
+        1);
+    bool skip = false;
+    int64_t offset = 0;
+    for (int digit = 0; digit < kRadixSize; ++digit) {
+      const int64_t digit_begin = offset;
+      for (int64_t part = 0; part < num_parts; ++part) {
+        int64_t* count = &histograms[part * kRadixSize + digit];
+        const int64_t part_count = *count;
+        *count = offset;
+        offset += part_count;
+      }
+      if (offset - digit_begin == n) { skip = true; }
+    }
+    if (skip) { continue; }
+    stream->ParallelFor(
+        0, num_parts,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t part = begin; part < end; ++part) {
+            Scatter(src_keys, src_values, dst_keys, dst_values, PartBegin(part),
+                    PartBegin(part + 1), pass, histograms.data() + part * kRadixSize);
+          }
+        },
+        1);
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+  if (src_keys != keys) {
+    stream->ParallelFor(0, n, [&](int64_t begin, int64_t end) {
+      std::memcpy(keys + begin, src_keys + begin, (end - begin) * sizeof(Key));
+      if (values != nullptr) {
+        std::memcpy(values + begin, src_values + begin, (end - begin) * sizeof(Value));
+      }
+    });
+  }
+}
+
+// Runs f(i, parallel) for every instance. Instances are spread over the threads, unless there are
+// fewer of them than threads and each is long enough to be split, in which case they run one after
+// another with `parallel` set, and f is expected to use all threads itself.
+template<typename F>
+void ForEachInstance(ep::CpuStream* stream, int64_t instance_num, int64_t instance_size,
+                     const F& f) {
+  const int64_t num_threads = stream->device()->GetNumThreads();
+  if (instance_num < num_threads && instance_size >= 2 * kMinSizePerThread) {
+    for (int64_t i = 0; i < instance_num; ++i) { f(i, true); }
+  } else {
+    stream->ParallelFor(
+        0, instance_num,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) { f(i, false); }
+        },
+        std::max<int64_t>(kParallelGrain / std::max<int64_t>(instance_size, 1), 1));
+  }
+}
+
+// Calls f(begin, end) over [0, n), split over the threads when `parallel`.
+template<typename F>
+void ForRange(ep::CpuStream* stream, bool parallel, int64_t n, const F& f) {
+  if (parallel) {
+    stream->ParallelFor(0, n, f);
+  } else {
+    f(0, n);
+  }
+}
+
+// Sorts one instance, with all threads when `parallel`.
+template<typename Key, typename Value>
+void SortInstance(ep::CpuStream* stream, bool parallel, Key* keys, Key* keys_tmp, Value* values,
+                  Value* values_tmp, int64_t n) {
+  const int64_t num_parts =
+      parallel ? std::min<int64_t>(stream->device()->GetNumThreads(), n / kMinSizePerThread) : 1;
+  if (num_parts > 1) {
+    ParallelRadixSort(stream, keys, keys_tmp, values, values_tmp, n, num_parts);
+  } else {
+    RadixSort(keys, keys_tmp, values, values_tmp, n);
+  }
+}
+
+}  // namespace cpu_radix_sort
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
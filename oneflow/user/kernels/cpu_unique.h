@@ -0,0 +1,356 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_CPU_UNIQUE_H_
+#define ONEFLOW_USER_KERNELS_CPU_UNIQUE_H_
+
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#include "oneflow/core/ep/cpu/cpu_device.h"
+
+namespace oneflow {
+
+// Deduplication of keys with open-addressing hash tables that live in a caller provided
+// workspace. Unique keys are numbered in the order of their first occurrence, as a serial scan
+// with a map would, whatever the number of threads.
+//
+// Every slot of a table has a tag byte and an entry with the key and two int64 fields. Slots are
+// probed linearly in aligned groups of 16, whose tags are compared at once with SSE2. A tag holds
+// 7 bits of the hash, or kEmpty.
+//
+// Large inputs are deduplicated in two phases. Every thread first deduplicates a chunk of the
+// input into a partial table of its own, which also absorbs the repeats of hot keys. The entries
+// of the partial tables are then bucketed by the partition of the global table their hash falls
+// into, and every thread merges the buckets of the partitions it owns, keeping the smallest first
+// position and the sum of the counts of every key.
+namespace cpu_unique {
+
+constexpr int64_t kGroupSize = 16;
+constexpr uint8_t kEmpty = 0x80;
+// Shorter inputs are deduplicated by a single thread.
+constexpr int64_t kMinParallelSize = 1 << 16;
+// Every partition of a parallel build has at least this many slots.
+constexpr int64_t kMinPartitionCapacity = 1 << 12;
+
+template<typename K>
+uint64_t Hash(K key) {
+  // -0.0 == +0.0, so both have to hash alike.
+  const K normalized = key == K(0) ? K(0) : key;
+  uint64_t h = 0;
+  std::memcpy(&h, &normalized, sizeof(K));
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+inline uint8_t Tag(uint64_t hash) { return static_cast<uint8_t>((hash >> 25) & 0x7F); }
+
+inline int64_t Capacity(int64_t n) {
+  int64_t capacity = kGroupSize;
+  while (capacity < 2 * n) { capacity *= 2; }
+  return capacity;
+}
+
+// Bit i of *match is set if the tag of slot i of the group is `tag`, bit i of *empty if the slot
+// is free.
+inline void MatchGroup(const uint8_t* group, uint8_t tag, uint32_t* match, uint32_t* empty) {
+#ifdef __SSE2__
+  const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  *match = _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(tag))));
+  *empty = _mm_movemask_epi8(ctrl);
+#else
+  *match = 0;
+  *empty = 0;
+  for (int64_t i = 0; i < kGroupSize; ++i) {
+    *match |= static_cast<uint32_t>(group[i] == tag) << i;
+    *empty |= static_cast<uint32_t>(group[i] == kEmpty) << i;
+  }
+#endif
+}
+
+template<typename K>
+struct HashTable {
+  struct Entry {
+    // The first position of the key.
+    int64_t position;
+    // The number of occurrences of the key while a table is filled. Afterwards, the slot of the key
+    // in the global table for a partial entry, and the index of the key for a global entry.
+    int64_t value;
+    K key;
+  };
+
+  static int64_t WorkspaceSize(int64_t capacity) {
+    return GetCudaAlignedSize(capacity) + GetCudaAlignedSize(capacity * sizeof(Entry));
+  }
+
+  HashTable(char* ptr, int64_t capacity) : capacity(capacity) {
+    tags = reinterpret_cast<uint8_t*>(ptr);
+    entries = reinterpret_cast<Entry*>(ptr + GetCudaAlignedSize(capacity));
+  }
+
+  // Looks key up in the partition of `size` slots at `base`, and inserts it with position
+  // `position` and value 0 if it is absent. Returns the slot, or -1 when the key is absent and
+  // the partition already holds `max_num_keys` keys.
+  int64_t FindOrInsert(int64_t base, int64_t size, uint64_t hash, K key, int64_t position,
+                       int64_t max_num_keys, int64_t* num_keys, bool* inserted) {
+    const uint8_t tag = Tag(hash);
+    const int64_t mask = size - 1;
+    int64_t group = hash & mask & ~(kGroupSize - 1);
+    while (true) {
+      const int64_t group_begin = base + group;
+      uint32_t match = 0;
+      uint32_t empty = 0;
+      MatchGroup(tags + group_begin, tag, &match, &empty);
+      while (match != 0) {
+        const int64_t slot = group_begin + __builtin_ctz(match);
+        if (entries[slot].key == key) {
+          *inserted = false;
+          return slot;
+        }
+        match &= match - 1;
+      }
+      if (empty != 0) {
+        if (*num_keys >= max_num_keys) { return -1; }
+        const int64_t slot = group_begin + __builtin_ctz(empty);
+        tags[slot] = tag;
+        entries[slot].key = key;
+        entries[slot].position = position;
+        entries[slot].value = 0;
+        *num_keys += 1;
+        *inserted = true;
+        return slot;
+      }
+      group = (group + kGroupSize) & mask;
+    }
+  }
+
+  int64_t capacity;
+  uint8_t* tags;
+  Entry* entries;
+};
+
+template<typename K>
+int64_t GetWorkspaceSize(int64_t n) {
+  // The partial tables, the global table, the bucketed partial entries and the slot of every
+  // input in its partial table.
+  return 2 * HashTable<K>::WorkspaceSize(Capacity(n)) + 2 * GetCudaAlignedSize(n * sizeof(int64_t));
+}
+
+template<typename K, typename IDX, typename F>
+int64_t SerialUnique(HashTable<K>* table, int64_t n, const K* in, IDX* inverse, IDX* count,
+                     const F& unique_fn) {
+  std::memset(table->tags, kEmpty, table->capacity);
+  int64_t num_unique = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    bool inserted = false;
+    const int64_t slot = table->FindOrInsert(0, table->capacity, Hash(in[i]), in[i], i,
+                                             table->capacity, &num_unique, &inserted);
+    auto& entry = table->entries[slot];
+    if (inserted) {
+      entry.value = num_unique - 1;
+      unique_fn(entry.value, i);
+      if (count != nullptr) { count[entry.value] = 0; }
+    }
+    if (count != nullptr) { count[entry.value] += 1; }
+    inverse[i] = static_cast<IDX>(entry.value);
+  }
+  return num_unique;
+}
+
+// Writes the index of the unique key of every input to `inverse` and, if `count` is not null,
+// the number of occurrences of every unique key to `count`. unique_fn(idx, i) is called once for
+// every unique key, with its index and the position of its first occurrence, possibly from
+// several threads. Returns the number of unique keys.
+template<typename K, typename IDX, typename F>
+int64_t Unique(ep::Stream* stream, int64_t n, const K* in, IDX* inverse, IDX* count,
+               void* workspace, int64_t workspace_size, const F& unique_fn) {
+  CHECK_LE(GetWorkspaceSize<K>(n), workspace_size);
+  if (n == 0) { return 0; }
+  const int64_t capacity = Capacity(n);
+  char* ptr = reinterpret_cast<char*>(workspace);
+  HashTable<K> global(ptr, capacity);
+  ptr += HashTable<K>::WorkspaceSize(capacity);
+  HashTable<K> partial(ptr, capacity);
+  ptr += HashTable<K>::WorkspaceSize(capacity);
+  int64_t* bucketed = reinterpret_cast<int64_t*>(ptr);
+  int64_t* slots = reinterpret_cast<int64_t*>(ptr + GetCudaAlignedSize(n * sizeof(int64_t)));
+
+  auto* cpu_stream = stream->As<ep::CpuStream>();
+  const int64_t num_threads = cpu_stream->device()->GetNumThreads();
+  int64_t num_parts = 1;
+  while (num_parts * 2 <= num_threads && capacity / (num_parts * 2) >= kMinPartitionCapacity) {
+    num_parts *= 2;
+  }
+  if (n < kMinParallelSize || num_parts == 1) {
+    return SerialUnique(&global, n, in, inverse, count, unique_fn);
+  }
+  // The input is cut into num_parts chunks and the global table into num_parts partitions. The
+  // partial table of a chunk has about twice as many slots as the chunk has keys.
+  const int64_t part_capacity = capacity / num_parts;
+  const int64_t chunk_size = (n + num_parts - 1) / num_parts;
+  const auto PartitionOf = [&](uint64_t hash) -> int64_t {
+    return (hash >> 32) & (num_parts - 1);
+  };
+  // Generic lambdas, so the per-slot and per-part bodies are inlined into the loops.
+  const auto ParallelForParts = [&](const auto& f) {
+    cpu_stream->ParallelFor(
+        0, num_parts,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t part = begin; part < end; ++part) { f(part); }
+        },
+        1);
+  };
+  const auto ForEachFullSlot = [](const HashTable<K>& table, int64_t part, int64_t part_capacity,
+                                  const auto& f) {
+    for (int64_t slot = part * part_capacity; slot < (part + 1) * part_capacity; ++slot) {
+      if (table.tags[slot] != kEmpty) { f(slot); }
+    }
+  };
+
+  // Phase 1: deduplicate every chunk into its partial table, and bucket the partial entries by
+  // partition of the global table.
+  std::vector<int64_t> offsets(num_parts * num_parts, 0);
+  // The hot loops work on local copies of the tables and bounds, which the compiler would
+  // otherwise reload after every store as they are captured by reference.
+  ParallelForParts([&](int64_t chunk) {
+    HashTable<K> table = partial;
+    int64_t* chunk_slots = slots;
+    const int64_t base = chunk * part_capacity;
+    const int64_t size = part_capacity;
+    const int64_t begin = chunk * chunk_size;
+    const int64_t end = std::min(n, begin + chunk_size);
+    std::memset(table.tags + base, kEmpty, size);
+    int64_t* chunk_counts = offsets.data() + chunk * num_parts;
+    int64_t num_keys = 0;
+    bool inserted = false;
+    for (int64_t i = begin; i < end; ++i) {
+      const uint64_t hash = Hash(in[i]);
+      const int64_t slot =
+          table.FindOrInsert(base, size, hash, in[i], i, size, &num_keys, &inserted);
+      if (inserted) { chunk_counts[PartitionOf(hash)] += 1; }
+      table.entries[slot].value += 1;
+      chunk_slots[i] = slot;
+    }
+  });
+  std::vector<int64_t> part_offsets(num_parts + 1, 0);
+  for (int64_t part = 0; part < num_parts; ++part) {
+    int64_t offset = part_offsets[part];
+    for (int64_t chunk = 0; chunk < num_parts; ++chunk) {
+      const int64_t chunk_count = offsets[chunk * num_parts + part];
+      offsets[chunk * num_parts + part] = offset;
+      offset += chunk_count;
+    }
+    part_offsets[part + 1] = offset;
+  }
+  ParallelForParts([&](int64_t chunk) {
+    int64_t* chunk_offsets = offsets.data() + chunk * num_parts;
+    ForEachFullSlot(partial, chunk, part_capacity, [&](int64_t slot) {
+      bucketed[chunk_offsets[PartitionOf(Hash(partial.entries[slot].key))]++] = slot;
+    });
+  });
+
+  // Phase 2: merge the buckets into the partitions of the global table, and point every partial
+  // entry to its global slot. A partition may receive more distinct keys than it has room for if
+  // the keys hash badly, in which case the whole input is done again by a single thread.
+  std::atomic<bool> overflow(false);
+  ParallelForParts([&](int64_t part) {
+    HashTable<K> table = global;
+    typename HashTable<K>::Entry* partial_entries = partial.entries;
+    const int64_t* bucket = bucketed;
+    const int64_t base = part * part_capacity;
+    const int64_t size = part_capacity;
+    const int64_t max_num_keys = size - size / 8;
+    std::memset(table.tags + base, kEmpty, size);
+    int64_t num_keys = 0;
+    bool inserted = false;
+    for (int64_t k = part_offsets[part]; k < part_offsets[part + 1]; ++k) {
+      auto& entry = partial_entries[bucket[k]];
+      const int64_t slot = table.FindOrInsert(base, size, Hash(entry.key), entry.key,
+                                              entry.position, max_num_keys, &num_keys, &inserted);
+      if (slot < 0) {
+        overflow = true;
+        return;
+      }
+      auto& global_entry = table.entries[slot];
+      global_entry.position = std::min(global_entry.position, entry.position);
+      global_entry.value += entry.value;
+      entry.value = slot;
+    }
+  });
+  if (overflow) { return SerialUnique(&global, n, in, inverse, count, unique_fn); }
+
+  // Number the unique keys by their first position: mark the first positions, count the marks
+  // of every chunk, then number the marked positions of every chunk in order.
+  int64_t* first = bucketed;
+  cpu_stream->ParallelFor(0, n, [&](int64_t begin, int64_t end) {
+    std::memset(first + begin, 0, (end - begin) * sizeof(int64_t));
+  });
+  ParallelForParts([&](int64_t part) {
+    ForEachFullSlot(global, part, part_capacity,
+                    [&](int64_t slot) { first[global.entries[slot].position] = 1; });
+  });
+  std::vector<int64_t> chunk_sums(num_parts + 1, 0);
+  ParallelForParts([&](int64_t chunk) {
+    const int64_t begin = chunk * chunk_size;
+    const int64_t end = std::min(n, begin + chunk_size);
+    chunk_sums[chunk + 1] = std::accumulate(first + begin, first + end, int64_t(0));
+  });
+  for (int64_t chunk = 0; chunk < num_parts; ++chunk) {
+    chunk_sums[chunk + 1] += chunk_sums[chunk];
+  }
+  ParallelForParts([&](int64_t chunk) {
+    auto* global_entries = global.entries;
+    const auto* partial_entries = partial.entries;
+    const int64_t* marks = first;
+    const int64_t* input_slots = slots;
+    const int64_t begin = chunk * chunk_size;
+    const int64_t end = std::min(n, begin + chunk_size);
+    int64_t idx = chunk_sums[chunk];
+    for (int64_t i = begin; i < end; ++i) {
+      if (marks[i] == 0) { continue; }
+      auto& entry = global_entries[partial_entries[input_slots[i]].value];
+      unique_fn(idx, i);
+      if (count != nullptr) { count[idx] = static_cast<IDX>(entry.value); }
+      entry.value = idx;
+      idx += 1;
+    }
+  });
+  cpu_stream->ParallelFor(0, n, [&](int64_t begin, int64_t end) {
+    const auto* global_entries = global.entries;
+    const auto* partial_entries = partial.entries;
+    const int64_t* input_slots = slots;
+    IDX* out = inverse;
+    for (int64_t i = begin; i < end; ++i) {
+      out[i] = static_cast<IDX>(global_entries[partial_entries[input_slots[i]].value].value);
+    }
+  });
+  return chunk_sums[num_parts];
+}
+
+}  // namespace cpu_unique
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_CPU_UNIQUE_H_
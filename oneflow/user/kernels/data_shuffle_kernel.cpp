@@ -0,0 +1,328 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#include "oneflow/user/kernels/cpu_unique.h"
+#include <numeric>
+
+namespace oneflow {
+
+namespace {
+
+template<typename F>
+void ParallelForRows(ep::Stream* stream, int64_t num_rows, int64_t row_size, const F& f) {
+  const int64_t grain = std::max<int64_t>(32768 / std::max<int64_t>(row_size, 1), 1);
+  stream->As<ep::CpuStream>()->ParallelFor(0, num_rows, f, grain);
+}
+
+// Deduplicates keys in first-occurrence order. When process_values is set the value of the first
+// occurrence of every key is kept, values being generated as i % num_tables if absent.
+template<typename K, typename V, typename IDX>
+IDX UniqueKeysAndValues(ep::Stream* stream, const int64_t num_keys, const K* keys, const V* values,
+                        const int32_t num_tables, const bool process_values, K* unique_keys,
+                        V* unique_values, IDX* inverse_indices, user_op::Tensor* tmp_buffer) {
+  return static_cast<IDX>(cpu_unique::Unique<K, IDX>(
+      stream, num_keys, keys, inverse_indices, nullptr, tmp_buffer->mut_dptr(),
+      tmp_buffer->shape().elem_cnt(), [&](int64_t idx, int64_t first) {
+        unique_keys[idx] = keys[first];
+        if (process_values) {
+          unique_values[idx] =
+              values != nullptr ? values[first] : static_cast<V>(first % num_tables);
+        }
+      }));
+}
+
+void CheckSingleRank(user_op::KernelComputeContext* ctx) {
+  CHECK_EQ(ctx->parallel_ctx().parallel_num(), 1)
+      << "The cpu kernel of " << ctx->op_type_name()
+      << " only supports a single rank, place one embedding on cuda devices for multiple ranks";
+}
+
+}  // namespace
+
+template<typename K, typename U, typename IDX>
+class CpuIdShuffleKernel final : public user_op::OpKernel {
+ public:
+  CpuIdShuffleKernel() = default;
+  ~CpuIdShuffleKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    CheckSingleRank(ctx);
+    const user_op::Tensor* ids = ctx->Tensor4ArgNameAndIndex("ids", 0);
+    user_op::Tensor* num_unique_matrix = ctx->Tensor4ArgNameAndIndex("num_unique_matrix", 0);
+    user_op::Tensor* inverse_unique_partition_indices =
+        ctx->Tensor4ArgNameAndIndex("inverse_unique_partition_indices", 0);
+    user_op::Tensor* cur_rank_num_unique = ctx->Tensor4ArgNameAndIndex("cur_rank_num_unique", 0);
+    user_op::Tensor* cur_rank_unique_ids = ctx->Tensor4ArgNameAndIndex("cur_rank_unique_ids", 0);
+    user_op::Tensor* cur_rank_unique_table_ids =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_unique_table_ids", 0);
+    user_op::Tensor* cur_rank_inverse_indices =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_inverse_indices", 0);
+    const int32_t num_tables = ctx->Attr<int32_t>("num_tables");
+    const bool has_table_ids = ctx->has_input("table_ids", 0);
+    const bool need_process_table_ids = (has_table_ids || num_tables > 1);
+    const int64_t num_ids = ids->shape().elem_cnt();
+    const U* table_ids_ptr = nullptr;
+    if (has_table_ids) {
+      const user_op::Tensor* table_ids = ctx->Tensor4ArgNameAndIndex("table_ids", 0);
+      table_ids_ptr = reinterpret_cast<const U*>(table_ids->dptr());
+    }
+    U* unique_table_ids_ptr = reinterpret_cast<U*>(cur_rank_unique_table_ids->mut_dptr());
+    // With a single rank the partitioned unique ids are already the ids of the current rank, so
+    // the second deduplication of the cuda kernel is the identity.
+    const IDX num_unique = UniqueKeysAndValues<K, U, IDX>(
+        ctx->stream(), num_ids, reinterpret_cast<const K*>(ids->dptr()), table_ids_ptr,
+        num_tables, need_process_table_ids,
+        reinterpret_cast<K*>(cur_rank_unique_ids->mut_dptr()), unique_table_ids_ptr,
+        reinterpret_cast<IDX*>(inverse_unique_partition_indices->mut_dptr()),
+        ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0));
+    if (!need_process_table_ids) {
+      std::fill(unique_table_ids_ptr, unique_table_ids_ptr + num_unique, static_cast<U>(0));
+    }
+    IDX* cur_rank_inverse_indices_ptr =
+        reinterpret_cast<IDX*>(cur_rank_inverse_indices->mut_dptr());
+    std::iota(cur_rank_inverse_indices_ptr, cur_rank_inverse_indices_ptr + num_unique, 0);
+    *reinterpret_cast<IDX*>(num_unique_matrix->mut_dptr()) = num_unique;
+    *reinterpret_cast<IDX*>(cur_rank_num_unique->mut_dptr()) = num_unique;
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define ID_DATA_TYPE_SEQ                            \
+  OF_PP_MAKE_TUPLE_SEQ(uint32_t, DataType::kUInt32) \
+  OF_PP_MAKE_TUPLE_SEQ(uint64_t, DataType::kUInt64) \
+  OF_PP_MAKE_TUPLE_SEQ(int32_t, DataType::kInt32)   \
+  OF_PP_MAKE_TUPLE_SEQ(int64_t, DataType::kInt64)
+
+#define TABLE_ID_DATA_TYPE_SEQ                      \
+  OF_PP_MAKE_TUPLE_SEQ(uint8_t, DataType::kUInt8)   \
+  OF_PP_MAKE_TUPLE_SEQ(uint32_t, DataType::kUInt32) \
+  OF_PP_MAKE_TUPLE_SEQ(uint64_t, DataType::kUInt64) \
+  OF_PP_MAKE_TUPLE_SEQ(int8_t, DataType::kInt8)     \
+  OF_PP_MAKE_TUPLE_SEQ(int32_t, DataType::kInt32)   \
+  OF_PP_MAKE_TUPLE_SEQ(int64_t, DataType::kInt64)
+
+#define IDX_DATA_TYPE_SEQ                           \
+  OF_PP_MAKE_TUPLE_SEQ(uint32_t, DataType::kUInt32) \
+  OF_PP_MAKE_TUPLE_SEQ(int32_t, DataType::kInt32)
+
+#define REGISTER_CPU_ID_SHUFFLE_KERNEL(k_dtype_pair, table_id_dtype_pair, idx_dtype_pair)         \
+  REGISTER_USER_KERNEL("id_shuffle")                                                              \
+      .SetCreateFn<CpuIdShuffleKernel<OF_PP_PAIR_FIRST(k_dtype_pair),                             \
+                                      OF_PP_PAIR_FIRST(table_id_dtype_pair),                      \
+                                      OF_PP_PAIR_FIRST(idx_dtype_pair)>>()                        \
+      .SetIsMatchedHob(                                                                           \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                          \
+          && (user_op::HobDataType("ids", 0) == OF_PP_PAIR_SECOND(k_dtype_pair))                  \
+          && (user_op::HobDataType("cur_rank_unique_table_ids", 0)                                \
+              == OF_PP_PAIR_SECOND(table_id_dtype_pair))                                          \
+          && (user_op::HobDataType("num_unique_matrix", 0) == OF_PP_PAIR_SECOND(idx_dtype_pair))) \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                         \
+        return cpu_unique::GetWorkspaceSize<OF_PP_PAIR_FIRST(k_dtype_pair)>(                      \
+            ctx->InputTensorDesc("ids", 0).shape().elem_cnt());                                   \
+      });
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_CPU_ID_SHUFFLE_KERNEL, ID_DATA_TYPE_SEQ,
+                                 TABLE_ID_DATA_TYPE_SEQ, IDX_DATA_TYPE_SEQ)
+
+template<typename T, typename IDX>
+class CpuEmbeddingShuffleKernel final : public user_op::OpKernel {
+ public:
+  CpuEmbeddingShuffleKernel() = default;
+  ~CpuEmbeddingShuffleKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    CheckSingleRank(ctx);
+    const user_op::Tensor* cur_rank_embeddings =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_embeddings", 0);
+    const user_op::Tensor* cur_rank_inverse_indices =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_inverse_indices", 0);
+    const user_op::Tensor* inverse_unique_partition_indices =
+        ctx->Tensor4ArgNameAndIndex("inverse_unique_partition_indices", 0);
+    user_op::Tensor* embeddings = ctx->Tensor4ArgNameAndIndex("embeddings", 0);
+    const int64_t embedding_size = cur_rank_embeddings->shape().At(1);
+    const int64_t num_ids = inverse_unique_partition_indices->shape().elem_cnt();
+    const IDX* cur_rank_inverse_indices_ptr =
+        reinterpret_cast<const IDX*>(cur_rank_inverse_indices->dptr());
+    const IDX* inverse_unique_partition_indices_ptr =
+        reinterpret_cast<const IDX*>(inverse_unique_partition_indices->dptr());
+    const T* cur_rank_embeddings_ptr = cur_rank_embeddings->dptr<T>();
+    T* embeddings_ptr = embeddings->mut_dptr<T>();
+    ParallelForRows(ctx->stream(), num_ids, embedding_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const IDX row = cur_rank_inverse_indices_ptr[inverse_unique_partition_indices_ptr[i]];
+        std::copy(cur_rank_embeddings_ptr + row * embedding_size,
+                  cur_rank_embeddings_ptr + (row + 1) * embedding_size,
+                  embeddings_ptr + i * embedding_size);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CPU_EMBEDDING_SHUFFLE_KERNEL(t_dtype_pair, idx_dtype_pair)                       \
+  REGISTER_USER_KERNEL("embedding_shuffle")                                                       \
+      .SetCreateFn<CpuEmbeddingShuffleKernel<OF_PP_PAIR_FIRST(t_dtype_pair),                      \
+                                             OF_PP_PAIR_FIRST(idx_dtype_pair)>>()                 \
+      .SetIsMatchedHob(                                                                           \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                          \
+          && (user_op::HobDataType("cur_rank_embeddings", 0) == OF_PP_PAIR_SECOND(t_dtype_pair))  \
+          && (user_op::HobDataType("num_unique_matrix", 0) == OF_PP_PAIR_SECOND(idx_dtype_pair)));
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_CPU_EMBEDDING_SHUFFLE_KERNEL, FLOATING_DATA_TYPE_SEQ,
+                                 IDX_DATA_TYPE_SEQ)
+
+template<typename T, typename IDX>
+class CpuEmbeddingGradientShuffleKernel final : public user_op::OpKernel {
+ public:
+  CpuEmbeddingGradientShuffleKernel() = default;
+  ~CpuEmbeddingGradientShuffleKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    CheckSingleRank(ctx);
+    const user_op::Tensor* embedding_grad = ctx->Tensor4ArgNameAndIndex("embedding_grad", 0);
+    const user_op::Tensor* num_unique_matrix = ctx->Tensor4ArgNameAndIndex("num_unique_matrix", 0);
+    const user_op::Tensor* cur_rank_inverse_indices =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_inverse_indices", 0);
+    const user_op::Tensor* inverse_unique_partition_indices =
+        ctx->Tensor4ArgNameAndIndex("inverse_unique_partition_indices", 0);
+    user_op::Tensor* cur_rank_unique_embedding_grad =
+        ctx->Tensor4ArgNameAndIndex("cur_rank_unique_embedding_grad", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t embedding_size = cur_rank_unique_embedding_grad->shape().At(1);
+    const int64_t num_rows = cur_rank_unique_embedding_grad->shape().At(0);
+    const int64_t num_ids = inverse_unique_partition_indices->shape().elem_cnt();
+    const int64_t num_unique = *reinterpret_cast<const IDX*>(num_unique_matrix->dptr());
+    CHECK_LE(num_unique, num_rows);
+    const IDX* cur_rank_inverse_indices_ptr =
+        reinterpret_cast<const IDX*>(cur_rank_inverse_indices->dptr());
+    const IDX* inverse_unique_partition_indices_ptr =
+        reinterpret_cast<const IDX*>(inverse_unique_partition_indices->dptr());
+
+    // Bucket the ids by destination row first, so that every row is summed by a single thread
+    // in a fixed order and the result does not depend on the thread count.
+    CHECK_GE(tmp_buffer->shape().elem_cnt(), (num_rows + 1 + num_ids) * sizeof(int64_t));
+    int64_t* row_offsets = tmp_buffer->mut_dptr<int64_t>();
+    int64_t* sorted_ids = row_offsets + num_rows + 1;
+    std::fill(row_offsets, row_offsets + num_unique + 1, 0);
+    for (int64_t i = 0; i < num_ids; ++i) {
+      const IDX row = cur_rank_inverse_indices_ptr[inverse_unique_partition_indices_ptr[i]];
+      row_offsets[row + 1] += 1;
+    }
+    for (int64_t row = 0; row < num_unique; ++row) { row_offsets[row + 1] += row_offsets[row]; }
+    for (int64_t i = 0; i < num_ids; ++i) {
+      const IDX row = cur_rank_inverse_indices_ptr[inverse_unique_partition_indices_ptr[i]];
+      sorted_ids[row_offsets[row]++] = i;
+    }
+    // row_offsets[row] now holds the end of the bucket of row.
+    const T* embedding_grad_ptr = embedding_grad->dptr<T>();
+    T* unique_embedding_grad_ptr = cur_rank_unique_embedding_grad->mut_dptr<T>();
+    ParallelForRows(ctx->stream(), num_unique, embedding_size, [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        T* out = unique_embedding_grad_ptr + row * embedding_size;
+        std::fill(out, out + embedding_size, static_cast<T>(0));
+        const int64_t bucket_begin = row == 0 ? 0 : row_offsets[row - 1];
+        for (int64_t k = bucket_begin; k < row_offsets[row]; ++k) {
+          const T* in = embedding_grad_ptr + sorted_ids[k] * embedding_size;
+          for (int64_t col = 0; col < embedding_size; ++col) { out[col] += in[col]; }
+        }
+      }
+    });
+    std::fill(unique_embedding_grad_ptr + num_unique * embedding_size,
+              unique_embedding_grad_ptr + num_rows * embedding_size, static_cast<T>(0));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CPU_EMBEDDING_GRADIENT_SHUFFLE_KERNEL(t_dtype_pair, idx_dtype_pair)              \
+  REGISTER_USER_KERNEL("embedding_gradient_shuffle")                                              \
+      .SetCreateFn<CpuEmbeddingGradientShuffleKernel<OF_PP_PAIR_FIRST(t_dtype_pair),              \
+                                                     OF_PP_PAIR_FIRST(idx_dtype_pair)>>()         \
+      .SetIsMatchedHob(                                                                           \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                          \
+          && (user_op::HobDataType("embedding_grad", 0) == OF_PP_PAIR_SECOND(t_dtype_pair))       \
+          && (user_op::HobDataType("num_unique_matrix", 0) == OF_PP_PAIR_SECOND(idx_dtype_pair))) \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                         \
+        const user_op::TensorDesc& cur_rank_inverse_indices =                                     \
+            ctx->InputTensorDesc("cur_rank_inverse_indices", 0);                                  \
+        const user_op::TensorDesc& inverse_unique_partition_indices =                             \
+            ctx->InputTensorDesc("inverse_unique_partition_indices", 0);                          \
+        return (cur_rank_inverse_indices.shape().elem_cnt() + 1                                   \
+                + inverse_unique_partition_indices.shape().elem_cnt())                            \
+               * sizeof(int64_t);                                                                 \
+      });
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_CPU_EMBEDDING_GRADIENT_SHUFFLE_KERNEL,
+                                 FLOATING_DATA_TYPE_SEQ, IDX_DATA_TYPE_SEQ)
+
+template<typename K, typename V, typename IDX>
+class CpuUniqueKeyValuePairKernel final : public user_op::OpKernel {
+ public:
+  CpuUniqueKeyValuePairKernel() = default;
+  ~CpuUniqueKeyValuePairKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* keys = ctx->Tensor4ArgNameAndIndex("keys", 0);
+    user_op::Tensor* num_unique = ctx->Tensor4ArgNameAndIndex("num_unique", 0);
+    user_op::Tensor* unique_keys = ctx->Tensor4ArgNameAndIndex("unique_keys", 0);
+    user_op::Tensor* unique_values = ctx->Tensor4ArgNameAndIndex("unique_values", 0);
+    user_op::Tensor* inverse_indices = ctx->Tensor4ArgNameAndIndex("inverse_indices", 0);
+    const int32_t num_tables = ctx->Attr<int32_t>("num_tables");
+    const bool has_values = ctx->has_input("values", 0);
+    const bool need_process_table_ids = (has_values || num_tables > 1);
+    const V* values_ptr = nullptr;
+    if (has_values) {
+      values_ptr = reinterpret_cast<const V*>(ctx->Tensor4ArgNameAndIndex("values", 0)->dptr());
+    }
+    *reinterpret_cast<IDX*>(num_unique->mut_dptr()) = UniqueKeysAndValues<K, V, IDX>(
+        ctx->stream(), keys->shape().elem_cnt(), reinterpret_cast<const K*>(keys->dptr()),
+        values_ptr, num_tables, need_process_table_ids,
+        reinterpret_cast<K*>(unique_keys->mut_dptr()),
+        reinterpret_cast<V*>(unique_values->mut_dptr()),
+        reinterpret_cast<IDX*>(inverse_indices->mut_dptr()),
+        ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CPU_UNIQUE_KEY_VALUE_PAIR_KERNEL(k_dtype_pair, value_dtype_pair, idx_dtype_pair) \
+  REGISTER_USER_KERNEL("unique_key_value_pair")                                                   \
+      .SetCreateFn<CpuUniqueKeyValuePairKernel<OF_PP_PAIR_FIRST(k_dtype_pair),                    \
+                                               OF_PP_PAIR_FIRST(value_dtype_pair),                \
+                                               OF_PP_PAIR_FIRST(idx_dtype_pair)>>()               \
+      .SetIsMatchedHob(                                                                           \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                          \
+          && (user_op::HobDataType("keys", 0) == OF_PP_PAIR_SECOND(k_dtype_pair))                 \
+          && (user_op::HobDataType("inverse_indices", 0) == OF_PP_PAIR_SECOND(idx_dtype_pair))    \
+          && (user_op::HobDataType("unique_values", 0) == OF_PP_PAIR_SECOND(value_dtype_pair)))   \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                         \
+        return cpu_unique::GetWorkspaceSize<OF_PP_PAIR_FIRST(k_dtype_pair)>(                      \
+            ctx->InputTensorDesc("keys", 0).shape().elem_cnt());                                  \
+      });
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_CPU_UNIQUE_KEY_VALUE_PAIR_KERNEL, ID_DATA_TYPE_SEQ,
+                                 ID_DATA_TYPE_SEQ, IDX_DATA_TYPE_SEQ)
+
+}  // namespace oneflow
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/dim_gather_kernel_util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
@@ -26,8 +27,19 @@ struct DimGatherFunctor<DeviceType::kCPU, IN_T, IDX_T> final {
                   const DimOpIndexNdHelper<IDX_T>& index_nd_helper, int ndim, int64_t elem_cnt,
                   int32_t dim_length, int32_t dim, const IDX_T* index, const IN_T* input,
                   IN_T* output) {
-    DoDimGather<IN_T, IDX_T>(input_nd_helper, index_nd_helper, ndim, elem_cnt, dim_length, dim,
-                             index, input, output);
+    // Same as DoDimGather, with the output elements split over the threads.
+    stream->As<ep::CpuStream>()->ParallelFor(0, elem_cnt, [&](int64_t begin, int64_t end) {
+      for (int64_t index_offset = begin; index_offset < end; ++index_offset) {
+        IDX_T coordinate[kDimGatherMaxDimCount] = {0};
+        const IDX_T x = index[index_offset];
+        CHECK_LE(x, dim_length) << "RuntimeError: index " << x
+                                << " is out of bounds for dimension " << dim << " with size "
+                                << dim_length;
+        index_nd_helper.OffsetToNdIndex(index_offset, coordinate, ndim);
+        coordinate[dim] = x;
+        output[index_offset] = input[input_nd_helper.NdIndexToOffset(coordinate, ndim)];
+      }
+    });
   }
 };
 
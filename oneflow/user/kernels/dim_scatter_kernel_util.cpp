@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/dim_scatter_kernel_util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 namespace user_op {
@@ -27,8 +28,46 @@ struct DimScatterFunctor<DeviceType::kCPU, IN_T, IDX_T, Opt> final {
                   const DimOpIndexNdHelper<IDX_T>& output_nd_helper, const int ndim,
                   const int64_t elem_cnt, const int32_t dim, const int64_t upper_bound,
                   const IDX_T* index, const IN_T* src, IN_T* output) {
-    DoDimScatter<IN_T, IDX_T, Opt>(src_nd_helper, idx_nd_helper, output_nd_helper, ndim, elem_cnt,
-                                   dim, upper_bound, index, src, output);
+    if (elem_cnt == 0) { return; }
+    // Index elements that differ outside `dim` never write the same output element, so the
+    // (outer, inner) lanes around `dim` are split over the threads. Each lane walks `dim` in
+    // order, which keeps the accumulation order, and the result, of the serial loop.
+    IDX_T last[kDimGatherMaxDimCount] = {0};
+    idx_nd_helper.OffsetToNdIndex(elem_cnt - 1, last, ndim);
+    int64_t outer_size = 1;
+    int64_t inner_size = 1;
+    for (int i = 0; i < dim; ++i) { outer_size *= last[i] + 1; }
+    for (int i = dim + 1; i < ndim; ++i) { inner_size *= last[i] + 1; }
+    const int64_t dim_size = last[dim] + 1;
+    stream->As<ep::CpuStream>()->ParallelFor(
+        0, outer_size * inner_size,
+        [&](int64_t begin, int64_t end) {
+          IDX_T coordinate[kDimGatherMaxDimCount] = {0};
+          for (int64_t lane = begin; lane < end;) {
+            // Lanes of the same outer index are contiguous in memory, so they go together.
+            const int64_t outer_idx = lane / inner_size;
+            const int64_t lane_end = std::min(end, (outer_idx + 1) * inner_size);
+            for (int64_t j = 0; j < dim_size; ++j) {
+              for (int64_t inner_idx = lane - outer_idx * inner_size;
+                   inner_idx < lane_end - outer_idx * inner_size; ++inner_idx) {
+                const int64_t idx_offset = (outer_idx * dim_size + j) * inner_size + inner_idx;
+                idx_nd_helper.OffsetToNdIndex(idx_offset, coordinate, ndim);
+                const IDX_T idx_elem = index[idx_offset];
+                if (idx_elem >= upper_bound) {
+                  UNIMPLEMENTED() << "The index element " << idx_elem
+                                  << " is out of bounds for dimension " << dim << " with size "
+                                  << upper_bound << ".";
+                }
+                const IDX_T src_offset = src_nd_helper.NdIndexToOffset(coordinate, ndim);
+                coordinate[dim] = idx_elem;
+                Opt<IN_T>::apply(src + src_offset,
+                                 output + output_nd_helper.NdIndexToOffset(coordinate, ndim));
+              }
+            }
+            lane = lane_end;
+          }
+        },
+        std::max<int64_t>(32768 / dim_size, 1));
   }
 };
 
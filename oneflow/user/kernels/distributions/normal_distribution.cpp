@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "oneflow/user/kernels/distributions/normal_distribution.h"
 #include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/random_philox_util.h"
 
 namespace oneflow {
 
@@ -23,10 +24,20 @@ template<typename T>
 void NormalDistribution<DeviceType::kCPU, T>::operator()(
     ep::Stream* stream, const int64_t elem_cnt, T* dptr,
     const std::shared_ptr<one::Generator>& generator) const {
-  CHECK_GE(elem_cnt, 0);
   auto gen = CHECK_JUST(generator->Get<one::CPUGeneratorImpl>());
-  std::normal_distribution<T> random_distribution(mean_, std_);
-  for (int64_t i = 0; i < elem_cnt; ++i) { dptr[i] = random_distribution(gen->engine()); }
+  const T mean = mean_;
+  const T stddev = std_;
+  // Box-Muller on consecutive pairs of uniforms, 1 - u keeps the logarithm finite.
+  PhiloxUniformForEach<T>(
+      stream, gen.get(), elem_cnt, [&](int64_t first, int64_t count, const T* uniform) {
+        T* out = dptr + first;
+        for (int64_t i = 0; i < count; i += 2) {
+          const T radius = std::sqrt(static_cast<T>(-2) * std::log(1 - uniform[i]));
+          const T theta = static_cast<T>(2 * M_PI) * uniform[i + 1];
+          out[i] = mean + stddev * radius * std::cos(theta);
+          if (i + 1 < count) { out[i + 1] = mean + stddev * radius * std::sin(theta); }
+        }
+      });
 }
 
 #define INITIATE_CPU_NORMAL_DISTRIBUTION(T, typeproto)               \
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/user/kernels/op_kernel_wrapper.h"
 #include "oneflow/core/kernel/kernel_util.h"
 #include "oneflow/user/kernels/dropout_kernel.h"
+#include "oneflow/user/kernels/random_philox_util.h"
 #include "oneflow/core/ep/include/primitive/add.h"
 
 namespace oneflow {
@@ -34,15 +35,21 @@ void FusedDropoutKernel(ep::Stream* stream, const int64_t elem_cnt,
                         const std::shared_ptr<one::CPUGeneratorImpl>& cpu_gen, const float rate,
                         float scale, const T* x, bool* mask, T* y) {
   /*
-  `uniform_real_distribution` interval is [a, b).
+  Philox uniforms lie in [0, 1).
   And `curand_uniform4` interval is (0, 1.0], so we use > in CUDA and use >= in CPU.
+  The mask and the output of each chunk are written in the same pass over the random numbers.
   */
-  std::uniform_real_distribution<float> random_distribution(GetZeroVal<float>(),
-                                                            GetOneVal<float>());
-  for (int64_t i = 0; i < elem_cnt; ++i) {
-    mask[i] = random_distribution(cpu_gen->engine()) >= rate;
-    y[i] = x[i] * static_cast<T>(mask[i]) * scale;
-  }
+  PhiloxUniformForEach<float>(stream, cpu_gen.get(), elem_cnt,
+                              [&](int64_t first, int64_t count, const float* uniform) {
+                                const T* x_ptr = x + first;
+                                bool* mask_ptr = mask + first;
+                                T* y_ptr = y + first;
+                                for (int64_t i = 0; i < count; ++i) {
+                                  const bool keep = uniform[i] >= rate;
+                                  mask_ptr[i] = keep;
+                                  y_ptr[i] = x_ptr[i] * static_cast<T>(keep) * scale;
+                                }
+                              });
 }
 
 template<typename T>
@@ -0,0 +1,506 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace oneflow {
+
+namespace {
+
+// Every dot product keeps kLanes independent partial sums, so the inner loops vectorize without
+// -ffast-math reassociating a single accumulator.
+constexpr int64_t kLanes = 8;
+constexpr int64_t kBlockSize = 4;
+
+template<typename T>
+T Dot(const T* x, const T* y, int64_t n) {
+  T acc[kLanes] = {};
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64_t l = 0; l < kLanes; ++l) { acc[l] += x[i + l] * y[i + l]; }
+  }
+  T sum = 0;
+  for (int64_t l = 0; l < kLanes; ++l) { sum += acc[l]; }
+  for (; i < n; ++i) { sum += x[i] * y[i]; }
+  return sum;
+}
+
+// Dot products of x with kBlockSize rows at once, so every load of x feeds four FMAs.
+template<typename T>
+void DotBlock(const T* x, const T* const* y, int64_t n, T* out) {
+  const T* y0 = y[0];
+  const T* y1 = y[1];
+  const T* y2 = y[2];
+  const T* y3 = y[3];
+  T acc0[kLanes] = {};
+  T acc1[kLanes] = {};
+  T acc2[kLanes] = {};
+  T acc3[kLanes] = {};
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64_t l = 0; l < kLanes; ++l) {
+      const T v = x[i + l];
+      acc0[l] += v * y0[i + l];
+      acc1[l] += v * y1[i + l];
+      acc2[l] += v * y2[i + l];
+      acc3[l] += v * y3[i + l];
+    }
+  }
+  T sum0 = 0;
+  T sum1 = 0;
+  T sum2 = 0;
+  T sum3 = 0;
+  for (int64_t l = 0; l < kLanes; ++l) {
+    sum0 += acc0[l];
+    sum1 += acc1[l];
+    sum2 += acc2[l];
+    sum3 += acc3[l];
+  }
+  for (; i < n; ++i) {
+    const T v = x[i];
+    sum0 += v * y0[i];
+    sum1 += v * y1[i];
+    sum2 += v * y2[i];
+    sum3 += v * y3[i];
+  }
+  out[0] = sum0;
+  out[1] = sum1;
+  out[2] = sum2;
+  out[3] = sum3;
+}
+
+// y += sum_k coeff[k] * x[k] over kBlockSize rows, so every load and store of y is shared.
+template<typename T>
+void AxpyBlock(const T* coeff, const T* const* x, int64_t n, T* y) {
+  const T a0 = coeff[0];
+  const T a1 = coeff[1];
+  const T a2 = coeff[2];
+  const T a3 = coeff[3];
+  const T* x0 = x[0];
+  const T* x1 = x[1];
+  const T* x2 = x[2];
+  const T* x3 = x[3];
+  for (int64_t i = 0; i < n; ++i) { y[i] += a0 * x0[i] + a1 * x1[i] + a2 * x2[i] + a3 * x3[i]; }
+}
+
+#ifdef __SSE2__
+
+inline float HorizontalSum(__m128 v) {
+  const __m128 high = _mm_movehl_ps(v, v);
+  const __m128 pair = _mm_add_ps(v, high);
+  return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+
+// Auto-vectorization of the lane loops above is fragile across optimization levels, so float,
+// the type DLRM runs in, gets explicit SSE2 versions.
+template<>
+float Dot<float>(const float* x, const float* y, int64_t n) {
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+  }
+  float sum = HorizontalSum(_mm_add_ps(acc0, acc1));
+  for (; i < n; ++i) { sum += x[i] * y[i]; }
+  return sum;
+}
+
+template<>
+void DotBlock<float>(const float* x, const float* const* y, int64_t n, float* out) {
+  const float* y0 = y[0];
+  const float* y1 = y[1];
+  const float* y2 = y[2];
+  const float* y3 = y[3];
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  __m128 acc2 = _mm_setzero_ps();
+  __m128 acc3 = _mm_setzero_ps();
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 v = _mm_loadu_ps(x + i);
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(v, _mm_loadu_ps(y0 + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(v, _mm_loadu_ps(y1 + i)));
+    acc2 = _mm_add_ps(acc2, _mm_mul_ps(v, _mm_loadu_ps(y2 + i)));
+    acc3 = _mm_add_ps(acc3, _mm_mul_ps(v, _mm_loadu_ps(y3 + i)));
+  }
+  float sum0 = HorizontalSum(acc0);
+  float sum1 = HorizontalSum(acc1);
+  float sum2 = HorizontalSum(acc2);
+  float sum3 = HorizontalSum(acc3);
+  for (; i < n; ++i) {
+    const float v = x[i];
+    sum0 += v * y0[i];
+    sum1 += v * y1[i];
+    sum2 += v * y2[i];
+    sum3 += v * y3[i];
+  }
+  out[0] = sum0;
+  out[1] = sum1;
+  out[2] = sum2;
+  out[3] = sum3;
+}
+
+template<>
+void AxpyBlock<float>(const float* coeff, const float* const* x, int64_t n, float* y) {
+  const float* x0 = x[0];
+  const float* x1 = x[1];
+  const float* x2 = x[2];
+  const float* x3 = x[3];
+  const __m128 a0 = _mm_set1_ps(coeff[0]);
+  const __m128 a1 = _mm_set1_ps(coeff[1]);
+  const __m128 a2 = _mm_set1_ps(coeff[2]);
+  const __m128 a3 = _mm_set1_ps(coeff[3]);
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 sum = _mm_add_ps(_mm_mul_ps(a0, _mm_loadu_ps(x0 + i)),
+                            _mm_mul_ps(a1, _mm_loadu_ps(x1 + i)));
+    sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(a2, _mm_loadu_ps(x2 + i)),
+                                     _mm_mul_ps(a3, _mm_loadu_ps(x3 + i))));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), sum));
+  }
+  for (; i < n; ++i) {
+    y[i] += coeff[0] * x0[i] + coeff[1] * x1[i] + coeff[2] * x2[i] + coeff[3] * x3[i];
+  }
+}
+
+#endif  // __SSE2__
+
+// Offset of row r of the lower triangle in the flattened interaction, which keeps the columns
+// c < r + offset of every row.
+inline int64_t TrilRowOffset(int64_t r, int64_t offset) { return r * (r - 1 + 2 * offset) / 2; }
+
+struct FeatureParam {
+  std::vector<int64_t> feature_dims;
+  int64_t concated_dim;
+  int64_t vector_size;
+};
+
+FeatureParam GetFeatureParam(const std::vector<const user_op::Tensor*>& features) {
+  FeatureParam param;
+  param.concated_dim = 0;
+  for (const user_op::Tensor* feature : features) {
+    param.feature_dims.push_back(feature->shape().At(1));
+    param.concated_dim += feature->shape().At(1);
+  }
+  param.vector_size = features.front()->shape().At(2);
+  return param;
+}
+
+// Collects the rows of one sample of the concatenated features without copying them.
+template<typename Ptr>
+void GetSampleRows(const std::vector<Ptr>& features, const FeatureParam& param, int64_t sample,
+                   Ptr* rows) {
+  const int64_t vector_size = param.vector_size;
+  int64_t row = 0;
+  for (size_t i = 0; i < features.size(); ++i) {
+    const int64_t feature_dim = param.feature_dims.at(i);
+    Ptr sample_ptr = features.at(i) + sample * feature_dim * vector_size;
+    for (int64_t j = 0; j < feature_dim; ++j) { rows[row++] = sample_ptr + j * vector_size; }
+  }
+}
+
+int64_t GetSampleGrainSize(int64_t sample_work) {
+  return std::max<int64_t>(32768 / std::max<int64_t>(sample_work, 1), 1);
+}
+
+std::vector<const user_op::Tensor*> GetInputs(user_op::KernelComputeContext* ctx,
+                                              const std::string& name) {
+  std::vector<const user_op::Tensor*> tensors;
+  for (int32_t i = 0; i < ctx->input_size(name); ++i) {
+    tensors.push_back(ctx->Tensor4ArgNameAndIndex(name, i));
+  }
+  return tensors;
+}
+
+template<typename T>
+class FusedDotFeatureInteractionCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedDotFeatureInteractionCpuKernel() = default;
+  ~FusedDotFeatureInteractionCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const std::vector<const user_op::Tensor*> feature_tensors = GetInputs(ctx, "features");
+    const FeatureParam param = GetFeatureParam(feature_tensors);
+    std::vector<const T*> features;
+    for (const user_op::Tensor* feature : feature_tensors) {
+      features.push_back(feature->dptr<T>());
+    }
+    const int64_t batch_size = out->shape().At(0);
+    const int64_t out_dim = out->shape().At(1);
+    const int64_t num_rows = param.concated_dim;
+    const int64_t vector_size = param.vector_size;
+    const int64_t offset = ctx->Attr<bool>("self_interaction") ? 1 : 0;
+    const int64_t interaction_dim = TrilRowOffset(num_rows, offset);
+    const int64_t output_padding = ctx->Attr<int32_t>("output_padding");
+    int64_t output_concat_dim = 0;
+    const T* output_concat = nullptr;
+    if (ctx->has_input("output_concat", 0)) {
+      const user_op::Tensor* output_concat_tensor =
+          ctx->Tensor4ArgNameAndIndex("output_concat", 0);
+      output_concat_dim = output_concat_tensor->shape().At(1);
+      output_concat = output_concat_tensor->dptr<T>();
+    }
+    CHECK_EQ(out_dim, output_concat_dim + interaction_dim + output_padding);
+    T* out_ptr = out->mut_dptr<T>();
+    // Samples are independent. Each one reads its feature rows in place and writes only the
+    // lower triangle of its gram matrix, straight behind the output_concat columns.
+    ctx->stream()->As<ep::CpuStream>()->ParallelFor(
+        0, batch_size,
+        [&](int64_t begin, int64_t end) {
+          std::vector<const T*> rows(num_rows);
+          for (int64_t b = begin; b < end; ++b) {
+            GetSampleRows(features, param, b, rows.data());
+            T* out_row = out_ptr + b * out_dim;
+            if (output_concat_dim > 0) {
+              std::memcpy(out_row, output_concat + b * output_concat_dim,
+                          output_concat_dim * sizeof(T));
+            }
+            T* interaction = out_row + output_concat_dim;
+            for (int64_t r = 0; r < num_rows; ++r) {
+              const T* x = rows[r];
+              const int64_t num_cols = r + offset;
+              T* dst = interaction + TrilRowOffset(r, offset);
+              int64_t c = 0;
+              for (; c + kBlockSize <= num_cols; c += kBlockSize) {
+                DotBlock(x, rows.data() + c, vector_size, dst + c);
+              }
+              for (; c < num_cols; ++c) { dst[c] = Dot(x, rows[c], vector_size); }
+            }
+            T* padding = interaction + interaction_dim;
+            std::fill(padding, padding + output_padding, static_cast<T>(0));
+          }
+        },
+        GetSampleGrainSize((interaction_dim + num_rows) * vector_size));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class FusedDotFeatureInteractionGradCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedDotFeatureInteractionGradCpuKernel() = default;
+  ~FusedDotFeatureInteractionGradCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const std::vector<const user_op::Tensor*> feature_tensors = GetInputs(ctx, "features");
+    const FeatureParam param = GetFeatureParam(feature_tensors);
+    std::vector<const T*> features;
+    std::vector<T*> features_grad;
+    for (int32_t i = 0; i < ctx->output_size("features_grad"); ++i) {
+      features.push_back(feature_tensors.at(i)->dptr<T>());
+      features_grad.push_back(ctx->Tensor4ArgNameAndIndex("features_grad", i)->mut_dptr<T>());
+    }
+    const int64_t batch_size = dy->shape().At(0);
+    const int64_t dy_dim = dy->shape().At(1);
+    const int64_t num_rows = param.concated_dim;
+    const int64_t vector_size = param.vector_size;
+    const bool self_interaction = ctx->Attr<bool>("self_interaction");
+    const int64_t offset = self_interaction ? 1 : 0;
+    const int64_t interaction_dim = TrilRowOffset(num_rows, offset);
+    int64_t output_concat_dim = 0;
+    T* output_concat_grad = nullptr;
+    if (ctx->has_output("output_concat_grad", 0)) {
+      user_op::Tensor* output_concat_grad_tensor =
+          ctx->Tensor4ArgNameAndIndex("output_concat_grad", 0);
+      output_concat_dim = output_concat_grad_tensor->shape().At(1);
+      output_concat_grad = output_concat_grad_tensor->mut_dptr<T>();
+    }
+    CHECK_LE(output_concat_dim + interaction_dim, dy_dim);
+    const T* dy_ptr = dy->dptr<T>();
+    // The gradient of the gram matrix is symmetric, so row r of the features gradient is row r
+    // of that matrix, rebuilt from the lower triangle of dy, times the features of the sample.
+    ctx->stream()->As<ep::CpuStream>()->ParallelFor(
+        0, batch_size,
+        [&](int64_t begin, int64_t end) {
+          std::vector<const T*> rows(num_rows);
+          std::vector<T*> grad_rows(num_rows);
+          std::vector<T> coeff(num_rows);
+          for (int64_t b = begin; b < end; ++b) {
+            GetSampleRows(features, param, b, rows.data());
+            GetSampleRows(features_grad, param, b, grad_rows.data());
+            const T* dy_row = dy_ptr + b * dy_dim;
+            if (output_concat_dim > 0) {
+              std::memcpy(output_concat_grad + b * output_concat_dim, dy_row,
+                          output_concat_dim * sizeof(T));
+            }
+            const T* interaction_grad = dy_row + output_concat_dim;
+            for (int64_t r = 0; r < num_rows; ++r) {
+              const T* row_grad = interaction_grad + TrilRowOffset(r, offset);
+              for (int64_t c = 0; c < r; ++c) { coeff[c] = row_grad[c]; }
+              coeff[r] = self_interaction ? 2 * row_grad[r] : static_cast<T>(0);
+              for (int64_t c = r + 1; c < num_rows; ++c) {
+                coeff[c] = interaction_grad[TrilRowOffset(c, offset) + r];
+              }
+              T* y = grad_rows[r];
+              std::fill(y, y + vector_size, static_cast<T>(0));
+              int64_t c = 0;
+              for (; c + kBlockSize <= num_rows; c += kBlockSize) {
+                AxpyBlock(coeff.data() + c, rows.data() + c, vector_size, y);
+              }
+              for (; c < num_rows; ++c) {
+                const T a = coeff[c];
+                const T* x = rows[c];
+                for (int64_t i = 0; i < vector_size; ++i) { y[i] += a * x[i]; }
+              }
+            }
+          }
+        },
+        GetSampleGrainSize(num_rows * num_rows * vector_size));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class FusedDotFeatureInteractionPoolingSumCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedDotFeatureInteractionPoolingSumCpuKernel() = default;
+  ~FusedDotFeatureInteractionPoolingSumCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const std::vector<const user_op::Tensor*> feature_tensors = GetInputs(ctx, "features");
+    const FeatureParam param = GetFeatureParam(feature_tensors);
+    std::vector<const T*> features;
+    for (const user_op::Tensor* feature : feature_tensors) {
+      features.push_back(feature->dptr<T>());
+    }
+    const int64_t batch_size = out->shape().At(0);
+    const int64_t num_rows = param.concated_dim;
+    const int64_t vector_size = param.vector_size;
+    T* out_ptr = out->mut_dptr<T>();
+    ctx->stream()->As<ep::CpuStream>()->ParallelFor(
+        0, batch_size,
+        [&](int64_t begin, int64_t end) {
+          std::vector<const T*> rows(num_rows);
+          std::vector<T> sum(vector_size);
+          std::vector<T> square_sum(vector_size);
+          for (int64_t b = begin; b < end; ++b) {
+            GetSampleRows(features, param, b, rows.data());
+            std::fill(sum.begin(), sum.end(), static_cast<T>(0));
+            std::fill(square_sum.begin(), square_sum.end(), static_cast<T>(0));
+            T* sum_ptr = sum.data();
+            T* square_sum_ptr = square_sum.data();
+            for (int64_t r = 0; r < num_rows; ++r) {
+              const T* x = rows[r];
+              for (int64_t i = 0; i < vector_size; ++i) {
+                sum_ptr[i] += x[i];
+                square_sum_ptr[i] += x[i] * x[i];
+              }
+            }
+            T* out_row = out_ptr + b * vector_size;
+            for (int64_t i = 0; i < vector_size; ++i) {
+              out_row[i] = (sum_ptr[i] * sum_ptr[i] - square_sum_ptr[i]) * static_cast<T>(0.5);
+            }
+          }
+        },
+        GetSampleGrainSize(num_rows * vector_size));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class FusedDotFeatureInteractionPoolingSumGradCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedDotFeatureInteractionPoolingSumGradCpuKernel() = default;
+  ~FusedDotFeatureInteractionPoolingSumGradCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const std::vector<const user_op::Tensor*> feature_tensors = GetInputs(ctx, "features");
+    const FeatureParam param = GetFeatureParam(feature_tensors);
+    std::vector<const T*> features;
+    std::vector<T*> features_grad;
+    for (int32_t i = 0; i < ctx->output_size("features_grad"); ++i) {
+      features.push_back(feature_tensors.at(i)->dptr<T>());
+      features_grad.push_back(ctx->Tensor4ArgNameAndIndex("features_grad", i)->mut_dptr<T>());
+    }
+    const int64_t batch_size = dy->shape().At(0);
+    const int64_t num_rows = param.concated_dim;
+    const int64_t vector_size = param.vector_size;
+    const T* dy_ptr = dy->dptr<T>();
+    ctx->stream()->As<ep::CpuStream>()->ParallelFor(
+        0, batch_size,
+        [&](int64_t begin, int64_t end) {
+          std::vector<const T*> rows(num_rows);
+          std::vector<T*> grad_rows(num_rows);
+          std::vector<T> sum(vector_size);
+          for (int64_t b = begin; b < end; ++b) {
+            GetSampleRows(features, param, b, rows.data());
+            GetSampleRows(features_grad, param, b, grad_rows.data());
+            std::fill(sum.begin(), sum.end(), static_cast<T>(0));
+            T* sum_ptr = sum.data();
+            for (int64_t r = 0; r < num_rows; ++r) {
+              const T* x = rows[r];
+              for (int64_t i = 0; i < vector_size; ++i) { sum_ptr[i] += x[i]; }
+            }
+            const T* dy_row = dy_ptr + b * vector_size;
+            for (int64_t r = 0; r < num_rows; ++r) {
+              const T* x = rows[r];
+              T* dx = grad_rows[r];
+              for (int64_t i = 0; i < vector_size; ++i) {
+                dx[i] = dy_row[i] * (sum_ptr[i] - x[i]);
+              }
+            }
+          }
+        },
+        GetSampleGrainSize(2 * num_rows * vector_size));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+#define REGISTER_FUSED_DOT_FEATURE_INTERACTION_CPU_KERNEL(dtype)                         \
+  REGISTER_USER_KERNEL("fused_dot_feature_interaction")                                  \
+      .SetCreateFn<FusedDotFeatureInteractionCpuKernel<dtype>>()                         \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                    \
+                       && (user_op::HobDataType("out", 0) == GetDataType<dtype>::value)  \
+                       && (user_op::HobAttr<std::string>("pooling") == "none"));         \
+  REGISTER_USER_KERNEL("fused_dot_feature_interaction")                                  \
+      .SetCreateFn<FusedDotFeatureInteractionPoolingSumCpuKernel<dtype>>()               \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                    \
+                       && (user_op::HobDataType("out", 0) == GetDataType<dtype>::value)  \
+                       && (user_op::HobAttr<std::string>("pooling") == "sum"));          \
+  REGISTER_USER_KERNEL("fused_dot_feature_interaction_grad")                             \
+      .SetCreateFn<FusedDotFeatureInteractionGradCpuKernel<dtype>>()                     \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                    \
+                       && (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value)   \
+                       && (user_op::HobAttr<std::string>("pooling") == "none"));         \
+  REGISTER_USER_KERNEL("fused_dot_feature_interaction_grad")                             \
+      .SetCreateFn<FusedDotFeatureInteractionPoolingSumGradCpuKernel<dtype>>()           \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                    \
+                       && (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value)   \
+                       && (user_op::HobAttr<std::string>("pooling") == "sum"));
+
+REGISTER_FUSED_DOT_FEATURE_INTERACTION_CPU_KERNEL(float)
+REGISTER_FUSED_DOT_FEATURE_INTERACTION_CPU_KERNEL(double)
+
+}  // namespace oneflow
@@ -0,0 +1,174 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/ep/cpu/cpu_softmax.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+struct ScaleMaskLoad {
+  ScaleMaskLoad(const T* src, const bool* mask, int64_t row_size, T fill, T scale)
+      : src(src), mask(mask), row_size(row_size), fill(fill), scale(scale) {}
+  const T* load(T* buf, int64_t row, int64_t col, int64_t n) const {
+    const int64_t offset = row * row_size + col;
+    for (int64_t i = 0; i < n; ++i) {
+      buf[i] = mask[offset + i] ? src[offset + i] * scale : fill;
+    }
+    return buf;
+  }
+  const T* src;
+  const bool* mask;
+  int64_t row_size;
+  T fill;
+  T scale;
+};
+
+template<typename T>
+struct ScaleMaskStore {
+  ScaleMaskStore(T* dst, const bool* mask, int64_t row_size, T fill, T scale)
+      : dst(dst), mask(mask), row_size(row_size), fill(fill), scale(scale) {}
+  T* ptr(int64_t row, int64_t col) const { return dst + row * row_size + col; }
+  void store(int64_t row, int64_t col, int64_t n) const {
+    const int64_t offset = row * row_size + col;
+    for (int64_t i = 0; i < n; ++i) {
+      dst[offset + i] = mask[offset + i] ? dst[offset + i] * scale : fill;
+    }
+  }
+  T* dst;
+  const bool* mask;
+  int64_t row_size;
+  T fill;
+  T scale;
+};
+
+template<typename T>
+struct DropoutLoad {
+  DropoutLoad(const T* src, const bool* mask, int64_t row_size, T scale)
+      : src(src), mask(mask), row_size(row_size), scale(scale) {}
+  const T* load(T* buf, int64_t row, int64_t col, int64_t n) const {
+    const int64_t offset = row * row_size + col;
+    for (int64_t i = 0; i < n; ++i) {
+      buf[i] = src[offset + i] * static_cast<T>(mask[offset + i]) * scale;
+    }
+    return buf;
+  }
+  const T* src;
+  const bool* mask;
+  int64_t row_size;
+  T scale;
+};
+
+// The softmax is written to softmax_y, then dropped out into dst.
+template<typename T>
+struct DropoutStore {
+  DropoutStore(T* dst, T* softmax_y, const bool* mask, int64_t row_size, T scale)
+      : dst(dst), softmax_y(softmax_y), mask(mask), row_size(row_size), scale(scale) {}
+  T* ptr(int64_t row, int64_t col) const { return softmax_y + row * row_size + col; }
+  void store(int64_t row, int64_t col, int64_t n) const {
+    const int64_t offset = row * row_size + col;
+    for (int64_t i = 0; i < n; ++i) {
+      dst[offset + i] = softmax_y[offset + i] * static_cast<T>(mask[offset + i]) * scale;
+    }
+  }
+  T* dst;
+  T* softmax_y;
+  const bool* mask;
+  int64_t row_size;
+  T scale;
+};
+
+}  // namespace
+
+template<typename T>
+class FusedScaleMaskSoftmaxDropoutCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedScaleMaskSoftmaxDropoutCpuKernel() = default;
+  ~FusedScaleMaskSoftmaxDropoutCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* mask = ctx->Tensor4ArgNameAndIndex("mask", 0);
+    const user_op::Tensor* dropout_mask = ctx->Tensor4ArgNameAndIndex("dropout_mask", 0);
+    user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
+    user_op::Tensor* softmax_y = ctx->Tensor4ArgNameAndIndex("softmax_y", 0);
+    const ShapeView& x_shape = x->shape();
+    CHECK_GE(x_shape.NumAxes(), 2);
+    const int64_t cols = x_shape.At(x_shape.NumAxes() - 1);
+    const int64_t rows = x_shape.Count(0, x_shape.NumAxes() - 1);
+    ScaleMaskLoad<T> load(x->dptr<T>(), mask->dptr<bool>(), cols,
+                          ctx->Attr<float>("mask_fill_value"), ctx->Attr<float>("scale_value"));
+    DropoutStore<T> store(y->mut_dptr<T>(), softmax_y->mut_dptr<T>(), dropout_mask->dptr<bool>(),
+                          cols, ctx->Attr<float>("dropout_scale_value"));
+    ep::cpu_softmax::DispatchSoftmax<ep::cpu_softmax::Algorithm::kSoftmax, T>(
+        ctx->stream()->As<ep::CpuStream>(), load, store, rows, cols);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_CPU_KERNEL(dtype)   \
+  REGISTER_USER_KERNEL("fused_scale_mask_softmax_dropout")            \
+      .SetCreateFn<FusedScaleMaskSoftmaxDropoutCpuKernel<dtype>>()    \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU) \
+                       && (user_op::HobDataType("y", 0) == GetDataType<dtype>::value));
+
+REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_CPU_KERNEL(float)
+REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_CPU_KERNEL(double)
+#undef REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_CPU_KERNEL
+
+template<typename T>
+class FusedScaleMaskSoftmaxDropoutGradCpuKernel final : public user_op::OpKernel {
+ public:
+  FusedScaleMaskSoftmaxDropoutGradCpuKernel() = default;
+  ~FusedScaleMaskSoftmaxDropoutGradCpuKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* softmax_y = ctx->Tensor4ArgNameAndIndex("softmax_y", 0);
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* mask = ctx->Tensor4ArgNameAndIndex("mask", 0);
+    const user_op::Tensor* dropout_mask = ctx->Tensor4ArgNameAndIndex("dropout_mask", 0);
+    user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    const ShapeView& dy_shape = dy->shape();
+    CHECK_GE(dy_shape.NumAxes(), 2);
+    const int64_t cols = dy_shape.At(dy_shape.NumAxes() - 1);
+    const int64_t rows = dy_shape.Count(0, dy_shape.NumAxes() - 1);
+    ep::cpu_softmax::DirectLoad<T> load_softmax_y(softmax_y->dptr<T>(), cols);
+    DropoutLoad<T> load_dy(dy->dptr<T>(), dropout_mask->dptr<bool>(), cols,
+                           ctx->Attr<float>("dropout_scale_value"));
+    ScaleMaskStore<T> store(dx->mut_dptr<T>(), mask->dptr<bool>(), cols, static_cast<T>(0.0),
+                            ctx->Attr<float>("scale_value"));
+    ep::cpu_softmax::DispatchSoftmaxGrad<ep::cpu_softmax::Algorithm::kSoftmax, T>(
+        ctx->stream()->As<ep::CpuStream>(), load_softmax_y, load_dy, store, rows, cols);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_GRAD_CPU_KERNEL(dtype) \
+  REGISTER_USER_KERNEL("fused_scale_mask_softmax_dropout_grad")          \
+      .SetCreateFn<FusedScaleMaskSoftmaxDropoutGradCpuKernel<dtype>>()   \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)    \
+                       && (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value));
+
+REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_GRAD_CPU_KERNEL(float)
+REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_GRAD_CPU_KERNEL(double)
+#undef REGISTER_FUSED_SCALE_MASK_SOFTMAX_DROPOUT_GRAD_CPU_KERNEL
+
+}  // namespace oneflow
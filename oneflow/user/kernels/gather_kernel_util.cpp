@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/gather_kernel_util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
@@ -76,19 +77,36 @@ void GatherKernelUtilImpl<DeviceType::kCPU, T, K>::Forward(ep::Stream* stream, c
   const int64_t outer_dim_size = flat_in_shape.At(0);
   const int64_t gather_dim_size = flat_in_shape.At(1);
   const int64_t inner_dim_size = flat_in_shape.At(2);
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_indices) {
-      CHECK_GE(indices[i], 0);
-      const int64_t idx = indices[i] - offset;
-      T* to = out + outer_idx * num_indices * inner_dim_size + i * inner_dim_size;
-      if (idx >= 0 && idx < gather_dim_size) {
-        const T* from = in + outer_idx * gather_dim_size * inner_dim_size + idx * inner_dim_size;
-        std::copy(from, from + inner_dim_size, to);
-      } else {
-        std::memset(reinterpret_cast<void*>(to), 0, inner_dim_size * sizeof(K));
-      }
-    }
-  }
+  if (inner_dim_size == 0) { return; }
+  // Rows are independent, so they are split over the threads. The source row a few iterations
+  // ahead is prefetched, since random indices defeat the hardware prefetcher.
+  constexpr int64_t kPrefetchDistance = 8;
+  auto SourceRow = [&](int64_t row) -> const T* {
+    const int64_t outer_idx = row / num_indices;
+    const K index = indices[row - outer_idx * num_indices];
+    CHECK_GE(index, 0);
+    const int64_t idx = index - offset;
+    if (idx < 0 || idx >= gather_dim_size) { return nullptr; }
+    return in + (outer_idx * gather_dim_size + idx) * inner_dim_size;
+  };
+  stream->As<ep::CpuStream>()->ParallelFor(
+      0, outer_dim_size * num_indices,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          if (row + kPrefetchDistance < end) {
+            const T* ahead = SourceRow(row + kPrefetchDistance);
+            if (ahead != nullptr) { __builtin_prefetch(ahead); }
+          }
+          const T* from = SourceRow(row);
+          T* to = out + row * inner_dim_size;
+          if (from != nullptr) {
+            std::memcpy(to, from, inner_dim_size * sizeof(T));
+          } else {
+            std::memset(reinterpret_cast<void*>(to), 0, inner_dim_size * sizeof(T));
+          }
+        }
+      },
+      std::max<int64_t>(32768 / inner_dim_size, 1));
 }
 
 #define INITIATE_GATHER_KERNEL_UTIL_CPU_IMPL(in_type_pair, index_type_pair)              \
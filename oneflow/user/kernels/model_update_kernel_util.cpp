@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/model_update_kernel_util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
@@ -38,6 +39,59 @@ void SumSquares2(int64_t n, const T* src0, T* dst0, const T* src1, T* dst1) {
   *dst1 += cblas_dot<T>(n, src1, 1, src1, 1);
 }
 
+// All updates below are elementwise, so [0, n) is split into independent contiguous chunks, one
+// per cpu stream thread. Loop invariant branches are resolved before the chunk loops so that the
+// inlined functors leave straight-line bodies the compiler can vectorize.
+template<typename F>
+void ParallelForElements(ep::Stream* stream, int64_t n, const F& f) {
+  stream->As<ep::CpuStream>()->ParallelFor(0, n, f);
+}
+
+// Calls f(tensor_index, offset_in_tensor, count) for every tensor overlapping the flattened range
+// [begin, end) of a multi tensor update.
+template<typename F>
+void ForEachTensorChunk(const std::vector<int64_t>& offsets, int64_t begin, int64_t end,
+                        const F& f) {
+  size_t i = std::upper_bound(offsets.cbegin(), offsets.cend(), begin) - offsets.cbegin() - 1;
+  while (begin < end) {
+    const int64_t tensor_end = std::min(end, offsets.at(i + 1));
+    if (tensor_end > begin) { f(i, begin - offsets.at(i), tensor_end - begin); }
+    begin = std::max(begin, tensor_end);
+    i += 1;
+  }
+}
+
+template<typename T, typename G>
+void SGDUpdateChunk(int64_t n, T scale, float l1, float l2, float weight_decay,
+                    float learning_rate, const G* model_diff, T* model) {
+  for (int64_t i = 0; i != n; ++i) {
+    SGDUpdateFunctor<T, G>()(model_diff + i, model + i, scale, l1, l2, weight_decay,
+                             learning_rate);
+  }
+}
+
+template<typename T, typename G>
+void MomentumUpdateChunk(int64_t n, T scale, float l1, float l2, float beta, float weight_decay,
+                         float learning_rate, const G* model_diff, T* model, T* momentum) {
+  for (int64_t i = 0; i != n; ++i) {
+    MomentumUpdateFunctor<T, G>()(model_diff + i, model + i, momentum + i, scale, l1, l2, beta,
+                                  weight_decay, learning_rate);
+  }
+}
+
+template<bool amsgrad, typename T, typename G>
+void AdamUpdateChunk(int64_t n, T scale, float l1, float l2, float beta1, float beta2,
+                     float epsilon, float weight_decay, float bias_correction1,
+                     float bias_correction2, float learning_rate, const G* model_diff, T* model,
+                     T* m, T* v, T* max_v) {
+  for (int64_t i = 0; i != n; ++i) {
+    AdamUpdateFunctor<T, G>()(model_diff + i, model + i, m + i, v + i,
+                              amsgrad ? max_v + i : nullptr, scale, l1, l2, beta1, beta2, epsilon,
+                              weight_decay, amsgrad, bias_correction1, bias_correction2,
+                              learning_rate);
+  }
+}
+
 }  // namespace
 
 template<typename T, typename G>
@@ -55,10 +109,10 @@ void SGDUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (skip_if != nullptr && *skip_if != 0) { return; }
   if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
-  for (int64_t i = 0; i != n; ++i) {
-    SGDUpdateFunctor<T, G>()(model_diff + i, model + i, scale, l1, l2, weight_decay,
-                             learning_rate_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    SGDUpdateChunk<T, G>(end - begin, scale, l1, l2, weight_decay, learning_rate_val,
+                         model_diff + begin, model + begin);
+  });
 }
 
 template struct SGDUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -116,10 +170,10 @@ void MomentumUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (skip_if != nullptr && *skip_if != 0) { return; }
   if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
-  for (int64_t i = 0; i != n; ++i) {
-    MomentumUpdateFunctor<T, G>()(model_diff + i, model + i, momentum + i, scale, l1, l2, beta,
-                                  weight_decay, learning_rate_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    MomentumUpdateChunk<T, G>(end - begin, scale, l1, l2, beta, weight_decay, learning_rate_val,
+                              model_diff + begin, model + begin, momentum + begin);
+  });
 }
 
 template struct MomentumUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -186,11 +240,19 @@ void AdamUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (bias_correction1_ptr != nullptr) { bias_correction1_val = *bias_correction1_ptr; }
   if (bias_correction2_ptr != nullptr) { bias_correction2_val = *bias_correction2_ptr; }
 
-  FOR_RANGE(int64_t, i, 0, n) {
-    AdamUpdateFunctor<T, G>()(model_diff + i, model + i, m + i, v + i, max_v + i, scale, l1, l2,
-                              beta1, beta2, epsilon, weight_decay, amsgrad, bias_correction1_val,
-                              bias_correction2_val, learning_rate_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    if (amsgrad) {
+      AdamUpdateChunk<true, T, G>(end - begin, scale, l1, l2, beta1, beta2, epsilon, weight_decay,
+                                  bias_correction1_val, bias_correction2_val, learning_rate_val,
+                                  model_diff + begin, model + begin, m + begin, v + begin,
+                                  max_v + begin);
+    } else {
+      AdamUpdateChunk<false, T, G>(end - begin, scale, l1, l2, beta1, beta2, epsilon,
+                                   weight_decay, bias_correction1_val, bias_correction2_val,
+                                   learning_rate_val, model_diff + begin, model + begin,
+                                   m + begin, v + begin, nullptr);
+    }
+  });
 }
 
 template struct AdamUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -260,10 +322,12 @@ void AdagradUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
   learning_rate_val = learning_rate_val / (1 + (train_step - 1) * lr_decay);
 
-  FOR_RANGE(int64_t, i, 0, n) {
-    AdagradUpdateFunctor<T, G>()(model_diff + i, model + i, sum + i, scale, l1, l2, epsilon,
-                                 weight_decay, learning_rate_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      AdagradUpdateFunctor<T, G>()(model_diff + i, model + i, sum + i, scale, l1, l2, epsilon,
+                                   weight_decay, learning_rate_val);
+    }
+  });
 }
 
 template struct AdagradUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -294,19 +358,23 @@ void LambUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (bias_correction1_ptr != nullptr) { bias_correction1_val = *bias_correction1_ptr; }
   if (bias_correction2_ptr != nullptr) { bias_correction2_val = *bias_correction2_ptr; }
 
-  FOR_RANGE(int64_t, i, 0, n) {
-    LambGradFunctor<T, G>()(model_diff + i, adam_diff + i, model + i, m + i, v + i, scale, l1, l2,
-                            beta1, beta2, epsilon, do_bias_correction, bias_correction1_val,
-                            bias_correction2_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      LambGradFunctor<T, G>()(model_diff + i, adam_diff + i, model + i, m + i, v + i, scale, l1,
+                              l2, beta1, beta2, epsilon, do_bias_correction, bias_correction1_val,
+                              bias_correction2_val);
+    }
+  });
   T* w_norm_2 = norm_buffer;
   T* g_norm_2 = norm_buffer + 1;
   Memset<DeviceType::kCPU>(stream, norm_buffer, 0, 2 * sizeof(T));
   SumSquares2(n, model, w_norm_2, adam_diff, g_norm_2);
   const float lr = LambLRFunctor<T>()(learning_rate_val, w_norm_2, g_norm_2);
-  FOR_RANGE(int64_t, i, 0, n) {
-    LambUpdateFunctor<T>()(lr, weight_decay, adam_diff + i, model + i);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      LambUpdateFunctor<T>()(lr, weight_decay, adam_diff + i, model + i);
+    }
+  });
 }
 
 template struct LambUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -341,19 +409,21 @@ void RmsPropUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (skip_if != nullptr && *skip_if != 0) { return; }
   if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
-  if (centered) {
-    FOR_RANGE(int64_t, i, 0, n) {
-      RmsPropUpdateFunctor<T, G, true>()(model_diff + i, model + i, n, scale, l1, l2,
-                                         mean_square + i, mean_gradient + i, epsilon, weight_decay,
-                                         decay_rate, learning_rate_val);
-    }
-  } else {
-    FOR_RANGE(int64_t, i, 0, n) {
-      RmsPropUpdateFunctor<T, G, false>()(model_diff + i, model + i, n, scale, l1, l2,
-                                          mean_square + i, nullptr, epsilon, weight_decay,
-                                          decay_rate, learning_rate_val);
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    if (centered) {
+      for (int64_t i = begin; i != end; ++i) {
+        RmsPropUpdateFunctor<T, G, true>()(model_diff + i, model + i, n, scale, l1, l2,
+                                           mean_square + i, mean_gradient + i, epsilon,
+                                           weight_decay, decay_rate, learning_rate_val);
+      }
+    } else {
+      for (int64_t i = begin; i != end; ++i) {
+        RmsPropUpdateFunctor<T, G, false>()(model_diff + i, model + i, n, scale, l1, l2,
+                                            mean_square + i, nullptr, epsilon, weight_decay,
+                                            decay_rate, learning_rate_val);
+      }
     }
-  }
+  });
 }
 
 template struct RmsPropUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -377,10 +447,12 @@ void LarsUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
   T model_norm = data_tmp[0];
   T model_diff_norm = data_tmp[1];
-  FOR_RANGE(int64_t, i, 0, n) {
-    model_diff_tmp[i] =
-        CastScaleRegularizeGradientFunctor<T, G>()(model_diff[i], model[i], scale, l1, l2);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      model_diff_tmp[i] =
+          CastScaleRegularizeGradientFunctor<T, G>()(model_diff[i], model[i], scale, l1, l2);
+    }
+  });
   Memset<DeviceType::kCPU>(stream, data_tmp, 0, 2 * sizeof(T));
   SumSquares2(n, model, &model_norm, model_diff_tmp, &model_diff_norm);
   model_norm = std::sqrt(model_norm);
@@ -390,10 +462,12 @@ void LarsUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
     lars = lars_coefficient * model_norm / (epsilon + model_diff_norm + weight_decay * model_norm);
   }
   T local_learning_rate = *learning_rate * lars;
-  FOR_RANGE(int64_t, i, 0, n) {
-    LarsUpdateFunctor<T>()(model_diff_tmp + i, model + i, momentum_beta, momentum + i, weight_decay,
-                           local_learning_rate);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      LarsUpdateFunctor<T>()(model_diff_tmp + i, model + i, momentum_beta, momentum + i,
+                             weight_decay, local_learning_rate);
+    }
+  });
 }
 
 template struct LarsUpdateKernelUtil<DeviceType::kCPU, float, float>;
@@ -416,13 +490,104 @@ void FtrlUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
   if (skip_if != nullptr && *skip_if != 0) { return; }
   if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
   if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
-  for (int64_t i = 0; i != n; ++i) {
-    FtrlUpdateFunctor<T, G>()(model_diff + i, model + i, accumulate + i, z + i, scale, l1, l2,
-                              lr_power, lambda1, lambda2, beta, weight_decay, learning_rate_val);
-  }
+  ParallelForElements(stream, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i != end; ++i) {
+      FtrlUpdateFunctor<T, G>()(model_diff + i, model + i, accumulate + i, z + i, scale, l1, l2,
+                                lr_power, lambda1, lambda2, beta, weight_decay,
+                                learning_rate_val);
+    }
+  });
 }
 
 template struct FtrlUpdateKernelUtil<DeviceType::kCPU, float, float>;
 template struct FtrlUpdateKernelUtil<DeviceType::kCPU, double, double>;
 
+template<typename T, typename G>
+struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float weight_decay, float learning_rate_val,
+                     const float* learning_rate, const T* scale_by_ptr, const int64_t* skip_if);
+};
+
+template<typename T, typename G>
+void MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale, float l1, float l2,
+    float weight_decay, float learning_rate_val, const float* learning_rate,
+    const T* scale_by_ptr, const int64_t* skip_if) {
+  if (skip_if != nullptr && *skip_if != 0) { return; }
+  if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
+  if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
+  ParallelForElements(stream, params.offsets.back(), [&](int64_t begin, int64_t end) {
+    ForEachTensorChunk(params.offsets, begin, end, [&](size_t t, int64_t offset, int64_t n) {
+      SGDUpdateChunk<T, G>(n, scale, l1, l2, weight_decay, learning_rate_val,
+                           params.model_diff.at(t) + offset, params.model.at(t) + offset);
+    });
+  });
+}
+
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
+template<typename T, typename G>
+struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float beta, float weight_decay, float learning_rate_val,
+                     const float* learning_rate, const T* scale_by_ptr, const int64_t* skip_if);
+};
+
+template<typename T, typename G>
+void MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale, float l1, float l2,
+    float beta, float weight_decay, float learning_rate_val, const float* learning_rate,
+    const T* scale_by_ptr, const int64_t* skip_if) {
+  if (skip_if != nullptr && *skip_if != 0) { return; }
+  if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
+  if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
+  ParallelForElements(stream, params.offsets.back(), [&](int64_t begin, int64_t end) {
+    ForEachTensorChunk(params.offsets, begin, end, [&](size_t t, int64_t offset, int64_t n) {
+      MomentumUpdateChunk<T, G>(n, scale, l1, l2, beta, weight_decay, learning_rate_val,
+                                params.model_diff.at(t) + offset, params.model.at(t) + offset,
+                                params.momentum.at(t) + offset);
+    });
+  });
+}
+
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
+template<typename T, typename G>
+struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float beta1, float beta2, float epsilon,
+                     float weight_decay, float learning_rate_val, float bias_correction1_val,
+                     float bias_correction2_val, const float* learning_rate,
+                     const T* scale_by_ptr, const int64_t* skip_if,
+                     const float* bias_correction1, const float* bias_correction2);
+};
+
+template<typename T, typename G>
+void MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale, float l1, float l2,
+    float beta1, float beta2, float epsilon, float weight_decay, float learning_rate_val,
+    float bias_correction1_val, float bias_correction2_val, const float* learning_rate,
+    const T* scale_by_ptr, const int64_t* skip_if, const float* bias_correction1_ptr,
+    const float* bias_correction2_ptr) {
+  if (skip_if != nullptr && *skip_if != 0) { return; }
+  if (learning_rate != nullptr) { learning_rate_val = *learning_rate; }
+  if (scale_by_ptr != nullptr) { scale *= *scale_by_ptr; }
+  if (bias_correction1_ptr != nullptr) { bias_correction1_val = *bias_correction1_ptr; }
+  if (bias_correction2_ptr != nullptr) { bias_correction2_val = *bias_correction2_ptr; }
+  ParallelForElements(stream, params.offsets.back(), [&](int64_t begin, int64_t end) {
+    ForEachTensorChunk(params.offsets, begin, end, [&](size_t t, int64_t offset, int64_t n) {
+      AdamUpdateChunk<false, T, G>(n, scale, l1, l2, beta1, beta2, epsilon, weight_decay,
+                                   bias_correction1_val, bias_correction2_val, learning_rate_val,
+                                   params.model_diff.at(t) + offset, params.model.at(t) + offset,
+                                   params.m.at(t) + offset, params.v.at(t) + offset, nullptr);
+    });
+  });
+}
+
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
 }  // namespace oneflow
@@ -323,6 +323,43 @@ struct LarsUpdateKernelUtil {
                      const G* model_diff, T* model, T* momentum, T* data_tmp, T* model_diff_tmp);
 };
 
+// Flattened view of the tensor lists of a multi_tensor_*_update op. offsets[i] is the position of
+// tensor i in the concatenation of all tensors and offsets.back() is the total element count.
+// State lists that the optimizer does not use stay empty.
+template<typename T, typename G>
+struct MultiTensorUpdateParams {
+  std::vector<int64_t> offsets;
+  std::vector<const G*> model_diff;
+  std::vector<T*> model;
+  std::vector<T*> momentum;
+  std::vector<T*> m;
+  std::vector<T*> v;
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorSGDUpdateKernelUtil {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float weight_decay, float learning_rate_val,
+                     const float* learning_rate, const T* scale_by_ptr, const int64_t* skip_if);
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorMomentumUpdateKernelUtil {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float beta, float weight_decay, float learning_rate_val,
+                     const float* learning_rate, const T* scale_by_ptr, const int64_t* skip_if);
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorAdamUpdateKernelUtil {
+  static void Update(ep::Stream* stream, const MultiTensorUpdateParams<T, G>& params, T scale,
+                     float l1, float l2, float beta1, float beta2, float epsilon,
+                     float weight_decay, float learning_rate_val, float bias_correction1_val,
+                     float bias_correction2_val, const float* learning_rate,
+                     const T* scale_by_ptr, const int64_t* skip_if,
+                     const float* bias_correction1, const float* bias_correction2);
+};
+
 #endif
 
 }  // namespace oneflow
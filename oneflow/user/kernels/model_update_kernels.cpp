@@ -1040,6 +1040,168 @@ REGISTER_FTRL_UPDATE_KERNEL(DeviceType::kCUDA, float, float);
 REGISTER_FTRL_UPDATE_KERNEL(DeviceType::kCUDA, double, double);
 #endif  // WITH_CUDA
 
+template<typename T, typename G>
+MultiTensorUpdateParams<T, G> MakeMultiTensorUpdateParams(user_op::KernelComputeContext* ctx,
+                                                          const std::vector<std::string>& states) {
+  MultiTensorUpdateParams<T, G> params;
+  const int32_t num_tensors = ctx->input_size("model");
+  CHECK_EQ(ctx->input_size("model_diff"), num_tensors);
+  params.offsets.reserve(num_tensors + 1);
+  params.offsets.emplace_back(0);
+  for (int32_t i = 0; i < num_tensors; ++i) {
+    user_op::Tensor* model = ctx->Tensor4ArgNameAndIndex("model", i);
+    const user_op::Tensor* model_diff = ctx->Tensor4ArgNameAndIndex("model_diff", i);
+    CHECK_EQ(model_diff->shape().elem_cnt(), model->shape().elem_cnt());
+    params.offsets.emplace_back(params.offsets.back() + model->shape().elem_cnt());
+    params.model.emplace_back(model->mut_dptr<T>());
+    params.model_diff.emplace_back(model_diff->dptr<G>());
+    for (const auto& state : states) {
+      user_op::Tensor* state_tensor = ctx->Tensor4ArgNameAndIndex(state, i);
+      CHECK_EQ(state_tensor->shape().elem_cnt(), model->shape().elem_cnt());
+      if (state == "momentum") {
+        params.momentum.emplace_back(state_tensor->mut_dptr<T>());
+      } else if (state == "m") {
+        params.m.emplace_back(state_tensor->mut_dptr<T>());
+      } else if (state == "v") {
+        params.v.emplace_back(state_tensor->mut_dptr<T>());
+      } else {
+        UNIMPLEMENTED();
+      }
+    }
+  }
+  return params;
+}
+
+template<typename T>
+void GetMultiTensorScalarInputs(user_op::KernelComputeContext* ctx, const float** learning_rate_ptr,
+                                const T** scale_by_ptr, const int64_t** skip_if_ptr) {
+  *learning_rate_ptr = nullptr;
+  if (ctx->has_input("learning_rate", 0)) {
+    *learning_rate_ptr = ctx->Tensor4ArgNameAndIndex("learning_rate", 0)->dptr<float>();
+  }
+  *scale_by_ptr = nullptr;
+  if (ctx->has_input("scale_by_tensor", 0)) {
+    const user_op::Tensor* scale_by_tensor = ctx->Tensor4ArgNameAndIndex("scale_by_tensor", 0);
+    CHECK_EQ(scale_by_tensor->data_type(), GetDataType<T>::value);
+    CHECK_EQ(scale_by_tensor->shape().elem_cnt(), 1);
+    *scale_by_ptr = scale_by_tensor->dptr<T>();
+  }
+  *skip_if_ptr = nullptr;
+  if (ctx->has_input("skip_if", 0)) {
+    const user_op::Tensor* skip_if = ctx->Tensor4ArgNameAndIndex("skip_if", 0);
+    CHECK_EQ(skip_if->shape().elem_cnt(), 1);
+    *skip_if_ptr = skip_if->dptr<int64_t>();
+  }
+}
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorSGDUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorSGDUpdateKernel() = default;
+  ~MultiTensorSGDUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const float* learning_rate_ptr = nullptr;
+    const T* scale_by_ptr = nullptr;
+    const int64_t* skip_if_ptr = nullptr;
+    GetMultiTensorScalarInputs<T>(ctx, &learning_rate_ptr, &scale_by_ptr, &skip_if_ptr);
+    MultiTensorSGDUpdateKernelUtil<device_type, T, G>::Update(
+        ctx->stream(), MakeMultiTensorUpdateParams<T, G>(ctx, {}),
+        static_cast<T>(ctx->Attr<double>("scale")), ctx->Attr<float>("l1"),
+        ctx->Attr<float>("l2"), ctx->Attr<float>("weight_decay"),
+        ctx->Attr<float>("learning_rate_val"), learning_rate_ptr, scale_by_ptr, skip_if_ptr);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(device, dtype, gtype)                     \
+  REGISTER_USER_KERNEL("multi_tensor_sgd_update")                                         \
+      .SetCreateFn<MultiTensorSGDUpdateKernel<device, dtype, gtype>>()                    \
+      .SetIsMatchedHob((user_op::HobDeviceType() == device)                               \
+                       && (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       && (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorMomentumUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorMomentumUpdateKernel() = default;
+  ~MultiTensorMomentumUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const float* learning_rate_ptr = nullptr;
+    const T* scale_by_ptr = nullptr;
+    const int64_t* skip_if_ptr = nullptr;
+    GetMultiTensorScalarInputs<T>(ctx, &learning_rate_ptr, &scale_by_ptr, &skip_if_ptr);
+    MultiTensorMomentumUpdateKernelUtil<device_type, T, G>::Update(
+        ctx->stream(), MakeMultiTensorUpdateParams<T, G>(ctx, {"momentum"}),
+        static_cast<T>(ctx->Attr<double>("scale")), ctx->Attr<float>("l1"),
+        ctx->Attr<float>("l2"), ctx->Attr<float>("beta"), ctx->Attr<float>("weight_decay"),
+        ctx->Attr<float>("learning_rate_val"), learning_rate_ptr, scale_by_ptr, skip_if_ptr);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(device, dtype, gtype)                \
+  REGISTER_USER_KERNEL("multi_tensor_momentum_update")                                    \
+      .SetCreateFn<MultiTensorMomentumUpdateKernel<device, dtype, gtype>>()               \
+      .SetIsMatchedHob((user_op::HobDeviceType() == device)                               \
+                       && (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       && (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorAdamUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorAdamUpdateKernel() = default;
+  ~MultiTensorAdamUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const float* learning_rate_ptr = nullptr;
+    const T* scale_by_ptr = nullptr;
+    const int64_t* skip_if_ptr = nullptr;
+    GetMultiTensorScalarInputs<T>(ctx, &learning_rate_ptr, &scale_by_ptr, &skip_if_ptr);
+    const float* bias_correction1_ptr = nullptr;
+    if (ctx->has_input("bias_correction1", 0)) {
+      const user_op::Tensor* bias_correction1 = ctx->Tensor4ArgNameAndIndex("bias_correction1", 0);
+      CHECK_EQ(bias_correction1->shape().elem_cnt(), 1);
+      bias_correction1_ptr = bias_correction1->dptr<float>();
+    }
+    const float* bias_correction2_ptr = nullptr;
+    if (ctx->has_input("bias_correction2", 0)) {
+      const user_op::Tensor* bias_correction2 = ctx->Tensor4ArgNameAndIndex("bias_correction2", 0);
+      CHECK_EQ(bias_correction2->shape().elem_cnt(), 1);
+      bias_correction2_ptr = bias_correction2->dptr<float>();
+    }
+    MultiTensorAdamUpdateKernelUtil<device_type, T, G>::Update(
+        ctx->stream(), MakeMultiTensorUpdateParams<T, G>(ctx, {"m", "v"}),
+        static_cast<T>(ctx->Attr<double>("scale")), ctx->Attr<float>("l1"),
+        ctx->Attr<float>("l2"), ctx->Attr<float>("beta1"), ctx->Attr<float>("beta2"),
+        ctx->Attr<float>("epsilon"), ctx->Attr<float>("weight_decay"),
+        ctx->Attr<float>("learning_rate_val"), ctx->Attr<float>("bias_correction1_val"),
+        ctx->Attr<float>("bias_correction2_val"), learning_rate_ptr, scale_by_ptr, skip_if_ptr,
+        bias_correction1_ptr, bias_correction2_ptr);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(device, dtype, gtype)                    \
+  REGISTER_USER_KERNEL("multi_tensor_adam_update")                                        \
+      .SetCreateFn<MultiTensorAdamUpdateKernel<device, dtype, gtype>>()                   \
+      .SetIsMatchedHob((user_op::HobDeviceType() == device)                               \
+                       && (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       && (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+
 }  // namespace
 
 }  // namespace oneflow
@@ -0,0 +1,60 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_RANDOM_PHILOX_UTIL_H_
+#define ONEFLOW_USER_KERNELS_RANDOM_PHILOX_UTIL_H_
+
+#include "oneflow/core/common/philox.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
+#include "oneflow/core/framework/random_generator.h"
+
+namespace oneflow {
+
+// Draws `n` uniform numbers in [0, 1) of type T from the philox stream of `generator` and hands
+// them to `f(first, count, uniform)` in chunks, where uniform[k] belongs to element first + k.
+// Element i always takes its number from block offset + i / kNumPerBlock, so the output only
+// depends on the seed and the offset, not on the number of threads. Chunks start at multiples of
+// kNumPerBlock, which lets `f` consume the numbers in pairs.
+template<typename T, typename F>
+void PhiloxUniformForEach(ep::Stream* stream, one::CPUGeneratorImpl* generator, int64_t n,
+                          const F& f) {
+  CHECK_GE(n, 0);
+  if (n == 0) { return; }
+  constexpr int64_t kNumPerBlock = PhiloxUniform<T>::kNumPerBlock;
+  constexpr int64_t kChunkBlocks = 256;
+  constexpr size_t kGrainBlocks = 4096;
+  const int64_t num_blocks = (n + kNumPerBlock - 1) / kNumPerBlock;
+  const uint64_t offset = generator->IncrementPhiloxOffset(num_blocks);
+  const Philox4x32 philox(generator->current_seed());
+  stream->As<ep::CpuStream>()->ParallelFor(
+      0, num_blocks,
+      [&](int64_t begin, int64_t end) {
+        T uniform[kChunkBlocks * kNumPerBlock];
+        for (int64_t chunk_begin = begin; chunk_begin < end; chunk_begin += kChunkBlocks) {
+          const int64_t chunk_end = std::min(chunk_begin + kChunkBlocks, end);
+          for (int64_t block = chunk_begin; block < chunk_end; ++block) {
+            PhiloxUniform<T>::Convert(philox(offset + block),
+                                      uniform + (block - chunk_begin) * kNumPerBlock);
+          }
+          const int64_t first = chunk_begin * kNumPerBlock;
+          f(first, std::min(chunk_end * kNumPerBlock, n) - first, uniform);
+        }
+      },
+      kGrainBlocks);
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_RANDOM_PHILOX_UTIL_H_
@@ -98,6 +98,7 @@ class ReduceKernel final : public user_op::OpKernel, public user_op::CudaGraphSu
   REGISTER_REDUCE_ARITHMETIC_KERNELS(device, int64_t)
 
 REGISTER_REDUCE_ARITHMETIC_KERNELS_BY_DEVICE(DeviceType::kCPU)
+REGISTER_REDUCE_ARITHMETIC_KERNELS(DeviceType::kCPU, float16)
 #ifdef WITH_CUDA
 REGISTER_REDUCE_ARITHMETIC_KERNELS_BY_DEVICE(DeviceType::kCUDA)
 #endif
@@ -117,6 +118,7 @@ REGISTER_REDUCE_SUM_KERNELS_BY_DEVICE(DeviceType::kCPU)
 REGISTER_REDUCE_SUM_KERNELS_BY_DEVICE(DeviceType::kCUDA)
 #endif
 REGISTER_REDUCE_SUM_KERNELS(DeviceType::kCPU, float)
+REGISTER_REDUCE_SUM_KERNELS(DeviceType::kCPU, float16)
 
 #define REGISTER_REDUCE_LOGICAL_KERNELS(device)                                    \
   REGISTER_REDUCE_LOGICAL_XPU_KERNEL("reduce_any", BinaryFuncAny, device, bool)    \
@@ -14,7 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
-#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
@@ -25,35 +25,60 @@ class CpuSortKernel final : public user_op::OpKernel {
   ~CpuSortKernel() = default;
 
  private:
+  using Traits = cpu_radix_sort::KeyTraits<T>;
+  using Key = typename Traits::Key;
+
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
-
-    Memcpy<DeviceType::kCPU>(ctx->stream(), out->mut_dptr<T>(), in->dptr<T>(),
-                             in->shape().elem_cnt() * sizeof(T));
-    const int32_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
-    const int32_t instance_num = in->shape().elem_cnt() / instance_size;
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t elem_cnt = in->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int64_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
+    const int64_t instance_num = elem_cnt / instance_size;
     const std::string& direction = ctx->Attr<std::string>("direction");
     const bool is_ascending = direction == "ASCENDING";
     const bool is_descending = direction == "DESCENDING";
-    FOR_RANGE(int32_t, i, 0, instance_num) {
-      T* out_ptr_i = out->mut_dptr<T>() + i * instance_size;
-      if (is_ascending) {
-        std::sort(out_ptr_i, out_ptr_i + instance_size, std::less<T>());
-      } else if (is_descending) {
-        std::sort(out_ptr_i, out_ptr_i + instance_size, std::greater<T>());
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
+    CHECK(is_ascending || is_descending);
+    // Descending order is the ascending order of the complemented keys.
+    const Key flip = is_ascending ? Key(0) : static_cast<Key>(~Key(0));
+    Key* keys = tmp_buffer->mut_dptr<Key>();
+    Key* keys_tmp = keys + elem_cnt;
+    auto* stream = ctx->stream()->As<ep::CpuStream>();
+    cpu_radix_sort::ForEachInstance(
+        stream, instance_num, instance_size, [&](int64_t i, bool parallel) {
+          const T* in_ptr_i = in->dptr<T>() + i * instance_size;
+          T* out_ptr_i = out->mut_dptr<T>() + i * instance_size;
+          Key* keys_i = keys + i * instance_size;
+          cpu_radix_sort::ForRange(stream, parallel, instance_size,
+                                   [&](int64_t begin, int64_t end) {
+                                     for (int64_t j = begin; j < end; ++j) {
+                                       keys_i[j] = Traits::Encode(in_ptr_i[j]) ^ flip;
+                                     }
+                                   });
+          cpu_radix_sort::SortInstance<Key, Key>(stream, parallel, keys_i,
+                                                 keys_tmp + i * instance_size, nullptr, nullptr,
+                                                 instance_size);
+          cpu_radix_sort::ForRange(stream, parallel, instance_size,
+                                   [&](int64_t begin, int64_t end) {
+                                     for (int64_t j = begin; j < end; ++j) {
+                                       out_ptr_i[j] = Traits::Decode(keys_i[j] ^ flip);
+                                     }
+                                   });
+        });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CPU_SORT_KERNEL(dtype)                                             \
-  REGISTER_USER_KERNEL("sort").SetCreateFn<CpuSortKernel<dtype>>().SetIsMatchedHob( \
-      (user_op::HobDeviceType() == DeviceType::kCPU)                                \
-      && (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+#define REGISTER_CPU_SORT_KERNEL(dtype)                                                  \
+  REGISTER_USER_KERNEL("sort")                                                           \
+      .SetCreateFn<CpuSortKernel<dtype>>()                                               \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                    \
+                       && (user_op::HobDataType("out", 0) == GetDataType<dtype>::value)) \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) -> size_t {                      \
+        using Key = cpu_radix_sort::KeyTraits<dtype>::Key;                               \
+        return 2 * ctx->InputShape("in", 0).elem_cnt() * sizeof(Key);                    \
+      });
 
 REGISTER_CPU_SORT_KERNEL(float)
 REGISTER_CPU_SORT_KERNEL(double)
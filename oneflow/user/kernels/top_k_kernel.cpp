@@ -14,63 +14,130 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
-#include "oneflow/core/thread/thread_manager.h"
-#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
 namespace {
 
+// Candidates are ranked by value, larger first, and by index, smaller first, among equal values.
 template<typename T>
-void ComputeTopOne(const T* in_ptr, const Range& range, int64_t instance_size, int64_t* out_ptr) {
-  FOR_RANGE(int64_t, i, range.begin(), range.end()) {
-    const T* in_ptr_i = in_ptr + i * instance_size;
-    out_ptr[i] = std::distance(in_ptr_i, std::max_element(in_ptr_i, in_ptr_i + instance_size));
-  }
+struct Candidate {
+  T value;
+  int64_t index;
+};
+
+template<typename T>
+bool Better(const Candidate<T>& lhs, const Candidate<T>& rhs) {
+  return lhs.value > rhs.value || (lhs.value == rhs.value && lhs.index < rhs.index);
 }
 
+constexpr int64_t kFilterBlockSize = 16;
+// Above this fraction of the instance size, k is served by a full radix sort instead of a heap.
+constexpr int64_t kMinInstanceSizePerK = 8;
+
+// The k best elements of in[begin, end), end - begin >= k, kept in a heap whose front is the worst
+// of them. Elements are visited in index order, so a later element enters only when it is strictly
+// larger than the front. Blocks without such an element are rejected by a compare-and-count scan,
+// which the compiler vectorizes, so most of the input is never offered to the heap.
 template<typename T>
-void ComputeTopK(const T* in_ptr, int64_t* indices_ptr, const Range& range, int64_t instance_size,
-                 int64_t k, bool sorted, int64_t* out_ptr) {
-  FOR_RANGE(int64_t, i, range.begin(), range.end()) {
-    const int64_t offset = i * instance_size;
-    const T* in_ptr_i = in_ptr + offset;
-    int64_t* indices_ptr_i = indices_ptr + offset;
-    std::iota(indices_ptr_i, indices_ptr_i + instance_size, 0);
-    auto comp = [&](const int64_t lhs, const int64_t rhs) {
-      const T l = in_ptr_i[lhs];
-      const T r = in_ptr_i[rhs];
-      if (l == r) {
-        return lhs < rhs;
-      } else {
-        return l > r;
-      }
-    };
-    std::nth_element(indices_ptr_i, indices_ptr_i + k, indices_ptr_i + instance_size, comp);
-    if (sorted) { std::sort(indices_ptr_i, indices_ptr_i + k, comp); }
-    std::copy(indices_ptr_i, indices_ptr_i + k, out_ptr + i * k);
+void HeapTopK(const T* in, int64_t begin, int64_t end, int64_t k,
+              std::vector<Candidate<T>>* heap) {
+  heap->clear();
+  for (int64_t i = begin; i < begin + k; ++i) { heap->push_back({in[i], i}); }
+  std::make_heap(heap->begin(), heap->end(), Better<T>);
+  T threshold = heap->front().value;
+  auto Offer = [&](int64_t i) {
+    if (in[i] > threshold) {
+      std::pop_heap(heap->begin(), heap->end(), Better<T>);
+      heap->back() = {in[i], i};
+      std::push_heap(heap->begin(), heap->end(), Better<T>);
+      threshold = heap->front().value;
+    }
+  };
+  int64_t i = begin + k;
+  for (; i + kFilterBlockSize <= end; i += kFilterBlockSize) {
+    int32_t num_above = 0;
+    for (int64_t j = 0; j < kFilterBlockSize; ++j) { num_above += in[i + j] > threshold; }
+    if (num_above == 0) { continue; }
+    for (int64_t j = 0; j < kFilterBlockSize; ++j) { Offer(i + j); }
   }
+  for (; i < end; ++i) { Offer(i); }
 }
 
+// Heap top-k of one instance. With `parallel`, contiguous parts of the instance are reduced to
+// their own top k by different threads and the best k of those candidates are kept.
 template<typename T>
-void CpuTopK(ep::Stream* /*stream*/, const T* in_ptr, int64_t* indices_ptr, int64_t instance_num,
-             int64_t instance_size, int64_t k, bool sorted, int64_t* out_ptr) {
-  const int64_t num_thread =
-      std::min(instance_num, static_cast<int64_t>(Global<ThreadPool>::Get()->thread_num()));
-  const BalancedSplitter bs(instance_num, num_thread);
-  BlockingCounter bc(num_thread);
-  FOR_RANGE(int64_t, thread_id, 0, num_thread) {
-    const Range range = bs.At(thread_id);
-    Global<ThreadPool>::Get()->AddWork([=, &bc]() {
-      if (k == 1) {
-        ComputeTopOne(in_ptr, range, instance_size, out_ptr);
-      } else {
-        ComputeTopK(in_ptr, indices_ptr, range, instance_size, k, sorted, out_ptr);
-      }
-      bc.Decrease();
-    });
+void InstanceHeapTopK(ep::CpuStream* stream, bool parallel, const T* in, int64_t n, int64_t k,
+                      int64_t* out) {
+  const int64_t num_parts =
+      parallel ? std::min<int64_t>(
+          stream->device()->GetNumThreads(),
+          n / std::max<int64_t>(k, cpu_radix_sort::kMinSizePerThread))
+               : 1;
+  std::vector<Candidate<T>> candidates;
+  if (num_parts > 1) {
+    std::vector<std::vector<Candidate<T>>> heaps(num_parts);
+    stream->ParallelFor(
+        0, num_parts,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t part = begin; part < end; ++part) {
+            HeapTopK(in, n * part / num_parts, n * (part + 1) / num_parts, k, &heaps[part]);
+          }
+        },
+        1);
+    for (const auto& heap : heaps) {
+      candidates.insert(candidates.end(), heap.begin(), heap.end());
+    }
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(), Better<T>);
+  } else {
+    HeapTopK(in, 0, n, k, &candidates);
+    std::sort_heap(candidates.begin(), candidates.end(), Better<T>);
   }
-  bc.WaitForeverUntilCntEqualZero();
+  for (int64_t i = 0; i < k; ++i) { out[i] = candidates[i].index; }
+}
+
+// Top-k of one instance through a stable descending radix sort of (key, index) pairs.
+template<typename T>
+void InstanceSortTopK(ep::CpuStream* stream, bool parallel, const T* in, int64_t n, int64_t k,
+                      int64_t* indices, int64_t* indices_tmp,
+                      typename cpu_radix_sort::KeyTraits<T>::Key* keys,
+                      typename cpu_radix_sort::KeyTraits<T>::Key* keys_tmp, int64_t* out) {
+  using Traits = cpu_radix_sort::KeyTraits<T>;
+  cpu_radix_sort::ForRange(stream, parallel, n, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      keys[i] = ~Traits::OrderKey(in[i]);
+      indices[i] = i;
+    }
+  });
+  cpu_radix_sort::SortInstance(stream, parallel, keys, keys_tmp, indices, indices_tmp, n);
+  std::copy(indices, indices + k, out);
+}
+
+// Every row of the output holds the indices of the k largest elements of its instance, from the
+// largest down, so the result is sorted whether or not `sorted` is asked for.
+template<typename T>
+void CpuTopK(ep::Stream* stream, const T* in_ptr, void* tmp_ptr, int64_t instance_num,
+             int64_t instance_size, int64_t k, int64_t* out_ptr) {
+  using Key = typename cpu_radix_sort::KeyTraits<T>::Key;
+  if (k == 0) { return; }
+  const int64_t elem_cnt = instance_num * instance_size;
+  const bool use_heap = k == 1 || k * kMinInstanceSizePerK <= instance_size;
+  int64_t* indices = reinterpret_cast<int64_t*>(tmp_ptr);
+  Key* keys = use_heap ? nullptr : reinterpret_cast<Key*>(indices + 2 * elem_cnt);
+  auto* cpu_stream = stream->As<ep::CpuStream>();
+  cpu_radix_sort::ForEachInstance(
+      cpu_stream, instance_num, instance_size, [&](int64_t i, bool parallel) {
+        const int64_t offset = i * instance_size;
+        if (use_heap) {
+          InstanceHeapTopK(cpu_stream, parallel, in_ptr + offset, instance_size, k,
+                           out_ptr + i * k);
+        } else {
+          InstanceSortTopK(cpu_stream, parallel, in_ptr + offset, instance_size, k,
+                           indices + offset, indices + elem_cnt + offset, keys + offset,
+                           keys + elem_cnt + offset, out_ptr + i * k);
+        }
+      });
 }
 
 }  // namespace
@@ -91,9 +158,9 @@ class TopKCpuKernel final : public user_op::OpKernel {
     const int64_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
     const int64_t instance_num = in->shape().elem_cnt() / instance_size;
     const int64_t k = std::min(static_cast<int64_t>(ctx->Attr<int32_t>("k")), instance_size);
-    int64_t* indices_ptr = tmp_buffer ? tmp_buffer->mut_dptr<int64_t>() : nullptr;
-    CpuTopK(ctx->stream(), in->dptr<T>(), indices_ptr, instance_num, instance_size, k,
-            ctx->Attr<bool>("sorted"), out->mut_dptr<int64_t>());
+    void* tmp_ptr = tmp_buffer ? tmp_buffer->mut_dptr() : nullptr;
+    CpuTopK(ctx->stream(), in->dptr<T>(), tmp_ptr, instance_num, instance_size, k,
+            out->mut_dptr<int64_t>());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -105,7 +172,10 @@ class TopKCpuKernel final : public user_op::OpKernel {
                        && (user_op::HobDataType("in", 0) == GetDataType<dtype>::value)) \
       .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                               \
         const Shape& in_shape = ctx->InputShape("in", 0);                               \
-        return ctx->Attr<int32_t>("k") > 1 ? in_shape.elem_cnt() * sizeof(int64_t) : 0; \
+        using Key = cpu_radix_sort::KeyTraits<dtype>::Key;                              \
+        return ctx->Attr<int32_t>("k") > 1                                              \
+                   ? 2 * in_shape.elem_cnt() * (sizeof(int64_t) + sizeof(Key))          \
+                   : 0;                                                                 \
       });
 
 REGISTER_CPU_TOP_K_KERNEL(float)
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/unique_kernel_util.h"
+#include "oneflow/user/kernels/cpu_unique.h"
 
 namespace oneflow {
 
@@ -28,31 +29,17 @@ struct UniqueKernelUtil<DeviceType::kCPU, KEY, IDX> {
   static void UniqueWithCounts(ep::Stream* stream, int64_t n, const KEY* in, IDX* num_unique,
                                KEY* unique_out, IDX* idx_out, IDX* count, void* workspace,
                                int64_t workspace_size_in_bytes) {
-    HashMap<KEY, IDX> map;
-    FOR_RANGE(int64_t, i, 0, n) {
-      KEY in_i = in[i];
-      auto it = map.find(in_i);
-      if (it == map.end()) {
-        IDX idx = map.size();
-        if (count != nullptr) { count[idx] = 1; }
-        idx_out[i] = idx;
-        unique_out[idx] = in_i;
-        map[in_i] = idx;
-      } else {
-        IDX idx = it->second;
-        if (count != nullptr) { count[idx] += 1; }
-        idx_out[i] = idx;
-      }
-    }
-    *num_unique = map.size();
+    *num_unique = static_cast<IDX>(cpu_unique::Unique(
+        stream, n, in, idx_out, count, workspace, workspace_size_in_bytes,
+        [&](int64_t idx, int64_t first) { unique_out[idx] = in[first]; }));
   }
   static void GetUniqueWorkspaceSizeInBytes(ep::Stream* stream, int64_t n,
                                             int64_t* workspace_size_in_bytes) {
-    *workspace_size_in_bytes = 1;
+    *workspace_size_in_bytes = cpu_unique::GetWorkspaceSize<KEY>(n);
   }
   static void GetUniqueWithCountsWorkspaceSizeInBytes(ep::Stream* stream, int64_t n,
                                                       int64_t* workspace_size_in_bytes) {
-    *workspace_size_in_bytes = 1;
+    *workspace_size_in_bytes = cpu_unique::GetWorkspaceSize<KEY>(n);
   }
 };
 
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/unsorted_segment_sum_kernel_util.h"
+#include "oneflow/core/ep/cpu/cpu_stream.h"
 
 namespace oneflow {
 
@@ -25,23 +26,112 @@ struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T> final {
                                  int64_t segment_id_offset, T* out);
 };
 
+namespace {
+
+constexpr int64_t kParallelGrain = 32768;
+constexpr int64_t kMinColsPerThread = 64;
+
+// Adds `num_rows` rows of one outer slice into `out`, restricted to the columns
+// [col_begin, col_end). The k-th row is `rows[k]`, or simply k when `rows` is nullptr. Rows are
+// visited in that order, so every output element is summed in the same order as the serial loop,
+// whatever way the work is split.
+template<typename T, typename K>
+void SegmentSumRows(const K* segment_ids, const T* data, int64_t num_segments,
+                    int64_t inner_dim_size, int64_t segment_id_offset, int64_t col_begin,
+                    int64_t col_end, const int64_t* rows, int64_t num_rows, T* out) {
+  FOR_RANGE(int64_t, k, 0, num_rows) {
+    const int64_t i = rows == nullptr ? k : rows[k];
+    CHECK_GE(segment_ids[i], 0);
+    const int64_t idx = segment_ids[i] - segment_id_offset;
+    if (idx < 0 || idx >= num_segments) { continue; }
+    const T* from = data + i * inner_dim_size;
+    T* to = out + idx * inner_dim_size;
+    std::transform(from + col_begin, from + col_end, to + col_begin, to + col_begin,
+                   std::plus<T>());
+  }
+}
+
+}  // namespace
+
 template<typename T, typename K>
 void UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T>::UnsortedSegmentSum(
     ep::Stream* stream, const K* segment_ids, const T* data, int64_t num_segment_ids,
     int64_t num_segments, int64_t outer_dim_size, int64_t inner_dim_size, int64_t segment_id_offset,
     T* out) {
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+  if (outer_dim_size == 0 || num_segment_ids == 0 || inner_dim_size == 0) { return; }
+  auto* cpu_stream = stream->As<ep::CpuStream>();
+  const int64_t num_threads = cpu_stream->device()->GetNumThreads();
+  const int64_t slice_work = num_segment_ids * inner_dim_size;
+  const auto SumSlice = [&](int64_t outer_idx, int64_t col_begin, int64_t col_end,
+                            const int64_t* rows, int64_t num_rows) {
+    SegmentSumRows(segment_ids, data + outer_idx * slice_work, num_segments, inner_dim_size,
+                   segment_id_offset, col_begin, col_end, rows, num_rows,
+                   out + outer_idx * num_segments * inner_dim_size);
+  };
+  if (num_threads == 1 || outer_dim_size * slice_work < kParallelGrain) {
+    FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
+      SumSlice(outer_idx, 0, inner_dim_size, nullptr, num_segment_ids);
+    }
+  } else if (outer_dim_size >= num_threads) {
+    // Outer slices write disjoint parts of the output.
+    cpu_stream->ParallelFor(
+        0, outer_dim_size,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t outer_idx = begin; outer_idx < end; ++outer_idx) {
+            SumSlice(outer_idx, 0, inner_dim_size, nullptr, num_segment_ids);
+          }
+        },
+        std::max<int64_t>(kParallelGrain / slice_work, 1));
+  } else if (inner_dim_size >= num_threads * kMinColsPerThread) {
+    // Wide rows: every thread owns a band of columns of all the segments, which stays balanced
+    // however skewed the segment ids are.
+    FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
+      cpu_stream->ParallelFor(
+          0, inner_dim_size,
+          [&](int64_t begin, int64_t end) {
+            SumSlice(outer_idx, begin, end, nullptr, num_segment_ids);
+          },
+          std::max<int64_t>(kParallelGrain / num_segment_ids, kMinColsPerThread));
+    }
+  } else {
+    // Narrow rows: split the segments into one contiguous range per thread, bucket the rows by
+    // the owner of their segment (stable, so each bucket keeps the serial order) and let every
+    // owner accumulate only into its own segments.
+    const int64_t num_owners = std::min(num_threads, num_segments);
+    const auto OwnerOf = [&](int64_t i) -> int64_t {
       CHECK_GE(segment_ids[i], 0);
       const int64_t idx = segment_ids[i] - segment_id_offset;
-      T* to = out + outer_idx * num_segments * inner_dim_size + idx * inner_dim_size;
-      if (idx >= 0 && idx < num_segments) {
-        const T* from = data + outer_idx * num_segment_ids * inner_dim_size + i * inner_dim_size;
-        std::transform(from, from + inner_dim_size, to, to, std::plus<T>());
-      }
+      if (idx < 0 || idx >= num_segments) { return -1; }
+      return idx * num_owners / num_segments;
+    };
+    std::vector<int64_t> bucket_offsets(num_owners + 1, 0);
+    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+      const int64_t owner = OwnerOf(i);
+      if (owner >= 0) { bucket_offsets[owner + 1] += 1; }
+    }
+    FOR_RANGE(int64_t, owner, 0, num_owners) {
+      bucket_offsets[owner + 1] += bucket_offsets[owner];
+    }
+    std::vector<int64_t> rows(bucket_offsets.back());
+    std::vector<int64_t> cursor(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+      const int64_t owner = OwnerOf(i);
+      if (owner >= 0) { rows[cursor[owner]++] = i; }
+    }
+    FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
+      cpu_stream->ParallelFor(
+          0, num_owners,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t owner = begin; owner < end; ++owner) {
+              SumSlice(outer_idx, 0, inner_dim_size, rows.data() + bucket_offsets[owner],
+                       bucket_offsets[owner + 1] - bucket_offsets[owner]);
+            }
+          },
+          1);
     }
   }
 }
+
 #define INITIATE_UNSORTED_SEGMENT_SUM_KERNEL_UTIL_CPU(in_type_pair, index_type_pair)             \
   template struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, OF_PP_PAIR_FIRST(in_type_pair), \
                                                OF_PP_PAIR_FIRST(index_type_pair),                \
@@ -455,6 +455,64 @@ Maybe<void> InferLarsUpdateDataType(user_op::InferContext* ctx) {
   return Maybe<void>::Ok();
 }
 
+Maybe<void> InferMultiTensorUpdateTensorDesc(user_op::InferContext* ctx,
+                                             const std::vector<std::string>& states) {
+  const int32_t num_tensors = ctx->input_size("model");
+  CHECK_GT_OR_RETURN(num_tensors, 0);
+  CHECK_EQ_OR_RETURN(ctx->input_size("model_diff"), num_tensors);
+  for (const auto& state : states) { CHECK_EQ_OR_RETURN(ctx->input_size(state), num_tensors); }
+  for (int32_t i = 0; i < num_tensors; ++i) {
+    const user_op::TensorDesc& model = ctx->InputTensorDesc("model", i);
+    const user_op::TensorDesc& model_diff = ctx->InputTensorDesc("model_diff", i);
+    CHECK_EQ_OR_RETURN(model_diff.shape(), model.shape());
+    for (const auto& state : states) {
+      JUST(CheckShapeLike(&ctx->InputTensorDesc(state, i), &model));
+    }
+  }
+  JUST(CheckLearningRateShape(ctx));
+  if (ctx->has_input("scale_by_tensor", 0)) {
+    const auto& scale_by_tensor = ctx->InputTensorDesc("scale_by_tensor", 0);
+    JUST(CheckScalarShape(&scale_by_tensor));
+  }
+  return Maybe<void>::Ok();
+}
+Maybe<void> InferMultiTensorUpdateDataType(user_op::InferContext* ctx,
+                                           const std::vector<std::string>& states) {
+  const DataType data_type = ctx->InputTensorDesc("model", 0).data_type();
+  for (int32_t i = 0; i < ctx->input_size("model"); ++i) {
+    const user_op::TensorDesc& model = ctx->InputTensorDesc("model", i);
+    CHECK_EQ_OR_RETURN(model.data_type(), data_type);
+    for (const auto& state : states) {
+      JUST(CheckDataTypeLike(&ctx->InputTensorDesc(state, i), &model));
+    }
+  }
+  JUST(CheckLearningRateDataType(ctx));
+  if (ctx->has_input("scale_by_tensor", 0)) {
+    const auto& scale_by_tensor = ctx->InputTensorDesc("scale_by_tensor", 0);
+    JUST(CheckScalarDataType(&scale_by_tensor, data_type));
+  }
+  return Maybe<void>::Ok();
+}
+
+// Parameters of a multi tensor update have unrelated shapes, so only the all broadcast signature
+// is offered; fuse_update_ops_pass only groups broadcast (or single device) models.
+Maybe<void> GetMultiTensorUpdateSbp(user_op::SbpContext* ctx) {
+  ctx->NewBuilder().Broadcast(ctx->inputs()).Build();
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> MultiTensorUpdateInputArgModifyFn(
+    const user_op::GetInputArgModifier& GetInputArgModifierFn,
+    const user_op::UserOpConfWrapper& conf, const std::vector<std::string>& states) {
+  for (int32_t i = 0; i < conf.input_size("model"); ++i) {
+    JUST(SetInputArgModifierMutable(GetInputArgModifierFn, "model", i));
+    for (const auto& state : states) {
+      JUST(SetInputArgModifierMutable(GetInputArgModifierFn, state, i));
+    }
+  }
+  return Maybe<void>::Ok();
+}
+
 }  // namespace
 
 /* static */ Maybe<void> SgdUpdateOp::InferLogicalTensorDesc(user_op::InferContext* ctx) {
@@ -851,4 +909,72 @@ Maybe<void> InferLarsUpdateDataType(user_op::InferContext* ctx) {
   return InferFtrlUpdateDataType(ctx);
 }
 
+/* static */ Maybe<void> MultiTensorSgdUpdateOp::InferLogicalTensorDesc(
+    user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateTensorDesc(ctx, {});
+}
+
+/*static*/ Maybe<void> MultiTensorSgdUpdateOp::InferPhysicalTensorDesc(user_op::InferContext* ctx) {
+  return InferLogicalTensorDesc(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorSgdUpdateOp::GetSbp(user_op::SbpContext* ctx) {
+  return GetMultiTensorUpdateSbp(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorSgdUpdateOp::ModifyInputArg(
+    const GetInputArgModifier& GetInputArgModifierFn, const user_op::UserOpConfWrapper& conf) {
+  return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf, {});
+}
+
+/* static */ Maybe<void> MultiTensorSgdUpdateOp::InferDataType(user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateDataType(ctx, {});
+}
+
+/* static */ Maybe<void> MultiTensorMomentumUpdateOp::InferLogicalTensorDesc(
+    user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateTensorDesc(ctx, {"momentum"});
+}
+
+/*static*/ Maybe<void> MultiTensorMomentumUpdateOp::InferPhysicalTensorDesc(
+    user_op::InferContext* ctx) {
+  return InferLogicalTensorDesc(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorMomentumUpdateOp::GetSbp(user_op::SbpContext* ctx) {
+  return GetMultiTensorUpdateSbp(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorMomentumUpdateOp::ModifyInputArg(
+    const GetInputArgModifier& GetInputArgModifierFn, const user_op::UserOpConfWrapper& conf) {
+  return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf, {"momentum"});
+}
+
+/* static */ Maybe<void> MultiTensorMomentumUpdateOp::InferDataType(user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateDataType(ctx, {"momentum"});
+}
+
+/* static */ Maybe<void> MultiTensorAdamUpdateOp::InferLogicalTensorDesc(
+    user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateTensorDesc(ctx, {"m", "v"});
+}
+
+/*static*/ Maybe<void> MultiTensorAdamUpdateOp::InferPhysicalTensorDesc(
+    user_op::InferContext* ctx) {
+  return InferLogicalTensorDesc(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorAdamUpdateOp::GetSbp(user_op::SbpContext* ctx) {
+  return GetMultiTensorUpdateSbp(ctx);
+}
+
+/* static */ Maybe<void> MultiTensorAdamUpdateOp::ModifyInputArg(
+    const GetInputArgModifier& GetInputArgModifierFn, const user_op::UserOpConfWrapper& conf) {
+  return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf, {"m", "v"});
+}
+
+/* static */ Maybe<void> MultiTensorAdamUpdateOp::InferDataType(user_op::InferContext* ctx) {
+  return InferMultiTensorUpdateDataType(ctx, {"m", "v"});
+}
+
 }  // namespace oneflow
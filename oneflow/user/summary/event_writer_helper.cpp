@@ -18,6 +18,8 @@ limitations under the License.
 #include "oneflow/user/summary/events_writer.h"
 #include "oneflow/user/summary/histogram.h"
 #include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/summary/summary.pb.h"
 #include "oneflow/core/summary/event.pb.h"
 
@@ -34,6 +36,8 @@ namespace summary {
 const char* kScalarPluginName = "scalars";
 const char* kHistogramPluginName = "histograms";
 const char* kImagePluginName = "images";
+// Tensors smaller than this are histogrammed on the calling thread
+const int64_t kParallelHistogramMinElemCnt = 1 << 16;
 
 void SetPluginData(SummaryMetadata* metadata, const char* name) {
   if (metadata->plugin_data().plugin_name().empty()) {
@@ -59,10 +63,22 @@ Maybe<void> FillHistogramInSummary(const user_op::Tensor& value, const std::stri
   Summary::Value* v = s->add_value();
   v->set_tag(tag);
   *v->mutable_metadata() = metadata;
+  const int64_t elem_cnt = value.shape().elem_cnt();
+  const T* dptr = value.dptr<T>();
   summary::Histogram histo;
-  for (int64_t i = 0; i < value.shape().elem_cnt(); i++) {
-    double double_val = value.dptr<T>()[i];
-    histo.AppendValue(double_val);
+  if (elem_cnt < kParallelHistogramMinElemCnt) {
+    histo.AppendValues<T>(dptr, elem_cnt);
+  } else {
+    const int64_t part_num = RoundUp(elem_cnt, kParallelHistogramMinElemCnt)
+                             / kParallelHistogramMinElemCnt;
+    BalancedSplitter bs(elem_cnt, part_num);
+    std::vector<summary::Histogram> part_histos(part_num);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      const Range range = bs.At(i);
+      part_histos.at(i).AppendValues<T>(dptr + range.begin(), range.size());
+    });
+    // merge in a fixed order so that the result does not depend on the thread schedule
+    for (const summary::Histogram& part_histo : part_histos) { histo.Merge(part_histo); }
   }
   histo.AppendToProto(v->mutable_histo());
   return Maybe<void>::Ok();
@@ -184,7 +200,7 @@ struct EventWriterHelper<DeviceType::kCPU, T> {
     e->set_step(step);
     e->set_wall_time(GetWallTime());
     CHECK_JUST(FillHistogramInSummary<T>(value, tag, e->mutable_summary()));
-    Global<EventsWriter>::Get()->AppendQueue(std::move(e));
+    Global<EventsWriter>::Get()->AppendQueue(std::move(e), EventPriority::kLow);
   }
 
   static void WriteImageToFile(int64_t step, const user_op::Tensor& tensor,
@@ -193,7 +209,7 @@ struct EventWriterHelper<DeviceType::kCPU, T> {
     e->set_step(step);
     e->set_wall_time(GetWallTime());
     CHECK_JUST(FillImageInSummary(tensor, tag, e->mutable_summary()));
-    Global<EventsWriter>::Get()->AppendQueue(std::move(e));
+    Global<EventsWriter>::Get()->AppendQueue(std::move(e), EventPriority::kLow);
   }
 };
 
@@ -17,21 +17,36 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/user/summary/env_time.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace oneflow {
 
 namespace summary {
 
-EventsWriter::EventsWriter() : is_inited_(false) {}
+EventsWriter::EventsWriter()
+    : is_inited_(false),
+      init_time_(0),
+      last_flush_time_(0),
+      flush_request_cnt_(0),
+      flush_done_cnt_(0),
+      shutdown_(false),
+      written_event_num_(0),
+      written_bytes_(0),
+      dropped_event_num_(0) {}
 
 EventsWriter::~EventsWriter() { Close(); }
 
 Maybe<void> EventsWriter::Init(const std::string& logdir) {
+  if (is_inited_) { return Maybe<void>::Ok(); }
   file_system_ = std::make_unique<fs::PosixFileSystem>();
   log_dir_ = logdir + "/event";
   file_system_->RecursivelyCreateDirIfNotExist(log_dir_);
   JUST(TryToInit());
   is_inited_ = true;
-  last_flush_time_ = CurrentMircoTime();
+  init_time_ = CurrentMircoTime();
+  last_flush_time_ = init_time_;
+  StartWriterThread();
   return Maybe<void>::Ok();
 }
 
@@ -55,28 +70,106 @@ Maybe<void> EventsWriter::TryToInit() {
     Event event;
     event.set_wall_time(current_time);
     event.set_file_version(FILE_VERSION);
+    // may be called from the writer thread, so only touch the file here
     WriteEvent(event);
-    Flush();
   }
   return Maybe<void>::Ok();
 }
 
-void EventsWriter::AppendQueue(std::unique_ptr<Event> event) {
-  queue_mutex.lock();
-  event_queue_.emplace_back(std::move(event));
-  queue_mutex.unlock();
-  if (event_queue_.size() > MAX_QUEUE_NUM || CurrentMircoTime() - last_flush_time_ > FLUSH_TIME) {
-    Flush();
+void EventsWriter::StartWriterThread() {
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    shutdown_ = false;
   }
+  writer_thread_ = std::thread(&EventsWriter::WriterLoop, this);
+}
+
+void EventsWriter::StopWriterThread() {
+  if (!writer_thread_.joinable()) { return; }
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    shutdown_ = true;
+  }
+  pending_cond_.notify_one();
+  writer_thread_.join();
+}
+
+void EventsWriter::WriterLoop() {
+  std::vector<PendingEvent> writing_events;
+  while (true) {
+    uint64_t flush_cnt = 0;
+    bool shutdown = false;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      pending_cond_.wait_for(lock, std::chrono::microseconds(FLUSH_TIME), [this]() {
+        return shutdown_ || flush_request_cnt_ > flush_done_cnt_
+               || pending_events_.size() > MAX_QUEUE_NUM;
+      });
+      writing_events.swap(pending_events_);
+      flush_cnt = flush_request_cnt_;
+      shutdown = shutdown_;
+    }
+    // producers blocked on a full queue can continue while this batch is being written
+    flushed_cond_.notify_all();
+    WriteBatch(writing_events);
+    writing_events.clear();
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      flush_done_cnt_ = flush_cnt;
+      last_flush_time_ = CurrentMircoTime();
+    }
+    flushed_cond_.notify_all();
+    if (shutdown) { break; }
+  }
+}
+
+void EventsWriter::AppendQueue(std::unique_ptr<Event> event, EventPriority priority) {
+  bool need_notify = false;
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (pending_events_.size() >= kMaxPendingEventNum) {
+      if (priority == EventPriority::kLow) {
+        dropped_event_num_ += 1;
+        return;
+      }
+      auto low_priority_it = std::find_if(
+          pending_events_.begin(), pending_events_.end(),
+          [](const PendingEvent& e) { return e.priority == EventPriority::kLow; });
+      if (low_priority_it != pending_events_.end()) {
+        pending_events_.erase(low_priority_it);
+        dropped_event_num_ += 1;
+      } else if (writer_thread_.joinable()) {
+        flushed_cond_.wait(lock, [this]() {
+          return pending_events_.size() < kMaxPendingEventNum || shutdown_;
+        });
+      }
+    }
+    pending_events_.emplace_back(PendingEvent{std::move(event), priority});
+    need_notify = pending_events_.size() > MAX_QUEUE_NUM
+                  || CurrentMircoTime() - last_flush_time_ > FLUSH_TIME;
+  }
+  if (need_notify) { pending_cond_.notify_one(); }
 }
 
 void EventsWriter::Flush() {
-  queue_mutex.lock();
-  for (const std::unique_ptr<Event>& e : event_queue_) { WriteEvent(*e); }
-  event_queue_.clear();
-  queue_mutex.unlock();
-  FileFlush();
-  last_flush_time_ = CurrentMircoTime();
+  if (!writer_thread_.joinable()) {
+    FileFlush();
+    return;
+  }
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  const uint64_t flush_cnt = ++flush_request_cnt_;
+  pending_cond_.notify_one();
+  flushed_cond_.wait(lock, [this, flush_cnt]() { return flush_done_cnt_ >= flush_cnt; });
+}
+
+void EventsWriter::EncodeRecord(const std::string& event_str, std::string* buffer) {
+  char head[kHeadSize];
+  char tail[kTailSize];
+  EncodeHead(head, event_str.size());
+  EncodeTail(tail, event_str.data(), event_str.size());
+  buffer->append(head, sizeof(head));
+  buffer->append(event_str);
+  buffer->append(tail, sizeof(tail));
 }
 
 void EventsWriter::WriteEvent(const Event& event) {
@@ -91,14 +184,36 @@ void EventsWriter::WriteEvent(const Event& event) {
     return;
   }
 
-  char head[kHeadSize];
-  char tail[kTailSize];
-  EncodeHead(head, event_str.size());
-  EncodeTail(tail, event_str.data(), event_str.size());
-  writable_file_->Append(head, sizeof(head));
-  writable_file_->Append(event_str.data(), event_str.size());
-  writable_file_->Append(tail, sizeof(tail));
+  std::string record;
+  EncodeRecord(event_str, &record);
+  writable_file_->Append(record.data(), record.size());
+  FileFlush();
+  written_event_num_ += 1;
+  written_bytes_ += record.size();
+}
+
+void EventsWriter::WriteBatch(const std::vector<PendingEvent>& batch) {
+  if (batch.empty()) { return; }
+  if (!TryToInit().IsOk()) {
+    LOG(ERROR) << "Write failed because file could not be opened.";
+    return;
+  }
+  if (writable_file_ == nullptr) {
+    LOG(WARNING) << "Log file is closed!";
+    return;
+  }
+  // serialize and checksum the whole batch, then hand it to the file in one append
+  std::string buffer;
+  std::string event_str;
+  for (const PendingEvent& pending_event : batch) {
+    event_str.clear();
+    pending_event.event->AppendToString(&event_str);
+    EncodeRecord(event_str, &buffer);
+  }
+  writable_file_->Append(buffer.data(), buffer.size());
   FileFlush();
+  written_event_num_ += batch.size();
+  written_bytes_ += buffer.size();
 }
 
 void EventsWriter::FileFlush() {
@@ -106,14 +221,36 @@ void EventsWriter::FileFlush() {
   writable_file_->Flush();
 }
 
+EventsWriterStats EventsWriter::GetStats() const {
+  EventsWriterStats stats{};
+  stats.written_event_num = written_event_num_;
+  stats.written_bytes = written_bytes_;
+  stats.dropped_event_num = dropped_event_num_;
+  if (is_inited_) {
+    const double elapsed_seconds =
+        static_cast<double>(CurrentMircoTime() - init_time_) / kMircoTimeToSecondTime;
+    if (elapsed_seconds > 0) {
+      stats.events_per_second = stats.written_event_num / elapsed_seconds;
+    }
+  }
+  return stats;
+}
+
 void EventsWriter::Close() {
   if (!is_inited_) { return; }
-  queue_mutex.unlock();
-  Flush();
+  StopWriterThread();
+  std::vector<PendingEvent> remaining_events;
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    remaining_events.swap(pending_events_);
+  }
+  WriteBatch(remaining_events);
+  FileFlush();
   if (writable_file_ != nullptr) {
     writable_file_->Close();
     writable_file_.reset(nullptr);
   }
+  is_inited_ = false;
 }
 
 }  // namespace summary
@@ -22,7 +22,10 @@ limitations under the License.
 #include "oneflow/core/summary/event.pb.h"
 
 #include <time.h>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace oneflow {
 
@@ -33,6 +36,19 @@ namespace summary {
 #define FILE_VERSION "brain.Event:3"
 const size_t kHeadSize = sizeof(uint64_t) + sizeof(uint32_t);
 const size_t kTailSize = sizeof(uint32_t);
+// Upper bound of events buffered in memory, low priority events are dropped beyond it
+const size_t kMaxPendingEventNum = 1024;
+
+// Low priority events (histograms, images) may be dropped when the writer falls behind,
+// high priority events (scalars, raw summaries) are never dropped.
+enum class EventPriority { kLow = 0, kHigh = 1 };
+
+struct EventsWriterStats {
+  int64_t written_event_num;
+  int64_t written_bytes;
+  int64_t dropped_event_num;
+  double events_per_second;
+};
 
 class EventsWriter {
  public:
@@ -44,11 +60,22 @@ class EventsWriter {
   void Flush();
   void Close();
 
-  void AppendQueue(std::unique_ptr<Event> event);
+  void AppendQueue(std::unique_ptr<Event> event, EventPriority priority = EventPriority::kHigh);
   void FileFlush();
+  EventsWriterStats GetStats() const;
 
  private:
+  struct PendingEvent {
+    std::unique_ptr<Event> event;
+    EventPriority priority;
+  };
+
   Maybe<void> TryToInit();
+  void StartWriterThread();
+  void StopWriterThread();
+  void WriterLoop();
+  void WriteBatch(const std::vector<PendingEvent>& batch);
+  static void EncodeRecord(const std::string& event_str, std::string* buffer);
   inline static void EncodeHead(char* head, size_t size);
   inline static void EncodeTail(char* tail, const char* data, size_t size);
 
@@ -57,9 +84,21 @@ class EventsWriter {
   std::string filename_;
   std::unique_ptr<fs::FileSystem> file_system_;
   std::unique_ptr<fs::WritableFile> writable_file_;
+  uint64_t init_time_;
   uint64_t last_flush_time_;
-  std::vector<std::unique_ptr<Event>> event_queue_;
-  std::mutex queue_mutex;
+  // Double buffered: producers fill pending_events_ while the writer thread serializes the
+  // previously swapped out batch without holding queue_mutex_.
+  std::vector<PendingEvent> pending_events_;
+  std::mutex queue_mutex_;
+  std::condition_variable pending_cond_;
+  std::condition_variable flushed_cond_;
+  uint64_t flush_request_cnt_;
+  uint64_t flush_done_cnt_;
+  bool shutdown_;
+  std::thread writer_thread_;
+  std::atomic<int64_t> written_event_num_;
+  std::atomic<int64_t> written_bytes_;
+  std::atomic<int64_t> dropped_event_num_;
   OF_DISALLOW_COPY(EventsWriter);
 };
 
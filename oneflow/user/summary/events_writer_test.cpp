@@ -0,0 +1,140 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <dirent.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "gtest/gtest.h"
+#include "oneflow/user/summary/events_writer.h"
+
+namespace oneflow {
+
+namespace summary {
+
+namespace test {
+
+namespace {
+
+std::string MakeTempDir() {
+  char dir[] = "/tmp/events_writer_test_XXXXXX";
+  CHECK(mkdtemp(dir) != nullptr);
+  return dir;
+}
+
+std::unique_ptr<Event> NewEvent(int64_t step) {
+  std::unique_ptr<Event> event(new Event());
+  event->set_wall_time(step);
+  event->set_step(step);
+  return event;
+}
+
+// Reads the only event file written under `logdir`.
+std::string ReadEventFile(const std::string& logdir) {
+  const std::string event_dir = logdir + "/event";
+  DIR* dir = opendir(event_dir.c_str());
+  CHECK(dir != nullptr);
+  std::string filename;
+  while (struct dirent* entry = readdir(dir)) {
+    if (std::strncmp(entry->d_name, "event.", 6) == 0) {
+      CHECK(filename.empty());
+      filename = event_dir + "/" + entry->d_name;
+    }
+  }
+  closedir(dir);
+  CHECK(!filename.empty());
+  std::ifstream file(filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Returns the steps of the framed records in `content`, the file version record has step 0.
+std::vector<int64_t> ParseSteps(const std::string& content) {
+  std::vector<int64_t> steps;
+  size_t offset = 0;
+  while (offset < content.size()) {
+    uint64_t size = 0;
+    CHECK_LE(offset + kHeadSize, content.size());
+    std::memcpy(&size, content.data() + offset, sizeof(size));
+    offset += kHeadSize;
+    CHECK_LE(offset + size + kTailSize, content.size());
+    Event event;
+    CHECK(event.ParseFromArray(content.data() + offset, size));
+    steps.emplace_back(event.step());
+    offset += size + kTailSize;
+  }
+  return steps;
+}
+
+}  // namespace
+
+TEST(EventsWriter, drop_low_priority_events_under_backpressure) {
+  const int64_t max_pending_event_num = kMaxPendingEventNum;
+  EventsWriter writer;
+  // without the writer thread nothing drains the queue, so it stays full
+  for (int64_t i = 0; i < max_pending_event_num; ++i) {
+    writer.AppendQueue(NewEvent(i + 1), EventPriority::kLow);
+  }
+  ASSERT_EQ(writer.GetStats().dropped_event_num, 0);
+  // low priority events are dropped when the queue is full
+  writer.AppendQueue(NewEvent(max_pending_event_num + 1), EventPriority::kLow);
+  ASSERT_EQ(writer.GetStats().dropped_event_num, 1);
+  // high priority events replace the oldest low priority one
+  writer.AppendQueue(NewEvent(max_pending_event_num + 2), EventPriority::kHigh);
+  ASSERT_EQ(writer.GetStats().dropped_event_num, 2);
+
+  const std::string logdir = MakeTempDir();
+  ASSERT_TRUE(writer.Init(logdir).IsOk());
+  writer.Flush();
+  const EventsWriterStats stats = writer.GetStats();
+  // the file version event and the kept events
+  ASSERT_EQ(stats.written_event_num, max_pending_event_num + 1);
+  const std::string content = ReadEventFile(logdir);
+  ASSERT_EQ(stats.written_bytes, static_cast<int64_t>(content.size()));
+  std::vector<int64_t> expected_steps{0};
+  for (int64_t i = 1; i < max_pending_event_num; ++i) { expected_steps.emplace_back(i + 1); }
+  expected_steps.emplace_back(max_pending_event_num + 2);
+  ASSERT_EQ(ParseSteps(content), expected_steps);
+}
+
+TEST(EventsWriter, flush_drains_the_queue) {
+  EventsWriter writer;
+  const std::string logdir = MakeTempDir();
+  ASSERT_TRUE(writer.Init(logdir).IsOk());
+  std::vector<int64_t> expected_steps{0};
+  for (int64_t round = 0; round < 4; ++round) {
+    // fewer events than MAX_QUEUE_NUM do not wake the writer thread by themselves
+    for (int64_t i = 0; i < MAX_QUEUE_NUM / 2; ++i) {
+      const int64_t step = expected_steps.size();
+      writer.AppendQueue(NewEvent(step), i % 2 == 0 ? EventPriority::kHigh : EventPriority::kLow);
+      expected_steps.emplace_back(step);
+    }
+    writer.Flush();
+    const EventsWriterStats stats = writer.GetStats();
+    ASSERT_EQ(stats.written_event_num, static_cast<int64_t>(expected_steps.size()));
+    ASSERT_EQ(stats.dropped_event_num, 0);
+    const std::string content = ReadEventFile(logdir);
+    ASSERT_EQ(stats.written_bytes, static_cast<int64_t>(content.size()));
+    ASSERT_EQ(ParseSteps(content), expected_steps);
+  }
+  ASSERT_GT(writer.GetStats().events_per_second, 0);
+  writer.Close();
+}
+
+}  // namespace test
+
+}  // namespace summary
+
+}  // namespace oneflow
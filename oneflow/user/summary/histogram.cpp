@@ -721,6 +721,70 @@ void Histogram::AppendValue(double value) {
   containers_.at(idx) += 1.0;
 }
 
+template<typename T>
+void Histogram::AppendValues(const T* values, int64_t num) {
+  constexpr int64_t kLaneNum = 4;
+  double sum[kLaneNum] = {0, 0, 0, 0};
+  double square_sum[kLaneNum] = {0, 0, 0, 0};
+  double min[kLaneNum] = {DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX};
+  double max[kLaneNum] = {-DBL_MAX, -DBL_MAX, -DBL_MAX, -DBL_MAX};
+  const int64_t vectorized_num = num / kLaneNum * kLaneNum;
+  for (int64_t i = 0; i < vectorized_num; i += kLaneNum) {
+    for (int64_t lane = 0; lane < kLaneNum; ++lane) {
+      const double value = static_cast<double>(values[i + lane]);
+      sum[lane] += value;
+      square_sum[lane] += value * value;
+      min[lane] = std::min(min[lane], value);
+      max[lane] = std::max(max[lane], value);
+    }
+  }
+  for (int64_t i = vectorized_num; i < num; ++i) {
+    const double value = static_cast<double>(values[i]);
+    sum[0] += value;
+    square_sum[0] += value * value;
+    min[0] = std::min(min[0], value);
+    max[0] = std::max(max[0], value);
+  }
+  for (int64_t lane = 0; lane < kLaneNum; ++lane) {
+    value_sum_ += sum[lane];
+    sum_value_squares_ += square_sum[lane];
+    min_value_ = std::min(min_value_, min[lane]);
+    max_value_ = std::max(max_value_, max[lane]);
+  }
+  value_count_ += num;
+  for (int64_t i = 0; i < num; ++i) {
+    const double value = static_cast<double>(values[i]);
+    const size_t idx = std::upper_bound(max_constainers_.begin(), max_constainers_.end(), value)
+                       - max_constainers_.begin();
+    CHECK_GT(containers_.size(), idx);
+    containers_[idx] += 1.0;
+  }
+}
+
+void Histogram::Merge(const Histogram& other) {
+  CHECK_EQ(containers_.size(), other.containers_.size());
+  value_count_ += other.value_count_;
+  value_sum_ += other.value_sum_;
+  sum_value_squares_ += other.sum_value_squares_;
+  min_value_ = std::min(min_value_, other.min_value_);
+  max_value_ = std::max(max_value_, other.max_value_);
+  for (size_t idx = 0; idx < containers_.size(); idx++) {
+    containers_[idx] += other.containers_[idx];
+  }
+}
+
+#define INSTANTIATE_HISTOGRAM_APPEND_VALUES(T) \
+  template void Histogram::AppendValues<T>(const T* values, int64_t num);
+
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(float)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(double)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int32_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int64_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(uint8_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int8_t)
+
+#undef INSTANTIATE_HISTOGRAM_APPEND_VALUES
+
 void Histogram::AppendToProto(HistogramProto* hist_proto) {
   hist_proto->Clear();
   hist_proto->set_num(value_count_);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_USER_SUMMARY_HISTOGRAM_H_
 #define ONEFLOW_USER_SUMMARY_HISTOGRAM_H_
 
+#include <cstdint>
 #include <vector>
 #include "oneflow/core/summary/summary.pb.h"
 
@@ -29,6 +30,13 @@ class Histogram {
   ~Histogram() {}
 
   void AppendValue(double value);
+  // Batched version of AppendValue, statistics are accumulated in independent lanes so the
+  // loop can be vectorized by the compiler.
+  template<typename T>
+  void AppendValues(const T* values, int64_t num);
+  // Histograms built on disjoint parts of the same tensor (e.g. by different threads) are
+  // combined with Merge, the bucket limits of both sides must be the same.
+  void Merge(const Histogram& other);
   void AppendToProto(HistogramProto* proto);
 
  private:
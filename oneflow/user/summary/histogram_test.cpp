@@ -0,0 +1,111 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cmath>
+#include <random>
+#include "gtest/gtest.h"
+#include "oneflow/user/summary/histogram.h"
+
+namespace oneflow {
+
+namespace summary {
+
+namespace test {
+
+namespace {
+
+HistogramProto AppendOneByOne(const std::vector<double>& values) {
+  Histogram histogram;
+  for (double value : values) { histogram.AppendValue(value); }
+  HistogramProto proto;
+  histogram.AppendToProto(&proto);
+  return proto;
+}
+
+// Histograms the values in `part_num` chunks with AppendValues and merges them in order.
+template<typename T>
+HistogramProto AppendInParts(const std::vector<T>& values, int64_t part_num) {
+  const int64_t num = values.size();
+  Histogram histogram;
+  for (int64_t part = 0; part < part_num; ++part) {
+    const int64_t begin = num * part / part_num;
+    const int64_t end = num * (part + 1) / part_num;
+    Histogram part_histogram;
+    part_histogram.AppendValues(values.data() + begin, end - begin);
+    histogram.Merge(part_histogram);
+  }
+  HistogramProto proto;
+  histogram.AppendToProto(&proto);
+  return proto;
+}
+
+void CheckHistogramEq(const HistogramProto& lhs, const HistogramProto& rhs, double sum_eps,
+                      double sum_squares_eps) {
+  ASSERT_EQ(lhs.num(), rhs.num());
+  ASSERT_EQ(lhs.min(), rhs.min());
+  ASSERT_EQ(lhs.max(), rhs.max());
+  ASSERT_NEAR(lhs.sum(), rhs.sum(), sum_eps);
+  ASSERT_NEAR(lhs.sum_squares(), rhs.sum_squares(), sum_squares_eps);
+  ASSERT_EQ(lhs.bucket_limit_size(), rhs.bucket_limit_size());
+  ASSERT_EQ(lhs.bucket_size(), rhs.bucket_size());
+  for (int i = 0; i < lhs.bucket_size(); ++i) {
+    ASSERT_EQ(lhs.bucket_limit(i), rhs.bucket_limit(i));
+    ASSERT_EQ(lhs.bucket(i), rhs.bucket(i));
+  }
+}
+
+}  // namespace
+
+TEST(Histogram, append_values_and_merge_int) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int32_t> dist(-100000, 100000);
+  // sizes which are not multiples of the lane number leave a tail
+  for (int64_t num : {0, 1, 3, 4, 1001, 65537}) {
+    std::vector<int32_t> values(num);
+    for (auto& value : values) { value = dist(gen); }
+    const HistogramProto expected =
+        AppendOneByOne(std::vector<double>(values.begin(), values.end()));
+    for (int64_t part_num : {1, 3, 8}) {
+      // integer sums are exact in any order
+      CheckHistogramEq(AppendInParts(values, part_num), expected, 0, 0);
+    }
+  }
+}
+
+TEST(Histogram, append_values_and_merge_float) {
+  std::mt19937 gen(0);
+  std::normal_distribution<float> dist(0, 1000);
+  for (int64_t num : {1, 7, 1001, 65537}) {
+    std::vector<float> values(num);
+    double abs_sum = 0;
+    for (auto& value : values) {
+      value = dist(gen);
+      abs_sum += std::abs(value);
+    }
+    const HistogramProto expected =
+        AppendOneByOne(std::vector<double>(values.begin(), values.end()));
+    for (int64_t part_num : {1, 3, 8}) {
+      // only the summation order differs
+      CheckHistogramEq(AppendInParts(values, part_num), expected, 1e-10 * abs_sum,
+                       1e-10 * expected.sum_squares());
+    }
+  }
+}
+
+}  // namespace test
+
+}  // namespace summary
+
+}  // namespace oneflow
@@ -206,6 +206,10 @@ def skip_unless_1n2d():
     return skip_unless(1, 2)
 
 
+def skip_unless_1n3d():
+    return skip_unless(1, 3)
+
+
 def skip_unless_1n4d():
     return skip_unless(1, 4)
 
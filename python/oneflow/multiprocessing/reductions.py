@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 """
+import os
 from multiprocessing.reduction import ForkingPickler
 
 import numpy as np
@@ -34,6 +35,127 @@ except ImportError:
     pass
 
 
+SharedMemoryBatchRing = flow._oneflow_internal.multiprocessing.SharedMemoryBatchRing
+
+# The batch ring of the current DataLoader worker process, see _get_worker_batch_ring
+_worker_batch_ring = None
+_worker_batch_ring_disabled = False
+# Slots which stack_into_worker_batch_ring filled and which are not sent yet, keyed by
+# their address in the worker
+_worker_stacked_slots = {}
+# Rings of the workers, opened by the process which receives the batches
+_opened_batch_rings = {}
+
+
+def _get_worker_batch_ring():
+    """Lazily creates the shared memory batch ring of a DataLoader worker process.
+
+    The ring is only used when ONEFLOW_DATALOADER_SHM_RING_SLOT_SIZE is set to a positive
+    number of bytes, since every worker keeps ONEFLOW_DATALOADER_SHM_RING_SLOT_NUM (8 by
+    default) slots of that size in /dev/shm for its whole lifetime.
+    """
+    global _worker_batch_ring, _worker_batch_ring_disabled
+    if _worker_batch_ring is not None or _worker_batch_ring_disabled:
+        return _worker_batch_ring
+    from oneflow.utils.data.dataloader import get_worker_info
+
+    if get_worker_info() is None:
+        return None
+    slot_size = int(os.getenv("ONEFLOW_DATALOADER_SHM_RING_SLOT_SIZE", "0"))
+    slot_num = int(os.getenv("ONEFLOW_DATALOADER_SHM_RING_SLOT_NUM", "8"))
+    if slot_size <= 0 or slot_num <= 0:
+        _worker_batch_ring_disabled = True
+        return None
+    try:
+        _worker_batch_ring = SharedMemoryBatchRing.create(slot_num, slot_size)
+    except Exception:
+        # e.g. /dev/shm is too small, fall back to one shared memory block per tensor
+        _worker_batch_ring_disabled = True
+    return _worker_batch_ring
+
+
+def stack_into_worker_batch_ring(batch):
+    """Stacks the cpu sample tensors of a DataLoader worker directly into a free slot of
+    its batch ring, so sending the batch to the main process needs no further copy.
+
+    Returns None if the ring is disabled or full, or if the samples can not be stacked
+    into a slot, in which case the caller falls back to flow.stack.
+    """
+    ring = _get_worker_batch_ring()
+    if ring is None:
+        return None
+    elem = batch[0]
+    for sample in batch:
+        if (
+            sample.is_global
+            or sample.device.type != "cpu"
+            or sample.dtype != elem.dtype
+            or sample.shape != elem.shape
+        ):
+            return None
+    try:
+        np_dtype = np.dtype(flow.convert_oneflow_dtype_to_numpy_dtype(elem.dtype))
+    except Exception:
+        return None
+    nbytes = len(batch) * elem.numel() * np_dtype.itemsize
+    if nbytes == 0:
+        return None
+    slot_id = ring.try_acquire_slot(nbytes)
+    if slot_id < 0:
+        return None
+    try:
+        out = np.ndarray(
+            (len(batch),) + tuple(elem.shape),
+            dtype=np_dtype,
+            buffer=ring.slot_buf(slot_id),
+        )
+        for i, sample in enumerate(batch):
+            out[i] = sample.numpy()
+    except Exception:
+        ring.release_slot(slot_id)
+        return None
+
+    address = out.ctypes.data
+    # the token tells this batch apart from a later batch stacked into the same slot
+    token = object()
+    _worker_stacked_slots[address] = (slot_id, token)
+
+    def release_unsent_slot():
+        entry = _worker_stacked_slots.get(address)
+        if entry is not None and entry[1] is token:
+            del _worker_stacked_slots[address]
+            ring.release_slot(slot_id)
+
+    t = flow.from_numpy(out)
+    t._register_storage_delete_hook(release_unsent_slot)
+    return t
+
+
+def _take_stacked_slot(tensor_data):
+    """Returns the slot that tensor_data was stacked into, or -1."""
+    if not tensor_data.flags.c_contiguous:
+        return -1
+    entry = _worker_stacked_slots.pop(tensor_data.ctypes.data, None)
+    return entry[0] if entry is not None else -1
+
+
+def _open_batch_ring(ring_name):
+    ring = _opened_batch_rings.get(ring_name)
+    if ring is None:
+        ring = SharedMemoryBatchRing.open(ring_name)
+        _opened_batch_rings[ring_name] = ring
+    return ring
+
+
+def release_opened_batch_rings():
+    """Drops the handles to the worker rings opened by this process.
+
+    Called when the DataLoader shuts its workers down. Tensors still borrowing a slot
+    keep their ring mapped until they are freed.
+    """
+    _opened_batch_rings.clear()
+
+
 def rebuild_empty_tensor(shape, dtype, requires_grad):
     t = flow.tensor([], dtype=dtype)
     t.requires_grad = requires_grad
@@ -56,6 +178,21 @@ def rebuild_shm_tensor(shm, shape, dtype, requires_grad):
     return t
 
 
+def rebuild_ring_tensor(ring_name, slot_id, shape, dtype, requires_grad):
+    ring = _open_batch_ring(ring_name)
+
+    def release_slot():
+        ring.release_slot(slot_id)
+
+    # the tensor borrows the slot memory, and gives the slot back to the worker once released
+    arr = np.ndarray(shape, dtype=dtype, buffer=ring.slot_buf(slot_id))
+    t = flow.from_numpy(arr)
+    t._register_storage_delete_hook(release_slot)
+    t.requires_grad = requires_grad
+
+    return t
+
+
 def rebuild_empty_parameter(shape, dtype, requires_grad):
     t = flow.tensor([], dtype=dtype)
     t = t.reshape(*shape)
@@ -79,6 +216,24 @@ def reduce_tensor(tensor):
 
     if tensor_data.nbytes == 0:
         return (rebuild_empty_tensor, (tensor.shape, tensor.dtype, requires_grad))
+    ring = _get_worker_batch_ring()
+    slot_id = -1
+    if ring is not None:
+        slot_id = _take_stacked_slot(tensor_data)
+        if slot_id < 0:
+            slot_id = ring.try_acquire_slot(tensor_data.nbytes)
+            if slot_id >= 0:
+                slot_numpy = np.ndarray(
+                    tensor_data.shape,
+                    dtype=tensor_data.dtype,
+                    buffer=ring.slot_buf(slot_id),
+                )
+                slot_numpy[...] = tensor_data
+    if slot_id >= 0:
+        return (
+            rebuild_ring_tensor,
+            (ring.name, slot_id, tensor_data.shape, tensor_data.dtype, requires_grad),
+        )
     else:
         shm = shared_memory.SharedMemory(create=True, size=tensor_data.nbytes)
         shm_numpy = np.ndarray(
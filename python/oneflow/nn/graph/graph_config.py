@@ -110,6 +110,34 @@ class GraphConfig(object):
         """
         self.proto.enable_fuse_model_update_ops = mode
 
+    def allow_multi_tensor_model_update(self, mode: bool = True):
+        r"""If set to true, the sgd, momentum and adam updates of CPU parameters that share the
+        same placement, learning rate and hyper parameters are grouped into one multi tensor
+        update op, which updates all of them in a single parallel pass. It takes effect together
+        with allow_fuse_model_update_ops.
+
+        For example:
+
+        .. code-block:: python
+
+            import oneflow as flow
+
+            class Graph(flow.nn.Graph):
+                def __init__(self):
+                    super().__init__()
+                    self.linear = flow.nn.Linear(3, 8, False)
+                    self.config.allow_fuse_model_update_ops(True)
+                    self.config.allow_multi_tensor_model_update(True)
+                def build(self, x):
+                    return self.linear(x)
+
+            graph = Graph()
+
+        Args:
+            mode (bool, optional): The default vaule is True.
+        """
+        self.proto.enable_multi_tensor_model_update = mode
+
     def allow_fuse_add_to_output(self, mode: bool = True):
         r"""If set to true, try to fuse a binary element-wise add operetor to one of the predecessors to improve performance.
 
@@ -13,6 +13,6 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 """
-from .ddp import DistributedDataParallel
+from .ddp import DistributedDataParallel, ddp_bucket_stats
 
-__all__ = ["DistributedDataParallel"]
+__all__ = ["DistributedDataParallel", "ddp_bucket_stats"]
@@ -13,8 +13,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 """
+import time
 import warnings
 from collections import OrderedDict
+from typing import Optional
 
 import oneflow as flow
 from oneflow.support.env_var_util import parse_boolean_from_env
@@ -36,44 +38,154 @@ def grad_setting_fn(module, param):
     return grad_setting
 
 
+class DDPBucketStats(object):
+    """
+    Host side timings of the gradient buckets, accumulated over backward passes.
+
+    Hooks run when autograd dispatches a gradient, not when the device computes it,
+    so times are those of the dispatch timeline.
+    """
+
+    def __init__(self, bucket_bytes):
+        self.bucket_bytes = bucket_bytes
+        self.iterations = 0
+        # From the first to the last gradient of a bucket.
+        self.fill_seconds = 0.0
+        # From a bucket being full to its launch, which waits for earlier buckets.
+        self.launch_delay_seconds = 0.0
+        # Bytes all-reduced while the backward pass was still producing gradients.
+        self.overlapped_bytes = 0
+        self.launched_bytes = 0
+        self._reset_iteration()
+
+    def _reset_iteration(self):
+        self._first_ready = [None] * len(self.bucket_bytes)
+        self._full = [None] * len(self.bucket_bytes)
+
+    def on_grad_ready(self, bucket_index, now, bucket_full):
+        if self._first_ready[bucket_index] is None:
+            self._first_ready[bucket_index] = now
+        if bucket_full:
+            self._full[bucket_index] = now
+
+    def on_launch(self, bucket_indices, now, is_last_grad):
+        for index in bucket_indices:
+            self.fill_seconds += self._full[index] - self._first_ready[index]
+            self.launch_delay_seconds += now - self._full[index]
+            self.launched_bytes += self.bucket_bytes[index]
+            if not is_last_grad:
+                self.overlapped_bytes += self.bucket_bytes[index]
+        if is_last_grad:
+            self.iterations += 1
+            self._reset_iteration()
+
+    def summary(self):
+        launches = max(self.iterations * len(self.bucket_bytes), 1)
+        return {
+            "num_buckets": len(self.bucket_bytes),
+            "bucket_bytes": list(self.bucket_bytes),
+            "iterations": self.iterations,
+            "mean_fill_seconds": self.fill_seconds / launches,
+            "mean_launch_delay_seconds": self.launch_delay_seconds / launches,
+            "overlap_ratio": self.overlapped_bytes / max(self.launched_bytes, 1),
+        }
+
+
+def ddp_bucket_stats(module):
+    """
+    Returns a dict summarizing the gradient buckets of a module wrapped by
+    :func:`DistributedDataParallel`: their sizes, the mean time a bucket takes to
+    fill and then to be launched, and ``overlap_ratio``, the fraction of the bytes
+    all-reduced before the last gradient of the backward pass was produced.
+    """
+    return module._ddp_bucket_stats.summary()
+
+
 def allreduce_fn(module, param):
     ddp_state_for_reversed_params = module._ddp_state_for_reversed_params
     buckets = module._buckets
     bucket_tensors = module._bucket_tensors
+    bucket_index = module._bucket_index[param]
+    # [ready grad count of each bucket, index of the next bucket to launch]
+    ddp_bucket_state = module._ddp_bucket_state
+    stats = module._ddp_bucket_stats
 
     def allreduce(grad):
-        ddp_state_for_reversed_params[param][0] = True
-        for index, bucket in enumerate(buckets):
-            deleted = all(ddp_state_for_reversed_params[x][1] for x in bucket)
-            if deleted:
-                continue
-
-            assert not any(ddp_state_for_reversed_params[x][1] for x in bucket)
-
-            all_params_in_bucket_ready = all(
-                ddp_state_for_reversed_params[x][0] for x in bucket
-            )
-            if all_params_in_bucket_ready:
-                for x in bucket:
-                    ddp_state_for_reversed_params[x][1] = True
-                # NOTE(jianhao)(higher-order-grad):
-                # local allreduce doesn't have gradient function, higher-order grad may be unsupported
-                flow._C.local_all_reduce(bucket_tensors[index], inplace=True)
-            else:
+        state = ddp_state_for_reversed_params[param]
+        if state[0]:
+            return
+        state[0] = True
+        ready_counts = ddp_bucket_state[0]
+        ready_counts[bucket_index] += 1
+        now = time.perf_counter()
+        stats.on_grad_ready(
+            bucket_index, now, ready_counts[bucket_index] == len(buckets[bucket_index])
+        )
+        # Buckets are launched in order, so that all ranks issue the same sequence of
+        # collectives.
+        launched = []
+        while ddp_bucket_state[1] < len(buckets):
+            index = ddp_bucket_state[1]
+            if ready_counts[index] < len(buckets[index]):
                 break
+            for x in buckets[index]:
+                ddp_state_for_reversed_params[x][1] = True
+            # NOTE(jianhao)(higher-order-grad):
+            # local allreduce doesn't have gradient function, higher-order grad may be unsupported
+            flow._C.local_all_reduce(bucket_tensors[index], inplace=True)
+            launched.append(index)
+            ddp_bucket_state[1] += 1
+        if len(launched) > 0:
+            stats.on_launch(launched, now, ddp_bucket_state[1] == len(buckets))
 
     return allreduce
 
 
+def _make_buckets(reversed_param_list, bucket_size, bucket_cap_mb, numel_in_bucket):
+    if bucket_cap_mb is None:
+        return [
+            reversed_param_list[i : i + bucket_size]
+            for i in range(0, len(reversed_param_list), bucket_size)
+        ]
+    # Gradients become ready roughly in reverse order of the parameters, so buckets
+    # filled in that order are complete early and their all-reduce overlaps the rest
+    # of the backward pass.
+    cap_elems = max(int(bucket_cap_mb * 1024 * 1024) // 4, 1)
+    buckets = []
+    bucket = []
+    bucket_elems = 0
+    for param in reversed_param_list:
+        elems = numel_in_bucket(param)
+        if len(bucket) > 0 and bucket_elems + elems > cap_elems:
+            buckets.append(bucket)
+            bucket = []
+            bucket_elems = 0
+        bucket.append(param)
+        bucket_elems += elems
+    if len(bucket) > 0:
+        buckets.append(bucket)
+    return buckets
+
+
 def DistributedDataParallel(
-    module: "flow.nn.Module", *, broadcast_buffers: bool = True, bucket_size: int = 10
+    module: "flow.nn.Module",
+    *,
+    broadcast_buffers: bool = True,
+    bucket_size: int = 10,
+    bucket_cap_mb: Optional[float] = None,
 ):
+    """
+    Gradients are all-reduced in buckets of ``bucket_size`` parameters, or, when
+    ``bucket_cap_mb`` is given, of at most that many megabytes of gradients. Each
+    bucket is all-reduced as soon as all its gradients are ready.
+    """
     assert all(x.dtype == flow.float32 for x in module.parameters())
     if parse_boolean_from_env("ONEFLOW_DISABLE_VIEW", False):
         warnings.warn(
             "because the environment variable 'ONEFLOW_DISABLE_VIEW' is set to true, so the view mechanism is disabled, and we will set bucket_size = 1"
         )
         bucket_size = 1
+        bucket_cap_mb = None
     world_size = flow.env.get_world_size()
     with flow.no_grad():
         for x in module.parameters():
@@ -102,23 +214,18 @@ def DistributedDataParallel(
         # avoid this hardcoded "512"
         return align(tensor.numel(), 512 // 4)
 
-    offset_in_bucket = 0
-    with flow.no_grad():
-        for i, param in enumerate(reversed_param_list):
+    module._buckets = _make_buckets(
+        reversed_param_list, bucket_size, bucket_cap_mb, numel_in_bucket
+    )
+    module._bucket_index = {}
+    for bucket_index, bucket in enumerate(module._buckets):
+        offset_in_bucket = 0
+        for param in bucket:
             assert param.is_leaf
-            if i % bucket_size == 0:
-                offset_in_bucket = 0
+            module._bucket_index[param] = bucket_index
             module._param_grad_offset_in_bucket[param] = offset_in_bucket
             offset_in_bucket += numel_in_bucket(param)
 
-    module._bucket_index = {
-        x: i // bucket_size for i, x in enumerate(reversed_param_list)
-    }
-    module._buckets = [
-        reversed_param_list[i : i + bucket_size]
-        for i in range(0, len(reversed_param_list), bucket_size)
-    ]
-
     bucket_elems = 0
     module._bucket_tensors = []
     for b in module._buckets:
@@ -131,6 +238,10 @@ def DistributedDataParallel(
         reversed([(x, [False, False]) for x in module.parameters() if x.requires_grad])
     )
     module._ddp_state_for_reversed_params = ddp_state_for_reversed_params
+    module._ddp_bucket_state = [[0] * len(module._buckets), 0]
+    module._ddp_bucket_stats = DDPBucketStats(
+        [x.numel() * 4 for x in module._bucket_tensors]
+    )
     # The gradient shoule be averaged by all the nodes, so besides allreduce,
     # a division by world_size is required.
     # Use x * (1 / world_size) instead of x / world_size for two reasons:
@@ -153,6 +264,8 @@ def DistributedDataParallel(
         ddp_state_for_reversed_params = module._ddp_state_for_reversed_params
         for state in ddp_state_for_reversed_params.values():
             state[0], state[1] = False, False
+        module._ddp_bucket_state[0] = [0] * len(module._buckets)
+        module._ddp_bucket_state[1] = 0
         if isinstance(output, (tuple, list)):
             if isinstance(output[0], dict):
                 # For List[Dict[Tensor]] return type.
@@ -93,6 +93,12 @@ def _init(
     assert store_options.__contains__("kv_store")
     kv_store = store_options["kv_store"]
     assert isinstance(kv_store, dict)
+    if kv_store.__contains__("device_type"):
+        assert kv_store["device_type"] in ["cuda", "cpu"]
+        if kv_store["device_type"] == "cpu":
+            assert not kv_store.__contains__(
+                "caches"
+            ), "caches are not supported by cpu kv_store"
     if kv_store.__contains__("caches"):
         caches = kv_store["caches"]
         assert isinstance(caches, (dict, list, tuple))
@@ -197,7 +203,9 @@ class Embedding(Module):
 
     def _save_to_state_dict(self, destination, prefix, keep_vars):
         snapshot_timestamp_tensor = flow.tensor(
-            datetime.datetime.now().timestamp(), dtype=flow.float64, device="cuda"
+            datetime.datetime.now().timestamp(),
+            dtype=flow.float64,
+            device="cuda" if flow.cuda.is_available() else "cpu",
         )
         # Broadcast timestamp tensor from master rank.
         flow.comm.broadcast(snapshot_timestamp_tensor, src=0)
@@ -446,6 +454,41 @@ def make_cached_host_mem_store_options(
     return options
 
 
+def make_cpu_store_options(
+    persistent_path, capacity=None, size_factor=1, physical_block_size=512
+):
+    """make CPU only store_options param of MultiTableEmbedding, the embedding is looked up and updated by cpu kernels directly on the persistent table, without any device cache. Only supports single rank.
+
+    Args:
+        persistent_path (str, list): persistent storage path of Embedding. If passed a str, current rank Embedding will be saved in path/rank_id-num_ranks path. If passed a list, the list length must equals num_ranks, each elem of list represent the path of rank_id Embedding.
+        capacity (int): total capacity of Embedding
+        size_factor (int, optional): store size factor of embedding_dim, if SGD update, and momentum = 0, should be 1, if momentum > 0, it should be 2. if Adam, should be 3. Defaults to 1.
+        physical_block_size (int, optional): physical_block_size should be sector size. Defaults to 512.
+
+    Returns:
+        dict: CPU only store_options param of MultiTableEmbedding
+
+    See also :func:`oneflow.one_embedding.make_device_mem_store_options`
+    """
+    assert isinstance(persistent_path, (str, list, tuple))
+    if capacity is not None:
+        assert capacity > 0
+    else:
+        capacity = 0
+    options = {
+        "kv_store": {
+            "device_type": "cpu",
+            "persistent_table": {
+                "path": persistent_path,
+                "physical_block_size": physical_block_size,
+                "capacity_hint": int(capacity),
+            },
+        },
+        "size_factor": size_factor,
+    }
+    return options
+
+
 def make_uniform_initializer(low, high):
     """make uniform initializer param of make_table_options
 
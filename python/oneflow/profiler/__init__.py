@@ -25,6 +25,9 @@ __all__ = [
     "profile",
     "record_function",
     "ProfilerActivity",
+    "vm_telemetry",
+    "vm_telemetry_string",
+    "summary_writer_stats",
 ]
 
 
@@ -42,3 +45,25 @@ def profiler_start():
 
 def profiler_stop():
     oneflow._oneflow_internal.profiler.ProfilerStop()
+
+
+def vm_telemetry():
+    """Returns the counters of the virtual machine as a dict with keys
+    `streams`, `instruction_types`, `fusion`, `scheduler` and `threads`. Latencies are in
+    nanoseconds.
+    """
+    return oneflow._oneflow_internal.vm.GetVmTelemetry()
+
+
+def vm_telemetry_string():
+    """Returns the counters of the virtual machine as a human-readable string."""
+    return oneflow._oneflow_internal.vm.GetVmTelemetryString()
+
+
+def summary_writer_stats():
+    """Returns the counters of the summary events writer as a dict with keys
+    `written_event_num`, `written_bytes`, `dropped_event_num` and `events_per_second`.
+    Dropped events are low priority events (histograms, images) discarded because the
+    writer fell behind.
+    """
+    return oneflow._oneflow_internal.summary.GetEventsWriterStats()
@@ -0,0 +1,107 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import gc
+import os
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+from oneflow.multiprocessing import reductions
+
+
+class ImageDataset(flow.utils.data.Dataset):
+    def __init__(self, length=64, shape=(3, 16, 16)):
+        self.images = np.random.rand(length, *shape).astype(np.float32)
+
+    def __getitem__(self, index):
+        return flow.tensor(self.images[index]), index
+
+    def __len__(self):
+        return len(self.images)
+
+
+def _ring_shm_names():
+    return set(name for name in os.listdir("/dev/shm") if name.startswith("ofshm_"))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestSharedMemoryBatchRing(flow.unittest.TestCase):
+    def setUp(self):
+        self.saved_env = {
+            key: os.environ.get(key)
+            for key in [
+                "ONEFLOW_DATALOADER_SHM_RING_SLOT_SIZE",
+                "ONEFLOW_DATALOADER_SHM_RING_SLOT_NUM",
+            ]
+        }
+
+    def tearDown(self):
+        for key, value in self.saved_env.items():
+            if value is None:
+                os.environ.pop(key, None)
+            else:
+                os.environ[key] = value
+
+    def _run_loader(test_case, slot_size, slot_num, keep_batches):
+        os.environ["ONEFLOW_DATALOADER_SHM_RING_SLOT_SIZE"] = str(slot_size)
+        os.environ["ONEFLOW_DATALOADER_SHM_RING_SLOT_NUM"] = str(slot_num)
+        shm_names_before = _ring_shm_names()
+        dataset = ImageDataset()
+        loader = flow.utils.data.DataLoader(dataset, batch_size=8, num_workers=2)
+        rings = {}
+        kept_batches = []
+        seen = []
+        for images, indices in loader:
+            index_array = indices.numpy()
+            test_case.assertTrue(
+                np.array_equal(images.numpy(), dataset.images[index_array])
+            )
+            seen.extend(index_array.tolist())
+            rings.update(reductions._opened_batch_rings)
+            if keep_batches:
+                kept_batches.append(images)
+        test_case.assertEqual(sorted(seen), list(range(len(dataset))))
+        # the handles are dropped once the workers are shut down
+        test_case.assertEqual(len(reductions._opened_batch_rings), 0)
+        for i, images in enumerate(kept_batches):
+            test_case.assertTrue(
+                np.array_equal(images.numpy(), dataset.images[i * 8 : (i + 1) * 8])
+            )
+        del images, indices, kept_batches
+        gc.collect()
+        for ring in rings.values():
+            test_case.assertEqual(ring.used_slot_num, 0)
+        test_case.assertEqual(_ring_shm_names() - shm_names_before, set())
+        return rings
+
+    def test_batches_stacked_into_ring(test_case):
+        rings = test_case._run_loader(1 << 20, 8, keep_batches=False)
+        test_case.assertEqual(len(rings), 2)
+
+    def test_full_ring_falls_back(test_case):
+        # a single slot is busy as long as its batch is alive
+        rings = test_case._run_loader(1 << 20, 1, keep_batches=True)
+        test_case.assertGreater(len(rings), 0)
+
+    def test_slot_too_small_falls_back(test_case):
+        test_case._run_loader(64, 8, keep_batches=False)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,125 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _make_deep_mlp(layer_num, hidden_size):
+    layers = []
+    for _ in range(layer_num):
+        layers.append(flow.nn.Linear(hidden_size, hidden_size))
+        layers.append(flow.nn.ReLU())
+    return flow.nn.Sequential(*layers)
+
+
+def _make_train_graph(model):
+    optimizer = flow.optim.SGD(model.parameters(), lr=0.0)
+
+    class TrainGraph(flow.nn.Graph):
+        def __init__(self):
+            super().__init__()
+            self.model = model
+            self.add_optimizer(optimizer)
+
+        def build(self, x):
+            loss = self.model(x).sum()
+            loss.backward()
+            return loss
+
+    return TrainGraph()
+
+
+# a synthetic job whose compile time is dominated by the task graph and plan
+# construction, with topological levels wide enough to be built in parallel
+_LAYER_NUM = 64
+_HIDDEN_SIZE = 16
+
+
+def _test_graph_compile(test_case, device):
+    model = _make_deep_mlp(_LAYER_NUM, _HIDDEN_SIZE).to(device)
+    x = flow.tensor(
+        np.random.randn(4, _HIDDEN_SIZE).astype(np.float32), device=flow.device(device)
+    )
+    eager_loss = model(x).sum()
+    graph = _make_train_graph(model)
+    lazy_loss = graph(x)
+    test_case.assertTrue(
+        np.allclose(lazy_loss.numpy(), eager_loss.numpy(), rtol=1e-4, atol=1e-4)
+    )
+
+
+def _compile_plan_in_subprocess(device, plan_path):
+    env = dict(os.environ)
+    env.pop("ONEFLOW_PLAN_CACHE_DIR", None)
+    subprocess.check_call(
+        [sys.executable, os.path.abspath(__file__), "--dump-plan", device, plan_path],
+        env=env,
+    )
+    with open(plan_path) as f:
+        return f.read()
+
+
+def _test_graph_compile_deterministic(test_case, device):
+    # parts of the compilation run concurrently, the plan must not depend on the schedule
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        plans = [
+            _compile_plan_in_subprocess(
+                device, os.path.join(tmp_dir, "plan_{}.txt".format(i))
+            )
+            for i in range(2)
+        ]
+    test_case.assertGreater(len(plans[0]), 0)
+    test_case.assertEqual(plans[0], plans[1])
+
+
+def _dump_plan(device, plan_path):
+    flow.manual_seed(0)
+    model = _make_deep_mlp(_LAYER_NUM, _HIDDEN_SIZE).to(device)
+    graph = _make_train_graph(model)
+    graph(flow.ones(4, _HIDDEN_SIZE, device=flow.device(device)))
+    with open(plan_path, "w") as f:
+        f.write(graph._c_nn_graph.plan)
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestGraphCompileTime(oneflow.unittest.TestCase):
+    def test_graph_compile_cpu(test_case):
+        _test_graph_compile(test_case, "cpu")
+
+    def test_graph_compile_deterministic_cpu(test_case):
+        _test_graph_compile_deterministic(test_case, "cpu")
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_graph_compile_gpu(test_case):
+        _test_graph_compile(test_case, "cuda")
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_graph_compile_deterministic_gpu(test_case):
+        _test_graph_compile_deterministic(test_case, "cuda")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 4 and sys.argv[1] == "--dump-plan":
+        _dump_plan(sys.argv[2], sys.argv[3])
+    else:
+        unittest.main()
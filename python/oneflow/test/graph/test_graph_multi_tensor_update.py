@@ -0,0 +1,118 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+import copy
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+class MultiParamModule(flow.nn.Module):
+    def __init__(self, init_values):
+        super().__init__()
+        for i, value in enumerate(init_values):
+            setattr(self, "para%d" % i, flow.nn.Parameter(flow.tensor(value)))
+
+    def forward(self, masks):
+        loss = None
+        for i, mask in enumerate(masks):
+            term = flow.sum(getattr(self, "para%d" % i) * mask)
+            loss = term if loss is None else loss + term
+        return loss
+
+
+def _train(optimizer_cls, optimizer_kwargs, init_values, grad_seq, multi_tensor):
+    module = MultiParamModule(init_values)
+    module.train()
+    optimizer = optimizer_cls(module.parameters(), **optimizer_kwargs)
+
+    class MultiTensorUpdateGraph(flow.nn.Graph):
+        def __init__(self):
+            super().__init__()
+            self.m = module
+            self.add_optimizer(optimizer)
+            self.config.allow_fuse_model_update_ops(multi_tensor)
+            self.config.allow_multi_tensor_model_update(multi_tensor)
+
+        def build(self, *masks):
+            loss = self.m(masks)
+            loss.backward()
+            return loss
+
+    graph = MultiTensorUpdateGraph()
+    for grads in grad_seq:
+        graph(*[flow.tensor(grad) for grad in grads])
+    op_type_names = set(
+        op.user_conf.op_type_name
+        for op in graph._full_graph_proto.net.op
+        if op.HasField("user_conf")
+    )
+    return [copy.copy(param.numpy()) for param in module.parameters()], op_type_names
+
+
+def _compare_with_single_tensor_update(
+    test_case, optimizer_cls, optimizer_kwargs, multi_tensor_op_type_name
+):
+    # The large shapes split the fused update over several ParallelFor ranges, which
+    # then start in the middle of a tensor.
+    shapes = [(3, 4), (256, 512), (17,), (100003,), (2, 3, 5), (1,)]
+    init_values = [np.random.uniform(size=shape).astype(np.float32) for shape in shapes]
+    grad_seq = [
+        [np.random.uniform(size=shape).astype(np.float32) for shape in shapes]
+        for _ in range(5)
+    ]
+    expected, single_tensor_ops = _train(
+        optimizer_cls, optimizer_kwargs, init_values, grad_seq, False
+    )
+    actual, multi_tensor_ops = _train(
+        optimizer_cls, optimizer_kwargs, init_values, grad_seq, True
+    )
+    test_case.assertNotIn(multi_tensor_op_type_name, single_tensor_ops)
+    test_case.assertIn(multi_tensor_op_type_name, multi_tensor_ops)
+    for lhs, rhs in zip(expected, actual):
+        test_case.assertTrue(np.allclose(lhs, rhs, rtol=1e-4, atol=1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestGraphMultiTensorUpdate(flow.unittest.TestCase):
+    def test_multi_tensor_sgd(test_case):
+        _compare_with_single_tensor_update(
+            test_case,
+            flow.optim.SGD,
+            {"lr": 0.1, "weight_decay": 0.01},
+            "multi_tensor_sgd_update",
+        )
+
+    def test_multi_tensor_momentum(test_case):
+        _compare_with_single_tensor_update(
+            test_case,
+            flow.optim.SGD,
+            {"lr": 0.1, "momentum": 0.9},
+            "multi_tensor_momentum_update",
+        )
+
+    def test_multi_tensor_adam(test_case):
+        _compare_with_single_tensor_update(
+            test_case,
+            flow.optim.Adam,
+            {"lr": 0.01, "betas": (0.9, 0.99)},
+            "multi_tensor_adam_update",
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
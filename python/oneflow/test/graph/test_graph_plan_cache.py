@@ -0,0 +1,105 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import oneflow as flow
+import oneflow.unittest
+
+# Compiles a small training graph, then writes the plan and whether it was restored
+# from the plan cache to the files given on the command line.
+_COMPILE_SCRIPT = """
+import sys
+import oneflow as flow
+
+model = flow.nn.Sequential(
+    flow.nn.Linear(8, 8), flow.nn.ReLU(), flow.nn.Linear(8, 1)
+).to(sys.argv[1])
+optimizer = flow.optim.SGD(model.parameters(), lr=0.1)
+
+
+class TrainGraph(flow.nn.Graph):
+    def __init__(self):
+        super().__init__()
+        self.model = model
+        self.add_optimizer(optimizer)
+
+    def build(self, x):
+        loss = self.model(x).sum()
+        loss.backward()
+        return loss
+
+
+graph = TrainGraph()
+graph(flow.ones(4, 8, device=sys.argv[1]))
+with open(sys.argv[2], "w") as f:
+    f.write(graph._c_nn_graph.plan)
+with open(sys.argv[3], "w") as f:
+    f.write(str(int(graph._c_nn_graph.plan_cache_hit)))
+"""
+
+
+def _compile_in_subprocess(cache_dir, device, tmp_dir, run_name):
+    script_path = os.path.join(tmp_dir, "compile_graph.py")
+    with open(script_path, "w") as f:
+        f.write(_COMPILE_SCRIPT)
+    plan_path = os.path.join(tmp_dir, run_name + "_plan.txt")
+    hit_path = os.path.join(tmp_dir, run_name + "_hit.txt")
+    env = dict(os.environ)
+    env["ONEFLOW_PLAN_CACHE_DIR"] = cache_dir
+    subprocess.check_call(
+        [sys.executable, script_path, device, plan_path, hit_path], env=env
+    )
+    with open(plan_path) as f:
+        plan = f.read()
+    with open(hit_path) as f:
+        hit = f.read() == "1"
+    return plan, hit
+
+
+def _test_graph_plan_cache(test_case, device):
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        cache_dir = os.path.join(tmp_dir, "plan_cache")
+        cold_plan, cold_hit = _compile_in_subprocess(cache_dir, device, tmp_dir, "cold")
+        test_case.assertFalse(cold_hit)
+        entries = os.listdir(cache_dir)
+        test_case.assertEqual(len(entries), 1)
+        entry_mtime = os.path.getmtime(os.path.join(cache_dir, entries[0]))
+
+        warm_plan, warm_hit = _compile_in_subprocess(cache_dir, device, tmp_dir, "warm")
+        test_case.assertTrue(warm_hit)
+        test_case.assertEqual(os.listdir(cache_dir), entries)
+        test_case.assertEqual(
+            os.path.getmtime(os.path.join(cache_dir, entries[0])), entry_mtime
+        )
+        test_case.assertEqual(warm_plan, cold_plan)
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestGraphPlanCache(flow.unittest.TestCase):
+    def test_graph_plan_cache_cpu(test_case):
+        _test_graph_plan_cache(test_case, "cpu")
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_graph_plan_cache_cuda(test_case):
+        _test_graph_plan_cache(test_case, "cuda")
+
+
+if __name__ == "__main__":
+    unittest.main()
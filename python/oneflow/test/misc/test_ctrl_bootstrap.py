@@ -0,0 +1,111 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+
+# The barrier algorithm is read once, by the first barrier while oneflow initializes,
+# so it has to be chosen before the import.
+os.environ["ONEFLOW_CTRL_BARRIER_ALGO"] = "dissemination"
+
+import unittest
+
+import oneflow as flow
+import oneflow.unittest
+
+_internal = flow._oneflow_internal
+
+
+def _port(rank):
+    return str(10000 + rank)
+
+
+def _test_dissemination_barrier(test_case):
+    world_size = flow.env.get_world_size()
+    # Reusing the barrier name checks that consecutive generations are kept apart.
+    for i in range(8):
+        key = "TestCtrlBarrier/{}".format(i)
+        _internal.CtrlIncreaseCount(key, 1)
+        _internal.CtrlBarrier("TestCtrlBarrier")
+        test_case.assertEqual(_internal.CtrlIncreaseCount(key, 0), world_size)
+
+
+def _test_batch_kv(test_case):
+    rank = flow.env.get_rank()
+    world_size = flow.env.get_world_size()
+    keys = [
+        "TestCtrlBatch/{}/{}".format(peer, suffix)
+        for peer in range(world_size)
+        for suffix in ["host", "port"]
+    ]
+    expected = [
+        value
+        for peer in range(world_size)
+        for value in ["host" + str(peer), _port(peer)]
+    ]
+    # Ranks push from the last one down, so the last rank's batch pull has to wait
+    # for keys that are still missing on their servers.
+    if rank + 1 < world_size:
+        _internal.CtrlPullKV("TestCtrlBatch/{}/port".format(rank + 1))
+    _internal.CtrlBatchPushKV(
+        [
+            ("TestCtrlBatch/{}/host".format(rank), "host" + str(rank)),
+            ("TestCtrlBatch/{}/port".format(rank), _port(rank)),
+        ]
+    )
+    test_case.assertEqual(_internal.CtrlBatchPullKV(keys), expected)
+    _internal.CtrlBarrier("TestCtrlBatch")
+
+
+def _test_prefix_kv(test_case):
+    rank = flow.env.get_rank()
+    world_size = flow.env.get_world_size()
+    prefix = "TestCtrlPrefix/"
+    for generation in range(2):
+        _internal.CtrlPushPrefixKV(prefix, str(rank), _port(rank + generation))
+        rank2port = _internal.CtrlPullKVByPrefix(prefix, world_size)
+        test_case.assertEqual(
+            rank2port,
+            {str(peer): _port(peer + generation) for peer in range(world_size)},
+        )
+        # The watch must not see the previous generation once the prefix is cleared.
+        _internal.CtrlBarrier("TestCtrlPrefix")
+        if rank == 0:
+            _internal.CtrlClearKVByPrefix(prefix)
+        _internal.CtrlBarrier("TestCtrlPrefix")
+
+
+class _CtrlBootstrapTestCases:
+    def test_dissemination_barrier(test_case):
+        _test_dissemination_barrier(test_case)
+
+    def test_batch_kv(test_case):
+        _test_batch_kv(test_case)
+
+    def test_prefix_kv(test_case):
+        _test_prefix_kv(test_case)
+
+
+@flow.unittest.skip_unless_1n2d()
+class TestCtrlBootstrap1n2d(_CtrlBootstrapTestCases, flow.unittest.TestCase):
+    pass
+
+
+@flow.unittest.skip_unless_1n4d()
+class TestCtrlBootstrap1n4d(_CtrlBootstrapTestCases, flow.unittest.TestCase):
+    pass
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -64,6 +64,18 @@ class TestArgsort(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_argsort_large_instance_cpu(test_case):
+        # Long rows are radix sorted by several threads on cpu.
+        for descending in [True, False]:
+            np_x = np.random.randint(-1000, 1000, size=(2, 100000)).astype(np.float32)
+            of_out = flow.argsort(flow.tensor(np_x), dim=-1, descending=descending)
+            np_out = np.argsort(-np_x if descending else np_x, axis=-1, kind="stable")
+            test_case.assertTrue(np.array_equal(of_out.numpy(), np_out))
+            of_sorted = flow.sort(flow.tensor(np_x), dim=-1, descending=descending)[0]
+            test_case.assertTrue(
+                np.array_equal(of_sorted.numpy(), np.take_along_axis(np_x, np_out, -1))
+            )
+
     @autotest(auto_backward=False, check_graph=True)
     def test_argsort_with_random_data(test_case):
         device = random_device()
@@ -0,0 +1,98 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_cpu_collectives(test_case, algo, elem_cnt):
+    os.environ["ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO"] = algo
+    # Small chunks so that even the small cases go through the pipelined path.
+    os.environ["ONEFLOW_CCL_CPU_CHUNK_BYTES"] = "1024"
+    world_size = flow.env.get_world_size()
+    placement = flow.placement("cpu", ranks=list(range(world_size)))
+    rank = flow.env.get_rank()
+    rng = np.random.RandomState(elem_cnt)
+    np_arrs = [
+        rng.uniform(-1, 1, (world_size * elem_cnt,)).astype(np.float32)
+        for _ in range(world_size)
+    ]
+    expected = np.sum(np_arrs, axis=0)
+    x = flow.tensor(np_arrs[rank]).to_global(
+        placement=placement, sbp=flow.sbp.partial_sum
+    )
+    all_reduced = x.to_global(sbp=flow.sbp.broadcast)
+    test_case.assertTrue(
+        np.allclose(all_reduced.to_local().numpy(), expected, 1e-5, 1e-5)
+    )
+    reduce_scattered = x.to_global(sbp=flow.sbp.split(0))
+    test_case.assertTrue(
+        np.allclose(
+            reduce_scattered.to_local().numpy(),
+            np.split(expected, world_size)[rank],
+            1e-5,
+            1e-5,
+        )
+    )
+    all_gathered = reduce_scattered.to_global(sbp=flow.sbp.broadcast)
+    test_case.assertTrue(
+        np.allclose(all_gathered.to_local().numpy(), expected, 1e-5, 1e-5)
+    )
+
+
+class _CclCpuAlgorithmsTestCases:
+    def tearDown(test_case):
+        os.environ.pop("ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO", None)
+        os.environ.pop("ONEFLOW_CCL_CPU_CHUNK_BYTES", None)
+
+    def test_ring(test_case):
+        # 100003 elements per rank are split into 16 chunks of 1024 bytes or more.
+        for elem_cnt in [1, 7, 4097, 100003]:
+            _test_cpu_collectives(test_case, "ring", elem_cnt)
+
+    def test_halving_doubling(test_case):
+        for elem_cnt in [1, 7, 4097, 100003]:
+            _test_cpu_collectives(test_case, "halving_doubling", elem_cnt)
+
+    def test_auto(test_case):
+        for elem_cnt in [7, 100003]:
+            _test_cpu_collectives(test_case, "auto", elem_cnt)
+
+
+@flow.unittest.skip_unless_1n2d()
+class TestCclCpuAlgorithms1n2d(_CclCpuAlgorithmsTestCases, flow.unittest.TestCase):
+    pass
+
+
+# Halving-doubling folds the rank beyond a power of two into a neighbour.
+@flow.unittest.skip_unless_1n3d()
+class TestCclCpuAlgorithms1n3d(_CclCpuAlgorithmsTestCases, flow.unittest.TestCase):
+    pass
+
+
+# The ring reduce-scatter reuses its receive and destination buffers from step 2 on,
+# after waiting for the sends that read them.
+@flow.unittest.skip_unless_1n4d()
+class TestCclCpuAlgorithms1n4d(_CclCpuAlgorithmsTestCases, flow.unittest.TestCase):
+    pass
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -105,6 +105,44 @@ class TestDDP(flow.unittest.TestCase):
         for dev_type in test_device:
             test_case._test_ddp_multiple_buckets(dev_type)
 
+    def _test_ddp_bucket_cap(test_case, dev_type):
+        class Mul(flow.nn.Module):
+            def __init__(self):
+                super().__init__()
+                for i in range(10):
+                    self.register_parameter(
+                        f"w{i}",
+                        flow.nn.Parameter(flow.ones(300 * (i + 1)) * (i % 2 + 1)),
+                    )
+
+            def forward(self, x):
+                return sum((x * getattr(self, f"w{i}")[:2]) for i in range(10))
+
+        rank = flow.env.get_rank()
+        x = flow.Tensor([rank + 1, rank + 1]).to(dev_type)
+        m = Mul().to(dev_type)
+        # 16KB holds a few of the smaller gradients but not the larger ones.
+        m = ddp(m, bucket_cap_mb=16 / 1024)
+        for iter in range(2):
+            y = m(x)
+            y.sum().backward()
+            for i in range(10):
+                grad = getattr(m, f"w{i}").grad.numpy()
+                expected = np.zeros(300 * (i + 1))
+                expected[:2] = 1.5 * (iter + 1)
+                test_case.assertTrue(np_allclose_with_shape(grad, expected))
+
+        stats = flow.nn.parallel.ddp_bucket_stats(m)
+        test_case.assertGreater(stats["num_buckets"], 1)
+        test_case.assertTrue(all(b <= 16 * 1024 for b in stats["bucket_bytes"]))
+        test_case.assertEqual(stats["iterations"], 2)
+        test_case.assertGreaterEqual(stats["overlap_ratio"], 0)
+        test_case.assertLess(stats["overlap_ratio"], 1)
+
+    def test_ddp_bucket_cap(test_case):
+        for dev_type in test_device:
+            test_case._test_ddp_bucket_cap(dev_type)
+
     def _test_ddp_with_unused_param(test_case, dev_type):
         class Model(flow.nn.Module):
             def __init__(self):
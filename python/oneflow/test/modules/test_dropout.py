@@ -183,9 +183,9 @@ def fixed_cpu_seed_dropout_test(test_case):
     gen1.manual_seed(5)
     dropped_array1 = np.array(
         [
-            [0.000000, 0.000000, 1.333333],
             [1.333333, 0.000000, 1.333333],
-            [1.333333, 1.333333, 1.333333],
+            [1.333333, 1.333333, 0.000000],
+            [1.333333, 0.000000, 1.333333],
         ]
     ).astype(np.float32)
     dropout1 = flow.nn.Dropout(p=0.25, generator=gen1)
@@ -198,7 +198,7 @@ def fixed_cpu_seed_dropout_test(test_case):
     gen2.manual_seed(7)
     dropout2 = flow.nn.Dropout(p=0.5, generator=gen2)
     dropped_array2 = np.array(
-        [[0.0, 0.0, 2.0], [0.0, 0.0, 2.0], [2.0, 0.0, 2.0]]
+        [[2.0, 2.0, 0.0], [0.0, 0.0, 2.0], [0.0, 2.0, 0.0]]
     ).astype(np.float32)
     out2 = dropout2(x)
     test_case.assertTrue(
@@ -0,0 +1,123 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+# Activations of the chain below need far more than the budget, so evicted tensors are
+# rematerialized during backward.
+_DTR_MEMORY_BUDGET_MB = 4
+_DEPTH = 32
+_SIZE = 256
+
+
+def _chain(x, w, depth):
+    y = x
+    for _ in range(depth):
+        y = flow.tanh(flow.matmul(y, w)) + y
+    return y.sum()
+
+
+def _np_chain_and_grad(x, w, depth):
+    ys = [x]
+    for _ in range(depth):
+        ys.append(np.tanh(ys[-1] @ w) + ys[-1])
+    grad_y = np.ones_like(x)
+    grad_w = np.zeros_like(w)
+    for i in reversed(range(depth)):
+        t = np.tanh(ys[i] @ w)
+        grad_pre = grad_y * (1 - t * t)
+        grad_w += ys[i].T @ grad_pre
+        grad_y = grad_pre @ w.T + grad_y
+    return ys[-1].sum(), grad_w
+
+
+def _chain_backward(x_np, w_np):
+    x = flow.tensor(x_np)
+    w = flow.tensor(w_np, requires_grad=True)
+    loss = _chain(x, w, _DEPTH)
+    loss.backward()
+    return loss.numpy(), w.grad.numpy()
+
+
+def _run_child(input_path, output_path):
+    inputs = np.load(input_path)
+    loss, grad = _chain_backward(inputs["x"], inputs["w"])
+    flow._oneflow_internal.eager.Sync()
+    stats = flow._oneflow_internal.eager.DtrStats()
+    np.savez(
+        output_path,
+        loss=loss,
+        grad=grad,
+        enabled=stats["enabled"],
+        evicted_cnt=stats["evicted_cnt"],
+        rematerialized_cnt=stats["rematerialized_cnt"],
+    )
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestDtr(flow.unittest.TestCase):
+    def test_chain_backward_cpu(test_case):
+        x_np = np.random.uniform(-0.1, 0.1, (_SIZE, _SIZE)).astype(np.float32)
+        w_np = np.random.uniform(-0.05, 0.05, (_SIZE, _SIZE)).astype(np.float32)
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            input_path = os.path.join(tmp_dir, "inputs.npz")
+            output_path = os.path.join(tmp_dir, "outputs.npz")
+            np.savez(input_path, x=x_np, w=w_np)
+            # the budget is read once per process, so DTR runs in a subprocess
+            env = dict(os.environ)
+            env["ONEFLOW_DTR_MEMORY_BUDGET_MB"] = str(_DTR_MEMORY_BUDGET_MB)
+            subprocess.check_call(
+                [
+                    sys.executable,
+                    os.path.abspath(__file__),
+                    "--dtr-child",
+                    input_path,
+                    output_path,
+                ],
+                env=env,
+            )
+            outputs = dict(np.load(output_path))
+
+        test_case.assertTrue(outputs["enabled"])
+        test_case.assertGreater(outputs["evicted_cnt"], 0)
+        test_case.assertGreater(outputs["rematerialized_cnt"], 0)
+        # rematerialization replays the same kernels, so the results match a run
+        # without a budget
+        loss, grad = _chain_backward(x_np, w_np)
+        test_case.assertTrue(np.allclose(outputs["loss"], loss, rtol=1e-5, atol=1e-5))
+        test_case.assertTrue(np.allclose(outputs["grad"], grad, rtol=1e-5, atol=1e-6))
+        expected_loss, expected_grad = _np_chain_and_grad(
+            x_np.astype(np.float64), w_np.astype(np.float64), _DEPTH
+        )
+        test_case.assertTrue(np.allclose(outputs["loss"], expected_loss, rtol=1e-3))
+        test_case.assertTrue(
+            np.allclose(outputs["grad"], expected_grad, rtol=1e-3, atol=1e-3)
+        )
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 4 and sys.argv[1] == "--dtr-child":
+        _run_child(sys.argv[2], sys.argv[3])
+    else:
+        unittest.main()
@@ -0,0 +1,63 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+from oneflow.test_utils.test_util import GenArgList
+
+
+def _run_steps(test_case, device, shapes):
+    for shape in shapes:
+        x_np = np.random.randn(*shape).astype(np.float32)
+        w_np = np.random.randn(shape[-1], 3).astype(np.float32)
+        x = flow.tensor(x_np, device=device)
+        w = flow.tensor(w_np, device=device)
+        y = flow.relu(flow.matmul(x, w)).sum(dim=0)
+        test_case.assertEqual(y.shape, flow.Size([3]))
+        test_case.assertTrue(
+            np.allclose(
+                y.numpy(), np.maximum(x_np @ w_np, 0).sum(axis=0), rtol=1e-4, atol=1e-4
+            )
+        )
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestEagerLocalInferCache(flow.unittest.TestCase):
+    def test_repeated_shapes(test_case):
+        _run_steps(test_case, "cpu", [(4, 5)] * 4)
+
+    def test_changing_shapes(test_case):
+        # Every change of input shape must invalidate the cached inference.
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        for arg in GenArgList(arg_dict):
+            _run_steps(test_case, arg[0], [(4, 5), (6, 5), (4, 7), (4, 5), (1, 2)])
+
+    def test_inplace_after_cached(test_case):
+        x = flow.ones(2, 3)
+        for _ in range(3):
+            y = flow.relu(x)
+            y.add_(1)
+            test_case.assertTrue(np.array_equal(y.numpy(), np.full((2, 3), 2.0)))
+
+
+if __name__ == "__main__":
+    unittest.main()
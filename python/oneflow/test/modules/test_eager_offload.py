@@ -0,0 +1,134 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+_OFFLOAD_BUDGET_MB = 64
+_TENSOR_BYTES = 4 * 1024 * 1024
+
+
+def _roundtrip(device):
+    # 64 tensors of 4MB each, four times the budget. flow.tensor lends its numpy copy
+    # to cpu tensors, so clone to get storages from the allocator.
+    rng = np.random.RandomState(0)
+    arrays = [rng.uniform(-1, 1, (1024, 1024)).astype(np.float32) for _ in range(64)]
+    tensors = [flow.tensor(a, device=device).clone() for a in arrays]
+    for t in tensors:
+        t.add_(1.0)
+    flow._oneflow_internal.eager.Sync()
+    stats_after_offload = flow._oneflow_internal.eager.OffloadStats()
+    return [t.numpy() for t in tensors], stats_after_offload
+
+
+def _optimizer_states(device):
+    # 32MB of weights plus their gradients and two adam states exceed the budget
+    flow.manual_seed(0)
+    linears = [flow.nn.Linear(1024, 1024).to(device) for _ in range(8)]
+    params = [p for m in linears for p in m.parameters()]
+    optimizer = flow.optim.Adam(params, lr=1e-3)
+    x = flow.tensor(
+        np.random.RandomState(1).randn(16, 1024).astype(np.float32), device=device
+    )
+    for _ in range(3):
+        y = x
+        for m in linears:
+            y = m(y)
+        y.sum().backward()
+        optimizer.step()
+        optimizer.zero_grad()
+    flow._oneflow_internal.eager.Sync()
+    stats_after_offload = flow._oneflow_internal.eager.OffloadStats()
+    return [p.numpy() for p in params], stats_after_offload
+
+
+_CASES = {"roundtrip": _roundtrip, "optimizer_states": _optimizer_states}
+
+
+def _run_child(case, device, output_path):
+    arrays, stats = _CASES[case](device)
+    np.savez(output_path, *arrays, **{"stats_" + k: v for k, v in stats.items()})
+
+
+def _test_offload(test_case, case, device):
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        output_path = os.path.join(tmp_dir, "outputs.npz")
+        # the budget is read once per process, so offloading runs in a subprocess
+        env = dict(os.environ)
+        env["ONEFLOW_EAGER_OFFLOAD_BUDGET_MB"] = str(_OFFLOAD_BUDGET_MB)
+        env.pop("ONEFLOW_DTR_MEMORY_BUDGET_MB", None)
+        subprocess.check_call(
+            [
+                sys.executable,
+                os.path.abspath(__file__),
+                "--offload-child",
+                case,
+                device,
+                output_path,
+            ],
+            env=env,
+        )
+        outputs = dict(np.load(output_path))
+    stats = {
+        k[len("stats_") :]: v for k, v in outputs.items() if k.startswith("stats_")
+    }
+    offloaded_arrays = [
+        outputs["arr_{}".format(i)] for i in range(len(outputs) - len(stats))
+    ]
+
+    test_case.assertTrue(stats["enabled"])
+    test_case.assertGreater(stats["offload_cnt"], 0)
+    test_case.assertGreater(stats["offloaded_bytes"], 0)
+    # the budget is soft by at most the allocation that triggered the offload
+    test_case.assertLessEqual(
+        stats["resident_bytes"], _OFFLOAD_BUDGET_MB * 1024 * 1024 + _TENSOR_BYTES
+    )
+    # offloading moves bytes around without touching them
+    expected_arrays, _ = _CASES[case](device)
+    test_case.assertEqual(len(offloaded_arrays), len(expected_arrays))
+    for offloaded, expected in zip(offloaded_arrays, expected_arrays):
+        test_case.assertTrue(np.array_equal(offloaded, expected))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestEagerOffload(flow.unittest.TestCase):
+    def test_offload_roundtrip_cpu(test_case):
+        _test_offload(test_case, "roundtrip", "cpu")
+
+    def test_offload_optimizer_states_cpu(test_case):
+        _test_offload(test_case, "optimizer_states", "cpu")
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_offload_roundtrip_cuda(test_case):
+        _test_offload(test_case, "roundtrip", "cuda")
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_offload_optimizer_states_cuda(test_case):
+        _test_offload(test_case, "optimizer_states", "cuda")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 5 and sys.argv[1] == "--offload-child":
+        _run_child(sys.argv[2], sys.argv[3], sys.argv[4])
+    else:
+        unittest.main()
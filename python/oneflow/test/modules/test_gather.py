@@ -103,6 +103,31 @@ def _test_gather_backward(test_case, device):
     test_case.assertTrue(np.array_equal(of_input.grad.numpy(), np_grad))
 
 
+def _test_gather_backward_skewed_indices(test_case, device):
+    # Enough rows for the cpu kernels to split the work, with most indices on one row.
+    num_rows, dim, num_indices = 1000, 8, 100000
+    index = np.random.randint(0, num_rows, size=num_indices)
+    index[np.random.rand(num_indices) < 0.9] = 7
+    input = np.random.randn(num_rows, dim).astype(np.float32)
+    grad = np.random.randn(num_indices, dim).astype(np.float32)
+    np_grad = np.zeros((num_rows, dim), dtype=np.float64)
+    np.add.at(np_grad, index, grad)
+
+    def run():
+        of_input = flow.tensor(input, requires_grad=True, device=flow.device(device))
+        output = flow._C.gather(
+            of_input, flow.tensor(index, device=flow.device(device)), axis=0
+        )
+        test_case.assertTrue(np.array_equal(output.numpy(), input[index]))
+        output.backward(flow.tensor(grad, device=flow.device(device)))
+        return of_input.grad.numpy()
+
+    of_grad = run()
+    test_case.assertTrue(np.allclose(of_grad, np_grad, rtol=1e-4, atol=1e-3))
+    if device == "cpu":
+        test_case.assertTrue(np.array_equal(of_grad, run()))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestGather(flow.unittest.TestCase):
     def test_gather(test_case):
@@ -112,6 +137,7 @@ class TestGather(flow.unittest.TestCase):
             _test_gather_tensor_function,
             _test_gather_random_array,
             _test_gather_backward,
+            _test_gather_backward_skewed_indices,
         ]
         arg_dict["device"] = ["cpu", "cuda"]
         for arg in GenArgList(arg_dict):
@@ -15,6 +15,9 @@ limitations under the License.
 """
 
 import os
+import subprocess
+import sys
+import tempfile
 import unittest
 import numpy as np
 
@@ -22,6 +25,18 @@ import oneflow as flow
 import oneflow.unittest
 
 
+def _run_num_threads_child(num_threads, output_path):
+    flow.set_num_threads(num_threads)
+    generator = flow.Generator(device="cpu")
+    generator.manual_seed(1)
+    # large enough to be split across threads by the cpu stream
+    x = flow.ones(1 << 20)
+    dropout = flow._C.dropout(x, p=0.3, training=True, generator=generator, addend=None)
+    randn = flow.randn(1 << 20, generator=generator)
+    rand = flow.rand(1 << 20, generator=generator)
+    np.savez(output_path, dropout.numpy(), randn.numpy(), rand.numpy())
+
+
 class TestGenerator(flow.unittest.TestCase):
     def test_different_devices(test_case):
         auto_gen = flow.Generator(device="auto")
@@ -40,6 +55,39 @@ class TestGenerator(flow.unittest.TestCase):
         generator.manual_seed(2)
         test_case.assertTrue(generator.initial_seed() == 2)
 
+    def test_cpu_random_independent_of_num_threads(test_case):
+        # the thread count is process wide, so every count runs in its own process
+        outputs = []
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            for num_threads in [1, max(os.cpu_count() or 1, 2)]:
+                output_path = os.path.join(tmp_dir, "{}.npz".format(num_threads))
+                subprocess.check_call(
+                    [
+                        sys.executable,
+                        os.path.abspath(__file__),
+                        "--num-threads-child",
+                        str(num_threads),
+                        output_path,
+                    ]
+                )
+                with np.load(output_path) as output:
+                    outputs.append([output[key] for key in sorted(output.files)])
+        for single_thread, multi_thread in zip(*outputs):
+            test_case.assertTrue(np.array_equal(single_thread, multi_thread))
+
+    def test_cpu_setstate_without_philox_offset(test_case):
+        generator = flow.Generator(device="cpu")
+        generator.manual_seed(3)
+        state = generator.get_state().numpy()
+        expected = flow.randn(1000, generator=generator).numpy()
+        flow.randn(1000, generator=generator)
+        # states saved before the philox offset end right after the seed
+        generator.set_state(flow.tensor(state[:-8], dtype=flow.uint8))
+        test_case.assertTrue(np.array_equal(generator.get_state().numpy(), state))
+        test_case.assertTrue(
+            np.array_equal(flow.randn(1000, generator=generator).numpy(), expected)
+        )
+
     def test_generator_in_dropout(test_case):
         tgt = flow.ones(2000000)
         output = flow._C.dropout(
@@ -171,4 +219,7 @@ class TestDefaultGenerator(flow.unittest.TestCase):
 
 
 if __name__ == "__main__":
-    unittest.main()
+    if len(sys.argv) == 4 and sys.argv[1] == "--num-threads-child":
+        _run_num_threads_child(int(sys.argv[2]), sys.argv[3])
+    else:
+        unittest.main()
@@ -306,6 +306,19 @@ class TestTopk(flow.unittest.TestCase):
         )
         return y[0], y[1]
 
+    def test_flow_topk_large_instance_cpu(test_case):
+        # Long rows are reduced by several threads on cpu.
+        for shape, k in [((2, 200000), 100), ((200000,), 1), ((3, 70000), 20000)]:
+            np_x = np.random.randn(*shape)
+            values, indices = flow.topk(flow.tensor(np_x), k)
+            np_indices = np.argsort(-np_x, axis=-1, kind="stable")[..., :k]
+            test_case.assertTrue(np.array_equal(indices.numpy(), np_indices))
+            test_case.assertTrue(
+                np.array_equal(
+                    values.numpy(), np.take_along_axis(np_x, np_indices, axis=-1)
+                )
+            )
+
 
 @flow.unittest.skip_unless_1n1d()
 class TestPow(flow.unittest.TestCase):
@@ -0,0 +1,194 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import os
+import tempfile
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from oneflow.test_utils.test_util import GenArgDict
+
+import oneflow as flow
+import oneflow.unittest
+
+# each table draws its ids from its own range and initializes them in its own range,
+# so a missing key initialized with the wrong table's initializer is visible
+_TABLE_RANGES = [(0, 64, 0.0, 1.0), (64, 96, 10.0, 11.0)]
+
+
+def _make_ids(batch_size):
+    columns = [
+        np.random.randint(id_low, id_high, (batch_size, 1), dtype=np.int64)
+        for id_low, id_high, _, _ in _TABLE_RANGES
+    ]
+    return np.concatenate(columns, axis=1)
+
+
+def _lookup_rows(ids, embeddings):
+    unique_ids, first_index = np.unique(ids.flatten(), return_index=True)
+    rows = embeddings.reshape(-1, embeddings.shape[-1])[first_index]
+    return dict(zip(unique_ids.tolist(), rows))
+
+
+def _rows_after_sgd(ids, embeddings, learning_rate):
+    # the loss is a plain sum, so every occurrence of an id adds a gradient of ones
+    unique_ids, counts = np.unique(ids.flatten(), return_counts=True)
+    id2row = _lookup_rows(ids, embeddings)
+    for key, count in zip(unique_ids.tolist(), counts.tolist()):
+        id2row[key] = id2row[key] - learning_rate * count
+    return id2row
+
+
+def _check_lookup(test_case, ids, embeddings, id2row):
+    for index in np.ndindex(*ids.shape):
+        test_case.assertTrue(
+            np.allclose(embeddings[index], id2row[ids[index]], atol=1e-5)
+        )
+
+
+def _read_snapshot(persistent_path, snapshot_name, embedding_size):
+    # a str persistent path holds rank i of n in "i-n"
+    reader = flow.one_embedding.make_persistent_table_reader(
+        [os.path.join(persistent_path, "0-1")],
+        snapshot_name,
+        flow.int64,
+        flow.float,
+        embedding_size,
+    )
+    id2row = {}
+    for keys, values in reader:
+        id2row.update(zip(keys.tolist(), values))
+    reader.close()
+    return id2row
+
+
+def _test_one_embedding_cpu(test_case, use_system_gather):
+    batch_size = 128
+    embedding_size = 16
+    learning_rate = 0.5
+    name = "cpu_embedding_system_gather_{}".format(use_system_gather)
+    env_backup = os.environ.get("ONEFLOW_ONE_EMBEDDING_USE_SYSTEM_GATHER")
+    # without the system gather a single rank runs the id_shuffle, embedding_shuffle
+    # and embedding_gradient_shuffle kernels
+    os.environ["ONEFLOW_ONE_EMBEDDING_USE_SYSTEM_GATHER"] = (
+        "1" if use_system_gather else "0"
+    )
+    try:
+        with tempfile.TemporaryDirectory() as persistent_path:
+            embedding = flow.one_embedding.MultiTableEmbedding(
+                name=name,
+                embedding_dim=embedding_size,
+                dtype=flow.float,
+                key_type=flow.int64,
+                tables=[
+                    flow.one_embedding.make_table_options(
+                        flow.one_embedding.make_uniform_initializer(
+                            low=init_low, high=init_high
+                        )
+                    )
+                    for _, _, init_low, init_high in _TABLE_RANGES
+                ],
+                store_options=flow.one_embedding.make_cpu_store_options(
+                    persistent_path, capacity=1024
+                ),
+            )
+
+            class TrainGraph(flow.nn.Graph):
+                def __init__(self):
+                    super().__init__()
+                    self.embedding = embedding
+                    self.add_optimizer(
+                        flow.optim.SGD(embedding.parameters(), lr=learning_rate)
+                    )
+
+                def build(self, ids):
+                    embeddings = self.embedding(ids)
+                    loss = embeddings.sum()
+                    loss.backward()
+                    return embeddings
+
+            graph = TrainGraph()
+            ids = _make_ids(batch_size)
+
+            def train_step():
+                return graph(flow.tensor(ids)).numpy()
+
+            # every key is missing, so each row comes from its table's initializer
+            embeddings = train_step()
+            test_case.assertEqual(embeddings.shape, (batch_size, 2, embedding_size))
+            for table_id, (_, _, init_low, init_high) in enumerate(_TABLE_RANGES):
+                test_case.assertTrue(np.all(embeddings[:, table_id] >= init_low))
+                test_case.assertTrue(np.all(embeddings[:, table_id] <= init_high))
+            # repeated ids are initialized once
+            _check_lookup(test_case, ids, embeddings, _lookup_rows(ids, embeddings))
+            id2row = _rows_after_sgd(ids, embeddings, learning_rate)
+
+            # every key is present and holds the row put back by the update
+            embeddings = train_step()
+            _check_lookup(test_case, ids, embeddings, id2row)
+            id2row = _rows_after_sgd(ids, embeddings, learning_rate)
+
+            embedding.save_snapshot("snapshot")
+            snapshot = _read_snapshot(persistent_path, "snapshot", embedding_size)
+            test_case.assertEqual(sorted(snapshot.keys()), sorted(id2row.keys()))
+            for key, row in id2row.items():
+                test_case.assertTrue(np.allclose(snapshot[key], row, atol=1e-5))
+
+            # a step after the snapshot changes the table, loading it restores it
+            _check_lookup(test_case, ids, train_step(), id2row)
+            embedding.load_snapshot("snapshot")
+            _check_lookup(test_case, ids, train_step(), id2row)
+
+            op_type_names = set(
+                op.user_conf.op_type_name
+                for op in graph._full_graph_proto.net.op
+                if op.HasField("user_conf")
+            )
+            expected_ops = [
+                "embedding_prefetch",
+                "embedding_lookup",
+                "sgd_embedding_update",
+                "embedding_put",
+            ]
+            if use_system_gather:
+                expected_ops += ["unique_key_value_pair"]
+            else:
+                expected_ops += [
+                    "id_shuffle",
+                    "embedding_shuffle",
+                    "embedding_gradient_shuffle",
+                ]
+            for op_type_name in expected_ops:
+                test_case.assertIn(op_type_name, op_type_names)
+    finally:
+        if env_backup is None:
+            del os.environ["ONEFLOW_ONE_EMBEDDING_USE_SYSTEM_GATHER"]
+        else:
+            os.environ["ONEFLOW_ONE_EMBEDDING_USE_SYSTEM_GATHER"] = env_backup
+
+
+@flow.unittest.skip_unless_1n1d()
+class OneEmbeddingCpuTestCase(flow.unittest.TestCase):
+    def test_one_embedding_cpu(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["use_system_gather"] = [True, False]
+        for arg in GenArgDict(arg_dict):
+            _test_one_embedding_cpu(test_case, **arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -89,6 +89,24 @@ class TestScatterOpsModule(flow.unittest.TestCase):
     def test_scatter_add_random_data_at_dim1(test_case):
         return _test_scatter_add_random_data(test_case, 1)
 
+    def test_scatter_add_large_skewed_index_cpu(test_case):
+        input = np.random.randn(64, 512).astype(np.float32)
+        src = np.random.randn(64, 4096).astype(np.float32)
+        index = np.random.randint(0, 512, size=(64, 4096))
+        index[np.random.rand(64, 4096) < 0.9] = 3
+        np_out = input.astype(np.float64)
+        for i in range(64):
+            np.add.at(np_out[i], index[i], src[i])
+
+        def run():
+            return flow.scatter_add(
+                flow.tensor(input), 1, flow.tensor(index), flow.tensor(src)
+            ).numpy()
+
+        of_out = run()
+        test_case.assertTrue(np.allclose(of_out, np_out, rtol=1e-4, atol=1e-3))
+        test_case.assertTrue(np.array_equal(of_out, run()))
+
 
 if __name__ == "__main__":
     unittest.main()
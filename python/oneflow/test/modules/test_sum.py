@@ -69,6 +69,42 @@ def _test_sum_impl(test_case, device, data_type):
     test_case.assertTrue(np.allclose(input.numpy(), of_out.numpy(), 1e-05, 1e-05))
 
 
+def _test_sum_cpu_reduce_layouts(test_case, shape, dim):
+    # Row, column, middle-axis, batch-norm style and mixed reductions, large enough
+    # for the cpu reduce engine to split the reduced rows over several parts.
+    np_arr = np.random.uniform(-1, 1, shape).astype(np.float32)
+    x = flow.tensor(np_arr, device="cpu")
+    np_out = np.sum(np_arr.astype(np.float64), axis=dim)
+    of_out = flow.sum(x, dim=dim)
+    test_case.assertTrue(np.allclose(of_out.numpy(), np_out, 1e-4, 1e-3))
+    of_out = flow.amax(x, dim=dim)
+    test_case.assertTrue(np.array_equal(of_out.numpy(), np.amax(np_arr, axis=dim)))
+    # float16 is accumulated in float, so only the final rounding differs.
+    half_arr = np_arr.astype(np.float16)
+    of_out = flow.sum(flow.tensor(half_arr, device="cpu"), dim=dim)
+    np_out = np.sum(half_arr.astype(np.float64), axis=dim).astype(np.float16)
+    test_case.assertTrue(
+        np.allclose(of_out.numpy().astype(np.float64), np_out, 1e-3, 1e-2)
+    )
+
+
+def _test_cpu_half_reduce(test_case, shape, dim):
+    # Values near 1 keep the float16 product in range over the reduced axes.
+    half_arr = np.random.uniform(0.9, 1.1, shape).astype(np.float16)
+    x = flow.tensor(half_arr, device="cpu")
+    of_out = flow.prod(x, dim=dim)
+    test_case.assertEqual(of_out.dtype, flow.float16)
+    np_out = np.prod(half_arr.astype(np.float64), axis=dim).astype(np.float16)
+    test_case.assertTrue(
+        np.allclose(of_out.numpy().astype(np.float64), np_out, 1e-2, 1e-2)
+    )
+    # min and max pick one of the inputs, so they match exactly.
+    of_out = flow.amin(x, dim=dim)
+    test_case.assertTrue(np.array_equal(of_out.numpy(), np.amin(half_arr, axis=dim)))
+    of_out = flow.amax(x, dim=dim)
+    test_case.assertTrue(np.array_equal(of_out.numpy(), np.amax(half_arr, axis=dim)))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestSumModule(flow.unittest.TestCase):
     def test_sum(test_case):
@@ -78,6 +114,32 @@ class TestSumModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _test_sum_impl(test_case, *arg)
 
+    def test_sum_cpu_reduce_layouts(test_case):
+        cases = [
+            ((1 << 20,), (0,)),
+            ((4, 300000), (1,)),
+            ((300000, 5), (0,)),
+            ((20000, 1000), (0,)),
+            ((8, 16, 3136), (0, 2)),
+            ((4, 50000, 6), (1,)),
+            ((3, 40, 50, 60), (0, 2)),
+            ((3, 40, 50, 60), (1, 3)),
+        ]
+        for shape, dim in cases:
+            _test_sum_cpu_reduce_layouts(test_case, shape, dim)
+
+    def test_cpu_half_reduce(test_case):
+        cases = [
+            ((1000,), (0,)),
+            ((64, 70), (1,)),
+            ((70, 64), (0,)),
+            ((4, 16, 50), (0, 2)),
+            # large enough for the reduced rows to be split over several parts
+            ((4, 50000, 6), (1,)),
+        ]
+        for shape, dim in cases:
+            _test_cpu_half_reduce(test_case, shape, dim)
+
     @autotest(check_graph=True)
     def test_sum_against_pytorch(test_case):
         device = random_device()
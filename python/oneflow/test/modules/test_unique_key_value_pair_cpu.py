@@ -0,0 +1,69 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_unique_key_value_pair(test_case, ids, num_tables, has_table_ids):
+    table_ids = (ids % num_tables).astype(np.int32)
+    outputs = flow._C.one_embedding_unique_key_value_pair(
+        flow.tensor(ids), flow.tensor(table_ids) if has_table_ids else None, num_tables
+    )
+    num_unique, unique_ids, unique_table_ids, inverse_indices = outputs
+    # Unique ids are numbered in the order of their first occurrence.
+    _, first = np.unique(ids, return_index=True)
+    first = np.sort(first)
+    np_unique_ids = ids.reshape(-1)[first]
+    num_unique = num_unique.numpy()[0]
+    test_case.assertEqual(num_unique, np_unique_ids.size)
+    unique_ids = unique_ids.numpy()[:num_unique]
+    test_case.assertTrue(np.array_equal(unique_ids, np_unique_ids))
+    inverse_indices = inverse_indices.numpy()
+    test_case.assertTrue(np.array_equal(unique_ids[inverse_indices], ids))
+    unique_table_ids = unique_table_ids.numpy()[:num_unique]
+    if has_table_ids:
+        test_case.assertTrue(
+            np.array_equal(unique_table_ids[inverse_indices], table_ids)
+        )
+    elif num_tables > 1:
+        # Without table ids, the position of the first occurrence picks the table.
+        test_case.assertTrue(np.array_equal(unique_table_ids, first % num_tables))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestUniqueKeyValuePairCpu(flow.unittest.TestCase):
+    def test_small_batch(test_case):
+        ids = np.random.randint(0, 100, size=(128, 3), dtype=np.int64)
+        _test_unique_key_value_pair(test_case, ids, 3, True)
+        _test_unique_key_value_pair(test_case, ids, 1, False)
+
+    def test_large_batch(test_case):
+        # Large enough for the table to be built by several threads.
+        ids = np.random.randint(0, 200000, size=(300000,), dtype=np.int64)
+        _test_unique_key_value_pair(test_case, ids, 4, True)
+        _test_unique_key_value_pair(test_case, ids, 4, False)
+
+    def test_skewed_ids(test_case):
+        ids = np.random.zipf(1.2, size=(300000,)).astype(np.int64)
+        _test_unique_key_value_pair(test_case, ids, 2, False)
+
+
+if __name__ == "__main__":
+    unittest.main()
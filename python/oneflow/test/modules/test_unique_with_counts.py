@@ -0,0 +1,68 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from oneflow.test_utils.test_util import GenArgDict
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_unique_with_counts(test_case, x, out_idx):
+    y, idx, count, num_unique = flow._C.unique_with_counts(
+        flow.tensor(x), out_idx=out_idx
+    )
+    # Unique values are numbered in the order of their first occurrence.
+    _, first, np_count = np.unique(x, return_index=True, return_counts=True)
+    order = np.argsort(first)
+    np_y = x[first[order]]
+    num_unique = num_unique.numpy()[0]
+    test_case.assertEqual(num_unique, np_y.size)
+    y = y.numpy()[:num_unique]
+    test_case.assertTrue(np.array_equal(y, np_y))
+    test_case.assertTrue(np.array_equal(y[idx.numpy()], x))
+    test_case.assertTrue(np.array_equal(count.numpy()[:num_unique], np_count[order]))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestUniqueWithCounts(flow.unittest.TestCase):
+    def test_small_input(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["dtype"] = [np.int32, np.int64, np.float32]
+        arg_dict["out_idx"] = [flow.int32, flow.int64]
+        for arg in GenArgDict(arg_dict):
+            x = np.random.randint(0, 100, size=(1000,)).astype(arg["dtype"])
+            _test_unique_with_counts(test_case, x, arg["out_idx"])
+
+    def test_large_input(test_case):
+        # 64k values or more are deduplicated by several threads.
+        arg_dict = OrderedDict()
+        arg_dict["num_values"] = [1 << 16, 300000]
+        arg_dict["max_value"] = [1000, 200000, 1 << 40]
+        arg_dict["out_idx"] = [flow.int32, flow.int64]
+        for arg in GenArgDict(arg_dict):
+            x = np.random.randint(0, arg["max_value"], size=(arg["num_values"],))
+            _test_unique_with_counts(test_case, x, arg["out_idx"])
+
+    def test_skewed_input(test_case):
+        x = np.random.zipf(1.2, size=(300000,)).astype(np.int64)
+        _test_unique_with_counts(test_case, x, flow.int64)
+
+
+if __name__ == "__main__":
+    unittest.main()
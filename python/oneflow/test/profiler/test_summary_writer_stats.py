@@ -0,0 +1,46 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import oneflow as flow
+import oneflow.unittest
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestSummaryWriterStats(flow.unittest.TestCase):
+    def test_summary_writer_stats(test_case):
+        class IdentityGraph(flow.nn.Graph):
+            def build(self, x):
+                return x + 1
+
+        # the events writer lives in the session runtime
+        IdentityGraph()(flow.ones(2))
+        stats = flow.profiler.summary_writer_stats()
+        test_case.assertEqual(
+            set(stats.keys()),
+            {
+                "written_event_num",
+                "written_bytes",
+                "dropped_event_num",
+                "events_per_second",
+            },
+        )
+        for value in stats.values():
+            test_case.assertGreaterEqual(value, 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
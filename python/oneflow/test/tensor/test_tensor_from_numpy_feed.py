@@ -0,0 +1,101 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import gc
+import os
+import sys
+import tracemalloc
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from oneflow.test_utils.test_util import GenArgDict
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_feed_lifetime(test_case, device, pin_memory):
+    arrays = [np.random.randn(64, 33).astype(np.float32) for _ in range(8)]
+    expected = [array.copy() for array in arrays]
+    refcounts = [sys.getrefcount(array) for array in arrays]
+    tensors = [
+        flow.tensor(array, device=device, pin_memory=pin_memory) for array in arrays
+    ]
+    for array, refcount in zip(arrays, refcounts):
+        # the tensor does not keep the caller's array alive
+        if device == "cuda" or pin_memory:
+            test_case.assertEqual(sys.getrefcount(array), refcount)
+        # and does not see later writes to it
+        array[:] = -1
+    del arrays
+    gc.collect()
+    # staging buffers released by earlier feeds are reused by later ones
+    expected.append(np.zeros((64, 33), dtype=np.float32))
+    tensors.append(flow.tensor(expected[-1], device=device, pin_memory=pin_memory))
+    for tensor, array in zip(tensors, expected):
+        test_case.assertEqual(tensor.is_pinned(), device == "cpu" and pin_memory)
+        test_case.assertTrue(np.array_equal(tensor.numpy(), array))
+
+
+def _feed_peak_bytes(array, device, pin_memory):
+    # numpy reports its data allocations to tracemalloc
+    tracemalloc.start()
+    tensor = flow.tensor(array, device=device, pin_memory=pin_memory)
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    tensor.numpy()
+    return peak
+
+
+def _test_feed_no_copy(test_case, device, pin_memory):
+    array = np.random.randn(1024, 1024, 4).astype(np.float32)
+    peak = _feed_peak_bytes(array, device, pin_memory)
+    test_case.assertLess(peak, array.nbytes // 2)
+    # a non-contiguous array still needs a contiguous copy
+    strided = array[:, :, ::2]
+    peak = _feed_peak_bytes(strided, device, pin_memory)
+    test_case.assertGreaterEqual(peak, strided.nbytes)
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestTensorFromNumpyFeed(flow.unittest.TestCase):
+    def test_cpu_feed_lifetime(test_case):
+        _test_feed_lifetime(test_case, "cpu", pin_memory=False)
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_staged_feed_lifetime(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["pin_memory"] = [True, False]
+        for arg in GenArgDict(arg_dict):
+            if arg["device"] == "cpu" and not arg["pin_memory"]:
+                continue
+            _test_feed_lifetime(test_case, **arg)
+
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_staged_feed_no_copy(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["pin_memory"] = [True, False]
+        for arg in GenArgDict(arg_dict):
+            if arg["device"] == "cpu" and not arg["pin_memory"]:
+                continue
+            _test_feed_no_copy(test_case, **arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
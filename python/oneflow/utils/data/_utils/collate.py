@@ -77,7 +77,12 @@ def default_collate(batch):
     elem = batch[0]
     elem_type = type(elem)
     if isinstance(elem, (flow.Tensor, flow._oneflow_internal.Tensor)):
-        # TODO: tensor.storage()._new_shared(numel)
+        from oneflow.multiprocessing.reductions import stack_into_worker_batch_ring
+
+        # in a worker process, stack straight into the shared memory batch ring
+        out = stack_into_worker_batch_ring(batch)
+        if out is not None:
+            return out
         return flow._C.stack(batch, dim=0)
     elif (
         elem_type.__module__ == "numpy"
@@ -0,0 +1,95 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Bus bandwidth of the cpu collectives, per algorithm and message size.
+
+    python3 -m oneflow.distributed.launch --nproc_per_node 4 tools/ccl_cpu_benchmark.py
+
+Bus bandwidth follows the nccl-tests convention: the algorithm bandwidth scaled by
+2 * (n - 1) / n for all-reduce and (n - 1) / n for reduce-scatter and all-gather, so that
+numbers are comparable across rank counts.
+"""
+import argparse
+import os
+
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--min_bytes", type=int, default=4 * 1024)
+    parser.add_argument("--max_bytes", type=int, default=256 * 1024 * 1024)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iters", type=int, default=20)
+    args = parser.parse_args()
+
+    world_size = flow.env.get_world_size()
+    rank = flow.env.get_rank()
+    placement = flow.placement("cpu", ranks=list(range(world_size)))
+    if rank == 0:
+        print(
+            "{:>18} {:>12} {:>12} {:>12}".format(
+                "collective", "bytes", "time(us)", "busbw(GB/s)"
+            )
+        )
+
+    def report(name, nbytes, seconds, factor):
+        if rank == 0:
+            busbw = nbytes * factor / seconds / 1e9
+            print(
+                "{:>18} {:>12} {:>12.1f} {:>12.3f}".format(
+                    name, nbytes, seconds * 1e6, busbw
+                )
+            )
+
+    nbytes = args.min_bytes
+    while nbytes <= args.max_bytes:
+        elem_cnt = nbytes // 4 // world_size * world_size
+        x = flow.ones(elem_cnt, dtype=flow.float32).to_global(
+            placement=placement, sbp=flow.sbp.partial_sum
+        )
+        for algo in ["ring", "halving_doubling"]:
+            os.environ["ONEFLOW_CCL_CPU_ALL_REDUCE_ALGO"] = algo
+            seconds = bench(
+                lambda: x.to_global(sbp=flow.sbp.broadcast).to_local().numpy(),
+                args.warmup,
+                args.iters,
+            )
+            report(
+                "all_reduce/" + algo,
+                elem_cnt * 4,
+                seconds,
+                2 * (world_size - 1) / world_size,
+            )
+        seconds = bench(
+            lambda: x.to_global(sbp=flow.sbp.split(0)).to_local().numpy(),
+            args.warmup,
+            args.iters,
+        )
+        report("reduce_scatter", elem_cnt * 4, seconds, (world_size - 1) / world_size)
+        s = x.to_global(sbp=flow.sbp.split(0))
+        seconds = bench(
+            lambda: s.to_global(sbp=flow.sbp.broadcast).to_local().numpy(),
+            args.warmup,
+            args.iters,
+        )
+        report("all_gather", elem_cnt * 4, seconds, (world_size - 1) / world_size)
+        nbytes *= 4
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Timing helper shared by the tools/*_cpu_benchmark.py scripts, which import it from the
+directory of the script.
+"""
+import time
+
+import oneflow as flow
+
+
+def bench(fn, warmup, iters):
+    """Returns the seconds per call of fn, averaged over iters calls after warmup calls.
+
+    Eager ops only enqueue instructions to the virtual machine, so the queue is drained
+    before the timer starts and before it is read.
+    """
+    for _ in range(warmup):
+        fn()
+    flow._oneflow_internal.eager.Sync()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    flow._oneflow_internal.eager.Sync()
+    return (time.perf_counter() - start) / iters
@@ -0,0 +1,96 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Time of the control plane exchanges that bootstrap a job, over the real grpc backend.
+
+    ONEFLOW_CTRL_BARRIER_ALGO=dissemination \\
+        python3 -m oneflow.distributed.launch --nproc_per_node 8 \\
+        tools/ctrl_bootstrap_benchmark.py
+
+Compares exchanging one value per rank with a push and a pull per peer, a batched
+pull and a prefix watch, and times full-world barriers with whichever algorithm
+ONEFLOW_CTRL_BARRIER_ALGO selects. Run it once per algorithm to compare them.
+"""
+import argparse
+import os
+import time
+
+import oneflow as flow
+
+_internal = flow._oneflow_internal
+
+
+def _exchange_per_key(name, rank, world_size):
+    _internal.CtrlPushKV("{}/{}".format(name, rank), str(rank))
+    for peer in range(world_size):
+        if peer != rank:
+            assert _internal.CtrlPullKV("{}/{}".format(name, peer)) == str(peer)
+
+
+def _exchange_batched(name, rank, world_size):
+    _internal.CtrlBatchPushKV([("{}/{}".format(name, rank), str(rank))])
+    keys = ["{}/{}".format(name, peer) for peer in range(world_size)]
+    assert _internal.CtrlBatchPullKV(keys) == [str(peer) for peer in range(world_size)]
+
+
+def _exchange_by_prefix(name, rank, world_size):
+    _internal.CtrlPushPrefixKV(name + "/", str(rank), str(rank))
+    assert len(_internal.CtrlPullKVByPrefix(name + "/", world_size)) == world_size
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--iters", type=int, default=20)
+    args = parser.parse_args()
+
+    rank = flow.env.get_rank()
+    world_size = flow.env.get_world_size()
+    if rank == 0:
+        print(
+            "{} ranks, ONEFLOW_CTRL_BARRIER_ALGO={}".format(
+                world_size, os.getenv("ONEFLOW_CTRL_BARRIER_ALGO", "auto")
+            )
+        )
+        print("{:>12} {:>12}".format("exchange", "time(ms)"))
+
+    cases = [
+        ("per key", _exchange_per_key),
+        ("batched", _exchange_batched),
+        ("prefix", _exchange_by_prefix),
+    ]
+    for case_name, exchange in cases:
+        _internal.CtrlBarrier("CtrlBootstrapBenchmark")
+        start = time.perf_counter()
+        for i in range(args.iters):
+            # Fresh keys every iteration, so no exchange is served from an earlier one.
+            name = "CtrlBootstrapBenchmark/{}/{}".format(exchange.__name__, i)
+            exchange(name, rank, world_size)
+        _internal.CtrlBarrier("CtrlBootstrapBenchmark")
+        seconds = (time.perf_counter() - start) / args.iters
+        if rank == 0:
+            print("{:>12} {:>12.3f}".format(case_name, seconds * 1e3))
+
+    _internal.CtrlBarrier("CtrlBootstrapBenchmark")
+    start = time.perf_counter()
+    for _ in range(args.iters):
+        _internal.CtrlBarrier("CtrlBootstrapBenchmark")
+    seconds = (time.perf_counter() - start) / args.iters
+    if rank == 0:
+        print("{:>12} {:>12.3f}".format("barrier", seconds * 1e3))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Latency of the DLRM dot interaction on cpu, fused_dot_feature_interaction against the
+batch_matmul, tril gather and concat it replaces.
+
+    python3 tools/dlrm_interaction_cpu_benchmark.py --threads 8
+
+Each case is the dense feature of the bottom mlp plus 26 sparse embeddings, as in the
+Criteo models. The inference rows only run the forward; the training rows also run the
+backward into both inputs.
+"""
+import argparse
+
+import numpy as np
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+NUM_SPARSE_FEATURES = 26
+
+
+def _fused(dense, sparse):
+    return flow._C.fused_dot_feature_interaction(
+        [dense.unsqueeze(1), sparse],
+        output_concat=dense,
+        self_interaction=False,
+        output_padding=1,
+        pooling="none",
+    )
+
+
+def _unfused(dense, sparse, li, lj, padding):
+    features = flow.cat([dense.unsqueeze(1), sparse], dim=1)
+    gram = flow.matmul(features, features, transpose_b=True)
+    return flow.cat([dense, gram[:, li, lj], padding], dim=1)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    args = parser.parse_args()
+    if args.threads > 0:
+        flow.set_num_threads(args.threads)
+
+    num_features = NUM_SPARSE_FEATURES + 1
+    li = flow.tensor([i for i in range(num_features) for j in range(i)])
+    lj = flow.tensor([j for i in range(num_features) for j in range(i)])
+
+    print(
+        "{:>36} {:>10} {:>10} {:>8}".format("case", "fused ms", "unfused ms", "speedup")
+    )
+    shapes = [(128, 128), (2048, 128), (8192, 128), (8192, 16)]
+    for batch_size, embedding_size in shapes:
+        dense_np = np.random.rand(batch_size, embedding_size).astype(np.float32)
+        sparse_np = np.random.rand(
+            batch_size, NUM_SPARSE_FEATURES, embedding_size
+        ).astype(np.float32)
+        padding = flow.zeros(batch_size, 1, dtype=flow.float32)
+        for mode in ["inference", "training"]:
+            requires_grad = mode == "training"
+            dense = flow.tensor(dense_np, requires_grad=requires_grad)
+            sparse = flow.tensor(sparse_np, requires_grad=requires_grad)
+
+            def run(interaction):
+                if not requires_grad:
+                    with flow.no_grad():
+                        return interaction()
+                out = interaction()
+                return flow.autograd.grad(out, [dense, sparse], flow.ones_like(out))
+
+            fused = bench(
+                lambda: run(lambda: _fused(dense, sparse)), args.warmup, args.iters
+            )
+            unfused = bench(
+                lambda: run(lambda: _unfused(dense, sparse, li, lj, padding)),
+                args.warmup,
+                args.iters,
+            )
+            name = "{} b{} d{}".format(mode, batch_size, embedding_size)
+            print(
+                "{:>36} {:>10.3f} {:>10.3f} {:>8.2f}".format(
+                    name, fused * 1e3, unfused * 1e3, unfused / fused
+                )
+            )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,100 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Throughput of the cpu gather and its backward (unsorted_segment_sum_like), dim_gather
+and scatter_add kernels under uniform and skewed index distributions.
+
+    python3 tools/gather_scatter_cpu_benchmark.py --threads 8
+
+The skewed distributions draw indices from a zipf law, so a few rows take most of the
+hits, as with the ids of an embedding table.
+"""
+import argparse
+
+import numpy as np
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+DISTRIBUTIONS = ["uniform", "zipf 1.1", "zipf 2.0", "single"]
+
+
+def _indices(distribution, num_indices, upper_bound):
+    if distribution == "uniform":
+        indices = np.random.randint(0, upper_bound, size=num_indices)
+    elif distribution == "single":
+        indices = np.zeros(num_indices)
+    else:
+        indices = np.random.zipf(float(distribution.split()[1]), size=num_indices) - 1
+        indices = np.random.permutation(upper_bound)[indices % upper_bound]
+    return flow.tensor(indices.astype(np.int64))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    args = parser.parse_args()
+    if args.threads > 0:
+        flow.set_num_threads(args.threads)
+
+    print("{:>36} {:>10} {:>12}".format("case", "ms", "GB/s"))
+
+    def report(name, nbytes, seconds):
+        print(
+            "{:>36} {:>10.3f} {:>12.2f}".format(
+                name, seconds * 1e3, nbytes / seconds / 1e9
+            )
+        )
+
+    for num_rows, dim, num_indices in [(1000000, 16, 1000000), (100000, 512, 65536)]:
+        table = flow.randn(num_rows, dim, dtype=flow.float32, requires_grad=True)
+        for distribution in DISTRIBUTIONS:
+            indices = _indices(distribution, num_indices, num_rows)
+            grad = flow.randn(num_indices, dim, dtype=flow.float32)
+            nbytes = 2 * grad.nelement() * 4
+            name = "gather {}x{} {}".format(num_rows, dim, distribution)
+            seconds = bench(
+                lambda: flow._C.gather(table, indices, axis=0), args.warmup, args.iters
+            )
+            report(name, nbytes, seconds)
+
+            def forward_backward():
+                out = flow._C.gather(table, indices, axis=0)
+                return flow.autograd.grad(out, table, grad)
+
+            # The backward of gather is unsorted_segment_sum_like into the table shape.
+            name = "gather+backward {}x{} {}".format(num_rows, dim, distribution)
+            seconds = bench(forward_backward, args.warmup, args.iters)
+            report(name, 2 * nbytes, seconds)
+
+    x = flow.randn(4096, 4096, dtype=flow.float32)
+    for distribution in DISTRIBUTIONS:
+        index = _indices(distribution, 4096 * 1024, 4096).reshape(4096, 1024)
+        nbytes = 2 * index.nelement() * 4
+        name = "dim_gather 4096x4096 {}".format(distribution)
+        seconds = bench(lambda: flow.gather(x, 1, index), args.warmup, args.iters)
+        report(name, nbytes, seconds)
+        src = flow.randn(4096, 1024, dtype=flow.float32)
+        name = "scatter_add 4096x4096 {}".format(distribution)
+        seconds = bench(
+            lambda: flow.scatter_add(x, 1, index, src), args.warmup, args.iters
+        )
+        report(name, nbytes, seconds)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,112 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Time of allocating, filling and adding to eager cpu tensors, with the numa host
+allocator against plain aligned_alloc.
+
+    python3 tools/host_allocator_cpu_benchmark.py --threads 8
+
+Each configuration runs in its own process, since the allocator reads its environment
+once. "aligned_alloc" raises the large block threshold above every size, which is the
+allocator before large blocks were introduced.
+"""
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+CONFIGS = [
+    ("aligned_alloc", {"ONEFLOW_CPU_LARGE_BLOCK_BYTES": str(1 << 62)}),
+    ("numa, no cache", {"ONEFLOW_CPU_LARGE_BLOCK_CACHE_BYTES": "0"}),
+    ("numa, no prefault", {"ONEFLOW_CPU_PREFAULT_LARGE_BLOCKS": "false"}),
+    ("numa", {}),
+]
+
+SIZES_MB = [1, 4, 64, 512]
+
+
+def _run_child(threads, warmup, iters):
+    import oneflow as flow
+
+    if threads > 0:
+        flow.set_num_threads(threads)
+    for size_mb in SIZES_MB:
+        numel = size_mb * 1024 * 1024 // 4
+
+        def step():
+            # a fresh output is allocated every iteration, as in a training loop
+            x = flow.ones(numel, dtype=flow.float32)
+            return x + 1
+
+        for _ in range(warmup):
+            step()
+        flow._oneflow_internal.eager.Sync()
+        start = time.perf_counter()
+        for _ in range(iters):
+            step()
+        flow._oneflow_internal.eager.Sync()
+        print(size_mb, (time.perf_counter() - start) / iters, flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=20)
+    parser.add_argument("--child", action="store_true")
+    args = parser.parse_args()
+    if args.child:
+        _run_child(args.threads, args.warmup, args.iters)
+        return
+
+    size2results = {size_mb: [] for size_mb in SIZES_MB}
+    for _, config_env in CONFIGS:
+        env = dict(os.environ)
+        env.update(config_env)
+        output = subprocess.check_output(
+            [
+                sys.executable,
+                os.path.abspath(__file__),
+                "--child",
+                "--threads",
+                str(args.threads),
+                "--warmup",
+                str(args.warmup),
+                "--iters",
+                str(args.iters),
+            ],
+            env=env,
+        )
+        for line in output.decode().splitlines():
+            size_mb, seconds = line.split()
+            size2results[int(size_mb)].append(float(seconds))
+
+    print(
+        "{:>8}".format("MB")
+        + "".join("{:>20}".format(name + " ms") for name, _ in CONFIGS)
+    )
+    for size_mb in SIZES_MB:
+        print(
+            "{:>8}".format(size_mb)
+            + "".join(
+                "{:>20.3f}".format(seconds * 1e3) for seconds in size2results[size_mb]
+            )
+        )
+
+
+if __name__ == "__main__":
+    main()
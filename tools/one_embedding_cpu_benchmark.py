@@ -0,0 +1,112 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Throughput of cpu one embedding, for lookup only and for a training step per optimizer.
+
+    python3 tools/one_embedding_cpu_benchmark.py --batch_size 16384 --num_tables 26
+
+The embedding is kept in a cpu persistent table (see
+flow.one_embedding.make_cpu_store_options) under a temporary directory. rows/s counts
+the looked up ids, i.e. batch_size * num_tables per step.
+"""
+import argparse
+import tempfile
+
+import numpy as np
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+
+def _make_embedding(name, args, persistent_path, size_factor):
+    store_options = flow.one_embedding.make_cpu_store_options(
+        persistent_path=persistent_path,
+        capacity=args.vocab_size,
+        size_factor=size_factor,
+    )
+    return flow.one_embedding.MultiTableEmbedding(
+        name=name,
+        embedding_dim=args.embedding_size,
+        dtype=flow.float,
+        key_type=flow.int64,
+        tables=[
+            flow.one_embedding.make_table_options(
+                flow.one_embedding.make_uniform_initializer(low=-0.05, high=0.05)
+            )
+            for _ in range(args.num_tables)
+        ],
+        store_options=store_options,
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--batch_size", type=int, default=16384)
+    parser.add_argument("--num_tables", type=int, default=26)
+    parser.add_argument("--embedding_size", type=int, default=128)
+    parser.add_argument("--vocab_size", type=int, default=1000000)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iters", type=int, default=20)
+    args = parser.parse_args()
+
+    ids = flow.tensor(
+        np.random.randint(
+            0, args.vocab_size, (args.batch_size, args.num_tables), dtype=np.int64
+        )
+    )
+    num_rows = args.batch_size * args.num_tables
+    print("{:>12} {:>12} {:>14}".format("step", "time(ms)", "rows/s"))
+
+    def report(name, seconds):
+        print(
+            "{:>12} {:>12.3f} {:>14.0f}".format(
+                name, seconds * 1e3, num_rows / seconds
+            )
+        )
+
+    optimizers = [
+        ("lookup", None, 1),
+        ("sgd", lambda params: flow.optim.SGD(params, lr=0.1), 1),
+        ("adagrad", lambda params: flow.optim.Adagrad(params, lr=0.1), 2),
+        ("adam", lambda params: flow.optim.Adam(params, lr=0.001), 3),
+    ]
+    for name, make_optimizer, size_factor in optimizers:
+        with tempfile.TemporaryDirectory() as persistent_path:
+            embedding = _make_embedding(
+                "bench_" + name, args, persistent_path, size_factor
+            )
+
+            class EmbeddingGraph(flow.nn.Graph):
+                def __init__(self):
+                    super().__init__()
+                    self.embedding = embedding
+                    if make_optimizer is not None:
+                        self.add_optimizer(make_optimizer(embedding.parameters()))
+
+                def build(self, ids):
+                    embeddings = self.embedding(ids)
+                    if make_optimizer is None:
+                        return embeddings
+                    loss = embeddings.sum()
+                    loss.backward()
+                    return loss
+
+            graph = EmbeddingGraph()
+            seconds = bench(lambda: graph(ids).numpy(), args.warmup, args.iters)
+            report(name, seconds)
+
+
+if __name__ == "__main__":
+    main()
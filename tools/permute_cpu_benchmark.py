@@ -0,0 +1,79 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Bandwidth of the cpu permute and copy_nd primitives, next to a plain copy of the same
+bytes.
+
+    python3 tools/permute_cpu_benchmark.py --threads 8
+
+Bandwidth counts every byte once read and once written. Views are disabled so that
+permute and narrow run their kernels instead of returning strided tensors.
+"""
+import argparse
+import os
+
+os.environ["ONEFLOW_DISABLE_VIEW"] = "1"
+
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+CASES = [
+    ("transpose 2d", (4096, 4096), (1, 0)),
+    ("nchw->nhwc", (32, 64, 56, 56), (0, 2, 3, 1)),
+    ("nhwc->nchw", (32, 56, 56, 64), (0, 3, 1, 2)),
+    ("heads (b,s,h,d)->(b,h,s,d)", (16, 512, 16, 64), (0, 2, 1, 3)),
+    ("heads (b,s,h,d)->(b,h,d,s)", (16, 512, 16, 64), (0, 2, 3, 1)),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    args = parser.parse_args()
+    if args.threads > 0:
+        flow.set_num_threads(args.threads)
+
+    print("{:>28} {:>12} {:>12} {:>12}".format("case", "MB", "GB/s", "copy GB/s"))
+
+    def report(name, nbytes, seconds, copy_seconds):
+        print(
+            "{:>28} {:>12.1f} {:>12.2f} {:>12.2f}".format(
+                name,
+                nbytes / 1e6,
+                2 * nbytes / seconds / 1e9,
+                2 * nbytes / copy_seconds / 1e9,
+            )
+        )
+
+    for name, shape, perm in CASES:
+        x = flow.randn(*shape, dtype=flow.float32)
+        nbytes = x.nelement() * 4
+        copy_seconds = bench(lambda: x.clone(), args.warmup, args.iters)
+        seconds = bench(lambda: flow.permute(x, perm), args.warmup, args.iters)
+        report(name, nbytes, seconds, copy_seconds)
+
+    x = flow.randn(64, 1024, 1024, dtype=flow.float32)
+    narrowed = flow.narrow(x, 2, 1, 1022)
+    nbytes = narrowed.nelement() * 4
+    copy_seconds = bench(lambda: narrowed.clone(), args.warmup, args.iters)
+    seconds = bench(lambda: flow.narrow(x, 2, 1, 1022), args.warmup, args.iters)
+    report("narrow (copy_nd)", nbytes, seconds, copy_seconds)
+
+
+if __name__ == "__main__":
+    main()
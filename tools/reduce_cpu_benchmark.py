@@ -0,0 +1,72 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+"""
+Throughput of the cpu reduce_sum, reduce_mean and reduce_max kernels on the shapes of
+the normalization layers: batch norm statistics over NCHW and NHWC activations, layer
+norm rows, and the bias gradients of linear layers.
+
+    python3 tools/reduce_cpu_benchmark.py --threads 8
+"""
+import argparse
+
+import oneflow as flow
+from cpu_benchmark_util import bench
+
+CASES = [
+    ("batch_norm nchw", (32, 64, 56, 56), (0, 2, 3)),
+    ("batch_norm nchw", (32, 256, 14, 14), (0, 2, 3)),
+    ("batch_norm nhwc", (32, 56, 56, 64), (0, 1, 2)),
+    ("batch_norm nhwc", (32, 14, 14, 256), (0, 1, 2)),
+    ("layer_norm", (8192, 1024), (1,)),
+    ("layer_norm", (64, 128, 768), (2,)),
+    ("group_norm", (32, 32, 8, 56, 56), (2, 3, 4)),
+    ("bias_grad", (65536, 1024), (0,)),
+    ("bias_grad", (64, 128, 768), (0, 1)),
+    ("whole", (1 << 26,), (0,)),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=10)
+    args = parser.parse_args()
+    if args.threads > 0:
+        flow.set_num_threads(args.threads)
+
+    print("{:>52} {:>10} {:>10}".format("case", "ms", "GB/s"))
+    for name, shape, dim in CASES:
+        for dtype in [flow.float32, flow.float16]:
+            x = flow.randn(*shape, dtype=flow.float32).to(dtype)
+            nbytes = x.nelement() * x.element_size()
+            ops = [("sum", flow.sum), ("max", flow.amax)]
+            if dtype == flow.float32:
+                ops.append(("mean", flow.mean))
+            for op_name, op in ops:
+                seconds = bench(lambda: op(x, dim=dim), args.warmup, args.iters)
+                case = "{} {} {} {} dim={}".format(
+                    op_name, name, tuple(shape), str(dtype).split(".")[-1], dim
+                )
+                print(
+                    "{:>52} {:>10.3f} {:>10.2f}".format(
+                        case, seconds * 1e3, nbytes / seconds / 1e9
+                    )
+                )
+
+
+if __name__ == "__main__":
+    main()